@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Document classes of lists of documents with one document per line
+/// \file documentLines.hpp
+#ifndef _STRUS_ANALYZER_DOCUMENT_LINES_HPP_INCLUDED
+#define _STRUS_ANALYZER_DOCUMENT_LINES_HPP_INCLUDED
+#include "strus/base/string_conv.hpp"
+#include <string>
+
+/// \brief MIME type of a list of JSON documents with one document per line (NDJSON, JSON Lines)
+#define STRUS_MIMETYPE_NDJSON "application/x-ndjson"
+
+namespace strus {
+namespace utils {
+
+/// \brief Get the MIME type of the documents of a list of documents with one document per line
+/// \param[in] mimeType MIME type of the list
+/// \return the MIME type of the documents in the list or NULL, if the MIME type does not describe a list with one document per line
+inline const char* documentLineMimeType( const std::string& mimeType)
+{
+	if (strus::caseInsensitiveEquals( mimeType, STRUS_MIMETYPE_NDJSON)
+	||  strus::caseInsensitiveEquals( mimeType, "x-ndjson"))
+	{
+		return "application/json";
+	}
+	return 0;
+}
+
+/// \brief Test if the lines of a content in a character set encoding can be found by searching for the byte '\\n'
+/// \param[in] encoding character set encoding of the content, empty for UTF-8
+inline bool isLineSplittableEncoding( const std::string& encoding)
+{
+	return !strus::caseInsensitiveStartsWith( encoding, "utf-16")
+	&&     !strus::caseInsensitiveStartsWith( encoding, "utf-32")
+	&&     !strus::caseInsensitiveStartsWith( encoding, "ucs-2")
+	&&     !strus::caseInsensitiveStartsWith( encoding, "ucs-4")
+	&&     !strus::caseInsensitiveStartsWith( encoding, "ucs2")
+	&&     !strus::caseInsensitiveStartsWith( encoding, "ucs4");
+}
+
+}}//namespace
+#endif
+
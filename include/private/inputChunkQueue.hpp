@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Queue of the input chunks fed to a segmenter and not consumed yet
+/// \file inputChunkQueue.hpp
+#ifndef _STRUS_ANALYZER_INPUT_CHUNK_QUEUE_HPP_INCLUDED
+#define _STRUS_ANALYZER_INPUT_CHUNK_QUEUE_HPP_INCLUDED
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstddef>
+
+namespace strus
+{
+
+/// \brief Ring buffer of the input chunks fed to a segmenter and not consumed yet
+/// \note Chunks are either copied into a buffer of the queue or referenced, if the caller guarantees their lifetime.
+///	The buffers of chunks released are reused for the next chunks copied.
+///	The chunk at the front of the queue stays at its address as long as it is not released.
+class InputChunkQueue
+{
+public:
+	InputChunkQueue()
+		:m_ring(),m_head(0),m_size(0),m_bufferedSize(0){}
+	~InputChunkQueue()
+	{
+		std::vector<Chunk*>::const_iterator ri = m_ring.begin(), re = m_ring.end();
+		for (; ri != re; ++ri) delete *ri;
+	}
+
+	/// \brief Add a chunk to the queue, copying it into a buffer of the queue
+	void pushCopy( const char* chunk, std::size_t chunksize)
+	{
+		Chunk& slot = allocSlot();
+		slot.buf.assign( chunk, chunksize);
+		slot.ref = 0;
+		slot.size = chunksize;
+		++m_size;
+		m_bufferedSize += chunksize;
+	}
+
+	/// \brief Add a chunk to the queue without copying it
+	/// \note The chunk must stay valid until it is released with pop_front
+	void pushReference( const char* chunk, std::size_t chunksize)
+	{
+		Chunk& slot = allocSlot();
+		slot.ref = chunk;
+		slot.size = chunksize;
+		++m_size;
+		m_bufferedSize += chunksize;
+	}
+
+	/// \brief Release the oldest chunk of the queue
+	void pop_front()
+	{
+		Chunk& slot = *m_ring[ m_head];
+		m_bufferedSize -= slot.size;
+		slot.buf.clear();
+		slot.ref = 0;
+		slot.size = 0;
+		m_head = (m_head + 1) % m_ring.size();
+		--m_size;
+	}
+
+	/// \brief Pointer to the content of the oldest chunk of the queue
+	const char* frontPtr() const
+	{
+		const Chunk& slot = *m_ring[ m_head];
+		return slot.ref ? slot.ref : slot.buf.c_str();
+	}
+	/// \brief Size of the oldest chunk of the queue in bytes
+	std::size_t frontSize() const
+	{
+		return m_ring[ m_head]->size;
+	}
+
+	/// \brief Test if there are no chunks in the queue
+	bool empty() const			{return m_size == 0;}
+	/// \brief Number of chunks in the queue
+	std::size_t size() const		{return m_size;}
+	/// \brief Sum of the sizes of all chunks in the queue in bytes
+	std::size_t bufferedSize() const	{return m_bufferedSize;}
+
+	/// \brief Release all chunks, keeping the buffers allocated
+	void clear()
+	{
+		while (m_size) pop_front();
+		m_head = 0;
+	}
+
+private:
+	InputChunkQueue( const InputChunkQueue&){}	//... non copyable
+	void operator=( const InputChunkQueue&){}	//... non copyable
+
+	struct Chunk
+	{
+		std::string buf;
+		const char* ref;
+		std::size_t size;
+
+		Chunk()
+			:buf(),ref(0),size(0){}
+	};
+
+	Chunk& allocSlot()
+	{
+		if (m_size == m_ring.size())
+		{
+			// ... grow the ring, moving only the pointers to the chunks
+			std::rotate( m_ring.begin(), m_ring.begin() + m_head, m_ring.end());
+			m_head = 0;
+			m_ring.resize( m_ring.empty() ? 4 : m_ring.size() * 2, 0);
+		}
+		Chunk*& slot = m_ring[ (m_head + m_size) % m_ring.size()];
+		if (!slot) slot = new Chunk();
+		return *slot;
+	}
+
+private:
+	std::vector<Chunk*> m_ring;
+	std::size_t m_head;
+	std::size_t m_size;
+	std::size_t m_bufferedSize;
+};
+
+}//namespace
+#endif
+
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Read only memory mapping of a file for sequential processing
+/// \file mappedFile.hpp
+#ifndef _STRUS_UTILS_MAPPED_FILE_HPP_INCLUDED
+#define _STRUS_UTILS_MAPPED_FILE_HPP_INCLUDED
+#include <string>
+#include <cstddef>
+
+namespace strus {
+namespace utils {
+
+/// \brief Read only memory mapping of a file for sequential processing
+/// \note On platforms without mmap the file is read into a buffer owned by this
+class MappedFile
+{
+public:
+	MappedFile()
+		:m_ptr(0),m_size(0),m_mapped(false),m_buf(){}
+	~MappedFile()
+	{
+		close();
+	}
+
+	/// \brief Map the content of a file, releasing the previous mapping
+	/// \param[in] path path of the file to map
+	/// \note Throws std::runtime_error on failure
+	void open( const std::string& path);
+
+	/// \brief Release the mapping
+	void close();
+
+	/// \brief Pointer to the content of the file, valid until the mapping is closed
+	const char* ptr() const		{return m_ptr;}
+	/// \brief Size of the file in bytes
+	std::size_t size() const	{return m_size;}
+
+private:
+	MappedFile( const MappedFile&){}	//... non copyable
+	void operator=( const MappedFile&){}	//... non copyable
+
+private:
+	const char* m_ptr;
+	std::size_t m_size;
+	bool m_mapped;
+	std::string m_buf;
+};
+
+}}//namespace
+#endif
+
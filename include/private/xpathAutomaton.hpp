@@ -13,19 +13,54 @@
 #include "textwolf/xmlscanner.hpp"
 #include "textwolf/charset.hpp"
 #include "textwolf/sourceiterator.hpp"
+#include <vector>
+#include <string>
 #include <cstdlib>
 #include <setjmp.h>
 
 namespace strus
 {
 
+/// \brief Set of the tag names referenced by the selector expressions of an automaton
+/// \note If all expressions are absolute paths without descendant steps ('//') and without wildcards ('*'),
+///	no expression can select anything in the subtree of a tag not in this set. The filter is disabled otherwise.
+///	The names are stored in an open addressing hash table, compared case insensitive, so that the
+///	cost of a lookup does not depend on the number of expressions.
+class XPathTagFilter
+{
+public:
+	XPathTagFilter()
+		:m_table(),m_size(0),m_enabled(true){}
+
+	/// \brief Add the tag names of a selector expression or disable the filter if the expression can select elements in tags not referenced
+	void addExpression( const std::string& expression);
+
+	/// \brief Test if the filter can be used to skip subtrees
+	bool enabled() const
+	{
+		return m_enabled && m_size;
+	}
+
+	/// \brief Test if a tag name is referenced by a selector expression
+	bool contains( const char* tagname, std::size_t tagnamesize) const;
+
+private:
+	void insert( const char* tagname, std::size_t tagnamesize);
+
+private:
+	std::vector<std::string> m_table;	///< hash table of the lowercase tag names, empty strings for unused slots
+	std::size_t m_size;			///< number of tag names in the table
+	bool m_enabled;				///< false if the set of expressions does not allow filtering
+};
+
+
 class XPathAutomatonContext
 {
 public:
 	typedef textwolf::XMLPathSelectAutomaton<> Automaton;
 
 public:
-	explicit XPathAutomatonContext( const Automaton* automaton_);
+	XPathAutomatonContext( const Automaton* automaton_, const XPathTagFilter* tagFilter_);
 	~XPathAutomatonContext(){}
 
 	void putElement(
@@ -35,22 +70,28 @@ public:
 
 	bool getNext( int& id);
 
+	/// \brief Reset the state for selecting the elements of a new document
+	void reset();
+
 private:
 	typedef textwolf::XMLPathSelect<
 			textwolf::charset::UTF8
 		> XMLPathSelect;
 
 	const Automaton* m_automaton;
+	const XPathTagFilter* m_tagFilter;
 	XMLPathSelect m_pathselect;
 	XMLPathSelect::iterator m_selitr;
 	XMLPathSelect::iterator m_selend;
+	int m_skipDepth;		///< depth in the subtree of a tag not referenced by any expression, 0 if not in such a subtree
 };
 
 
 class XPathAutomaton
 {
 public:
-	XPathAutomaton(){}
+	XPathAutomaton()
+		:m_automaton(),m_tagFilter(){}
 	~XPathAutomaton(){}
 
 	void defineSelectorExpression( int id, const std::string& expression);
@@ -64,6 +105,7 @@ private:
 private:
 	typedef textwolf::XMLPathSelectAutomatonParser<> Automaton;
 	Automaton m_automaton;
+	XPathTagFilter m_tagFilter;
 };
 
 } // namespace
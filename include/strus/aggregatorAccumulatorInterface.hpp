@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Interface for the incremental evaluation of an aggregator function on the search index terms of a document
+/// \file aggregatorAccumulatorInterface.hpp
+#ifndef _STRUS_ANALYZER_AGGREGATOR_ACCUMULATOR_INTERFACE_HPP_INCLUDED
+#define _STRUS_ANALYZER_AGGREGATOR_ACCUMULATOR_INTERFACE_HPP_INCLUDED
+#include "strus/numericVariant.hpp"
+#include <vector>
+#include <string>
+#include <cstddef>
+
+/// \brief strus toplevel namespace
+namespace strus
+{
+
+/// \class AggregatorAccumulatorInterface
+/// \brief Interface for the incremental evaluation of an aggregator function on the search index terms of a document
+/// \note The search index terms of a document are passed to all accumulators of a document analyzer in one pass.
+///	Only terms with a type in the list returned by featureTypes() are passed to an accumulator.
+class AggregatorAccumulatorInterface
+{
+public:
+	/// \brief Destructor
+	virtual ~AggregatorAccumulatorInterface(){}
+
+	/// \brief Get the types of the search index terms this accumulator has to see
+	/// \return list of type names (compared case sensitive with the types of the search index terms)
+	virtual std::vector<std::string> featureTypes() const=0;
+
+	/// \brief Reset the state for the evaluation on a new document
+	virtual void clear()=0;
+
+	/// \brief Add a search index term of the current document
+	/// \param[in] typeidx index of the type of the term in the list returned by featureTypes()
+	/// \param[in] value value of the search index term
+	/// \param[in] valuesize size of value in bytes
+	virtual void add( int typeidx, const char* value, std::size_t valuesize)=0;
+
+	/// \brief Get the result of the aggregation of the terms added since the last clear
+	/// \return aggregated value, equal to the value returned by AggregatorFunctionInstanceInterface::evaluate for the document
+	virtual NumericVariant result() const=0;
+};
+
+}//namespace
+#endif
+
@@ -16,6 +16,8 @@
 /// \brief strus toplevel namespace
 namespace strus
 {
+/// \brief Forward declaration
+class AggregatorAccumulatorInterface;
 
 /// \class AggregatorFunctionInstanceInterface
 /// \brief Interface for a parameterized aggregator function
@@ -30,6 +32,14 @@ public:
 	/// \return aggregated value
 	virtual NumericVariant evaluate( const analyzer::Document& document) const=0;
 
+	/// \brief Create an accumulator evaluating this function incrementally on the search index terms of a document, in one pass with the other aggregators
+	/// \return the accumulator (with ownership) or NULL, if the function has to be evaluated on the complete document with evaluate(const analyzer::Document&) or in case of an error
+	/// \note the default implementation returns NULL
+	virtual AggregatorAccumulatorInterface* createAccumulator() const
+	{
+		return 0;
+	}
+
 	/// \brief Get the name of the function
 	/// \return the identifier
 	virtual const char* name() const=0;
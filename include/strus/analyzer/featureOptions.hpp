@@ -39,8 +39,16 @@ public:
 	FeatureOptions( unsigned int opt_)
 		:m_opt(opt_){}
 
+	/// \brief Layout of the bits of the options transcription
+	enum {
+		PositionBindMask=0x3,		///< bits 0..1: PositionBind value
+		ReservedMask=0xfc,		///< bits 2..7: reserved for further flags
+		NormalizerCacheSizeShift=8,	///< bits 8..31: maximum number of entries of the normalizer cache
+		MaxNormalizerCacheSize=0xffffff	///< maximum number of entries of the normalizer cache
+	};
+
 	/// \brief Get the PositionBind value set
-	analyzer::PositionBind positionBind() const		{return (analyzer::PositionBind)(m_opt & 0x3);}
+	analyzer::PositionBind positionBind() const		{return (analyzer::PositionBind)(m_opt & PositionBindMask);}
 	const char* positionBindName() const
 	{
 		static const char* ar[] = {"content","succ","pred","unique"};
@@ -48,7 +56,18 @@ public:
 	}
 
 	/// \brief Define the PositionBind value
-	void definePositionBind( analyzer::PositionBind b)	{m_opt &= ~0x3; m_opt |= (unsigned int)b;}
+	void definePositionBind( analyzer::PositionBind b)	{m_opt &= ~(unsigned int)PositionBindMask; m_opt |= ((unsigned int)b & PositionBindMask);}
+
+	/// \brief Get the maximum number of entries of the cache for the normalization results of the feature, 0 if no cache is used
+	unsigned int normalizerCacheSize() const		{return m_opt >> NormalizerCacheSizeShift;}
+
+	/// \brief Define the maximum number of entries of the cache for the normalization results of the feature
+	/// \param[in] size maximum number of entries (up to MaxNormalizerCacheSize, bigger values are truncated), 0 for no cache
+	void defineNormalizerCacheSize( unsigned int size)
+	{
+		m_opt &= (PositionBindMask | ReservedMask);
+		m_opt |= ((size > MaxNormalizerCacheSize ? (unsigned int)MaxNormalizerCacheSize : size) << NormalizerCacheSizeShift);
+	}
 
 	/// \brief Get the options transacription as integer
 	unsigned int opt() const				{return m_opt;}
@@ -56,12 +75,21 @@ public:
 	StructView view() const
 	{
 		StructView rt;
-		if (opt())
+		if (positionBind() != analyzer::BindContent)
 		{
 			rt( "position", positionBindName());
 		}
+		if (normalizerCacheSize())
+		{
+			rt( "cache", (int)normalizerCacheSize());
+		}
 		return rt;
 	}
+private:
+	// ... compile time check that the bits of the flags and of the normalizer cache size do not overlap and that the cache size fits into the options
+	typedef char CheckFlagBits[ ((PositionBindMask | ReservedMask) >> NormalizerCacheSizeShift) == 0 ? 1 : -1];
+	typedef char CheckCacheSizeBits[ ((unsigned int)MaxNormalizerCacheSize <= (0xffffffffU >> NormalizerCacheSizeShift)) ? 1 : -1];
+
 private:
 	unsigned int m_opt;
 };
@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Output of the normalization of a batch of tokens
+/// \file normalizedOutput.hpp
+#ifndef _STRUS_ANALYZER_NORMALIZED_OUTPUT_HPP_INCLUDED
+#define _STRUS_ANALYZER_NORMALIZED_OUTPUT_HPP_INCLUDED
+#include "strus/analyzer/tokenSpan.hpp"
+#include <vector>
+#include <string>
+#include <cstring>
+
+/// \brief strus toplevel namespace
+namespace strus {
+/// \brief analyzer parameter and return value objects namespace
+namespace analyzer {
+
+/// \brief Output of the normalization of a batch of tokens
+/// \note The values are appended to one string buffer (arena), that is kept with its capacity when cleared.
+///	Every input token gets a list of zero or more values. The values of the current token are added with
+///	append/push_back followed by closeValue (or addValue), the list of values of the token is closed with closeToken.
+class NormalizedOutput
+{
+public:
+	/// \brief Default constructor
+	NormalizedOutput()
+		:m_arena(),m_valueEnd(),m_tokenEnd(){}
+
+	/// \brief Reset the content, keeping the memory allocated
+	void clear()
+	{
+		m_arena.clear();
+		m_valueEnd.clear();
+		m_tokenEnd.clear();
+	}
+
+	/// \brief Append a string to the value currently built
+	void append( const char* ptr, std::size_t size)
+	{
+		m_arena.append( ptr, size);
+	}
+	/// \brief Append a null terminated string to the value currently built
+	void append( const char* str)
+	{
+		m_arena.append( str);
+	}
+	/// \brief Append a character to the value currently built
+	void push_back( char ch)
+	{
+		m_arena.push_back( ch);
+	}
+	/// \brief Close the value currently built and add it to the values of the current token
+	void closeValue()
+	{
+		m_valueEnd.push_back( m_arena.size());
+	}
+	/// \brief Add a value to the values of the current token
+	void addValue( const char* ptr, std::size_t size)
+	{
+		m_arena.append( ptr, size);
+		m_valueEnd.push_back( m_arena.size());
+	}
+	/// \brief Close the list of values of the current token, the following values belong to the next token
+	void closeToken()
+	{
+		m_tokenEnd.push_back( m_valueEnd.size());
+	}
+
+	/// \brief Add the values of a token in the format returned by NormalizerFunctionInstanceInterface::normalize and close the token
+	/// \param[in] res single value or list of '\0' prefixed values, if the first character is a '\0'
+	void addNormalizeResult( const std::string& res)
+	{
+		if (!res.empty() && res[0] == '\0')
+		{
+			char const* vi = res.c_str();
+			char const* ve = vi + res.size();
+			for (++vi; vi < ve; vi = std::strchr( vi, '\0')+1)
+			{
+				addValue( vi, std::strlen( vi));
+			}
+		}
+		else
+		{
+			addValue( res.c_str(), res.size());
+		}
+		closeToken();
+	}
+
+	/// \brief Get the number of tokens with their values closed
+	std::size_t nofTokens() const
+	{
+		return m_tokenEnd.size();
+	}
+	/// \brief Get the index of the first value of a token
+	std::size_t valuesStart( std::size_t tokidx) const
+	{
+		return tokidx ? m_tokenEnd[ tokidx-1] : 0;
+	}
+	/// \brief Get the index of the value following the last value of a token
+	std::size_t valuesEnd( std::size_t tokidx) const
+	{
+		return m_tokenEnd[ tokidx];
+	}
+	/// \brief Get the total number of values
+	std::size_t nofValues() const
+	{
+		return m_valueEnd.size();
+	}
+	/// \brief Get a value by index
+	TokenSpan value( std::size_t validx) const
+	{
+		std::size_t start = validx ? m_valueEnd[ validx-1] : 0;
+		return TokenSpan( m_arena.c_str() + start, m_valueEnd[ validx] - start);
+	}
+
+	/// \brief Get the values of a token in the format returned by NormalizerFunctionInstanceInterface::normalize
+	/// \return single value or list of '\0' prefixed values if the token has not exactly one value or the value starts with a '\0'
+	std::string normalizeResult( std::size_t tokidx) const
+	{
+		return normalizeResult( valuesStart( tokidx), valuesEnd( tokidx));
+	}
+
+	/// \brief Get a range of values in the format returned by NormalizerFunctionInstanceInterface::normalize
+	/// \param[in] vi index of the first value
+	/// \param[in] ve index of the value following the last value
+	std::string normalizeResult( std::size_t vi, std::size_t ve) const
+	{
+		std::string rt;
+		if (ve - vi == 1 && !(value( vi).size() && value( vi).ptr()[0] == '\0'))
+		{
+			rt.append( value( vi).ptr(), value( vi).size());
+		}
+		else if (vi == ve)
+		{
+			rt.push_back( '\0');	// ... empty list
+		}
+		else
+		{
+			for (; vi != ve; ++vi)
+			{
+				TokenSpan val = value( vi);
+				rt.push_back( '\0');
+				rt.append( val.ptr(), val.size());
+			}
+		}
+		return rt;
+	}
+
+	/// \brief Exchange the content with another output
+	void swap( NormalizedOutput& o)
+	{
+		m_arena.swap( o.m_arena);
+		m_valueEnd.swap( o.m_valueEnd);
+		m_tokenEnd.swap( o.m_tokenEnd);
+	}
+
+private:
+	NormalizedOutput( const NormalizedOutput&){}	//... non copyable
+	void operator=( const NormalizedOutput&){}	//... non copyable
+
+private:
+	std::string m_arena;			///< buffer with all values appended
+	std::vector<std::size_t> m_valueEnd;	///< end of each value in m_arena
+	std::vector<std::size_t> m_tokenEnd;	///< end of the list of values of each token in m_valueEnd
+};
+
+}}//namespace
+#endif
+
@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Structure referencing the string of a token to process, without ownership
+/// \file tokenSpan.hpp
+#ifndef _STRUS_ANALYZER_TOKEN_SPAN_HPP_INCLUDED
+#define _STRUS_ANALYZER_TOKEN_SPAN_HPP_INCLUDED
+#include <cstddef>
+
+/// \brief strus toplevel namespace
+namespace strus {
+/// \brief analyzer parameter and return value objects namespace
+namespace analyzer {
+
+/// \brief Structure referencing the string of a token to process, without ownership
+struct TokenSpan
+{
+public:
+	/// \brief Default constructor
+	TokenSpan()
+		:m_ptr(0),m_size(0){}
+	/// \brief Constructor
+	/// \param[in] ptr_ pointer to the start of the token string (not owned, not necessarily null terminated)
+	/// \param[in] size_ size of the token string in bytes
+	TokenSpan( const char* ptr_, std::size_t size_)
+		:m_ptr(ptr_),m_size(size_){}
+	/// \brief Copy constructor
+	TokenSpan( const TokenSpan& o)
+		:m_ptr(o.m_ptr),m_size(o.m_size){}
+
+	/// \brief Get the pointer to the start of the token string
+	const char* ptr() const		{return m_ptr;}
+	/// \brief Get the size of the token string in bytes
+	std::size_t size() const	{return m_size;}
+
+private:
+	const char* m_ptr;
+	std::size_t m_size;
+};
+
+}}//namespace
+#endif
+
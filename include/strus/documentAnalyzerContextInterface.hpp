@@ -10,12 +10,15 @@
 #ifndef _STRUS_ANALYZER_DOCUMENT_ANALYZER_CONTEXT_INTERFACE_HPP_INCLUDED
 #define _STRUS_ANALYZER_DOCUMENT_ANALYZER_CONTEXT_INTERFACE_HPP_INCLUDED
 #include "strus/analyzer/document.hpp"
+#include "strus/analyzer/documentClass.hpp"
 #include <vector>
 #include <string>
 
 /// \brief strus toplevel namespace
 namespace strus
 {
+/// \brief Forward declaration
+class DocumentSinkInterface;
 
 /// \brief Defines the context for analyzing multi part documents, iterating on the sub documents defined, splitting them into normalized terms that can be fed to the strus IR engine
 class DocumentAnalyzerContextInterface
@@ -30,10 +33,46 @@ public:
 	/// \param[in] eof true, if this chunk fed is the last one in input
 	virtual void putInput( const char* chunk, std::size_t chunksize, bool eof)=0;
 
+	/// \brief Feed the analyzer with the next chunk of input to process without copying it
+	/// \param[in] chunk pointer to input chunk to process
+	/// \param[in] chunksize size of input chunk to process in bytes
+	/// \param[in] eof true, if this chunk fed is the last one in input
+	/// \remark the caller guarantees that the chunk stays valid until it is consumed, that is until bufferedInputSize() does not count it anymore (chunks are consumed in the order they were fed)
+	/// \note the default implementation copies the chunk with putInput
+	virtual void putInputReference( const char* chunk, std::size_t chunksize, bool eof)
+	{
+		putInput( chunk, chunksize, eof);
+	}
+
+	/// \brief Feed the analyzer with the complete content of a file mapped into memory instead of reading it into a buffer
+	/// \param[in] path path of the file to process
+	/// \remark The file content is the last input fed (end of input is declared). The mapping is released when the context is destroyed.
+	virtual void putInputMapped( const std::string& path)=0;
+
+	/// \brief Get the sum of the sizes in bytes of the chunks fed and not consumed yet
+	/// \return the number of bytes buffered or referenced by the segmenter
+	/// \note used by the caller to apply back-pressure, feeding more input only if the number is below a limit
+	virtual std::size_t bufferedInputSize() const
+	{
+		return 0;
+	}
+
+	/// \brief Reset the context for analyzing a new input, keeping the segmenter contexts and buffers allocated where possible
+	/// \param[in] dclass description of the content type and encoding of the new input
+	/// \return true on success, false on error (reported to the error buffer)
+	/// \remark Input fed before and not processed yet is discarded
+	virtual bool reset( const analyzer::DocumentClass& dclass)=0;
+
 	/// \brief Analyze the next sub document from the input feeded with putInput(const char*,std::size_t)
 	/// \param[out] doc the analyzed sub document structure
 	/// \return true, if the next document could be fetched, false if more input has to be fed or no input left (EOF)
 	virtual bool analyzeNext( analyzer::Document& doc)=0;
+
+	/// \brief Analyze the next sub document from the input feeded with putInput(const char*,std::size_t) and pass its elements to a sink without building an analyzer::Document
+	/// \param[in,out] sink receiver of the elements of the analyzed sub document
+	/// \return true, if the next document could be fetched, false if more input has to be fed or no input left (EOF)
+	/// \note The strings passed to the sink are views into the buffers of the analyzer context, valid only during the call
+	virtual bool analyzeNext( DocumentSinkInterface& sink)=0;
 };
 
 }//namespace
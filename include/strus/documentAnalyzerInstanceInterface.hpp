@@ -167,6 +167,21 @@ public:
 			const std::string& selectexpr,
 			const analyzer::DocumentClass& documentClass)=0;
 
+	/// \brief Enable the parallel tokenization and normalization of the features of big documents
+	/// \param[in] minDocumentSize minimum size of the input of a document analyzer context in bytes, from which on its features are processed in parallel
+	/// \param[in] nofThreads number of threads to use for one document, 0 or 1 for disabling parallel processing
+	/// \remark The result of the analysis is the same as with sequential processing
+	virtual void defineParallelProcessing(
+			std::size_t minDocumentSize,
+			unsigned int nofThreads)=0;
+
+	/// \brief Define the maximum number of document analyzer contexts kept for reuse in the pool of contexts of this analyzer
+	/// \param[in] maxNofContexts maximum number of contexts kept, 0 for disabling the reuse of contexts
+	/// \remark The pool is used by analyze, analyzeFile and acquireContext. It should be as big as the number of threads analyzing documents concurrently.
+	/// \note Any definition changing the configuration of the analyzer deletes the contexts kept in the pool
+	virtual void defineContextPool(
+			std::size_t maxNofContexts)=0;
+
 	/// \brief Segment and tokenize a document, assign types to tokens and metadata and normalize their values
 	/// \param[in] content document content string to analyze
 	/// \param[in] dclass description of the content type and encoding to process
@@ -176,12 +191,86 @@ public:
 			const std::string& content,
 			const analyzer::DocumentClass& dclass) const=0;
 
+	/// \brief Segment and tokenize a document read from a file mapped into memory, assign types to tokens and metadata and normalize their values
+	/// \param[in] path path of the file with the document content to analyze
+	/// \param[in] dclass description of the content type and encoding to process
+	/// \return the analyzed document
+	/// \remark Same as analyze(const std::string&,const analyzer::DocumentClass&) without reading the file content into a string before
+	virtual analyzer::Document analyzeFile(
+			const std::string& path,
+			const analyzer::DocumentClass& dclass) const=0;
+
+	/// \brief Input document of a batch analysis
+	struct Input
+	{
+		std::string content;			///< document content string to analyze
+		analyzer::DocumentClass dclass;		///< description of the content type and encoding to process
+
+		Input()
+			:content(),dclass(){}
+		Input( const std::string& content_, const analyzer::DocumentClass& dclass_)
+			:content(content_),dclass(dclass_){}
+#if __cplusplus >= 201103L
+		Input( Input&& ) = default;
+		Input( const Input& ) = default;
+		Input& operator= ( Input&& ) = default;
+		Input& operator= ( const Input& ) = default;
+#else
+		Input( const Input& o)
+			:content(o.content),dclass(o.dclass){}
+#endif
+	};
+
+	/// \brief Receiver of the results of a batch analysis
+	/// \note The methods are called from the thread calling analyzeBatch only, in the order of the input documents
+	class Callback
+	{
+	public:
+		/// \brief Destructor
+		virtual ~Callback(){}
+
+		/// \brief Receive an analyzed document
+		/// \param[in] inputidx index of the input document the result belongs to
+		/// \param[in] doc analyzed (sub-)document, called for every sub document of a multipart document
+		virtual void document( std::size_t inputidx, const analyzer::Document& doc)=0;
+
+		/// \brief Receive the error of a failed analysis of an input document
+		/// \param[in] inputidx index of the input document that failed
+		/// \param[in] msg error message
+		/// \note The documents of the same input delivered before the error are incomplete
+		virtual void error( std::size_t inputidx, const char* msg)=0;
+	};
+
+	/// \brief Analyze a list of documents in parallel
+	/// \param[in] inputs list of documents to analyze
+	/// \param[in] nofThreads number of worker threads to use, 0 or 1 for processing the documents in the calling thread
+	/// \param[in] callback receiver of the results, called in the order of the input documents
+	/// \return true on success, false if the batch processing failed (errors of single documents are reported to the callback)
+	/// \remark Multipart documents are supported, every sub document is passed to the callback
+	virtual bool analyzeBatch(
+			const std::vector<Input>& inputs,
+			unsigned int nofThreads,
+			Callback& callback) const=0;
+
 	/// \brief Create the context used for analyzing multipart or very big documents
 	/// \param[in] dclass description of the content type and encoding to process
 	/// \return the document analyzer context (with ownership)
 	virtual DocumentAnalyzerContextInterface* createContext(
 			const analyzer::DocumentClass& dclass) const=0;
 
+	/// \brief Get a document analyzer context from the pool of contexts of this analyzer, reset for a new input, or create a new one, if the pool is empty
+	/// \param[in] dclass description of the content type and encoding to process
+	/// \return the document analyzer context (with ownership until it is given back with releaseContext) or NULL in case of an error
+	/// \remark Thread safe, avoids the construction of the segmenter contexts and buffers for every document when analyzing many small documents
+	virtual DocumentAnalyzerContextInterface* acquireContext(
+			const analyzer::DocumentClass& dclass) const=0;
+
+	/// \brief Give a document analyzer context acquired with acquireContext back to the pool of contexts of this analyzer
+	/// \param[in] context the context to give back (passed with ownership, deleted if the pool is full)
+	/// \remark Thread safe, only contexts returned by acquireContext of the same analyzer can be given back
+	virtual void releaseContext(
+			DocumentAnalyzerContextInterface* context) const=0;
+
 	/// \brief Return a structure with all definitions for introspection
 	/// \return the structure with all definitions for introspection
 	virtual StructView view() const=0;
@@ -64,6 +64,25 @@ public:
 			const std::string& content,
 			const analyzer::DocumentClass& dclass) const=0;
 
+	/// \brief Segment and tokenize a document read from a file mapped into memory, assign types to tokens and metadata and normalize their values
+	/// \param[in] path path of the file with the document content to analyze
+	/// \param[in] dclass description of the content type and encoding to process
+	/// \return the analyzed document
+	/// \remark Same as analyze(const std::string&,const analyzer::DocumentClass&) without reading the file content into a string before
+	virtual analyzer::Document analyzeFile(
+			const std::string& path,
+			const analyzer::DocumentClass& dclass) const=0;
+
+	/// \brief Detect the class of a document and analyze it with the analyzer assigned to the class detected
+	/// \param[in] content document content string to analyze
+	/// \return the analyzed document
+	/// \remark The document class is detected once from the start of the content with the detectors of the text processor
+	/// \note The detection reads only the first 4K of the content, its segmenter state is not passed to the analysis, so this prefix is scanned twice
+	/// \note There is no cache of the analyzer resolved per (mime type,schema,encoding), the lookup of the analyzer by (mime type,schema) is done in a table built with the configuration, the encoding does not take part in the selection of the analyzer
+	/// \note A list of JSON documents with one document per line (application/x-ndjson) is only detected if its first line ends within the first 4K, a list with a longer first line is detected as application/json
+	virtual analyzer::Document analyzeAuto(
+			const std::string& content) const=0;
+
 	/// \brief Create the context used for analyzing multipart or very big documents
 	/// \param[in] dclass description of the content type and encoding to process
 	/// \return the document analyzer context (with ownership)
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Interface for a receiver of the elements of an analyzed document, an alternative to the materialization of an analyzer::Document
+/// \file documentSinkInterface.hpp
+#ifndef _STRUS_ANALYZER_DOCUMENT_SINK_INTERFACE_HPP_INCLUDED
+#define _STRUS_ANALYZER_DOCUMENT_SINK_INTERFACE_HPP_INCLUDED
+#include "strus/numericVariant.hpp"
+#include "strus/analyzer/documentStructure.hpp"
+#include <cstddef>
+
+/// \brief strus toplevel namespace
+namespace strus
+{
+
+/// \brief Interface for a receiver of the elements of an analyzed document
+/// \note Strings are passed as views (pointer and size) into the buffers of the analyzer. They are only valid during the call.
+/// \note The elements of a document are passed in the order: search index terms, forward index terms, meta data, attributes and access rights, structures
+class DocumentSinkInterface
+{
+public:
+	/// \brief Destructor
+	virtual ~DocumentSinkInterface(){}
+
+	/// \brief Start of a new document
+	/// \param[in] subDocumentTypeName name of the sub document type as declared in the document analyzer (empty for the main document)
+	/// \param[in] subDocumentTypeNameSize size of subDocumentTypeName in bytes
+	virtual void startDocument( const char* subDocumentTypeName, std::size_t subDocumentTypeNameSize)=0;
+
+	/// \brief Define a search index term of the document
+	/// \param[in] type type name of the search index term
+	/// \param[in] typesize size of type in bytes
+	/// \param[in] value value of the search index term
+	/// \param[in] valuesize size of value in bytes
+	/// \param[in] pos position of the search index term in the document (token position not byte position)
+	virtual void addSearchIndexTerm( const char* type, std::size_t typesize, const char* value, std::size_t valuesize, unsigned int pos)=0;
+
+	/// \brief Define a forward index term of the document
+	/// \param[in] type type name of the forward index term
+	/// \param[in] typesize size of type in bytes
+	/// \param[in] value value of the forward index term
+	/// \param[in] valuesize size of value in bytes
+	/// \param[in] pos position of the forward index term in the document (token position not byte position)
+	virtual void addForwardIndexTerm( const char* type, std::size_t typesize, const char* value, std::size_t valuesize, unsigned int pos)=0;
+
+	/// \brief Define a meta data element of the document
+	/// \param[in] name name of the meta data element
+	/// \param[in] namesize size of name in bytes
+	/// \param[in] value value of the meta data element
+	virtual void setMetaData( const char* name, std::size_t namesize, const NumericVariant& value)=0;
+
+	/// \brief Define an attribute of the document
+	/// \param[in] name name of the attribute
+	/// \param[in] namesize size of name in bytes
+	/// \param[in] value value of the attribute
+	/// \param[in] valuesize size of value in bytes
+	virtual void setAttribute( const char* name, std::size_t namesize, const char* value, std::size_t valuesize)=0;
+
+	/// \brief Define a user role name to allow access to this document (ACL enabled in the storage)
+	/// \param[in] userRoleName name of the user role
+	/// \param[in] userRoleNameSize size of userRoleName in bytes
+	virtual void addAccess( const char* userRoleName, std::size_t userRoleNameSize)=0;
+
+	/// \brief Define a search index structure in the document
+	/// \param[in] name label of the structure
+	/// \param[in] namesize size of name in bytes
+	/// \param[in] header header element of the structure
+	/// \param[in] content content element of the structure
+	virtual void addSearchIndexStructure( const char* name, std::size_t namesize, const analyzer::DocumentStructure::PositionRange& header, const analyzer::DocumentStructure::PositionRange& content)=0;
+
+	/// \brief End of the current document, all its elements have been passed
+	virtual void endDocument()=0;
+};
+
+}//namespace
+#endif
+
@@ -10,6 +10,8 @@
 #ifndef _STRUS_ANALYZER_NORMALIZER_FUNCTION_INSTANCE_INTERFACE_HPP_INCLUDED
 #define _STRUS_ANALYZER_NORMALIZER_FUNCTION_INSTANCE_INTERFACE_HPP_INCLUDED
 #include "strus/structView.hpp"
+#include "strus/analyzer/tokenSpan.hpp"
+#include "strus/analyzer/normalizedOutput.hpp"
 #include <string>
 
 /// \brief strus toplevel namespace
@@ -30,12 +32,27 @@ public:
 	/// \return list of normalized tokens
 	virtual std::string normalize( const char* src, std::size_t srcsize) const=0;
 
+	/// \brief Normalization of a batch of tokens, e.g. all tokens of a segment
+	/// \param[in] in array of tokens to normalize
+	/// \param[in] n number of tokens in the array
+	/// \param[in,out] out where to append the values of each token to, one closed list of values per token
+	/// \note The default implementation calls normalize for each token, implementations should override it to avoid temporary allocations per token
+	/// \note In case of an error it is reported to the error buffer and the output may contain less than n tokens
+	virtual void normalizeBatch( const analyzer::TokenSpan* in, std::size_t n, analyzer::NormalizedOutput& out) const
+	{
+		for (std::size_t ii=0; ii < n; ++ii)
+		{
+			out.addNormalizeResult( normalize( in[ ii].ptr(), in[ ii].size()));
+		}
+	}
+
 	/// \brief Get the name of the function
 	/// \return the identifier
 	virtual const char* name() const=0;
 
 	/// \brief Return a structure with all definitions for introspection
 	/// \return the structure with all definitions for introspection
+	/// \note The structure has to describe all arguments the instance was created with, because the document analyzer shares the results of normalizers of equal name and view between features
 	virtual StructView view() const=0;
 };
 
@@ -41,6 +41,18 @@ public:
 			const std::vector<NormalizerFunctionInstanceInterface*>& normalizers,
 			int priority)=0;
 
+	/// \brief Define a cache for the normalization results of all elements of a term type
+	/// \param[in] termtype term type name of the elements to define the cache for
+	/// \param[in] maxNofEntries maximum number of entries in the cache of a query analyzer context, 0 for no cache
+	/// \note The cache is kept by each query analyzer context and reused for all queries analyzed with it
+	virtual void defineNormalizerCache( const std::string& termtype, unsigned int maxNofEntries)=0;
+
+	/// \brief Define a cache for the results of query analysis shared by all query analyzer contexts created by this
+	/// \param[in] maxMemory maximum memory in bytes (estimated) used by the cache entries, 0 for no cache
+	/// \note A query is found in the cache if its fields and groupings are defined in the same order with the same arguments.
+	///	The statistics of the cache (hits and misses) are part of the introspection returned by view()
+	virtual void defineResultCache( std::size_t maxMemory)=0;
+
 	/// \brief Get the query term types declared in order of appearance in declarations
 	/// return the query field types
 	virtual std::vector<std::string> queryTermTypes() const=0;
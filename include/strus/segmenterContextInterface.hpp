@@ -9,6 +9,7 @@
 /// \file segmenterContextInterface.hpp
 #ifndef _STRUS_ANALYZER_SEGMENTER_CONTEXT_INTERFACE_HPP_INCLUDED
 #define _STRUS_ANALYZER_SEGMENTER_CONTEXT_INTERFACE_HPP_INCLUDED
+#include "strus/analyzer/documentClass.hpp"
 #include <utility>
 #include <string>
 
@@ -34,6 +35,34 @@ public:
 	/// \remark the buffer passed to this must be copied by the segmenter, because it is not guaranteed to survive till the next call of putInput.
 	virtual void putInput( const char* chunk, std::size_t chunksize, bool eof)=0;
 
+	/// \brief Feed the segmenter with the next chunk of input to process without copying it
+	/// \param[in] chunk pointer to input chunk to process (referenced, not copied by this)
+	/// \param[in] chunksize size of input chunk to process in bytes
+	/// \param[in] eof true, if this is the last chunk to feed
+	/// \remark the caller guarantees that the chunk stays valid until the segmenter has consumed it. Chunks are consumed in the order they were fed, the sum of the sizes of the chunks not consumed yet is returned by bufferedInputSize()
+	/// \note the default implementation copies the chunk with putInput
+	virtual void putInputReference( const char* chunk, std::size_t chunksize, bool eof)
+	{
+		putInput( chunk, chunksize, eof);
+	}
+
+	/// \brief Get the sum of the sizes in bytes of the chunks fed and not consumed yet by the segmenter
+	/// \return the number of bytes buffered or referenced
+	/// \note the default implementation returns 0, for segmenters keeping no references to chunks fed and without a limit of input buffered
+	virtual std::size_t bufferedInputSize() const
+	{
+		return 0;
+	}
+
+	/// \brief Reset the context for segmenting a new document, keeping the structures and buffers allocated
+	/// \param[in] dclass description of the content type and encoding of the new document
+	/// \return true on success, false if the context cannot be reused for the document class given (e.g. a different character set encoding) and a new context has to be created
+	/// \note the default implementation returns false
+	virtual bool reset( const analyzer::DocumentClass& dclass)
+	{
+		return false;
+	}
+
 	/// \brief Fetch the next text segment
 	/// \param[out] id identifier of the expression that addresses the text segment (defined with SegmenterInterface::defineSelectorExpression(int, const std::string&) or with SegmenterInterface::defineSubSection(int,int,const std::string&))
 	/// \param[out] pos position of the segment in the original source
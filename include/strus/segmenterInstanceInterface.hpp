@@ -12,6 +12,8 @@
 #include "strus/analyzer/documentClass.hpp"
 #include "strus/structView.hpp"
 #include <string>
+#include <vector>
+#include <cstddef>
 
 /// \brief strus toplevel namespace
 namespace strus
@@ -44,6 +46,63 @@ public:
 	/// \return the segmenter context object (with ownership, to be desposed with delete by the caller)
 	virtual SegmenterContextInterface* createContext( const analyzer::DocumentClass& dclass) const=0;
 
+	/// \brief Part of a content that can be segmented independently of the other parts
+	struct ContentPart
+	{
+		std::size_t start;	///< offset of the first byte of the part in the content
+		std::size_t end;	///< offset of the byte after the last byte of the part in the content
+		int index;		///< number of elements (e.g. rows of a table) in the content before the part
+
+		ContentPart()
+			:start(0),end(0),index(0){}
+		ContentPart( std::size_t start_, std::size_t end_, int index_)
+			:start(start_),end(end_),index(index_){}
+#if __cplusplus >= 201103L
+		ContentPart( ContentPart&& ) = default;
+		ContentPart( const ContentPart& ) = default;
+		ContentPart& operator= ( ContentPart&& ) = default;
+		ContentPart& operator= ( const ContentPart& ) = default;
+#else
+		ContentPart( const ContentPart& o)
+			:start(o.start),end(o.end),index(o.index){}
+#endif
+	};
+
+	/// \brief Split a complete content into parts that can be segmented independently, e.g. ranges of rows of a table sharing its header
+	/// \param[out] parts where to append the parts to, in ascending order of their position in the content
+	/// \param[in] dclass description of the document type and encoding of the content
+	/// \param[in] content pointer to the complete content
+	/// \param[in] contentsize size of the content in bytes
+	/// \param[in] nofParts number of parts wished, the number of parts returned may be smaller
+	/// \return true on success, false if the segmenter does not support the splitting of a content of this class or on error
+	/// \note the default implementation returns false
+	virtual bool splitContent(
+			std::vector<ContentPart>& parts,
+			const analyzer::DocumentClass& dclass,
+			const char* content,
+			std::size_t contentsize,
+			unsigned int nofParts) const
+	{
+		return false;
+	}
+
+	/// \brief Creates a context for segmenting a part of a content returned by splitContent
+	/// \param[in] dclass description of the document type and encoding of the content
+	/// \param[in] content pointer to the complete content (referenced, not copied by the context, the content has to stay valid until the context is deleted)
+	/// \param[in] contentsize size of the content in bytes
+	/// \param[in] part part of the content to segment
+	/// \return the segmenter context object (with ownership, to be desposed with delete by the caller), fed with the complete input, or NULL on error or if not supported
+	/// \remark the positions of the segments returned are the same as when segmenting the complete content
+	/// \note the default implementation returns NULL
+	virtual SegmenterContextInterface* createPartContext(
+			const analyzer::DocumentClass& dclass,
+			const char* content,
+			std::size_t contentsize,
+			const ContentPart& part) const
+	{
+		return 0;
+	}
+
 	/// \brief Creates an instance of the segmenters document markup context
 	/// \param[in] dclass description of the document type and encoding to process
 	/// \param[in] content document content to process (no chunkwise processing)
@@ -34,12 +34,23 @@ public:
 	/// \param[in] srcsize size of the segment to tokenize in bytes
 	virtual std::vector<analyzer::Token> tokenize( const char* src, std::size_t srcsize) const=0;
 
+	/// \brief Tokenize a segment into a list of tokens passed by the caller, for reusing its memory
+	/// \param[in] src pointer to segment to tokenize
+	/// \param[in] srcsize size of the segment to tokenize in bytes
+	/// \param[out] res where to write the tokens to, the previous content is discarded, the content is undefined in case of an error
+	/// \note The default implementation assigns the result of tokenize, implementations should override it to avoid allocating a new vector per segment
+	virtual void tokenizeInto( const char* src, std::size_t srcsize, std::vector<analyzer::Token>& res) const
+	{
+		res = tokenize( src, srcsize);
+	}
+
 	/// \brief Get the name of the function
 	/// \return the identifier
 	virtual const char* name() const=0;
 
 	/// \brief Return a structure with all definitions for introspection
 	/// \return the structure with all definitions for introspection
+	/// \note The structure has to describe all arguments the instance was created with, because the document analyzer shares the tokenization between features with tokenizers of equal name and view
 	virtual StructView view() const=0;
 };
 
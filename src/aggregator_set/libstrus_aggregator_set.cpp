@@ -8,11 +8,13 @@
 #include "strus/lib/aggregator_set.hpp"
 #include "strus/aggregatorFunctionInterface.hpp"
 #include "strus/aggregatorFunctionInstanceInterface.hpp"
+#include "strus/aggregatorAccumulatorInterface.hpp"
 #include "strus/errorBufferInterface.hpp"
 #include "strus/analyzer/documentTerm.hpp"
 #include "strus/base/dll_tags.hpp"
 #include "strus/base/string_conv.hpp"
 #include "strus/base/math.hpp"
+#include "strus/base/symbolTable.hpp"
 #include "private/errorUtils.hpp"
 #include "private/internationalization.hpp"
 #include <vector>
@@ -26,6 +28,93 @@ static bool g_intl_initialized = false;
 
 #define MODULE_NAME "typeset/valueset aggregator"
 
+/// \brief Accumulator of a set aggregator, also used for the evaluation on a complete document
+/// \note For a set of types (typeset) every type is a feature type of the accumulator with its bit as element.
+///	For a set of values (valueset) the values are mapped with a symbol table to their bits.
+class SetAggregatorAccumulator
+	:public AggregatorAccumulatorInterface
+{
+public:
+	/// \brief Constructor
+	SetAggregatorAccumulator( const std::string& type, const std::map<std::string,unsigned int>& itemmap, ErrorBufferInterface* errorhnd)
+		:m_typeset(type.empty()),m_types(),m_typemap(errorhnd),m_typebits(),m_valuemap(errorhnd),m_valuebits(),m_result(0),m_errorhnd(errorhnd)
+	{
+		std::map<std::string,unsigned int>::const_iterator ii = itemmap.begin(), ie = itemmap.end();
+		if (m_typeset)
+		{
+			for (; ii != ie; ++ii)
+			{
+				if (!m_typemap.getOrCreate( ii->first)) throw std::runtime_error( m_errorhnd->fetchError());
+				m_types.push_back( ii->first);
+				m_typebits.push_back( ii->second);
+			}
+		}
+		else
+		{
+			m_types.push_back( type);
+			for (; ii != ie; ++ii)
+			{
+				uint32_t valueid = m_valuemap.getOrCreate( ii->first);
+				if (!valueid) throw std::runtime_error( m_errorhnd->fetchError());
+				if (m_valuebits.size() < valueid) m_valuebits.resize( valueid, 0);
+				m_valuebits[ valueid-1] = ii->second;
+			}
+		}
+	}
+
+	virtual std::vector<std::string> featureTypes() const
+	{
+		return m_types;
+	}
+
+	virtual void clear()
+	{
+		m_result = 0;
+	}
+
+	virtual void add( int typeidx, const char* value, std::size_t valuesize)
+	{
+		if (m_typeset)
+		{
+			m_result |= m_typebits[ typeidx];
+		}
+		else
+		{
+			uint32_t valueid = m_valuemap.get( value, valuesize);
+			if (valueid) m_result |= m_valuebits[ valueid-1];
+		}
+	}
+
+	/// \brief Add a search index term of any type, terms with a type not in the list of feature types are ignored
+	void addTerm( const std::string& type, const std::string& value)
+	{
+		if (m_typeset)
+		{
+			uint32_t typeid_ = m_typemap.get( type);
+			if (typeid_) add( typeid_-1, value.c_str(), value.size());
+		}
+		else if (type == m_types[0])
+		{
+			add( 0, value.c_str(), value.size());
+		}
+	}
+
+	virtual NumericVariant result() const
+	{
+		return NumericVariant( (NumericVariant::IntType)m_result);
+	}
+
+private:
+	bool m_typeset;
+	std::vector<std::string> m_types;
+	SymbolTable m_typemap;
+	std::vector<unsigned int> m_typebits;
+	SymbolTable m_valuemap;
+	std::vector<unsigned int> m_valuebits;
+	unsigned int m_result;
+	ErrorBufferInterface* m_errorhnd;
+};
+
 class SetAggregatorFunctionInstance
 	:public AggregatorFunctionInstanceInterface
 {
@@ -50,43 +139,28 @@ public:
 	{
 		try
 		{
-			unsigned int rt = 0;
+			SetAggregatorAccumulator accu( m_type, m_itemmap, m_errorhnd);
 			std::vector<DocumentTerm>::const_iterator
 				si = document.searchIndexTerms().begin(),
 				se = document.searchIndexTerms().end();
-	
-			if (m_type.empty())
+			for (; si != se; ++si)
 			{
-				for (; si != se; ++si)
-				{
-					std::map<std::string,unsigned int>::const_iterator
-						fi = m_itemmap.find( si->type());
-					if (fi != m_itemmap.end())
-					{
-						rt |= fi->second;
-					}
-				}
+				accu.addTerm( si->type(), si->value());
 			}
-			else
-			{
-				for (; si != se; ++si)
-				{
-					if (si->type() == m_type)
-					{
-						std::map<std::string,unsigned int>::const_iterator
-							fi = m_itemmap.find( si->value());
-						if (fi != m_itemmap.end())
-						{
-							rt |= fi->second;
-						}
-					}
-				}
-			}
-			return NumericVariant( (NumericVariant::IntType)rt);
+			return accu.result();
 		}
 		CATCH_ERROR_ARG1_MAP_RETURN( _TXT("error in '%s': %s"), MODULE_NAME, *m_errorhnd, (NumericVariant::IntType)0);
 	}
 
+	virtual AggregatorAccumulatorInterface* createAccumulator() const
+	{
+		try
+		{
+			return new SetAggregatorAccumulator( m_type, m_itemmap, m_errorhnd);
+		}
+		CATCH_ERROR_ARG1_MAP_RETURN( _TXT("error in '%s': %s"), MODULE_NAME, *m_errorhnd, 0);
+	}
+
 	virtual const char* name() const	{return m_name;}
 	virtual StructView view() const
 	{
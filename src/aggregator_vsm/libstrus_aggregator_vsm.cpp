@@ -8,11 +8,13 @@
 #include "strus/lib/aggregator_vsm.hpp"
 #include "strus/aggregatorFunctionInterface.hpp"
 #include "strus/aggregatorFunctionInstanceInterface.hpp"
+#include "strus/aggregatorAccumulatorInterface.hpp"
 #include "strus/errorBufferInterface.hpp"
 #include "strus/analyzer/documentTerm.hpp"
 #include "strus/base/dll_tags.hpp"
 #include "strus/base/string_conv.hpp"
 #include "strus/base/math.hpp"
+#include "strus/base/symbolTable.hpp"
 #include "private/errorUtils.hpp"
 #include "private/internationalization.hpp"
 #include <vector>
@@ -40,6 +42,57 @@ double sumSquareTfAggregatorFunctionCall( const std::vector<double>& input)
 	return strus::Math::sqrt( sum);
 }
 
+class VsmAggregatorAccumulator
+	:public AggregatorAccumulatorInterface
+{
+public:
+	/// \brief Constructor
+	VsmAggregatorAccumulator( const std::string& featuretype_, AggregatorFunctionCall call_, const std::string& name_, ErrorBufferInterface* errorhnd)
+		:m_featuretype(featuretype_),m_call(call_),m_name(name_),m_termmap(errorhnd),m_tfar(),m_errorhnd(errorhnd){}
+
+	virtual std::vector<std::string> featureTypes() const
+	{
+		return std::vector<std::string>( 1, m_featuretype);
+	}
+
+	virtual void clear()
+	{
+		m_termmap.clear();
+		m_tfar.clear();
+	}
+
+	virtual void add( int, const char* value, std::size_t valuesize)
+	{
+		try
+		{
+			uint32_t termid = m_termmap.getOrCreate( value, valuesize);
+			if (!termid) throw std::runtime_error( m_errorhnd->fetchError());
+			if (m_termmap.isNew())
+			{
+				m_tfar.push_back( 1.0);
+			}
+			else
+			{
+				++m_tfar[ termid-1];
+			}
+		}
+		CATCH_ERROR_ARG1_MAP( _TXT("error in '%s' aggregator: %s"), m_name.c_str(), *m_errorhnd);
+	}
+
+	virtual NumericVariant result() const
+	{
+		return m_call( m_tfar);
+	}
+
+private:
+	std::string m_featuretype;
+	AggregatorFunctionCall m_call;
+	std::string m_name;
+	SymbolTable m_termmap;
+	std::vector<double> m_tfar;
+	ErrorBufferInterface* m_errorhnd;
+};
+
 class VsmAggregatorFunctionInstance
 	:public AggregatorFunctionInstanceInterface
 {
@@ -52,8 +105,7 @@ public:
 	{
 		try
 		{
-			std::map<std::string,std::size_t> termmap;
-			std::vector<double> tfar;
+			VsmAggregatorAccumulator accu( m_featuretype, m_call, m_name, m_errorhnd);
 			std::vector<DocumentTerm>::const_iterator
 				si = document.searchIndexTerms().begin(),
 				se = document.searchIndexTerms().end();
@@ -62,23 +114,23 @@ public:
 			{
 				if (si->type() == m_featuretype)
 				{
-					std::map<std::string,std::size_t>::const_iterator ti = termmap.find( si->value());
-					if (ti == termmap.end())
-					{
-						termmap[ si->value()] = tfar.size();
-						tfar.push_back( 1.0);
-					}
-					else
-					{
-						++tfar[ ti->second];
-					}
+					accu.add( 0, si->value().c_str(), si->value().size());
 				}
 			}
-			return m_call( tfar);
+			return accu.result();
 		}
 		CATCH_ERROR_ARG1_MAP_RETURN( _TXT("error in '%s' aggregator: %s"), m_name.c_str(), *m_errorhnd, (NumericVariant::IntType)0);
 	}
 
+	virtual AggregatorAccumulatorInterface* createAccumulator() const
+	{
+		try
+		{
+			return new VsmAggregatorAccumulator( m_featuretype, m_call, m_name, m_errorhnd);
+		}
+		CATCH_ERROR_ARG1_MAP_RETURN( _TXT("error in '%s' aggregator: %s"), m_name.c_str(), *m_errorhnd, 0);
+	}
+
 	virtual const char* name() const	{return "vsm";}
 	virtual StructView view() const
 	{
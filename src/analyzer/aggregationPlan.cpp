@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Evaluation of all aggregated meta data of a document in one pass over its search index terms
+/// \file aggregationPlan.cpp
+#include "aggregationPlan.hpp"
+#include "strus/aggregatorFunctionInstanceInterface.hpp"
+#include "strus/errorBufferInterface.hpp"
+#include "strus/debugTraceInterface.hpp"
+#include "strus/analyzer/documentTerm.hpp"
+#include "private/internationalization.hpp"
+#include <stdexcept>
+
+using namespace strus;
+
+AggregationPlan::AggregationPlan( const std::vector<StatisticsConfig>& configs, ErrorBufferInterface* errorhnd)
+	:m_configs(configs),m_accumulators(),m_nofEvaluated(0),m_typemap(errorhnd),m_dispatch(),m_dispatchStart(),m_errorhnd(errorhnd)
+{
+	try
+	{
+		std::vector<std::vector<Dispatch> > dispatchByType;
+		std::vector<StatisticsConfig>::const_iterator ci = configs.begin(), ce = configs.end();
+		for (int accuidx=0; ci != ce; ++ci,++accuidx)
+		{
+			AggregatorAccumulatorInterface* accu = ci->statfunc()->createAccumulator();
+			m_accumulators.push_back( accu);
+			if (!accu)
+			{
+				if (m_errorhnd->hasError())
+				{
+					throw std::runtime_error( m_errorhnd->fetchError());
+				}
+				++m_nofEvaluated;
+				continue;
+			}
+			std::vector<std::string> types = accu->featureTypes();
+			std::vector<std::string>::const_iterator ti = types.begin(), te = types.end();
+			for (int typeidx=0; ti != te; ++ti,++typeidx)
+			{
+				uint32_t typeid_ = m_typemap.getOrCreate( *ti);
+				if (!typeid_) throw std::runtime_error( m_errorhnd->fetchError());
+				if (dispatchByType.size() < typeid_) dispatchByType.resize( typeid_);
+				dispatchByType[ typeid_-1].push_back( Dispatch( accuidx, typeidx));
+			}
+		}
+		std::vector<std::vector<Dispatch> >::const_iterator di = dispatchByType.begin(), de = dispatchByType.end();
+		for (; di != de; ++di)
+		{
+			m_dispatchStart.push_back( m_dispatch.size());
+			m_dispatch.insert( m_dispatch.end(), di->begin(), di->end());
+		}
+		m_dispatchStart.push_back( m_dispatch.size());
+	}
+	catch (...)
+	{
+		std::vector<AggregatorAccumulatorInterface*>::const_iterator ai = m_accumulators.begin(), ae = m_accumulators.end();
+		for (; ai != ae; ++ai) delete *ai;
+		throw;
+	}
+}
+
+AggregationPlan::~AggregationPlan()
+{
+	std::vector<AggregatorAccumulatorInterface*>::const_iterator ai = m_accumulators.begin(), ae = m_accumulators.end();
+	for (; ai != ae; ++ai) delete *ai;
+}
+
+void AggregationPlan::clear()
+{
+	std::vector<AggregatorAccumulatorInterface*>::const_iterator ai = m_accumulators.begin(), ae = m_accumulators.end();
+	for (; ai != ae; ++ai)
+	{
+		if (*ai) (*ai)->clear();
+	}
+}
+
+void AggregationPlan::accumulate( const analyzer::Document& doc)
+{
+	std::vector<analyzer::DocumentTerm>::const_iterator
+		ti = doc.searchIndexTerms().begin(), te = doc.searchIndexTerms().end();
+	for (; ti != te; ++ti)
+	{
+		addSearchIndexTerm( ti->type().c_str(), ti->type().size(), ti->value().c_str(), ti->value().size());
+	}
+}
+
+NumericVariant AggregationPlan::result( std::size_t idx, const analyzer::Document* doc) const
+{
+	if (m_accumulators[ idx])
+	{
+		return m_accumulators[ idx]->result();
+	}
+	else if (doc)
+	{
+		return m_configs[ idx].statfunc()->evaluate( *doc);
+	}
+	else
+	{
+		throw std::runtime_error( _TXT("aggregator without accumulator evaluated without document"));
+	}
+}
+
+void AggregatingDocumentSink::setAggregatedMetaData()
+{
+	if (m_done) return;
+	m_done = true;
+	if (m_debugtrace) m_debugtrace->open( "metadata");
+	std::size_t ii = 0, ie = m_plan.size();
+	for (; ii != ie; ++ii)
+	{
+		NumericVariant value = m_plan.result( ii, m_doc);
+		const std::string& name = m_plan.name( ii);
+		m_sink.setMetaData( name.c_str(), name.size(), value);
+		if (m_debugtrace) m_debugtrace->event( "aggregated", "%s %s", name.c_str(), value.tostring().c_str());
+	}
+	if (m_debugtrace) m_debugtrace->close();
+}
+
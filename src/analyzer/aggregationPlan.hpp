@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Evaluation of all aggregated meta data of a document in one pass over its search index terms
+/// \file aggregationPlan.hpp
+#ifndef _STRUS_ANALYZER_AGGREGATION_PLAN_HPP_INCLUDED
+#define _STRUS_ANALYZER_AGGREGATION_PLAN_HPP_INCLUDED
+#include "documentAnalyzerInstance.hpp"
+#include "strus/documentSinkInterface.hpp"
+#include "strus/aggregatorAccumulatorInterface.hpp"
+#include "strus/numericVariant.hpp"
+#include "strus/analyzer/document.hpp"
+#include "strus/base/symbolTable.hpp"
+#include <vector>
+#include <string>
+
+namespace strus
+{
+/// \brief Forward declaration
+class ErrorBufferInterface;
+/// \brief Forward declaration
+class DebugTraceContextInterface;
+
+/// \brief Compiled plan for the evaluation of all aggregated meta data of a document in one pass over its search index terms
+/// \note The types of the terms are mapped with a hash table to ids, every id refers to the list of accumulators interested in the type.
+///	Aggregators without accumulator are evaluated on the complete document.
+class AggregationPlan
+{
+public:
+	typedef DocumentAnalyzerInstance::StatisticsConfig StatisticsConfig;
+
+	/// \brief Constructor
+	/// \param[in] configs list of the aggregated meta data definitions of the document analyzer
+	/// \param[in] errorhnd error buffer interface
+	AggregationPlan( const std::vector<StatisticsConfig>& configs, ErrorBufferInterface* errorhnd);
+	~AggregationPlan();
+
+	/// \brief Test if the all aggregators are evaluated with accumulators, without the document materialized
+	bool complete() const					{return m_nofEvaluated == 0;}
+	/// \brief Number of aggregated meta data elements
+	std::size_t size() const				{return m_configs.size();}
+	/// \brief Name of an aggregated meta data element
+	const std::string& name( std::size_t idx) const		{return m_configs[ idx].name();}
+
+	/// \brief Reset the accumulators for a new document
+	void clear();
+
+	/// \brief Pass a search index term of the current document to the accumulators interested in its type
+	void addSearchIndexTerm( const char* type, std::size_t typesize, const char* value, std::size_t valuesize)
+	{
+		uint32_t typeid_ = m_typemap.get( type, typesize);
+		if (typeid_)
+		{
+			std::vector<Dispatch>::const_iterator
+				di = m_dispatch.begin() + m_dispatchStart[ typeid_-1],
+				de = m_dispatch.begin() + m_dispatchStart[ typeid_];
+			for (; di != de; ++di)
+			{
+				m_accumulators[ di->accuidx]->add( di->typeidx, value, valuesize);
+			}
+		}
+	}
+
+	/// \brief Pass all search index terms of a document to the accumulators
+	void accumulate( const analyzer::Document& doc);
+
+	/// \brief Get the value of an aggregated meta data element of the current document
+	/// \param[in] idx index of the element
+	/// \param[in] doc the complete document or NULL, if not available (only allowed if the plan is complete)
+	NumericVariant result( std::size_t idx, const analyzer::Document* doc) const;
+
+private:
+	AggregationPlan( const AggregationPlan&);	//... non copyable
+	void operator=( const AggregationPlan&);	//... non copyable
+
+	/// \brief Reference to an accumulator interested in a type
+	struct Dispatch
+	{
+		int accuidx;	///< index of the accumulator
+		int typeidx;	///< index of the type in the list of types of the accumulator
+
+		Dispatch( int accuidx_, int typeidx_)
+			:accuidx(accuidx_),typeidx(typeidx_){}
+#if __cplusplus >= 201103L
+		Dispatch( Dispatch&& ) = default;
+		Dispatch( const Dispatch& ) = default;
+		Dispatch& operator= ( Dispatch&& ) = default;
+		Dispatch& operator= ( const Dispatch& ) = default;
+#else
+		Dispatch( const Dispatch& o)
+			:accuidx(o.accuidx),typeidx(o.typeidx){}
+#endif
+	};
+
+private:
+	std::vector<StatisticsConfig> m_configs;				///< copy of the aggregated meta data definitions, independent of later changes of the analyzer configuration
+	std::vector<AggregatorAccumulatorInterface*> m_accumulators;		///< accumulator per definition or NULL if evaluated on the document
+	int m_nofEvaluated;							///< number of definitions without accumulator
+	SymbolTable m_typemap;							///< map of the types to ids
+	std::vector<Dispatch> m_dispatch;					///< accumulators interested in a type, grouped by type id
+	std::vector<std::size_t> m_dispatchStart;				///< start of the group of each type id in m_dispatch, with the end as last element
+	ErrorBufferInterface* m_errorhnd;
+};
+
+
+/// \brief Document sink passing the search index terms to an aggregation plan and setting the aggregated meta data
+/// \note If the plan is complete, the aggregated meta data are set after the meta data of the document and before its attributes,
+///	otherwise at the end of the document, because the aggregators without accumulator need the complete document.
+class AggregatingDocumentSink
+	:public DocumentSinkInterface
+{
+public:
+	/// \param[in] sink_ the sink to forward the elements of the document to
+	/// \param[in] plan_ the aggregation plan
+	/// \param[in] doc_ the document built by the sink or NULL if the plan is complete
+	/// \param[in] debugtrace_ debug trace context or NULL
+	AggregatingDocumentSink( DocumentSinkInterface& sink_, AggregationPlan& plan_, const analyzer::Document* doc_, DebugTraceContextInterface* debugtrace_)
+		:m_sink(sink_),m_plan(plan_),m_doc(doc_),m_debugtrace(debugtrace_),m_done(false){}
+	virtual ~AggregatingDocumentSink(){}
+
+	virtual void startDocument( const char* subDocumentTypeName, std::size_t subDocumentTypeNameSize)
+	{
+		m_plan.clear();
+		m_done = false;
+		m_sink.startDocument( subDocumentTypeName, subDocumentTypeNameSize);
+	}
+	virtual void addSearchIndexTerm( const char* type, std::size_t typesize, const char* value, std::size_t valuesize, unsigned int pos)
+	{
+		m_plan.addSearchIndexTerm( type, typesize, value, valuesize);
+		m_sink.addSearchIndexTerm( type, typesize, value, valuesize, pos);
+	}
+	virtual void addForwardIndexTerm( const char* type, std::size_t typesize, const char* value, std::size_t valuesize, unsigned int pos)
+	{
+		m_sink.addForwardIndexTerm( type, typesize, value, valuesize, pos);
+	}
+	virtual void setMetaData( const char* name, std::size_t namesize, const NumericVariant& value)
+	{
+		m_sink.setMetaData( name, namesize, value);
+	}
+	virtual void setAttribute( const char* name, std::size_t namesize, const char* value, std::size_t valuesize)
+	{
+		if (m_plan.complete()) setAggregatedMetaData();
+		m_sink.setAttribute( name, namesize, value, valuesize);
+	}
+	virtual void addAccess( const char* userRoleName, std::size_t userRoleNameSize)
+	{
+		if (m_plan.complete()) setAggregatedMetaData();
+		m_sink.addAccess( userRoleName, userRoleNameSize);
+	}
+	virtual void addSearchIndexStructure( const char* name, std::size_t namesize, const analyzer::DocumentStructure::PositionRange& header, const analyzer::DocumentStructure::PositionRange& content)
+	{
+		if (m_plan.complete()) setAggregatedMetaData();
+		m_sink.addSearchIndexStructure( name, namesize, header, content);
+	}
+	virtual void endDocument()
+	{
+		setAggregatedMetaData();
+		m_sink.endDocument();
+	}
+
+private:
+	void setAggregatedMetaData();
+
+private:
+	DocumentSinkInterface& m_sink;
+	AggregationPlan& m_plan;
+	const analyzer::Document* m_doc;
+	DebugTraceContextInterface* m_debugtrace;
+	bool m_done;
+};
+
+}//namespace
+#endif
+
@@ -45,7 +45,7 @@ struct TermPrio
 	}
 };
 
-void BindTerm::eliminateCoveredElements( std::vector<BindTerm>& terms)
+void BindTerm::eliminateCoveredElements( std::vector<BindTerm>& terms, const BindTermValueBuffer& valuebuf)
 {
 	std::set<TermPrio> prioset;
 	std::vector<BindTerm>::const_iterator ti = terms.begin(), te = terms.end();
@@ -106,7 +106,7 @@ void BindTerm::eliminateCoveredElements( std::vector<BindTerm>& terms)
 		}
 		terms.pop_back();
 	}
-	std::sort( terms.begin(), terms.end());
+	std::sort( terms.begin(), terms.end(), Order( valuebuf));
 }
 
 
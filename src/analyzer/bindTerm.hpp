@@ -10,15 +10,54 @@
 #include "strus/analyzer/positionBind.hpp"
 #include <string>
 #include <vector>
+#include <cstring>
 
 namespace strus
 {
 
+/// \brief Buffer for the values of the terms of one document
+/// \note Values are stored as null terminated strings and referenced by offset and size
+class BindTermValueBuffer
+{
+public:
+	BindTermValueBuffer()
+		:m_buf(){}
+
+	/// \brief Append a value to the buffer
+	/// \return the offset of the value in the buffer
+	std::size_t append( const char* value, std::size_t valuesize)
+	{
+		std::size_t rt = m_buf.size();
+		m_buf.append( value, valuesize);
+		m_buf.push_back( '\0');
+		return rt;
+	}
+	/// \brief Append the contents of another buffer
+	/// \return the offset of the appended contents, to be added to the value offsets of the terms referring to the other buffer
+	std::size_t append( const BindTermValueBuffer& o)
+	{
+		std::size_t rt = m_buf.size();
+		m_buf.append( o.m_buf);
+		return rt;
+	}
+	/// \brief Get a value by offset
+	const char* value( std::size_t ofs) const	{return m_buf.c_str() + ofs;}
+	/// \brief Get the size of the buffer in bytes
+	std::size_t size() const			{return m_buf.size();}
+	/// \brief Get the pointer to the start of the buffer
+	const char* base() const			{return m_buf.c_str();}
+	/// \brief Reset the buffer for the next document, the memory allocated is kept
+	void clear()					{m_buf.clear();}
+
+private:
+	std::string m_buf;
+};
+
 class BindTerm
 {
 public:
-	BindTerm( int seg_, int ofs_, int endofs_, int ordlen_, int priority_, analyzer::PositionBind posbind_, const std::string& type_, const std::string& value_)
-		:m_seg(seg_),m_ofs(ofs_),m_endofs(endofs_),m_ordlen(ordlen_),m_priority(priority_),m_posbind(posbind_),m_type(type_),m_value(value_){}
+	BindTerm( int seg_, int ofs_, int endofs_, int ordlen_, int priority_, analyzer::PositionBind posbind_, int typeidx_, int typeord_, std::size_t valueofs_, std::size_t valuesize_)
+		:m_seg(seg_),m_ofs(ofs_),m_endofs(endofs_),m_ordlen(ordlen_),m_priority(priority_),m_posbind(posbind_),m_typeidx(typeidx_),m_typeord(typeord_),m_valueofs(valueofs_),m_valuesize(valuesize_){}
 #if __cplusplus >= 201103L
 	BindTerm( BindTerm&& ) = default;
 	BindTerm( const BindTerm& ) = default;
@@ -26,42 +65,58 @@ public:
 	BindTerm& operator= ( const BindTerm& ) = default;
 #else
 	BindTerm( const BindTerm& o)
-		:m_seg(o.m_seg),m_ofs(o.m_ofs),m_endofs(o.m_endofs),m_ordlen(o.m_ordlen),m_priority(o.m_priority),m_posbind(o.m_posbind),m_type(o.m_type),m_value(o.m_value){}
+		:m_seg(o.m_seg),m_ofs(o.m_ofs),m_endofs(o.m_endofs),m_ordlen(o.m_ordlen),m_priority(o.m_priority),m_posbind(o.m_posbind),m_typeidx(o.m_typeidx),m_typeord(o.m_typeord),m_valueofs(o.m_valueofs),m_valuesize(o.m_valuesize){}
 #endif
 	int seg() const						{return m_seg;}
 	int ofs() const						{return m_ofs;}
 	int endofs() const					{return m_endofs;}
 	int ordlen() const					{return m_ordlen;}
-	const std::string& type() const				{return m_type;}
-	const std::string& value() const			{return m_value;}
+	/// \brief Index of the feature (in FeatureConfigMap) defining the type of the term
+	int typeidx() const					{return m_typeidx;}
+	/// \brief Rank of the type name of the term in the lexical order of all type names
+	int typeord() const					{return m_typeord;}
+	/// \brief Offset of the value of the term in the document value buffer
+	std::size_t valueofs() const				{return m_valueofs;}
+	/// \brief Size of the value of the term in bytes
+	std::size_t valuesize() const				{return m_valuesize;}
 	int priority() const					{return m_priority;}
 	analyzer::PositionBind posbind() const			{return m_posbind;}
 
-	bool operator < (const BindTerm& o) const
+	/// \brief Move the reference of the value after appending its value buffer to another at the offset passed
+	void relocateValue( std::size_t bufferofs)		{m_valueofs += bufferofs;}
+
+	/// \brief Order of terms, comparing integers only, except for terms differing only in their value
+	class Order
 	{
-		return (m_seg == o.m_seg)
-			? (
-				(m_ofs == o.m_ofs)
-				? (
-					(m_ordlen == o.m_ordlen)
-					? (
-						(m_endofs == o.m_endofs)
-						? (
-							(m_type == o.m_type)
-							? (m_value < o.m_value)
-							: (m_type < o.m_type)
-						)
-						: (m_endofs < o.m_endofs)
-					)
-					: (m_ordlen < o.m_ordlen)
-				)
-				: (m_ofs < o.m_ofs)
-			)
-			: (m_seg < o.m_seg);
-	}
+	public:
+		explicit Order( const BindTermValueBuffer& valuebuf_)
+			:m_valuebuf(&valuebuf_){}
+
+		bool operator()( const BindTerm& a, const BindTerm& b) const
+		{
+			if (a.m_seg != b.m_seg) return a.m_seg < b.m_seg;
+			if (a.m_ofs != b.m_ofs) return a.m_ofs < b.m_ofs;
+			if (a.m_ordlen != b.m_ordlen) return a.m_ordlen < b.m_ordlen;
+			if (a.m_endofs != b.m_endofs) return a.m_endofs < b.m_endofs;
+			if (a.m_typeord != b.m_typeord) return a.m_typeord < b.m_typeord;
+			if (a.m_valueofs == b.m_valueofs) return false;
+			return compareValue( a, b) < 0;
+		}
+
+	private:
+		int compareValue( const BindTerm& a, const BindTerm& b) const
+		{
+			std::size_t minsize = a.m_valuesize < b.m_valuesize ? a.m_valuesize : b.m_valuesize;
+			int cmp = std::memcmp( m_valuebuf->value( a.m_valueofs), m_valuebuf->value( b.m_valueofs), minsize);
+			return cmp ? cmp : ((a.m_valuesize > b.m_valuesize) - (a.m_valuesize < b.m_valuesize));
+		}
+
+	private:
+		const BindTermValueBuffer* m_valuebuf;
+	};
 
 	/// \brief Sorts the elements in the passed list and eliminates covered elements
-	static void eliminateCoveredElements( std::vector<BindTerm>& terms);
+	static void eliminateCoveredElements( std::vector<BindTerm>& terms, const BindTermValueBuffer& valuebuf);
 
 private:
 	int m_seg;
@@ -70,28 +125,10 @@ private:
 	int m_ordlen;
 	int m_priority;
 	analyzer::PositionBind m_posbind;
-	std::string m_type;
-	std::string m_value;
-};
-
-class BindLexem
-	:public BindTerm
-{
-public:
-	BindLexem( const BindLexem& o)
-		:BindTerm(o),m_id(o.m_id){}
-	BindLexem( int id_, const BindTerm& term)
-		:BindTerm(term),m_id(id_){}
-
-	int id() const		{return m_id;}
-
-	bool operator < (const BindLexem& o) const
-	{
-		return BindTerm::operator <(o);
-	}
-
-private:
-	int m_id;
+	int m_typeidx;
+	int m_typeord;
+	std::size_t m_valueofs;
+	std::size_t m_valuesize;
 };
 
 }//namespace
@@ -0,0 +1,283 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Parallel analysis of a list of documents with a work stealing scheduler
+/// \file documentAnalyzerBatch.cpp
+#include "documentAnalyzerBatch.hpp"
+#include "documentAnalyzerInstance.hpp"
+#include "documentAnalyzerContext.hpp"
+#include "strus/errorBufferInterface.hpp"
+#include "private/internationalization.hpp"
+#include <stdexcept>
+#include <new>
+
+using namespace strus;
+
+/// \brief Number of inputs per worker a worker can start ahead of the next input to deliver
+#define RESULT_WINDOW_PER_WORKER 4
+
+DocumentAnalyzerBatch::DocumentAnalyzerBatch(
+		const DocumentAnalyzerInstance* analyzer_,
+		const std::vector<Input>& inputs_,
+		unsigned int nofThreads_,
+		ErrorBufferInterface* errorhnd_)
+	:m_analyzer(analyzer_)
+	,m_inputs(&inputs_)
+	,m_nofThreads(nofThreads_)
+	,m_results(inputs_.size())
+	,m_queues()
+	,m_window(0)
+	,m_nextDeliver(0)
+	,m_nofFailedWorkers(0)
+	,m_resultMutex()
+	,m_resultCond()
+	,m_terminate(0)
+	,m_errorhnd(errorhnd_)
+{
+	if (m_nofThreads > inputs_.size())
+	{
+		m_nofThreads = inputs_.size();
+	}
+	if (m_nofThreads > 1)
+	{
+		m_window = m_nofThreads * RESULT_WINDOW_PER_WORKER;
+		m_queues.reserve( m_nofThreads);
+		for (unsigned int qi=0; qi < m_nofThreads; ++qi)
+		{
+			m_queues.push_back( new WorkQueue());
+		}
+		// Distribute round robin, so that the workers progress in the order of the inputs:
+		std::size_t ii = 0, ie = inputs_.size();
+		for (; ii != ie; ++ii)
+		{
+			m_queues[ ii % m_nofThreads]->push( ii);
+		}
+	}
+}
+
+DocumentAnalyzerBatch::~DocumentAnalyzerBatch()
+{
+	std::vector<WorkQueue*>::const_iterator qi = m_queues.begin(), qe = m_queues.end();
+	for (; qi != qe; ++qi)
+	{
+		delete *qi;
+	}
+}
+
+bool DocumentAnalyzerBatch::tryFetchWork( unsigned int workeridx, std::size_t limit, std::size_t& inputidx, bool& allEmpty)
+{
+	bool empty;
+	if (m_queues[ workeridx]->pop( inputidx, limit, empty)) return true;
+	allEmpty = empty;
+
+	// Steal from the other workers, starting with the next one.
+	// We take the oldest input of the victim, because the results are delivered in order:
+	for (unsigned int vi=1; vi < m_nofThreads; ++vi)
+	{
+		if (m_queues[ (workeridx + vi) % m_nofThreads]->pop( inputidx, limit, empty)) return true;
+		allEmpty &= empty;
+	}
+	return false;
+}
+
+bool DocumentAnalyzerBatch::fetchWork( unsigned int workeridx, std::size_t& inputidx)
+{
+	for (;;)
+	{
+		std::size_t nextDeliver;
+		{
+			strus::scoped_lock lock( m_resultMutex);
+			nextDeliver = m_nextDeliver;
+		}
+		if (m_terminate.value()) return false;
+		bool allEmpty = true;
+		if (tryFetchWork( workeridx, nextDeliver + m_window, inputidx, allEmpty)) return true;
+		if (allEmpty) return false;
+
+		// ... all inputs left are outside the window, wait for the next delivery.
+		// The next input to deliver is either in progress or at the front of a queue and inside the window, so this cannot block forever:
+		strus::unique_lock lock( m_resultMutex);
+		while (m_nextDeliver == nextDeliver && !m_terminate.value())
+		{
+			m_resultCond.wait( lock);
+		}
+	}
+}
+
+void DocumentAnalyzerBatch::analyzeInput( DocumentAnalyzerContext*& context, std::size_t inputidx, Result& result)
+{
+	const Input& input = (*m_inputs)[ inputidx];
+	try
+	{
+		if (context)
+		{
+			if (!context->reset( input.dclass))
+			{
+				result.error = m_errorhnd->fetchError();
+				delete context;
+				context = 0;
+				return;
+			}
+		}
+		else
+		{
+			context = new DocumentAnalyzerContext( m_analyzer, input.dclass, m_errorhnd);
+		}
+		context->putInput( input.content.c_str(), input.content.size(), true);
+		analyzer::Document doc;
+		while (context->analyzeNext( doc))
+		{
+			result.documents.push_back( doc);
+		}
+		if (m_errorhnd->hasError())
+		{
+			result.error = m_errorhnd->fetchError();
+		}
+	}
+	catch (const std::bad_alloc&)
+	{
+		result.error = _TXT("out of memory");
+		delete context;
+		context = 0;
+	}
+	catch (const std::exception& err)
+	{
+		result.error = err.what();
+		delete context;
+		context = 0;
+	}
+}
+
+void DocumentAnalyzerBatch::runWorker( unsigned int workeridx)
+{
+	if (!m_errorhnd->allocContext())
+	{
+		// ... the inputs of this worker are stolen by the others or analyzed by the thread calling run if no worker started
+		strus::scoped_lock lock( m_resultMutex);
+		++m_nofFailedWorkers;
+		m_resultCond.notify_all();
+		return;
+	}
+	DocumentAnalyzerContext* context = 0;
+	std::size_t inputidx;
+	while (fetchWork( workeridx, inputidx))
+	{
+		Result& result = m_results[ inputidx];
+		analyzeInput( context, inputidx, result);
+
+		strus::scoped_lock lock( m_resultMutex);
+		result.done = true;
+		m_resultCond.notify_all();
+	}
+	delete context;
+	m_errorhnd->releaseContext();
+}
+
+void DocumentAnalyzerBatch::deliver( Callback& callback, std::size_t inputidx)
+{
+	Result& result = m_results[ inputidx];
+	std::vector<analyzer::Document>::const_iterator di = result.documents.begin(), de = result.documents.end();
+	for (; di != de; ++di)
+	{
+		callback.document( inputidx, *di);
+	}
+	if (!result.error.empty())
+	{
+		callback.error( inputidx, result.error.c_str());
+	}
+	// Free the memory of delivered results:
+	std::vector<analyzer::Document>().swap( result.documents);
+	std::string().swap( result.error);
+}
+
+void DocumentAnalyzerBatch::runSequential( Callback& callback)
+{
+	DocumentAnalyzerContext* context = 0;
+	try
+	{
+		std::size_t ii = 0, ie = m_inputs->size();
+		for (; ii != ie; ++ii)
+		{
+			analyzeInput( context, ii, m_results[ ii]);
+			deliver( callback, ii);
+		}
+		delete context;
+	}
+	catch (...)
+	{
+		delete context;
+		throw;
+	}
+}
+
+bool DocumentAnalyzerBatch::waitResult( std::size_t inputidx)
+{
+	strus::unique_lock lock( m_resultMutex);
+	while (!m_results[ inputidx].done)
+	{
+		if (m_nofFailedWorkers == m_nofThreads) return false;
+		m_resultCond.wait( lock);
+	}
+	return true;
+}
+
+void DocumentAnalyzerBatch::terminateWorkers( std::vector<strus::thread*>& workers)
+{
+	m_terminate.set( 1);
+	{
+		strus::scoped_lock lock( m_resultMutex);
+		m_resultCond.notify_all();
+	}
+	std::vector<strus::thread*>::iterator wi = workers.begin(), we = workers.end();
+	for (; wi != we; ++wi)
+	{
+		(*wi)->join();
+		delete *wi;
+	}
+	workers.clear();
+}
+
+void DocumentAnalyzerBatch::run( Callback& callback)
+{
+	if (m_nofThreads <= 1)
+	{
+		runSequential( callback);
+		return;
+	}
+	std::vector<strus::thread*> workers;
+	DocumentAnalyzerContext* context = 0;	//... context of the calling thread, used only if no worker could start
+	try
+	{
+		workers.reserve( m_nofThreads);
+		for (unsigned int wi=0; wi < m_nofThreads; ++wi)
+		{
+			workers.push_back( new strus::thread( &DocumentAnalyzerBatch::runWorker, this, wi));
+		}
+		std::size_t ii = 0, ie = m_inputs->size();
+		for (; ii != ie; ++ii)
+		{
+			if (!waitResult( ii))
+			{
+				analyzeInput( context, ii, m_results[ ii]);
+			}
+			deliver( callback, ii);
+
+			strus::scoped_lock lock( m_resultMutex);
+			m_nextDeliver = ii+1;
+			m_resultCond.notify_all();
+		}
+		terminateWorkers( workers);
+		delete context;
+	}
+	catch (...)
+	{
+		terminateWorkers( workers);
+		delete context;
+		throw;
+	}
+}
+
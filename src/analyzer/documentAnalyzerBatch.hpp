@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Parallel analysis of a list of documents with a work stealing scheduler
+/// \file documentAnalyzerBatch.hpp
+#ifndef _STRUS_DOCUMENT_ANALYZER_BATCH_HPP_INCLUDED
+#define _STRUS_DOCUMENT_ANALYZER_BATCH_HPP_INCLUDED
+#include "strus/documentAnalyzerInstanceInterface.hpp"
+#include "strus/analyzer/document.hpp"
+#include "strus/base/thread.hpp"
+#include "strus/base/atomic.hpp"
+#include <vector>
+#include <deque>
+#include <string>
+
+namespace strus
+{
+/// \brief Forward declaration
+class ErrorBufferInterface;
+/// \brief Forward declaration
+class DocumentAnalyzerInstance;
+/// \brief Forward declaration
+class DocumentAnalyzerContext;
+
+/// \brief Parallel analysis of a list of documents
+/// \note Every worker thread owns one document analyzer context that is reset for every input it processes.
+///	Inputs are distributed round robin to the queues of the workers, a worker with an empty queue steals work from the others.
+///	The results are delivered in the order of the inputs by the thread calling run.
+///	Workers do not start an input more than a window of inputs ahead of the next input to deliver,
+///	this bounds the number of results buffered when the analysis of one input is slow.
+class DocumentAnalyzerBatch
+{
+public:
+	typedef DocumentAnalyzerInstanceInterface::Input Input;
+	typedef DocumentAnalyzerInstanceInterface::Callback Callback;
+
+	DocumentAnalyzerBatch(
+			const DocumentAnalyzerInstance* analyzer_,
+			const std::vector<Input>& inputs_,
+			unsigned int nofThreads_,
+			ErrorBufferInterface* errorhnd_);
+	~DocumentAnalyzerBatch();
+
+	/// \brief Analyze all inputs and pass the results in the order of the inputs to a callback
+	/// \param[in] callback receiver of the results
+	void run( Callback& callback);
+
+private:
+	/// \brief Result of the analysis of one input
+	struct Result
+	{
+		std::vector<analyzer::Document> documents;
+		std::string error;
+		bool done;
+
+		Result()
+			:documents(),error(),done(false){}
+	};
+
+	/// \brief Queue of input indices of one worker
+	class WorkQueue
+	{
+	public:
+		WorkQueue()
+			:m_mutex(),m_ar(){}
+
+		void push( std::size_t inputidx)
+		{
+			strus::scoped_lock lock( m_mutex);
+			m_ar.push_back( inputidx);
+		}
+		/// \brief Pop the oldest input if its index is smaller than a limit
+		/// \param[out] inputidx the input popped
+		/// \param[in] limit upper bound (exclusive) of the input index popped
+		/// \param[out] empty true, if the queue is empty
+		/// \return true, if an input was popped
+		bool pop( std::size_t& inputidx, std::size_t limit, bool& empty)
+		{
+			strus::scoped_lock lock( m_mutex);
+			empty = m_ar.empty();
+			if (empty || m_ar.front() >= limit) return false;
+			inputidx = m_ar.front();
+			m_ar.pop_front();
+			return true;
+		}
+
+	private:
+		strus::mutex m_mutex;
+		std::deque<std::size_t> m_ar;
+	};
+
+private:
+	DocumentAnalyzerBatch( const DocumentAnalyzerBatch&){}	//... non copyable
+	void operator=( const DocumentAnalyzerBatch&){}		//... non copyable
+
+	void runWorker( unsigned int workeridx);
+	bool fetchWork( unsigned int workeridx, std::size_t& inputidx);
+	bool tryFetchWork( unsigned int workeridx, std::size_t limit, std::size_t& inputidx, bool& allEmpty);
+	void analyzeInput( DocumentAnalyzerContext*& context, std::size_t inputidx, Result& result);
+	void deliver( Callback& callback, std::size_t inputidx);
+	void runSequential( Callback& callback);
+	bool waitResult( std::size_t inputidx);
+	void terminateWorkers( std::vector<strus::thread*>& workers);
+
+private:
+	const DocumentAnalyzerInstance* m_analyzer;
+	const std::vector<Input>* m_inputs;
+	unsigned int m_nofThreads;
+	std::vector<Result> m_results;
+	std::vector<WorkQueue*> m_queues;
+	std::size_t m_window;			///< maximum distance of an input started to the next input to deliver
+	std::size_t m_nextDeliver;		///< index of the next input to deliver, protected by m_resultMutex
+	unsigned int m_nofFailedWorkers;	///< number of workers that could not start, protected by m_resultMutex
+	strus::mutex m_resultMutex;
+	strus::condition_variable m_resultCond;	///< signals a result done, a result delivered or a worker failed to start
+	strus::AtomicCounter<int> m_terminate;
+	ErrorBufferInterface* m_errorhnd;
+};
+
+}//namespace
+#endif
+
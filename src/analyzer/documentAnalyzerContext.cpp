@@ -6,6 +6,7 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  */
 #include "documentAnalyzerContext.hpp"
+#include "documentBuilderSink.hpp"
 #include "strus/debugTraceInterface.hpp"
 #include "strus/normalizerFunctionInstanceInterface.hpp"
 #include "strus/tokenizerFunctionInstanceInterface.hpp"
@@ -14,6 +15,7 @@
 #include "strus/errorBufferInterface.hpp"
 #include "strus/base/string_conv.hpp"
 #include "private/errorUtils.hpp"
+#include "private/documentLines.hpp"
 #include "private/internationalization.hpp"
 #include <stdexcept>
 #include <sstream>
@@ -29,7 +31,10 @@
 #define DEBUG_EVENT2( NAME, FMT, ID, VAL)			if (m_debugtrace) m_debugtrace->event( NAME, FMT, ID, VAL);
 #define DEBUG_EVENT2_CONTENT( NAME, FMT, ID, VAL, STR, LEN)	if (m_debugtrace) {std::string cs(contentCut(STR,LEN,100)); m_debugtrace->event( NAME, FMT, ID, VAL, cs.c_str());}
 
-#define FIELD_ID_SEPARATOR ','
+/// \brief Size in bytes of the parts a content is split into for parallel analysis, the sub documents of one part per thread are kept in memory
+#define PART_SIZE (1UL<<20)
+/// \brief Maximum number of parts a content is split into for parallel analysis
+#define MAX_NOF_PARTS (1UL<<16)
 
 #define B10000000 128
 #define B11000000 (127+64)
@@ -49,18 +54,33 @@ static std::string contentCut( const char* str, std::size_t size, std::size_t le
 using namespace strus;
 
 DocumentAnalyzerContext::DocumentAnalyzerContext( const DocumentAnalyzerInstance* analyzer_, const analyzer::DocumentClass& dclass, ErrorBufferInterface* errorhnd_)
-	:m_segmentProcessor(analyzer_->featureConfigMap(), errorhnd_)
+	:m_normalizerCacheMap(analyzer_->featureConfigMap())
+	,m_segmentProcessor(analyzer_->featureConfigMap(), errorhnd_)
+	,m_parallelProcessor(0)
+	,m_linesAnalyzer(0)
+	,m_partsAnalyzer(0)
+	,m_documentClass(dclass)
+	,m_content()
+	,m_partsAnalysisEnabled(true)
 	,m_analyzer(analyzer_)
+	,m_aggregationPlan(analyzer_->statisticsConfigs(),errorhnd_)
 	,m_segmenter(m_analyzer->segmenter()->createContext( dclass))
 	,m_segmenterstack()
+	,m_subsegmenterCache()
 	,m_eof(false)
 	,m_curr_position_ofs(0)
 	,m_curr_position(0)
 	,m_start_position(0)
 	,m_nof_segments(0)
+	,m_inputSize(0)
+	,m_inputRef(0)
+	,m_inputRefSize(0)
+	,m_mappedInput()
 	,m_subdocTypeName()
 	,m_activeFields()
+	,m_fieldIdMap()
 	,m_structures()
+	,m_structureBuilder()
 	,m_errorhnd(errorhnd_)
 	,m_debugtrace(0)
 {
@@ -68,480 +88,431 @@ DocumentAnalyzerContext::DocumentAnalyzerContext( const DocumentAnalyzerInstance
 	{
 		throw std::runtime_error( _TXT("failed to create document analyzer context"));
 	}
+	if (utils::documentLineMimeType( dclass.mimeType()))
+	{
+		try
+		{
+			m_linesAnalyzer = new DocumentLinesAnalyzer( m_analyzer, dclass, m_errorhnd);
+		}
+		catch (...)
+		{
+			delete m_segmenter;
+			throw;
+		}
+	}
+	m_segmentProcessor.setNormalizerCache( &m_normalizerCacheMap);
+	if (m_analyzer->parallelNofThreads() > 1)
+	{
+		m_parallelProcessor = new ParallelSegmentProcessor( m_analyzer->featureConfigMap(), m_analyzer->parallelNofThreads(), m_errorhnd);
+	}
+	DebugTraceInterface* dbgi = m_errorhnd->debugTrace();
+	if (dbgi) m_debugtrace = dbgi->createTraceContext( STRUS_DBGTRACE_COMPONENT_NAME);
+}
+
+DocumentAnalyzerContext::DocumentAnalyzerContext( const DocumentAnalyzerInstance* analyzer_, SegmenterContextInterface* segmenter_, ErrorBufferInterface* errorhnd_)
+	:m_normalizerCacheMap(analyzer_->featureConfigMap())
+	,m_segmentProcessor(analyzer_->featureConfigMap(), errorhnd_)
+	,m_parallelProcessor(0)
+	,m_linesAnalyzer(0)
+	,m_partsAnalyzer(0)
+	,m_documentClass()
+	,m_content()
+	,m_partsAnalysisEnabled(false)
+	,m_analyzer(analyzer_)
+	,m_aggregationPlan(analyzer_->statisticsConfigs(),errorhnd_)
+	,m_segmenter(segmenter_)
+	,m_segmenterstack()
+	,m_subsegmenterCache()
+	,m_eof(true)
+	,m_curr_position_ofs(0)
+	,m_curr_position(0)
+	,m_start_position(0)
+	,m_nof_segments(0)
+	,m_inputSize(0)
+	,m_inputRef(0)
+	,m_inputRefSize(0)
+	,m_mappedInput()
+	,m_subdocTypeName()
+	,m_activeFields()
+	,m_fieldIdMap()
+	,m_structures()
+	,m_structureBuilder()
+	,m_errorhnd(errorhnd_)
+	,m_debugtrace(0)
+{
+	// ... the part is analyzed in the thread of the caller, the segments are not processed in parallel
+	m_segmentProcessor.setNormalizerCache( &m_normalizerCacheMap);
 	DebugTraceInterface* dbgi = m_errorhnd->debugTrace();
 	if (dbgi) m_debugtrace = dbgi->createTraceContext( STRUS_DBGTRACE_COMPONENT_NAME);
 }
 
 DocumentAnalyzerContext::~DocumentAnalyzerContext()
 {
+	if (m_parallelProcessor) delete m_parallelProcessor;
+	if (m_linesAnalyzer) delete m_linesAnalyzer;
+	if (m_partsAnalyzer) delete m_partsAnalyzer;
 	delete m_segmenter;
-	std::vector<SegmenterStackElement>::const_iterator si = m_segmenterstack.begin(), se = m_segmenterstack.begin();
+	std::vector<SegmenterStackElement>::const_iterator si = m_segmenterstack.begin(), se = m_segmenterstack.end();
 	for (; si != se; ++si)
 	{
 		delete si->segmenter;
 	}
+	std::vector<SegmenterContextInterface*>::const_iterator ci = m_subsegmenterCache.begin(), ce = m_subsegmenterCache.end();
+	for (; ci != ce; ++ci)
+	{
+		delete *ci;
+	}
 	if (m_debugtrace) delete m_debugtrace;
 }
 
-void DocumentAnalyzerContext::putInput( const char* chunk, std::size_t chunksize, bool eof)
+bool DocumentAnalyzerContext::reset( const analyzer::DocumentClass& dclass)
 {
-	m_segmenter->putInput( chunk, chunksize, eof);
-	m_eof = eof;
-}
-
-void DocumentAnalyzerContext::processAggregatedMetadata( analyzer::Document& res) const
-{
-	std::vector<DocumentAnalyzerInstance::StatisticsConfig>::const_iterator
-		si = m_analyzer->statisticsConfigs().begin(), se = m_analyzer->statisticsConfigs().end();
-	DEBUG_OPEN( "metadata");
-	for (; si != se; ++si)
+	try
 	{
-		NumericVariant value = si->statfunc()->evaluate( res);
-		res.setMetaData( si->name(), value);
-		DEBUG_EVENT2( "aggregated", "%s %s", si->name().c_str(), value.tostring().c_str());
+		while (!m_segmenterstack.empty())
+		{
+			popSegmenter();
+		}
+		if (m_partsAnalyzer)
+		{
+			delete m_partsAnalyzer;
+			m_partsAnalyzer = 0;
+		}
+		std::string().swap( m_content);
+		m_partsAnalysisEnabled = true;
+		m_documentClass = dclass;
+		if (!m_segmenter->reset( dclass))
+		{
+			if (m_errorhnd->hasError()) return false;
+			// ... the segmenter context cannot be reused for this document class, create a new one
+			SegmenterContextInterface* segmenter = m_analyzer->segmenter()->createContext( dclass);
+			if (!segmenter)
+			{
+				throw std::runtime_error( _TXT("failed to create segmenter context"));
+			}
+			delete m_segmenter;
+			m_segmenter = segmenter;
+		}
+		if (utils::documentLineMimeType( dclass.mimeType()))
+		{
+			if (m_linesAnalyzer)
+			{
+				m_linesAnalyzer->reset( dclass);
+			}
+			else
+			{
+				m_linesAnalyzer = new DocumentLinesAnalyzer( m_analyzer, dclass, m_errorhnd);
+			}
+		}
+		else if (m_linesAnalyzer)
+		{
+			delete m_linesAnalyzer;
+			m_linesAnalyzer = 0;
+		}
+		m_eof = false;
+		m_curr_position_ofs = 0;
+		m_curr_position = 0;
+		m_start_position = 0;
+		m_nof_segments = 0;
+		m_inputSize = 0;
+		m_inputRef = 0;
+		m_inputRefSize = 0;
+		m_mappedInput.close();
+		m_subdocTypeName.clear();
+		m_activeFields.clear();
+		m_fieldIdMap.clear();
+		m_structures.clear();
+		m_segmentProcessor.clearTermMaps();
+		if (m_parallelProcessor) m_parallelProcessor->clear();
+		return true;
 	}
-	DEBUG_CLOSE();
+	CATCH_ERROR_MAP_RETURN( _TXT("error in document analyzer context reset: %s"), *m_errorhnd, false);
 }
 
-
-void DocumentAnalyzerContext::completeDocumentProcessing( analyzer::Document& res)
+bool DocumentAnalyzerContext::releaseInput()
 {
-	// collect open structures that did not get the terminate event:
-	collectActiveFields();
-
-	// process concatenated chunks:
-	m_segmentProcessor.processConcatenated();
-	m_segmentProcessor.eliminateCovered();
-
-	// create output (with real positions):
-	res = m_segmentProcessor.fetchDocument( m_analyzer->structureConfigList(), m_structures);
-	res.setSubDocumentTypeName( m_subdocTypeName);
-
-	// Map aggregated metadata, if defined:
-	processAggregatedMetadata( res);
-
-	// Reset current document processing state:
-	m_segmentProcessor.clearTermMaps();
-	m_activeFields.clear();
-	m_structures.clear();
+	// ... the reset clears the input references of the segmenters before it closes the mapping they refer to
+	return reset( m_documentClass);
 }
 
-struct FieldArea
+SegmenterContextInterface* DocumentAnalyzerContext::acquireSubSegmenter( int subsegmenterIdx)
 {
-	enum Type {HeaderType,ContentType};
-	Type type;
-	const char* id;
-	SearchIndexStructure::PositionRange positionRange;
-
-	FieldArea()
-		:type(ContentType),id(0),positionRange(){}
-	FieldArea( Type type_, const char* id_, const SearchIndexStructure::PositionRange& positionRange_)
-		:type(type_),id(id_),positionRange(positionRange_){}
-	FieldArea( const FieldArea& o)
-		:type(o.type),id(o.id),positionRange(o.positionRange){}
-
-	bool operator<( const FieldArea& o) const
+	const DocumentAnalyzerInstance::SubSegmenterDef* subsegmenterdef = m_analyzer->subsegmenter( subsegmenterIdx);
+	if ((std::size_t)subsegmenterIdx < m_subsegmenterCache.size() && m_subsegmenterCache[ subsegmenterIdx])
 	{
-		if (positionRange.second == o.positionRange.second)
+		SegmenterContextInterface* rt = m_subsegmenterCache[ subsegmenterIdx];
+		m_subsegmenterCache[ subsegmenterIdx] = 0;
+		if (rt->reset( subsegmenterdef->documentClass))
 		{
-			return (positionRange.first == o.positionRange.first)
-				? (type == o.type
-					? id < o.id
-					: (int)type < (int)o.type)
-				: positionRange.first < o.positionRange.first;
+			return rt;
 		}
-		else
-		{
-			return positionRange.second < o.positionRange.second;
-		}
-	}
-	bool covers( const FieldArea& oth) const
-	{
-		return positionRange.second >= oth.positionRange.second
-			&& positionRange.first <= oth.positionRange.first;
+		delete rt;
+		if (m_errorhnd->hasError()) throw std::runtime_error( _TXT("failed to reset sub segmenter context"));
 	}
-	bool isequal( const FieldArea& oth) const
+	SegmenterContextInterface* rt = subsegmenterdef->segmenterInstance->createContext( subsegmenterdef->documentClass);
+	if (!rt) throw std::runtime_error( _TXT("failed to create sub segmenter context"));
+	return rt;
+}
+
+void DocumentAnalyzerContext::releaseSubSegmenter( int subsegmenterIdx, SegmenterContextInterface* segmenter)
+{
+	if ((std::size_t)subsegmenterIdx >= m_subsegmenterCache.size())
 	{
-		return positionRange.second == oth.positionRange.second
-			&& positionRange.first == oth.positionRange.first;
+		m_subsegmenterCache.resize( subsegmenterIdx+1, 0);
 	}
-	static bool isMatchSeparator( char aa)
+	if (m_subsegmenterCache[ subsegmenterIdx])
 	{
-		return aa == '\0' || aa == FIELD_ID_SEPARATOR;
+		// ... another context of the same sub segmenter (nested sub content) is already kept
+		delete segmenter;
 	}
-	static bool isSubMatch( const char* haystack, const char* needle)
+	else
 	{
-		char const* ai = std::strstr( haystack, needle);
-		return ai
-			&& (ai == haystack || *(ai-1) == FIELD_ID_SEPARATOR)
-			&& isMatchSeparator( ai[std::strlen(needle)]);
+		m_subsegmenterCache[ subsegmenterIdx] = segmenter;
 	}
-	struct IdSubString {
-		const char* str;
-		std::size_t len;
-		int hash;
-	};
-	static int hashIdSubString( const char* str, std::size_t len)
+}
+
+void DocumentAnalyzerContext::popSegmenter()
+{
+	SegmenterContextInterface* segmenter = m_segmenter;
+	int subsegmenterIdx = m_segmenterstack.back().subsegmenterIdx;
+	m_segmenter = m_segmenterstack.back().segmenter;
+	m_curr_position_ofs = m_segmenterstack.back().curr_position_ofs;
+	m_start_position = m_segmenterstack.back().start_position;
+	m_segmenterstack.pop_back();
+	try
 	{
-		std::size_t li = 0, le = len;
-		int hs = 1031;
-		for (; li != le; ++li)
-		{
-			hs += (str[ li] * li * 10) + 137;
-		}
-		return hs;
+		releaseSubSegmenter( subsegmenterIdx, segmenter);
 	}
-
-	static void parseIdSubStrings( IdSubString* buf, std::size_t bufsize, std::size_t& len, const char* haystack)
+	catch (const std::bad_alloc&)
 	{
-		char const* hi = haystack;
-		char const* hn = std::strchr( hi, FIELD_ID_SEPARATOR);
-		len = 0;
-
-		for (; hn && len < bufsize;
-			hi=hn+1,hn = std::strchr( hi, FIELD_ID_SEPARATOR),++len)
-		{
-			buf[ len].hash
-				= hashIdSubString(
-					buf[ len].str = hi,
-					buf[ len].len = hn-hi);
-		}
-		if (len == bufsize)
-		{
-			throw strus::runtime_error(_TXT("too many ids (%d) assigned to structure in '%s'"), (int)len, haystack);
-		}
-		buf[ len].hash
-			= hashIdSubString(
-				buf[ len].str = hi,
-				buf[ len].len = std::strchr( hi, '\0')-hi);
-		++len;
+		delete segmenter;
+		throw;
 	}
+}
 
-	static bool findCommonMatch( const char* haystack1, const char* haystack2)
-	{
-		enum {MaxNofFields = 1024};
+SegmenterContextInterface* DocumentAnalyzerContext::rootSegmenter() const
+{
+	// ... input is always fed to the segmenter of the document, not to a segmenter of sub content on the stack
+	return m_segmenterstack.empty() ? m_segmenter : m_segmenterstack.front().segmenter;
+}
 
-		IdSubString har1[ MaxNofFields]; std::size_t harlen1 = 0;
-		IdSubString har2[ MaxNofFields]; std::size_t harlen2 = 0;
+bool DocumentAnalyzerContext::isSplittableInput( std::size_t chunksize, bool eof) const
+{
+	// ... only a big content fed completely with one call, analyzed as sub documents, is split into parts analyzed in parallel
+	return m_partsAnalysisEnabled && eof && m_inputSize == 0 && !m_eof
+		&& m_analyzer->parallelNofThreads() > 1
+		&& !m_analyzer->subdoctypes().empty()
+		&& chunksize >= m_analyzer->parallelMinDocumentSize();
+}
 
-		parseIdSubStrings( har1, MaxNofFields, harlen1, haystack1);
-		parseIdSubStrings( har2, MaxNofFields, harlen2, haystack2);
+bool DocumentAnalyzerContext::putSplittableInput( const char* content, std::size_t contentsize, bool copy)
+{
+	unsigned int nofThreads = m_analyzer->parallelNofThreads();
+	std::size_t nofParts = contentsize / PART_SIZE;
+	if (nofParts < nofThreads) nofParts = nofThreads;
+	if (nofParts > MAX_NOF_PARTS) nofParts = MAX_NOF_PARTS;
 
-		std::size_t h1 = 0;
-		for (; h1 < harlen1; ++h1)
+	std::vector<SegmenterInstanceInterface::ContentPart> parts;
+	if (!m_analyzer->segmenter()->splitContent( parts, m_documentClass, content, contentsize, nofParts) || parts.size() <= 1)
+	{
+		if (m_errorhnd->hasError())
 		{
-			std::size_t h2 = 0;
-			for (; h2 < harlen2; ++h2)
-			{
-				if (har1[ h1].hash == har2[ h2].hash
-				&&  har1[ h1].len == har2[ h2].len
-				&&  0==std::memcmp( har1[ h1].str, har2[ h2].str, har2[ h2].len))
-				{
-					return true;
-				}
-			}
+			throw std::runtime_error( m_errorhnd->fetchError());
 		}
 		return false;
 	}
-	bool matches( const FieldArea& oth) const
+	// ... the parts are offsets into the content, it is copied only after the segmenter has split it
+	if (copy)
 	{
-		if (id == oth.id) return true;
-		if (!id || !oth.id) return false;
-		if (0!=std::strchr( id, FIELD_ID_SEPARATOR))
-		{
-			if (0!=std::strchr( oth.id, FIELD_ID_SEPARATOR))
-			{
-				return findCommonMatch( id, oth.id);
-			}
-			else
-			{
-				return isSubMatch( id, oth.id);
-			}
-		}
-		else if (0!=std::strchr( oth.id, FIELD_ID_SEPARATOR))
-		{
-			return isSubMatch( oth.id, id);
-		}
-		else
-		{
-			return 0==std::strcmp( id, oth.id);
-		}
-		return false;
+		m_content.assign( content, contentsize);
+		content = m_content.c_str();
 	}
-};
+	m_partsAnalyzer = new DocumentPartsAnalyzer( m_analyzer, m_documentClass, content, contentsize, parts, nofThreads, m_errorhnd);
+	return true;
+}
 
-static void collectHeaderFields(
-	std::set<FieldArea>& res,
-	const std::vector<SeachIndexFieldConfig>& fieldConfigs,
-	const std::vector<SearchIndexField>& fields, int configIdx)
+bool DocumentAnalyzerContext::isReferencedInput( const char* segment, std::size_t segmentsize) const
 {
-	std::vector<SearchIndexField>::const_iterator fi = fields.begin(), fe = fields.end();
-	for (; fi != fe; ++fi)
-	{
-		const SeachIndexFieldConfig& config = fieldConfigs[ fi->configIdx()];
-		std::vector<int>::const_iterator
-			hi = config.headerStructureList().begin(),
-			he = config.headerStructureList().end();
-		for (; hi != he; ++hi)
-		{
-			if (*hi == configIdx)
-			{
-				const char* idstr = fi->id().empty() ? 0 : fi->id().c_str();
-				SearchIndexStructure::PositionRange posrange( fi->start(), fi->end());
-				FieldArea area( FieldArea::HeaderType, idstr, posrange);
-				res.insert( area);
-			}
-		}
-	}
+	return m_inputRef && segment >= m_inputRef && segment + segmentsize <= m_inputRef + m_inputRefSize;
 }
 
-static void collectContentFields(
-	std::set<FieldArea>& res,
-	const std::vector<SeachIndexFieldConfig>& fieldConfigs,
-	const std::vector<SearchIndexField>& fields, int configIdx)
+void DocumentAnalyzerContext::putInput( const char* chunk, std::size_t chunksize, bool eof)
 {
-	std::vector<SearchIndexField>::const_iterator fi = fields.begin(), fe = fields.end();
-	for (; fi != fe; ++fi)
-	{
-		const SeachIndexFieldConfig& config = fieldConfigs[ fi->configIdx()];
-		std::vector<int>::const_iterator
-			ci = config.contentStructureList().begin(),
-			ce = config.contentStructureList().end();
-		for (; ci != ce; ++ci)
+	if (m_linesAnalyzer)
+	{
+		try
+		{
+			m_linesAnalyzer->putInput( chunk, chunksize, eof);
+		}
+		CATCH_ERROR_MAP( _TXT("error in DocumentAnalyzerContext::putInput: %s"), *m_errorhnd);
+	}
+	else if (isSplittableInput( chunksize, eof))
+	{
+		try
 		{
-			if (*ci == configIdx)
+			if (!putSplittableInput( chunk, chunksize, true/*copy*/))
 			{
-				const char* idstr = fi->id().empty() ? 0 : fi->id().c_str();
-				SearchIndexStructure::PositionRange posrange( fi->start(), fi->end());
-				FieldArea area( FieldArea::ContentType, idstr, posrange);
-				res.insert( area);
+				rootSegmenter()->putInput( chunk, chunksize, eof);
 			}
 		}
+		CATCH_ERROR_MAP( _TXT("error in DocumentAnalyzerContext::putInput: %s"), *m_errorhnd);
+	}
+	else
+	{
+		rootSegmenter()->putInput( chunk, chunksize, eof);
+	}
+	if (!m_errorhnd->hasError())
+	{
+		// ... a chunk rejected (e.g. because of a buffer limit exceeded) can be fed again
+		m_inputSize += chunksize;
+		m_eof = eof;
 	}
 }
 
-static void addStructureFieldCandidate( std::vector<FieldArea>& candidates, const FieldArea& area)
+void DocumentAnalyzerContext::putInputReference( const char* chunk, std::size_t chunksize, bool eof)
 {
-	std::vector<FieldArea>::iterator ci = candidates.begin(), ce = candidates.end();
-	while (ci != ce)
+	if (m_linesAnalyzer)
 	{
-		if (ci->covers( area))
+		try
 		{
-			return;
+			m_linesAnalyzer->putInputReference( chunk, chunksize, eof);
 		}
-		else if (area.covers( *ci))
+		CATCH_ERROR_MAP( _TXT("error in DocumentAnalyzerContext::putInputReference: %s"), *m_errorhnd);
+	}
+	else if (isSplittableInput( chunksize, eof))
+	{
+		try
 		{
-			ci = candidates.erase( ci);
-			ce = candidates.end();
+			if (!putSplittableInput( chunk, chunksize, false/*copy*/))
+			{
+				rootSegmenter()->putInputReference( chunk, chunksize, eof);
+				if (!m_errorhnd->hasError())
+				{
+					m_inputRef = chunk;
+					m_inputRefSize = chunksize;
+				}
+			}
 		}
-		else
+		CATCH_ERROR_MAP( _TXT("error in DocumentAnalyzerContext::putInputReference: %s"), *m_errorhnd);
+	}
+	else
+	{
+		rootSegmenter()->putInputReference( chunk, chunksize, eof);
+		if (eof && m_inputSize == 0 && !m_errorhnd->hasError())
 		{
-			++ci;
+			m_inputRef = chunk;
+			m_inputRefSize = chunksize;
 		}
 	}
-	candidates.push_back( area);
+	if (!m_errorhnd->hasError())
+	{
+		m_inputSize += chunksize;
+		m_eof = eof;
+	}
 }
 
-static void addInnerStructureFieldCandidate( std::vector<FieldArea>& candidates, const FieldArea& area)
+void DocumentAnalyzerContext::putInputMapped( const std::string& path)
 {
-	std::vector<FieldArea>::iterator ci = candidates.begin(), ce = candidates.end();
-	while (ci != ce)
+	try
 	{
-		if (ci->covers( area))
-		{
-			ci = candidates.erase( ci);
-			ce = candidates.end();
-		}
-		else if (area.covers( *ci))
+		if (m_eof)
 		{
-			return;
-		}
-		else
-		{
-			++ci;
+			// ... the segmenter may still reference the mapping of the input fed before
+			throw std::runtime_error( _TXT("input fed after declared end of input"));
 		}
+		m_mappedInput.open( path);
+		putInputReference( m_mappedInput.ptr(), m_mappedInput.size(), true);
 	}
-	candidates.push_back( area);
+	CATCH_ERROR_ARG1_MAP( _TXT("error feeding the content of file '%s' to the document analyzer: %s"), path.c_str(), *m_errorhnd);
 }
 
-static void flushStructureFieldCandidates( std::vector<SearchIndexStructure>& dest, int configIdx, const FieldArea& header, const std::vector<FieldArea>& candidates)
+std::size_t DocumentAnalyzerContext::bufferedInputSize() const
 {
-	std::vector<FieldArea>::const_iterator ci = candidates.begin(), ce = candidates.end();
-	for (; ci != ce; ++ci)
+	if (m_linesAnalyzer) return m_linesAnalyzer->bufferedInputSize();
+	if (m_partsAnalyzer) return m_partsAnalyzer->bufferedInputSize();
+	return rootSegmenter()->bufferedInputSize();
+}
+
+void DocumentAnalyzerContext::processAggregatedMetadata( analyzer::Document& res)
+{
+	// ... all accumulators in one pass over the terms, the other aggregators evaluated on the document
+	m_aggregationPlan.clear();
+	m_aggregationPlan.accumulate( res);
+	DEBUG_OPEN( "metadata");
+	std::size_t ai = 0, ae = m_aggregationPlan.size();
+	for (; ai != ae; ++ai)
 	{
-		dest.push_back( SearchIndexStructure( configIdx, header.positionRange, ci->positionRange));
+		NumericVariant value = m_aggregationPlan.result( ai, &res);
+		res.setMetaData( m_aggregationPlan.name( ai), value);
+		DEBUG_EVENT2( "aggregated", "%s %s", m_aggregationPlan.name( ai).c_str(), value.tostring().c_str());
 	}
+	DEBUG_CLOSE();
 }
 
-void DocumentAnalyzerContext::buildStructures( const std::vector<SearchIndexField>& fields, int configIdx)
+
+void DocumentAnalyzerContext::completeDocumentProcessing( DocumentSinkInterface& sink, analyzer::Document* doc)
 {
-	const SeachIndexStructureConfig& structConfig
-		= m_analyzer->structureConfigList()[ configIdx];
-	std::set<FieldArea> areaset;
+	// process the segments collected for parallel processing:
+	if (m_parallelProcessor && m_parallelProcessor->size())
+	{
+		DEBUG_EVENT1( "parallel-segments", "%d", (int)m_parallelProcessor->size());
+		m_parallelProcessor->run( m_segmentProcessor);
+	}
+
+	// collect open structures that did not get the terminate event:
+	collectActiveFields();
 
-	collectHeaderFields( areaset, m_analyzer->fieldConfigList(), fields, configIdx);
-	collectContentFields( areaset, m_analyzer->fieldConfigList(), fields, configIdx);
+	// process concatenated chunks:
+	m_segmentProcessor.processConcatenated();
+	m_segmentProcessor.eliminateCovered();
 
-	switch (structConfig.structureType())
+	// create output (with real positions):
+	if (m_analyzer->statisticsConfigs().empty())
 	{
-		case DocumentAnalyzerInstanceInterface::StructureCover:
-		{
-			// Find header covering content completely (not equal)
-			std::set<FieldArea>::reverse_iterator ai = areaset.rbegin(), ae = areaset.rend();
-			for (; ai != ae; ++ai)
-			{
-				if (ai->type == FieldArea::HeaderType)
-				{
-					std::vector<FieldArea> candidates;
-					std::set<FieldArea>::reverse_iterator next_ai = ai;
-					++next_ai;
-					for (; next_ai != ae; ++next_ai)
-					{
-						if (next_ai->type == FieldArea::ContentType
-						&&  ai->matches( *next_ai)
-						&&  ai->covers( *next_ai)
-						&& !ai->isequal( *next_ai))
-						{
-							addStructureFieldCandidate( candidates, *next_ai);
-						}
-					}
-					flushStructureFieldCandidates( m_structures, configIdx, *ai, candidates);
-				}
-			}
-			break;
-		}
-		case DocumentAnalyzerInstanceInterface::StructureLabel:
-		{
-			// Find header inside content (covered by content, not equal)
-			std::set<FieldArea>::const_iterator ai = areaset.begin(), ae = areaset.end();
-			for (; ai != ae; ++ai)
-			{
-				if (ai->type == FieldArea::HeaderType)
-				{
-					std::vector<FieldArea> candidates;
-					std::set<FieldArea>::const_iterator next_ai = ai;
-					++next_ai;
-					for (; next_ai != ae; ++next_ai)
-					{
-						if (next_ai->type == FieldArea::ContentType
-						&&  next_ai->matches( *ai)
-						&&  next_ai->covers( *ai)
-						&& !next_ai->isequal( *ai))
-						{
-							addInnerStructureFieldCandidate( candidates, *next_ai);
-						}
-					}
-					flushStructureFieldCandidates( m_structures, configIdx, *ai, candidates);
-				}
-			}
-		}
-		case DocumentAnalyzerInstanceInterface::StructureHeader:
-		{
-			std::set<FieldArea>::const_iterator ai = areaset.begin(), ae = areaset.end();
-			for (; ai != ae; ++ai)
-			{
-				if (ai->type == FieldArea::HeaderType)
-				{
-					std::vector<FieldArea> candidates;
-					std::set<FieldArea>::const_iterator next_ai = ai;
-					++next_ai;
-					for (; next_ai != ae && next_ai->type == FieldArea::ContentType; ++next_ai)
-					{
-						if (next_ai->positionRange.first >= ai->positionRange.second
-						&&  next_ai->matches( *ai))
-						{
-							addStructureFieldCandidate( candidates, *next_ai);
-						}
-					}
-					flushStructureFieldCandidates( m_structures, configIdx, *ai, candidates);
-				}
-			}
-			break;
-		}
-		case DocumentAnalyzerInstanceInterface::StructureFooter:
-		{
-			std::set<FieldArea>::reverse_iterator ai = areaset.rbegin(), ae = areaset.rend();
-			for (; ai != ae; ++ai)
-			{
-				if (ai->type == FieldArea::HeaderType)
-				{
-					std::vector<FieldArea> candidates;
-					std::set<FieldArea>::reverse_iterator next_ai = ai;
-					++next_ai;
-					for (; next_ai != ae && next_ai->type == FieldArea::ContentType; ++next_ai)
-					{
-						if (next_ai->positionRange.second <= ai->positionRange.first
-						&&  next_ai->matches( *ai))
+		// ... no aggregated metadata, pass the elements directly to the sink
+		sink.startDocument( m_subdocTypeName.c_str(), m_subdocTypeName.size());
+		m_segmentProcessor.fetchDocument( sink, m_analyzer->structureConfigList(), m_structures);
+		sink.endDocument();
+	}
+	else if (doc || m_aggregationPlan.complete())
+	{
+		// ... the aggregated metadata are accumulated in one pass while the search index terms are passed to the sink,
+		//	aggregators without accumulator are evaluated on the document built by the sink
+		AggregatingDocumentSink aggsink( sink, m_aggregationPlan, doc, m_debugtrace);
+		aggsink.startDocument( m_subdocTypeName.c_str(), m_subdocTypeName.size());
+		m_segmentProcessor.fetchDocument( aggsink, m_analyzer->structureConfigList(), m_structures);
+		aggsink.endDocument();
+	}
+	else
+	{
+		// ... aggregators need the complete document, materialize it before passing it to the sink
+		analyzer::Document res;
+		DocumentBuilderSink builder( &res);
+		builder.startDocument( m_subdocTypeName.c_str(), m_subdocTypeName.size());
+		m_segmentProcessor.fetchDocument( builder, m_analyzer->structureConfigList(), m_structures);
+		builder.endDocument();
+		processAggregatedMetadata( res);
+		DocumentBuilderSink::feed( sink, res);
+	}
 
-						{
-							addStructureFieldCandidate( candidates, *next_ai);
-						}
-					}
-					flushStructureFieldCandidates( m_structures, configIdx, *ai, candidates);
-				}
-			}
-			break;
-		}
-		case DocumentAnalyzerInstanceInterface::StructureSpan:
-		{
-			std::set<FieldArea>::const_iterator ai = areaset.begin(), ae = areaset.end();
-			for (; ai != ae; ++ai)
-			{
-				if (ai->type == FieldArea::HeaderType)
-				{
-					std::vector<FieldArea> candidates;
-					std::set<FieldArea>::const_iterator next_ai = ai;
-					++next_ai;
-					for (; next_ai != ae; ++next_ai)
-					{
-						if (next_ai->type == FieldArea::ContentType
-						&&  next_ai->positionRange.first >= ai->positionRange.second
-						&&  next_ai->matches( *ai))
-						{
-							SearchIndexStructure::PositionRange
-								posrange( ai->positionRange.first, next_ai->positionRange.first);
-							FieldArea area( FieldArea::ContentType, ai->id, posrange);
-							addStructureFieldCandidate( candidates, area);
-							break;//... only the next candidate matches
-						}
-					}
-					if (candidates.empty())
-					{
-						//... no end marker found, set end position to end of document
-						SearchIndexStructure::PositionRange
-							posrange( ai->positionRange.first, analyzer::Position::endOfDocument());
-						FieldArea area( FieldArea::ContentType, ai->id, posrange);
-						addStructureFieldCandidate( candidates, area);
-					}
-					flushStructureFieldCandidates( m_structures, configIdx, *ai, candidates);
-				}
-			}
-			break;
-		}
-		case DocumentAnalyzerInstanceInterface::StructureAssociative:
-		{
-			std::set<FieldArea>::const_iterator ai = areaset.begin(), ae = areaset.end();
-			for (; ai != ae; ++ai)
-			{
-				if (ai->type == FieldArea::HeaderType)
-				{
-					std::vector<FieldArea> candidates;
-					std::set<FieldArea>::const_iterator next_ai = areaset.begin();
-					for (; next_ai != ae; ++next_ai)
-					{
-						if (next_ai->type == FieldArea::ContentType
-						&&  !ai->isequal( *next_ai)
-						&&  next_ai->matches( *ai))
-						{
-							addStructureFieldCandidate( candidates, *next_ai);
-						}
-					}
-					flushStructureFieldCandidates( m_structures, configIdx, *ai, candidates);
-				}
-			}
-			break;
-		}
+	// Collect the statistics of the normalizer caches:
+	if (!m_normalizerCacheMap.empty())
+	{
+		m_analyzer->normalizerCacheStatistics().collect( m_normalizerCacheMap);
 	}
+
+	// Reset current document processing state:
+	m_segmentProcessor.clearTermMaps();
+	m_activeFields.clear();
+	m_fieldIdMap.clear();
+	m_structures.clear();
+}
+
+void DocumentAnalyzerContext::buildStructures( const std::vector<SearchIndexField>& fields, int configIdx)
+{
+	const SeachIndexStructureConfig& structConfig
+		= m_analyzer->structureConfigList()[ configIdx];
+	m_structureBuilder.build( m_structures, configIdx, structConfig.structureType(), m_analyzer->fieldConfigList(), fields);
 }
 
 void DocumentAnalyzerContext::collectIndexFields( int scopeIdx)
@@ -624,7 +595,7 @@ void DocumentAnalyzerContext::handleStructureEvent( int evhnd, const char* segsr
 			std::size_t aidx = m_activeFields.size();
 			for (; aidx && (m_activeFields[aidx-1].configIdx() != configIdx || m_activeFields[aidx-1].end().defined()); --aidx){}
 			if (!aidx) throw std::runtime_error(_TXT("logic error: field id event without start detected"));
-			m_activeFields[aidx-1].setId( strus::string_conv::trim( segsrc, segsize));
+			m_activeFields[aidx-1].setId( strus::string_conv::trim( segsrc, segsize), m_fieldIdMap);
 			break;
 		}
 		case FieldEvent_Start:
@@ -652,128 +623,171 @@ bool DocumentAnalyzerContext::analyzeNext( analyzer::Document& doc)
 	try
 	{
 		doc.clear();
-		const char* segsrc = 0;
-		std::size_t segsrcsize = 0;
-		int featidx = 0;
+		if (m_linesAnalyzer)
+		{
+			return m_linesAnalyzer->analyzeNext( doc);
+		}
+		if (m_partsAnalyzer)
+		{
+			return m_partsAnalyzer->analyzeNext( doc);
+		}
+		DocumentBuilderSink sink( &doc);
+		return analyzeNextDocument( sink, &doc);
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error in DocumentAnalyzerContext::analyzeNext: %s"), *m_errorhnd, false);
+}
 
-		DEBUG_OPEN( "analyze");
-		for (;;)
+bool DocumentAnalyzerContext::analyzeNext( DocumentSinkInterface& sink)
+{
+	try
+	{
+		if (m_linesAnalyzer || m_partsAnalyzer)
 		{
-			// [1] Scan the document and push the normalized tokenization of the elements to the result:
-			while (m_segmenter->getNext( featidx, m_curr_position, segsrc, segsrcsize))
+			analyzer::Document doc;
+			if (m_linesAnalyzer ? !m_linesAnalyzer->analyzeNext( doc) : !m_partsAnalyzer->analyzeNext( doc)) return false;
+			DocumentBuilderSink::feed( sink, doc);
+			return true;
+		}
+		return analyzeNextDocument( sink, 0);
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error in DocumentAnalyzerContext::analyzeNext: %s"), *m_errorhnd, false);
+}
+
+bool DocumentAnalyzerContext::analyzeNextDocument( DocumentSinkInterface& sink, analyzer::Document* doc)
+{
+	const char* segsrc = 0;
+	std::size_t segsrcsize = 0;
+	int featidx = 0;
+
+	DEBUG_OPEN( "analyze");
+	for (;;)
+	{
+		// [1] Scan the document and push the normalized tokenization of the elements to the result:
+		while (m_segmenter->getNext( featidx, m_curr_position, segsrc, segsrcsize))
+		{
+			m_curr_position += m_curr_position_ofs;
+			try
 			{
-				m_curr_position += m_curr_position_ofs;
-				try
+				DEBUG_EVENT2_CONTENT( "segment", "%d %d %s", (int)m_curr_position, (featidx), segsrc, segsrcsize);
+				if (featidx >= SubDocumentEnd)
 				{
-					DEBUG_EVENT2_CONTENT( "segment", "%d %d %s", (int)m_curr_position, (featidx), segsrc, segsrcsize);
-					if (featidx >= SubDocumentEnd)
+					if (featidx >= OfsSubContent)
 					{
-						if (featidx >= OfsSubContent)
+						const DocumentAnalyzerInstance::SubSegmenterDef* subsegmenterdef = m_analyzer->subsegmenter( featidx - OfsSubContent);
+						if (subsegmenterdef)
 						{
-							const DocumentAnalyzerInstance::SubSegmenterDef* subsegmenterdef = m_analyzer->subsegmenter( featidx - OfsSubContent);
-							if (subsegmenterdef)
+							DEBUG_EVENT2( "subcontent", "%s; charset=%s", subsegmenterdef->documentClass.mimeType().c_str(), subsegmenterdef->documentClass.encoding().c_str());
+							SegmenterContextInterface* ns = acquireSubSegmenter( featidx - OfsSubContent);
+							try
 							{
-								DEBUG_EVENT2( "subcontent", "%s; charset=%s", subsegmenterdef->documentClass.mimeType().c_str(), subsegmenterdef->documentClass.encoding().c_str());
-								SegmenterContextInterface* ns = subsegmenterdef->segmenterInstance->createContext( subsegmenterdef->documentClass);
-								if (!ns) throw std::runtime_error( _TXT("failed to create sub segmenter context"));
-								m_segmenterstack.push_back( SegmenterStackElement( m_start_position, m_curr_position_ofs, m_segmenter));
-								m_segmenter = ns;
-								m_curr_position_ofs = m_curr_position;
-								m_segmenter->putInput( segsrc, segsrcsize, true);
+								m_segmenterstack.push_back( SegmenterStackElement( m_start_position, m_curr_position_ofs, m_segmenter, featidx - OfsSubContent));
 							}
-						}
-						//... start or end of document marker
-						else if (featidx == SubDocumentEnd)
-						{
-							if (m_nof_segments == 0)
+							catch (const std::bad_alloc&)
 							{
-								DEBUG_CLOSE();
-								return false;
+								delete ns;
+								throw;
 							}
-							//... end of sub document -> out of loop and return document
-							m_nof_segments = 0;
-							completeDocumentProcessing( doc);
-							DEBUG_EVENT1( "subdocument-end", "%s", m_subdocTypeName.c_str());
-							m_subdocTypeName.clear();
+							m_segmenter = ns;
+							m_curr_position_ofs = m_curr_position;
+							// ... the segment stays valid until the sub segmenter is consumed, because the parent segmenter is not called before
+							m_segmenter->putInputReference( segsrc, segsrcsize, true);
+						}
+					}
+					//... start or end of document marker
+					else if (featidx == SubDocumentEnd)
+					{
+						if (m_nof_segments == 0)
+						{
 							DEBUG_CLOSE();
-							return true;
+							return false;
 						}
-						else
+						//... end of sub document -> out of loop and return document
+						m_nof_segments = 0;
+						completeDocumentProcessing( sink, doc);
+						DEBUG_EVENT1( "subdocument-end", "%s", m_subdocTypeName.c_str());
+						m_subdocTypeName.clear();
+						DEBUG_CLOSE();
+						return true;
+					}
+					else
+					{
+						if (m_nof_segments > 0)
 						{
-							if (m_nof_segments > 0)
-							{
-								throw std::runtime_error( _TXT("addressing segments outside of a sub document or overlapping sub documents found"));
-							}
-							// create new sub document:
-							m_subdocTypeName = m_analyzer->subdoctypes()[ featidx-OfsSubDocument];
-							m_start_position = m_curr_position;
-							DEBUG_EVENT1( "subdocument-start", "%s", m_subdocTypeName.c_str());
+							throw std::runtime_error( _TXT("addressing segments outside of a sub document or overlapping sub documents found"));
 						}
+						// create new sub document:
+						m_subdocTypeName = m_analyzer->subdoctypes()[ featidx-OfsSubDocument];
+						m_start_position = m_curr_position;
+						DEBUG_EVENT1( "subdocument-start", "%s", m_subdocTypeName.c_str());
 					}
-					else if (featidx >= OfsStructureElement)
+				}
+				else if (featidx >= OfsStructureElement)
+				{
+					int evhnd = featidx - OfsStructureElement;
+					handleStructureEvent( evhnd, segsrc, segsrcsize);
+				}
+				else
+				{
+					// Features:
+					++m_nof_segments;
+					const FeatureConfig& feat = m_analyzer->featureConfigMap().featureConfig( featidx);
+					if (feat.tokenizer()->concatBeforeTokenize())
 					{
-						int evhnd = featidx - OfsStructureElement;
-						handleStructureEvent( evhnd, segsrc, segsrcsize);
+						DEBUG_EVENT1( "concat-feat", "%s", feat.name().c_str());
+						// concat chunks that need to be concatenated before tokenization:
+						std::size_t rel_position = (std::size_t)(m_curr_position - m_start_position);
+						m_segmentProcessor.concatDocumentSegment(
+								featidx, rel_position, segsrc, segsrcsize);
 					}
 					else
 					{
-						// Features:
-						++m_nof_segments;
-						const FeatureConfig& feat = m_analyzer->featureConfigMap().featureConfig( featidx);
-						if (feat.tokenizer()->concatBeforeTokenize())
+						std::size_t rel_position = (std::size_t)(m_curr_position - m_start_position);
+						if (m_parallelProcessor && m_inputSize >= m_analyzer->parallelMinDocumentSize())
 						{
-							DEBUG_EVENT1( "concat-feat", "%s", feat.name().c_str());
-							// concat chunks that need to be concatenated before tokenization:
-							std::size_t rel_position = (std::size_t)(m_curr_position - m_start_position);
-							m_segmentProcessor.concatDocumentSegment(
-									featidx, rel_position, segsrc, segsrcsize);
+							// defer the tokenization and normalization of big documents to process them in parallel:
+							DEBUG_EVENT1( "defer-feat", "%s", feat.name().c_str());
+							m_parallelProcessor->push( featidx, rel_position, segsrc, segsrcsize, isReferencedInput( segsrc, segsrcsize));
 						}
 						else
 						{
 							DEBUG_EVENT1( "process-feat", "%s", feat.name().c_str());
-							std::size_t rel_position = (std::size_t)(m_curr_position - m_start_position);
 							m_segmentProcessor.processDocumentSegment(
 									featidx, rel_position, segsrc, segsrcsize);
 						}
 					}
 				}
-				catch (const std::runtime_error& err)
-				{
-					std::string chunk( segsrc, segsrcsize);
-					throw strus::runtime_error( _TXT( "error in analyze when processing chunk (%s): %s"), chunk.c_str(), err.what());
-				}
-			}
-			if (m_errorhnd->hasError())
-			{
-				break;
-			}
-			if (m_segmenterstack.empty())
-			{
-				break;
 			}
-			else
+			catch (const std::runtime_error& err)
 			{
-				delete m_segmenter;
-				m_segmenter = m_segmenterstack.back().segmenter;
-				m_curr_position_ofs = m_segmenterstack.back().curr_position_ofs;
-				m_start_position = m_segmenterstack.back().start_position;
-				m_segmenterstack.pop_back();
+				std::string chunk( segsrc, segsrcsize);
+				throw strus::runtime_error( _TXT( "error in analyze when processing chunk (%s): %s"), chunk.c_str(), err.what());
 			}
 		}
-		if (m_eof && m_nof_segments > 0)
+		if (m_errorhnd->hasError())
 		{
-			if (!m_subdocTypeName.empty())
-			{
-				throw strus::runtime_error( _TXT( "sub document '%s' not terminated"), m_subdocTypeName.c_str());
-			}
-			completeDocumentProcessing( doc);
-			m_nof_segments = 0;
-			DEBUG_CLOSE();
-			return true;
+			break;
 		}
+		if (m_segmenterstack.empty())
+		{
+			break;
+		}
+		else
+		{
+			popSegmenter();
+		}
+	}
+	if (m_eof && m_nof_segments > 0)
+	{
+		if (!m_subdocTypeName.empty())
+		{
+			throw strus::runtime_error( _TXT( "sub document '%s' not terminated"), m_subdocTypeName.c_str());
+		}
+		completeDocumentProcessing( sink, doc);
+		m_nof_segments = 0;
 		DEBUG_CLOSE();
-		return false;
+		return true;
 	}
-	CATCH_ERROR_MAP_RETURN( _TXT("error in DocumentAnalyzerContext::analyzeNext: %s"), *m_errorhnd, false);
+	DEBUG_CLOSE();
+	return false;
 }
 
@@ -9,8 +9,14 @@
 #define _STRUS_DOCUMENT_ANALYZER_CONTEXT_HPP_INCLUDED
 #include "documentAnalyzerInstance.hpp"
 #include "segmentProcessor.hpp"
+#include "parallelSegmentProcessor.hpp"
+#include "documentLinesAnalyzer.hpp"
+#include "documentPartsAnalyzer.hpp"
+#include "searchIndexStructureBuilder.hpp"
+#include "aggregationPlan.hpp"
 #include "strus/documentAnalyzerContextInterface.hpp"
 #include "strus/segmenterContextInterface.hpp"
+#include "private/mappedFile.hpp"
 
 namespace strus
 {
@@ -27,24 +33,60 @@ public:
 			const DocumentAnalyzerInstance* analyzer_,
 			const analyzer::DocumentClass& dclass,
 			ErrorBufferInterface* errorhnd);
+	/// \brief Constructor of a context analyzing a part of a content with a segmenter context fed with the part already
+	/// \param[in] segmenter_ segmenter context created with SegmenterInstanceInterface::createPartContext (with ownership)
+	DocumentAnalyzerContext(
+			const DocumentAnalyzerInstance* analyzer_,
+			SegmenterContextInterface* segmenter_,
+			ErrorBufferInterface* errorhnd);
 	virtual ~DocumentAnalyzerContext();
 
 	virtual void putInput(const char* chunk, std::size_t chunksize, bool eof);
 
+	virtual void putInputReference( const char* chunk, std::size_t chunksize, bool eof);
+
+	virtual void putInputMapped( const std::string& path);
+
+	virtual std::size_t bufferedInputSize() const;
+
 	virtual bool analyzeNext( analyzer::Document& doc);
 
+	virtual bool analyzeNext( DocumentSinkInterface& sink);
+
+	virtual bool reset( const analyzer::DocumentClass& dclass);
+
+	/// \brief Get the document analyzer this context belongs to
+	const DocumentAnalyzerInstance* analyzer() const		{return m_analyzer;}
+
+	/// \brief Disable the analysis of the parts of a big content in parallel until the next reset, for callers fetching only the first document
+	void disablePartsAnalysis()					{m_partsAnalysisEnabled = false;}
+
+	/// \brief Release the input fed, resetting the segmenters referencing it and closing the mapping of a file fed with putInputMapped
+	/// \note Called before the context is put back into a pool, so that a pooled context does not keep a file mapped
+	/// \return true on success, false if the context cannot be reused, the input is released by its destruction then
+	bool releaseInput();
+
 private:
-	void processAggregatedMetadata( analyzer::Document& res) const;
-	void completeDocumentProcessing( analyzer::Document& res);
+	SegmenterContextInterface* rootSegmenter() const;
+	bool isSplittableInput( std::size_t chunksize, bool eof) const;
+	bool putSplittableInput( const char* content, std::size_t contentsize, bool copy);
+	bool isReferencedInput( const char* segment, std::size_t segmentsize) const;
+	SegmenterContextInterface* acquireSubSegmenter( int subsegmenterIdx);
+	void releaseSubSegmenter( int subsegmenterIdx, SegmenterContextInterface* segmenter);
+	void popSegmenter();
+	bool analyzeNextDocument( DocumentSinkInterface& sink, analyzer::Document* doc);
+	void processAggregatedMetadata( analyzer::Document& res);
+	void completeDocumentProcessing( DocumentSinkInterface& sink, analyzer::Document* doc);
 
 	struct SegmenterStackElement
 	{
 		SegmenterPosition start_position;
 		SegmenterPosition curr_position_ofs;
 		SegmenterContextInterface* segmenter;
+		int subsegmenterIdx;	///< index of the sub segmenter definition of the segmenter processing the sub content on top of this
 
-		SegmenterStackElement( SegmenterPosition start_position_, SegmenterPosition curr_position_ofs_, SegmenterContextInterface* segmenter_)
-			:start_position(start_position_),curr_position_ofs(curr_position_ofs_),segmenter(segmenter_){}
+		SegmenterStackElement( SegmenterPosition start_position_, SegmenterPosition curr_position_ofs_, SegmenterContextInterface* segmenter_, int subsegmenterIdx_)
+			:start_position(start_position_),curr_position_ofs(curr_position_ofs_),segmenter(segmenter_),subsegmenterIdx(subsegmenterIdx_){}
 #if __cplusplus >= 201103L
 		SegmenterStackElement( SegmenterStackElement&& ) = default;
 		SegmenterStackElement( const SegmenterStackElement& ) = default;
@@ -52,7 +94,7 @@ private:
 		SegmenterStackElement& operator= ( const SegmenterStackElement& ) = default;
 #else
 		SegmenterStackElement( const SegmenterStackElement& o)
-			:start_position(o.start_position),curr_position_ofs(o.curr_position_ofs),segmenter(o.segmenter){}
+			:start_position(o.start_position),curr_position_ofs(o.curr_position_ofs),segmenter(o.segmenter),subsegmenterIdx(o.subsegmenterIdx){}
 #endif
 	};
 	void collectActiveFields();
@@ -61,18 +103,33 @@ private:
 	void handleStructureEvent( int evhnd, const char* segsrc, std::size_t segsize);
 
 private:
+	NormalizerCacheMap m_normalizerCacheMap;
 	SegmentProcessor m_segmentProcessor;
+	ParallelSegmentProcessor* m_parallelProcessor;
+	DocumentLinesAnalyzer* m_linesAnalyzer;		///< analyzer of the lines of a list with one document per line, NULL for other documents
+	DocumentPartsAnalyzer* m_partsAnalyzer;		///< analyzer of the parts of a content split by the segmenter, NULL if the content is not analyzed in parts
+	analyzer::DocumentClass m_documentClass;
+	std::string m_content;				///< copy of a content fed with putInput and split into parts
+	bool m_partsAnalysisEnabled;			///< true if a big content may be split into parts analyzed in parallel
 	const DocumentAnalyzerInstance* m_analyzer;
+	AggregationPlan m_aggregationPlan;
 	SegmenterContextInterface* m_segmenter;
 	std::vector<SegmenterStackElement> m_segmenterstack;
+	std::vector<SegmenterContextInterface*> m_subsegmenterCache;	///< segmenter contexts for sub contents kept for reuse, indexed by sub segmenter definition
 	bool m_eof;
 	SegmenterPosition m_curr_position_ofs;
 	SegmenterPosition m_curr_position;
 	SegmenterPosition m_start_position;
 	unsigned int m_nof_segments;
+	std::size_t m_inputSize;
+	const char* m_inputRef;				///< complete input referenced by the segmenter, segments pointing into it are not copied for parallel processing
+	std::size_t m_inputRefSize;			///< size of m_inputRef in bytes
+	utils::MappedFile m_mappedInput;
 	std::string m_subdocTypeName;
 	std::vector<SearchIndexField> m_activeFields;
+	SearchIndexFieldIdMap m_fieldIdMap;
 	std::vector<SearchIndexStructure> m_structures;
+	SearchIndexStructureBuilder m_structureBuilder;
 	ErrorBufferInterface* m_errorhnd;
 	DebugTraceContextInterface* m_debugtrace;
 };
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Pool of document analyzer contexts reused for analyzing many small documents
+/// \file documentAnalyzerContextPool.cpp
+#include "documentAnalyzerContextPool.hpp"
+#include "documentAnalyzerContext.hpp"
+#include "strus/errorBufferInterface.hpp"
+#include "private/internationalization.hpp"
+#include "private/errorUtils.hpp"
+
+using namespace strus;
+
+DocumentAnalyzerContextPool::~DocumentAnalyzerContextPool()
+{
+	clear();
+}
+
+DocumentAnalyzerContext* DocumentAnalyzerContextPool::acquire( const DocumentAnalyzerInstance* analyzer, const analyzer::DocumentClass& dclass, ErrorBufferInterface* errorhnd)
+{
+	DocumentAnalyzerContext* rt = 0;
+	{
+		strus::scoped_lock lock( m_mutex);
+		if (!m_contexts.empty())
+		{
+			rt = m_contexts.back();
+			m_contexts.pop_back();
+		}
+	}
+	if (rt)
+	{
+		if (!rt->reset( dclass))
+		{
+			delete rt;
+			return 0;
+		}
+		return rt;
+	}
+	try
+	{
+		return new DocumentAnalyzerContext( analyzer, dclass, errorhnd);
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error creating document analyzer context: %s"), *errorhnd, 0);
+}
+
+void DocumentAnalyzerContextPool::release( DocumentAnalyzerContext* context)
+{
+	{
+		strus::scoped_lock lock( m_mutex);
+		if (m_contexts.size() < m_maxSize)
+		{
+			try
+			{
+				m_contexts.push_back( context);
+				return;
+			}
+			catch (const std::bad_alloc&)
+			{
+				//... the context is deleted
+			}
+		}
+	}
+	delete context;
+}
+
+void DocumentAnalyzerContextPool::setMaxSize( std::size_t maxSize_)
+{
+	std::vector<DocumentAnalyzerContext*> deleted;
+	{
+		strus::scoped_lock lock( m_mutex);
+		m_maxSize = maxSize_;
+		while (m_contexts.size() > m_maxSize)
+		{
+			deleted.push_back( m_contexts.back());
+			m_contexts.pop_back();
+		}
+	}
+	std::vector<DocumentAnalyzerContext*>::const_iterator ci = deleted.begin(), ce = deleted.end();
+	for (; ci != ce; ++ci) delete *ci;
+}
+
+void DocumentAnalyzerContextPool::clear()
+{
+	std::vector<DocumentAnalyzerContext*> deleted;
+	{
+		strus::scoped_lock lock( m_mutex);
+		deleted.swap( m_contexts);
+	}
+	std::vector<DocumentAnalyzerContext*>::const_iterator ci = deleted.begin(), ce = deleted.end();
+	for (; ci != ce; ++ci) delete *ci;
+}
+
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Pool of document analyzer contexts reused for analyzing many small documents
+/// \file documentAnalyzerContextPool.hpp
+#ifndef _STRUS_DOCUMENT_ANALYZER_CONTEXT_POOL_HPP_INCLUDED
+#define _STRUS_DOCUMENT_ANALYZER_CONTEXT_POOL_HPP_INCLUDED
+#include "strus/analyzer/documentClass.hpp"
+#include "strus/base/thread.hpp"
+#include <vector>
+#include <cstddef>
+
+namespace strus
+{
+/// \brief Forward declaration
+class ErrorBufferInterface;
+/// \brief Forward declaration
+class DocumentAnalyzerInstance;
+/// \brief Forward declaration
+class DocumentAnalyzerContext;
+
+/// \brief Thread safe pool of document analyzer contexts
+/// \note Contexts released are kept up to a maximum number and reset for the next document acquired,
+///	so that the segmenter contexts, the debug trace context and the buffers of a context are not created again for every document.
+class DocumentAnalyzerContextPool
+{
+public:
+	/// \param[in] maxSize_ maximum number of contexts kept in the pool
+	explicit DocumentAnalyzerContextPool( std::size_t maxSize_)
+		:m_mutex(),m_contexts(),m_maxSize(maxSize_){}
+	~DocumentAnalyzerContextPool();
+
+	/// \brief Get a context from the pool reset for a new document or create a new one, if the pool is empty
+	/// \param[in] analyzer the document analyzer the context belongs to
+	/// \param[in] dclass description of the content type and encoding of the document
+	/// \param[in] errorhnd error buffer interface for the context created
+	/// \return the context (with ownership till it is released) or NULL in case of an error reported to the error buffer
+	DocumentAnalyzerContext* acquire( const DocumentAnalyzerInstance* analyzer, const analyzer::DocumentClass& dclass, ErrorBufferInterface* errorhnd);
+
+	/// \brief Put a context back into the pool or delete it, if the pool is full
+	/// \param[in] context the context acquired before (with ownership)
+	void release( DocumentAnalyzerContext* context);
+
+	/// \brief Set the maximum number of contexts kept in the pool, deleting the contexts exceeding it
+	void setMaxSize( std::size_t maxSize_);
+
+	/// \brief Delete all contexts kept in the pool
+	void clear();
+
+private:
+	DocumentAnalyzerContextPool( const DocumentAnalyzerContextPool&){}	//... non copyable
+	void operator=( const DocumentAnalyzerContextPool&){}			//... non copyable
+
+private:
+	strus::mutex m_mutex;					///< mutex for the access of the pool
+	std::vector<DocumentAnalyzerContext*> m_contexts;	///< contexts ready for reuse
+	std::size_t m_maxSize;					///< maximum number of contexts kept
+};
+
+}//namespace
+#endif
+
@@ -7,6 +7,7 @@
  */
 #include "documentAnalyzerInstance.hpp"
 #include "documentAnalyzerContext.hpp"
+#include "documentAnalyzerBatch.hpp"
 #include "strus/normalizerFunctionInstanceInterface.hpp"
 #include "strus/tokenizerFunctionInstanceInterface.hpp"
 #include "strus/segmenterInstanceInterface.hpp"
@@ -30,6 +31,8 @@
 
 using namespace strus;
 
+#define DEFAULT_CONTEXT_POOL_SIZE 16
+
 DocumentAnalyzerInstance::DocumentAnalyzerInstance( const TextProcessorInterface* textproc_, const SegmenterInterface* segmenter_, const analyzer::SegmenterOptions& opts, ErrorBufferInterface* errorhnd)
 	:m_textproc(textproc_)
 	,m_segmenter(segmenter_->createInstance( opts))
@@ -43,6 +46,10 @@ DocumentAnalyzerInstance::DocumentAnalyzerInstance( const TextProcessorInterface
 	,m_statistics()
 	,m_forwardIndexTermTypeSet()
 	,m_searchIndexTermTypeSet()
+	,m_parallelMinDocumentSize(0)
+	,m_parallelNofThreads(0)
+	,m_normalizerCacheStatistics()
+	,m_contextPool(DEFAULT_CONTEXT_POOL_SIZE)
 	,m_errorhnd(errorhnd)
 {
 	if (!m_segmenter)
@@ -53,6 +60,7 @@ DocumentAnalyzerInstance::DocumentAnalyzerInstance( const TextProcessorInterface
 
 DocumentAnalyzerInstance::~DocumentAnalyzerInstance()
 {
+	m_contextPool.clear();
 	delete m_segmenter;
 	std::vector<SubSegmenterDef>::iterator si = m_subsegmenterList.begin(), se = m_subsegmenterList.end();
 	for (; si != se; ++si)
@@ -82,6 +90,8 @@ static int getSubSegmenterIndex( const std::vector<DocumentAnalyzerInstance::Sub
 
 void DocumentAnalyzerInstance::defineSelectorExpression( unsigned int featidx, const std::string& selectexpr)
 {
+	// ... the contexts pooled were created for the configuration before
+	m_contextPool.clear();
 	int sidx = getSubSegmenterIndex( m_subsegmenterList, selectexpr);
 	if (sidx >= 0)
 	{
@@ -95,6 +105,7 @@ void DocumentAnalyzerInstance::defineSelectorExpression( unsigned int featidx, c
 
 void DocumentAnalyzerInstance::defineSubSection( int startId, int endId, const std::string& selectexpr)
 {
+	m_contextPool.clear();
 	int sidx = getSubSegmenterIndex( m_subsegmenterList, selectexpr);
 	if (sidx >= 0)
 	{
@@ -114,6 +125,7 @@ void DocumentAnalyzerInstance::addSearchIndexFeature(
 		int priority,
 		const analyzer::FeatureOptions& options)
 {
+	m_contextPool.clear();
 	try
 	{
 		unsigned int featidx = m_featureConfigMap.defineFeature( FeatSearchIndexTerm, type, selectexpr, tokenizer, normalizers, priority, options);
@@ -131,6 +143,7 @@ void DocumentAnalyzerInstance::addForwardIndexFeature(
 		int priority,
 		const analyzer::FeatureOptions& options)
 {
+	m_contextPool.clear();
 	try
 	{
 		unsigned int featidx = m_featureConfigMap.defineFeature( FeatForwardIndexTerm, type, selectexpr, tokenizer, normalizers, priority, options);
@@ -146,6 +159,7 @@ void DocumentAnalyzerInstance::addSearchIndexField(
 		const std::string& selectexpr,
 		const std::string& keyexpr)
 {
+	m_contextPool.clear();
 	try
 	{
 		if (MaxFieldEventIdx <= m_fieldConfigList.size())
@@ -216,6 +230,7 @@ void DocumentAnalyzerInstance::addSearchIndexStructure(
 		const std::string& contentFieldName,
 		const StructureType& structureType)
 {
+	m_contextPool.clear();
 	try
 	{
 		int sidx = m_structureConfigList.size();
@@ -242,6 +257,7 @@ void DocumentAnalyzerInstance::defineMetaData(
 		TokenizerFunctionInstanceInterface* tokenizer,
 		const std::vector<NormalizerFunctionInstanceInterface*>& normalizers)
 {
+	m_contextPool.clear();
 	try
 	{
 		unsigned int featidx = m_featureConfigMap.defineFeature( FeatMetaData, metaname, selectexpr, tokenizer, normalizers, 0/*priority*/, analyzer::FeatureOptions());
@@ -256,6 +272,7 @@ void DocumentAnalyzerInstance::defineAttribute(
 		TokenizerFunctionInstanceInterface* tokenizer,
 		const std::vector<NormalizerFunctionInstanceInterface*>& normalizers)
 {
+	m_contextPool.clear();
 	try
 	{
 		unsigned int featidx = m_featureConfigMap.defineFeature( FeatAttribute, attribname, selectexpr, tokenizer, normalizers, 0/*priority*/, analyzer::FeatureOptions());
@@ -268,6 +285,7 @@ void DocumentAnalyzerInstance::defineAggregatedMetaData(
 		const std::string& metaname,
 		AggregatorFunctionInstanceInterface* statfunc)
 {
+	m_contextPool.clear();
 	try
 	{
 		m_statistics.push_back( StatisticsConfig( metaname, statfunc));
@@ -283,6 +301,7 @@ void DocumentAnalyzerInstance::defineSubDocument(
 		const std::string& subDocumentTypeName,
 		const std::string& selectexpr)
 {
+	m_contextPool.clear();
 	try
 	{
 		int subDocumentType = m_subdoctypear.size();
@@ -301,6 +320,7 @@ void DocumentAnalyzerInstance::defineSubContent(
 		const std::string& selectexpr,
 		const analyzer::DocumentClass& documentClass)
 {
+	m_contextPool.clear();
 	try
 	{
 		defineSelectorExpression( m_subsegmenterList.size()+OfsSubContent, selectexpr);
@@ -322,6 +342,21 @@ void DocumentAnalyzerInstance::defineSubContent(
 	CATCH_ERROR_MAP( _TXT("error in DocumentAnalyzerInstance::defineSubContentSegmenter: %s"), *m_errorhnd);
 }
 
+void DocumentAnalyzerInstance::defineParallelProcessing(
+		std::size_t minDocumentSize,
+		unsigned int nofThreads)
+{
+	m_contextPool.clear();
+	m_parallelMinDocumentSize = minDocumentSize;
+	m_parallelNofThreads = nofThreads;
+}
+
+void DocumentAnalyzerInstance::defineContextPool(
+		std::size_t maxNofContexts)
+{
+	m_contextPool.setMaxSize( maxNofContexts);
+}
+
 analyzer::Document DocumentAnalyzerInstance::analyze(
 		const std::string& content,
 		const analyzer::DocumentClass& dclass) const
@@ -329,18 +364,72 @@ analyzer::Document DocumentAnalyzerInstance::analyze(
 	try
 	{
 		analyzer::Document rt;
-		strus::local_ptr<DocumentAnalyzerContext>
-			analyzerInstance( new DocumentAnalyzerContext( this, dclass, m_errorhnd));
+		DocumentAnalyzerContext* context = m_contextPool.acquire( this, dclass, m_errorhnd);
+		if (!context) throw std::runtime_error( _TXT("failed to create document analyzer context"));
+		strus::local_ptr<DocumentAnalyzerContext> analyzerInstance( context);
+		// ... only the first document is fetched, splitting the content to analyze its parts in parallel is not worth it
+		analyzerInstance->disablePartsAnalysis();
 		analyzerInstance->putInput( content.c_str(), content.size(), true);
 		if (!analyzerInstance->analyzeNext( rt))
 		{
 			throw std::runtime_error( _TXT("analyzed content incomplete or empty"));
 		}
+		m_contextPool.release( analyzerInstance.release());
 		return rt;
 	}
 	CATCH_ERROR_MAP_RETURN( _TXT("error in document analyze: %s"), *m_errorhnd, analyzer::Document());
 }
 
+analyzer::Document DocumentAnalyzerInstance::analyzeFile(
+		const std::string& path,
+		const analyzer::DocumentClass& dclass) const
+{
+	try
+	{
+		analyzer::Document rt;
+		DocumentAnalyzerContext* context = m_contextPool.acquire( this, dclass, m_errorhnd);
+		if (!context) throw std::runtime_error( _TXT("failed to create document analyzer context"));
+		strus::local_ptr<DocumentAnalyzerContext> analyzerInstance( context);
+		analyzerInstance->disablePartsAnalysis();
+		analyzerInstance->putInputMapped( path);
+		bool fed = !m_errorhnd->hasError();
+		bool analyzed = fed && analyzerInstance->analyzeNext( rt);
+		// ... the mapping of the file is released before the context is put back into the pool, on failure as on success
+		if (analyzerInstance->releaseInput())
+		{
+			m_contextPool.release( analyzerInstance.release());
+		}
+		else if (fed && analyzed)
+		{
+			throw std::runtime_error( _TXT("failed to release the input of the document analyzer context"));
+		}
+		if (!fed)
+		{
+			throw std::runtime_error( _TXT("failed to feed the content of the file to analyze"));
+		}
+		if (!analyzed)
+		{
+			throw std::runtime_error( _TXT("analyzed content incomplete or empty"));
+		}
+		return rt;
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error in document analyze file: %s"), *m_errorhnd, analyzer::Document());
+}
+
+bool DocumentAnalyzerInstance::analyzeBatch(
+		const std::vector<Input>& inputs,
+		unsigned int nofThreads,
+		Callback& callback) const
+{
+	try
+	{
+		DocumentAnalyzerBatch batch( this, inputs, nofThreads, m_errorhnd);
+		batch.run( callback);
+		return true;
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error in document analyze batch: %s"), *m_errorhnd, false);
+}
+
 DocumentAnalyzerContextInterface* DocumentAnalyzerInstance::createContext( const analyzer::DocumentClass& dclass) const
 {
 	try
@@ -350,6 +439,24 @@ DocumentAnalyzerContextInterface* DocumentAnalyzerInstance::createContext( const
 	CATCH_ERROR_MAP_RETURN( _TXT("error in document analyzer create context: %s"), *m_errorhnd, 0);
 }
 
+DocumentAnalyzerContextInterface* DocumentAnalyzerInstance::acquireContext( const analyzer::DocumentClass& dclass) const
+{
+	return m_contextPool.acquire( this, dclass, m_errorhnd);
+}
+
+void DocumentAnalyzerInstance::releaseContext( DocumentAnalyzerContextInterface* context) const
+{
+	DocumentAnalyzerContext* ctx = dynamic_cast<DocumentAnalyzerContext*>( context);
+	if (ctx && ctx->analyzer() == this)
+	{
+		m_contextPool.release( ctx);
+	}
+	else
+	{
+		delete context;
+	}
+}
+
 static StructView getFeatureView( const FeatureConfig& cfg)
 {
 	typedef Reference<NormalizerFunctionInstanceInterface> NormalizerReference;
@@ -427,12 +534,22 @@ StructView DocumentAnalyzerInstance::view() const
 		{
 			subDocumentListView( di->first, di->second);
 		}
-		return analyzer::DocumentAnalyzerView(
+		analyzer::DocumentAnalyzerView rt(
 			segmenterView, subcontents, subDocumentListView,
 			attributes, metadata,
 			searchindex, forwardindex,
 			searchfields, searchstructures,
 			aggregators, lexems);
+		if (m_featureConfigMap.nofSharedTokenizers())
+		{
+			// ... number of features reusing the tokenization of a feature with the same selector and tokenizer
+			rt( "sharedtokenizer", m_featureConfigMap.nofSharedTokenizers());
+		}
+		if (m_featureConfigMap.hasNormalizerCache())
+		{
+			rt( "normalizercache", m_normalizerCacheStatistics.view());
+		}
+		return rt;
 	}
 	CATCH_ERROR_MAP_RETURN( _TXT("error in document analyzer introspection: %s"), *m_errorhnd, StructView());
 }
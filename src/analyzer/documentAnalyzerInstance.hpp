@@ -18,6 +18,8 @@
 #include "private/documentAnalyzerView.hpp"
 #include "featureConfigMap.hpp"
 #include "searchIndexStructure.hpp"
+#include "normalizerCache.hpp"
+#include "documentAnalyzerContextPool.hpp"
 #include <vector>
 #include <string>
 #include <map>
@@ -101,13 +103,35 @@ public:
 			const std::string& selectexpr,
 			const analyzer::DocumentClass& documentClass);
 
+	virtual void defineParallelProcessing(
+			std::size_t minDocumentSize,
+			unsigned int nofThreads);
+
+	virtual void defineContextPool(
+			std::size_t maxNofContexts);
+
 	virtual analyzer::Document analyze(
 			const std::string& content,
 			const analyzer::DocumentClass& dclass) const;
 
+	virtual analyzer::Document analyzeFile(
+			const std::string& path,
+			const analyzer::DocumentClass& dclass) const;
+
+	virtual bool analyzeBatch(
+			const std::vector<Input>& inputs,
+			unsigned int nofThreads,
+			Callback& callback) const;
+
 	virtual DocumentAnalyzerContextInterface* createContext(
 			const analyzer::DocumentClass& dclass) const;
 
+	virtual DocumentAnalyzerContextInterface* acquireContext(
+			const analyzer::DocumentClass& dclass) const;
+
+	virtual void releaseContext(
+			DocumentAnalyzerContextInterface* context) const;
+
 	/// \brief Return a structure with all definitions for introspection
 	/// \return the structure with all definitions for introspection
 	virtual StructView view() const;
@@ -159,6 +183,9 @@ public:/*DocumentAnalyzerContext*/
 	const std::vector<std::string>& subdoctypes() const				{return m_subdoctypear;}
 	const std::vector<StatisticsConfig>& statisticsConfigs() const			{return m_statistics;}
 	const std::vector<SubSegmenterDef>& subsegmenterList() const			{return m_subsegmenterList;}
+	std::size_t parallelMinDocumentSize() const					{return m_parallelMinDocumentSize;}
+	unsigned int parallelNofThreads() const						{return m_parallelNofThreads;}
+	NormalizerCacheStatistics& normalizerCacheStatistics() const			{return m_normalizerCacheStatistics;}
 
 private:
 	void defineSelectorExpression( unsigned int featdidx, const std::string& selectexpr);
@@ -178,6 +205,10 @@ private:
 	std::vector<StatisticsConfig> m_statistics;
 	TermTypeSet m_forwardIndexTermTypeSet;
 	TermTypeSet m_searchIndexTermTypeSet;
+	std::size_t m_parallelMinDocumentSize;
+	unsigned int m_parallelNofThreads;
+	mutable NormalizerCacheStatistics m_normalizerCacheStatistics;
+	mutable DocumentAnalyzerContextPool m_contextPool;
 	ErrorBufferInterface* m_errorhnd;
 };
 
@@ -14,8 +14,11 @@
 #include "strus/textProcessorInterface.hpp"
 #include "strus/analyzerObjectBuilderInterface.hpp"
 #include "private/documentAnalyzerMapView.hpp"
+#include "private/documentLines.hpp"
 #include "private/internationalization.hpp"
 #include "private/errorUtils.hpp"
+#include "strus/base/stdint.h"
+#include <cstring>
 
 using namespace strus;
 
@@ -28,6 +31,17 @@ static std::string getMimeSchemaKey( const std::string& mimeType, const std::str
 	return rt;
 }
 
+/// \brief FNV-1a hash of a (mime type, schema) pair without building a key string
+static std::size_t getMimeSchemaHash( const std::string& mimeType, const std::string& schema)
+{
+	uint32_t hash = 2166136261U;
+	std::string::const_iterator si = mimeType.begin(), se = mimeType.end();
+	for (; si != se; ++si) hash = (hash ^ (unsigned char)*si) * 16777619U;
+	hash = (hash ^ (unsigned char)';') * 16777619U;
+	for (si = schema.begin(), se = schema.end(); si != se; ++si) hash = (hash ^ (unsigned char)*si) * 16777619U;
+	return hash;
+}
+
 static std::pair<std::string,std::string> getMimeSchemaKeyParts( const std::string& key)
 {
 	char const* ki = std::strchr( key.c_str(), ';');
@@ -69,33 +83,90 @@ void DocumentAnalyzerMap::addAnalyzer(
 		{
 			m_schemaAnalyzerMap[ getMimeSchemaKey( mimeType_, schema_)] = analyzer.get();
 		}
+		rebuildDispatchTable();
 	}
 	CATCH_ERROR_MAP( _TXT("error adding analyzer to map: %s"), *m_errorhnd);
 }
 
+void DocumentAnalyzerMap::rebuildDispatchTable()
+{
+	// ... table size is a power of two with a load factor of at most 1/2
+	std::size_t nofElements = m_mimeTypeAnalyzerMap.size() + m_schemaAnalyzerMap.size();
+	std::size_t tableSize = 8;
+	while (tableSize < nofElements * 2) tableSize *= 2;
+	m_dispatchTable.assign( tableSize, DispatchSlot());
+
+	Map::const_iterator mi = m_mimeTypeAnalyzerMap.begin(), me = m_mimeTypeAnalyzerMap.end();
+	for (; mi != me; ++mi)
+	{
+		insertDispatchTable( mi->first, std::string(), mi->second);
+	}
+	mi = m_schemaAnalyzerMap.begin(), me = m_schemaAnalyzerMap.end();
+	for (; mi != me; ++mi)
+	{
+		std::pair<std::string,std::string> kp = getMimeSchemaKeyParts( mi->first);
+		insertDispatchTable( kp.first, kp.second, mi->second);
+	}
+}
+
+void DocumentAnalyzerMap::insertDispatchTable( const std::string& mimeType, const std::string& schema, const DocumentAnalyzerInstanceInterface* analyzer_)
+{
+	std::size_t mask = m_dispatchTable.size() - 1;
+	std::size_t idx = getMimeSchemaHash( mimeType, schema) & mask;
+	while (m_dispatchTable[ idx].analyzer)
+	{
+		idx = (idx + 1) & mask;
+	}
+	DispatchSlot& slot = m_dispatchTable[ idx];
+	slot.mimeType = mimeType;
+	slot.schema = schema;
+	slot.analyzer = analyzer_;
+}
+
+const DocumentAnalyzerInstanceInterface* DocumentAnalyzerMap::findDispatchTable( const std::string& mimeType, const std::string& schema) const
+{
+	if (m_dispatchTable.empty()) return NULL;
+	std::size_t mask = m_dispatchTable.size() - 1;
+	std::size_t idx = getMimeSchemaHash( mimeType, schema) & mask;
+	for (; m_dispatchTable[ idx].analyzer; idx = (idx + 1) & mask)
+	{
+		const DispatchSlot& slot = m_dispatchTable[ idx];
+		if (slot.mimeType == mimeType && slot.schema == schema)
+		{
+			return slot.analyzer;
+		}
+	}
+	return NULL;
+}
+
 const DocumentAnalyzerInstanceInterface* DocumentAnalyzerMap::getAnalyzer( const std::string& mimeType, const std::string& schema) const
 {
 	try
 	{
-		Map::const_iterator ai;
-		if (schema.empty())
+		const DocumentAnalyzerInstanceInterface* rt = findDispatchTable( mimeType, schema);
+		if (!rt && !schema.empty())
 		{
-			ai = m_mimeTypeAnalyzerMap.find( mimeType);
+			rt = findDispatchTable( mimeType, std::string());
 		}
-		else
+		if (!rt)
 		{
-			ai = m_schemaAnalyzerMap.find( getMimeSchemaKey( mimeType, schema));
-			if (ai == m_schemaAnalyzerMap.end())
+			// ... a list with one document per line is analyzed line by line with the analyzer of its documents
+			const char* lineMimeType = utils::documentLineMimeType( mimeType);
+			if (lineMimeType)
 			{
-				ai = m_mimeTypeAnalyzerMap.find( mimeType);
+				rt = findDispatchTable( lineMimeType, schema);
+				if (!rt && !schema.empty())
+				{
+					rt = findDispatchTable( lineMimeType, std::string());
+				}
 			}
 		}
-		if (ai == m_mimeTypeAnalyzerMap.end())
+		if (!rt)
 		{
 			throw strus::runtime_error(_TXT("no analyzer defined for this document class: mime-type=\"%s\", schema=\"%s\""),
 							mimeType.c_str(), schema.c_str());
 		}
-		return ai->second;
+		return rt;
 	}
 	CATCH_ERROR_MAP_RETURN( _TXT("error getting the analyzer for a document class: %s"), *m_errorhnd, NULL);
 }
@@ -113,6 +184,45 @@ analyzer::Document DocumentAnalyzerMap::analyze(
 	CATCH_ERROR_MAP_RETURN( _TXT("error analyzing document: %s"), *m_errorhnd, analyzer::Document());
 }
 
+analyzer::Document DocumentAnalyzerMap::analyzeFile(
+			const std::string& path,
+			const analyzer::DocumentClass& dclass) const
+{
+	try
+	{
+		const DocumentAnalyzerInstanceInterface* analyzer = getAnalyzer( dclass.mimeType(), dclass.schema());
+		if (!analyzer) return analyzer::Document();
+		return analyzer->analyzeFile( path, dclass);
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error analyzing document file: %s"), *m_errorhnd, analyzer::Document());
+}
+
+analyzer::Document DocumentAnalyzerMap::analyzeAuto(
+			const std::string& content) const
+{
+	enum {MaxDetectSize=4096};
+	try
+	{
+		const TextProcessorInterface* textproc = m_objbuilder->getTextProcessor();
+		if (!textproc) throw std::runtime_error( m_errorhnd->fetchError());
+
+		// Detect the document class from the start of the content only, the class detected is passed to the analysis.
+		// The detectors do not hand over their segmenter state, so the analysis reads the prefix used for detection again:
+		analyzer::DocumentClass dclass;
+		bool isComplete = content.size() <= (std::size_t)MaxDetectSize;
+		std::size_t detectSize = isComplete ? content.size() : (std::size_t)MaxDetectSize;
+		if (!textproc->detectDocumentClass( dclass, content.c_str(), detectSize, isComplete))
+		{
+			if (m_errorhnd->hasError()) throw std::runtime_error( m_errorhnd->fetchError());
+			throw std::runtime_error( _TXT("failed to detect document class"));
+		}
+		const DocumentAnalyzerInstanceInterface* analyzer = getAnalyzer( dclass.mimeType(), dclass.schema());
+		if (!analyzer) return analyzer::Document();
+		return analyzer->analyze( content, dclass);
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error analyzing document with class detection: %s"), *m_errorhnd, analyzer::Document());
+}
+
 DocumentAnalyzerContextInterface* DocumentAnalyzerMap::createContext(
 		const analyzer::DocumentClass& dclass) const
 {
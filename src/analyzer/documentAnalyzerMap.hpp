@@ -16,6 +16,7 @@
 #include "strus/analyzer/documentClass.hpp"
 #include <vector>
 #include <string>
+#include <map>
 
 /// \brief strus toplevel namespace
 namespace strus
@@ -34,7 +35,7 @@ class DocumentAnalyzerMap
 {
 public:
 	DocumentAnalyzerMap( const AnalyzerObjectBuilderInterface* objbuilder_, ErrorBufferInterface* errorhnd_)
-		:m_errorhnd(errorhnd_),m_objbuilder(objbuilder_),m_mimeTypeAnalyzerMap(),m_schemaAnalyzerMap(),m_analyzers(){}
+		:m_errorhnd(errorhnd_),m_objbuilder(objbuilder_),m_mimeTypeAnalyzerMap(),m_schemaAnalyzerMap(),m_analyzers(),m_dispatchTable(){}
 	virtual ~DocumentAnalyzerMap(){}
 
 	virtual DocumentAnalyzerInstanceInterface* createAnalyzer(
@@ -54,6 +55,13 @@ public:
 			const std::string& content,
 			const analyzer::DocumentClass& dclass) const;
 
+	virtual analyzer::Document analyzeFile(
+			const std::string& path,
+			const analyzer::DocumentClass& dclass) const;
+
+	virtual analyzer::Document analyzeAuto(
+			const std::string& content) const;
+
 	virtual DocumentAnalyzerContextInterface* createContext(
 			const analyzer::DocumentClass& dclass) const;
 
@@ -63,12 +71,37 @@ private:
 	typedef strus::Reference<DocumentAnalyzerInstanceInterface> DocumentAnalyzerReference;
 	typedef std::map<std::string,const DocumentAnalyzerInstanceInterface*> Map;
 
+	/// \brief Slot of the open addressing hash table for the dispatch of a document class to its analyzer
+	struct DispatchSlot
+	{
+		std::string mimeType;
+		std::string schema;
+		const DocumentAnalyzerInstanceInterface* analyzer;
+
+		DispatchSlot()
+			:mimeType(),schema(),analyzer(0){}
+#if __cplusplus >= 201103L
+		DispatchSlot( DispatchSlot&& ) = default;
+		DispatchSlot( const DispatchSlot& ) = default;
+		DispatchSlot& operator= ( DispatchSlot&& ) = default;
+		DispatchSlot& operator= ( const DispatchSlot& ) = default;
+#else
+		DispatchSlot( const DispatchSlot& o)
+			:mimeType(o.mimeType),schema(o.schema),analyzer(o.analyzer){}
+#endif
+	};
+
+	void rebuildDispatchTable();
+	void insertDispatchTable( const std::string& mimeType, const std::string& schema, const DocumentAnalyzerInstanceInterface* analyzer_);
+	const DocumentAnalyzerInstanceInterface* findDispatchTable( const std::string& mimeType, const std::string& schema) const;
+
 private:
 	ErrorBufferInterface* m_errorhnd;
 	const AnalyzerObjectBuilderInterface* m_objbuilder;
 	Map m_mimeTypeAnalyzerMap;
 	Map m_schemaAnalyzerMap;
 	std::vector<DocumentAnalyzerReference> m_analyzers;
+	std::vector<DispatchSlot> m_dispatchTable;	///< open addressing hash table (mime type, schema) -> analyzer, schema empty for the analyzers of m_mimeTypeAnalyzerMap
 };
 
 }//namespace
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Implementation of a document sink building an analyzer::Document
+/// \file documentBuilderSink.hpp
+#ifndef _STRUS_ANALYZER_DOCUMENT_BUILDER_SINK_HPP_INCLUDED
+#define _STRUS_ANALYZER_DOCUMENT_BUILDER_SINK_HPP_INCLUDED
+#include "strus/documentSinkInterface.hpp"
+#include "strus/analyzer/document.hpp"
+#include <string>
+#include <vector>
+
+namespace strus
+{
+
+/// \brief Document sink filling an analyzer::Document
+class DocumentBuilderSink
+	:public DocumentSinkInterface
+{
+public:
+	explicit DocumentBuilderSink( analyzer::Document* doc_)
+		:m_doc(doc_){}
+	virtual ~DocumentBuilderSink(){}
+
+	virtual void startDocument( const char* subDocumentTypeName, std::size_t subDocumentTypeNameSize)
+	{
+		m_doc->setSubDocumentTypeName( std::string( subDocumentTypeName, subDocumentTypeNameSize));
+	}
+	virtual void addSearchIndexTerm( const char* type, std::size_t typesize, const char* value, std::size_t valuesize, unsigned int pos)
+	{
+		m_doc->addSearchIndexTerm( std::string( type, typesize), std::string( value, valuesize), pos);
+	}
+	virtual void addForwardIndexTerm( const char* type, std::size_t typesize, const char* value, std::size_t valuesize, unsigned int pos)
+	{
+		m_doc->addForwardIndexTerm( std::string( type, typesize), std::string( value, valuesize), pos);
+	}
+	virtual void setMetaData( const char* name, std::size_t namesize, const NumericVariant& value)
+	{
+		m_doc->setMetaData( std::string( name, namesize), value);
+	}
+	virtual void setAttribute( const char* name, std::size_t namesize, const char* value, std::size_t valuesize)
+	{
+		m_doc->setAttribute( std::string( name, namesize), std::string( value, valuesize));
+	}
+	virtual void addAccess( const char* userRoleName, std::size_t userRoleNameSize)
+	{
+		m_doc->addAccess( std::string( userRoleName, userRoleNameSize));
+	}
+	virtual void addSearchIndexStructure( const char* name, std::size_t namesize, const analyzer::DocumentStructure::PositionRange& header, const analyzer::DocumentStructure::PositionRange& content)
+	{
+		m_doc->addSearchIndexStructure( std::string( name, namesize), header, content);
+	}
+	virtual void endDocument(){}
+
+	/// \brief Pass all elements of a document to a sink
+	static void feed( DocumentSinkInterface& sink, const analyzer::Document& doc)
+	{
+		sink.startDocument( doc.subDocumentTypeName().c_str(), doc.subDocumentTypeName().size());
+		std::vector<analyzer::DocumentTerm>::const_iterator
+			si = doc.searchIndexTerms().begin(), se = doc.searchIndexTerms().end();
+		for (; si != se; ++si)
+		{
+			sink.addSearchIndexTerm( si->type().c_str(), si->type().size(), si->value().c_str(), si->value().size(), si->pos());
+		}
+		std::vector<analyzer::DocumentTerm>::const_iterator
+			fi = doc.forwardIndexTerms().begin(), fe = doc.forwardIndexTerms().end();
+		for (; fi != fe; ++fi)
+		{
+			sink.addForwardIndexTerm( fi->type().c_str(), fi->type().size(), fi->value().c_str(), fi->value().size(), fi->pos());
+		}
+		std::vector<analyzer::DocumentMetaData>::const_iterator
+			mi = doc.metadata().begin(), me = doc.metadata().end();
+		for (; mi != me; ++mi)
+		{
+			sink.setMetaData( mi->name().c_str(), mi->name().size(), mi->value());
+		}
+		std::vector<analyzer::DocumentAttribute>::const_iterator
+			ai = doc.attributes().begin(), ae = doc.attributes().end();
+		for (; ai != ae; ++ai)
+		{
+			sink.setAttribute( ai->name().c_str(), ai->name().size(), ai->value().c_str(), ai->value().size());
+		}
+		std::vector<std::string>::const_iterator
+			li = doc.accessList().begin(), le = doc.accessList().end();
+		for (; li != le; ++li)
+		{
+			sink.addAccess( li->c_str(), li->size());
+		}
+		std::vector<analyzer::DocumentStructure>::const_iterator
+			ti = doc.searchIndexStructures().begin(), te = doc.searchIndexStructures().end();
+		for (; ti != te; ++ti)
+		{
+			sink.addSearchIndexStructure( ti->name().c_str(), ti->name().size(), ti->source(), ti->sink());
+		}
+		sink.endDocument();
+	}
+
+private:
+	analyzer::Document* m_doc;
+};
+
+}//namespace
+#endif
+
@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Analysis of a list of documents with one document per line (e.g. NDJSON)
+/// \file documentLinesAnalyzer.cpp
+#include "documentLinesAnalyzer.hpp"
+#include "documentAnalyzerInstance.hpp"
+#include "documentAnalyzerBatch.hpp"
+#include "strus/errorBufferInterface.hpp"
+#include "private/documentLines.hpp"
+#include "private/internationalization.hpp"
+#include <cstring>
+#include <stdexcept>
+
+using namespace strus;
+
+#define LINES_PER_WORKER 64
+#define MAX_BATCH_BYTES (16UL<<20)
+
+DocumentLinesAnalyzer::DocumentLinesAnalyzer(
+		const DocumentAnalyzerInstance* analyzer_,
+		const analyzer::DocumentClass& dclass,
+		ErrorBufferInterface* errorhnd_)
+	:m_analyzer(analyzer_)
+	,m_lineClass()
+	,m_chunks()
+	,m_chunkpos(0)
+	,m_carry()
+	,m_eof(false)
+	,m_lineno(0)
+	,m_nofThreads(analyzer_->parallelNofThreads())
+	,m_maxBatchLines(LINES_PER_WORKER)
+	,m_batch()
+	,m_batchLinenoar()
+	,m_batchBytes(0)
+	,m_results()
+	,m_resultidx(0)
+	,m_errorhnd(errorhnd_)
+{
+	if (m_nofThreads > 1)
+	{
+		m_maxBatchLines = m_nofThreads * LINES_PER_WORKER;
+	}
+	setDocumentClass( dclass);
+}
+
+void DocumentLinesAnalyzer::setDocumentClass( const analyzer::DocumentClass& dclass)
+{
+	const char* lineMimeType = utils::documentLineMimeType( dclass.mimeType());
+	if (!lineMimeType)
+	{
+		throw strus::runtime_error( _TXT("MIME type '%s' does not describe a list of documents with one document per line"), dclass.mimeType().c_str());
+	}
+	if (!utils::isLineSplittableEncoding( dclass.encoding()))
+	{
+		throw strus::runtime_error( _TXT("character set encoding '%s' not supported for lists of documents with one document per line"), dclass.encoding().c_str());
+	}
+	m_lineClass = analyzer::DocumentClass( lineMimeType, dclass.encoding(), dclass.schema());
+}
+
+void DocumentLinesAnalyzer::reset( const analyzer::DocumentClass& dclass)
+{
+	setDocumentClass( dclass);
+	m_chunks.clear();
+	m_chunkpos = 0;
+	m_carry.clear();
+	m_eof = false;
+	m_lineno = 0;
+	m_batch.clear();
+	m_batchLinenoar.clear();
+	m_batchBytes = 0;
+	m_results.clear();
+	m_resultidx = 0;
+}
+
+void DocumentLinesAnalyzer::putInput( const char* chunk, std::size_t chunksize, bool eof)
+{
+	if (m_eof)
+	{
+		throw std::runtime_error( _TXT("input fed after declared end of input"));
+	}
+	if (chunksize) m_chunks.pushCopy( chunk, chunksize);
+	m_eof = eof;
+}
+
+void DocumentLinesAnalyzer::putInputReference( const char* chunk, std::size_t chunksize, bool eof)
+{
+	if (m_eof)
+	{
+		throw std::runtime_error( _TXT("input fed after declared end of input"));
+	}
+	if (chunksize) m_chunks.pushReference( chunk, chunksize);
+	m_eof = eof;
+}
+
+std::size_t DocumentLinesAnalyzer::bufferedInputSize() const
+{
+	return m_chunks.bufferedSize() - m_chunkpos;
+}
+
+bool DocumentLinesAnalyzer::fetchLine( std::string& line)
+{
+	while (!m_chunks.empty())
+	{
+		const char* ptr = m_chunks.frontPtr() + m_chunkpos;
+		std::size_t size = m_chunks.frontSize() - m_chunkpos;
+		const char* eoln = (const char*)std::memchr( ptr, '\n', size);
+		if (eoln)
+		{
+			line.assign( m_carry);
+			line.append( ptr, eoln - ptr);
+			m_carry.clear();
+			m_chunkpos += eoln - ptr + 1;
+			if (m_chunkpos == m_chunks.frontSize())
+			{
+				m_chunks.pop_front();
+				m_chunkpos = 0;
+			}
+			++m_lineno;
+			return true;
+		}
+		// ... the line continues in the next chunk, keep its start and release the chunk
+		m_carry.append( ptr, size);
+		m_chunks.pop_front();
+		m_chunkpos = 0;
+	}
+	if (m_eof && !m_carry.empty())
+	{
+		line.swap( m_carry);
+		m_carry.clear();
+		++m_lineno;
+		return true;
+	}
+	return false;
+}
+
+static bool isEmptyLine( const std::string& line)
+{
+	std::string::const_iterator li = line.begin(), le = line.end();
+	for (; li != le && (unsigned char)*li <= 32; ++li){}
+	return li == le;
+}
+
+bool DocumentLinesAnalyzer::fillBatch()
+{
+	while (m_batch.size() < m_maxBatchLines && m_batchBytes < MAX_BATCH_BYTES)
+	{
+		m_batch.push_back( Input());
+		Input& input = m_batch.back();
+		if (!fetchLine( input.content))
+		{
+			m_batch.pop_back();
+			// ... an incomplete batch is analyzed only at the end of input
+			return m_eof && !m_batch.empty();
+		}
+		if (isEmptyLine( input.content))
+		{
+			m_batch.pop_back();
+			continue;
+		}
+		input.dclass = m_lineClass;
+		m_batchLinenoar.push_back( m_lineno);
+		m_batchBytes += input.content.size();
+	}
+	return true;
+}
+
+void DocumentLinesAnalyzer::ResultCollector::document( std::size_t inputidx, const analyzer::Document& doc)
+{
+	m_results->push_back( Result());
+	m_results->back().doc = doc;
+	m_results->back().lineno = (*m_linenoar)[ inputidx];
+}
+
+void DocumentLinesAnalyzer::ResultCollector::error( std::size_t inputidx, const char* msg)
+{
+	m_results->push_back( Result());
+	m_results->back().error = msg;
+	m_results->back().lineno = (*m_linenoar)[ inputidx];
+}
+
+void DocumentLinesAnalyzer::runBatch()
+{
+	ResultCollector collector( m_results, m_batchLinenoar);
+	DocumentAnalyzerBatch batch( m_analyzer, m_batch, m_nofThreads, m_errorhnd);
+	batch.run( collector);
+	m_batch.clear();
+	m_batchLinenoar.clear();
+	m_batchBytes = 0;
+}
+
+bool DocumentLinesAnalyzer::analyzeNext( analyzer::Document& doc)
+{
+	for (;;)
+	{
+		if (m_resultidx < m_results.size())
+		{
+			Result& result = m_results[ m_resultidx++];
+			if (!result.error.empty())
+			{
+				throw strus::runtime_error( _TXT("error analyzing the document in line %u: %s"), result.lineno, result.error.c_str());
+			}
+			doc.swap( result.doc);
+			return true;
+		}
+		m_results.clear();
+		m_resultidx = 0;
+		if (!fillBatch()) return false;
+		runBatch();
+	}
+}
+
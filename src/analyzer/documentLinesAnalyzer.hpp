@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Analysis of a list of documents with one document per line (e.g. NDJSON)
+/// \file documentLinesAnalyzer.hpp
+#ifndef _STRUS_DOCUMENT_LINES_ANALYZER_HPP_INCLUDED
+#define _STRUS_DOCUMENT_LINES_ANALYZER_HPP_INCLUDED
+#include "strus/documentAnalyzerInstanceInterface.hpp"
+#include "strus/analyzer/document.hpp"
+#include "strus/analyzer/documentClass.hpp"
+#include "private/inputChunkQueue.hpp"
+#include <vector>
+#include <string>
+
+namespace strus
+{
+/// \brief Forward declaration
+class ErrorBufferInterface;
+/// \brief Forward declaration
+class DocumentAnalyzerInstance;
+
+/// \brief Analysis of a list of documents with one document per line
+/// \note The lines are found with memchr on the chunks fed, without parsing the documents.
+///	Lines are collected to batches analyzed with DocumentAnalyzerBatch, in parallel with the threads configured
+///	with DocumentAnalyzerInstance::defineParallelProcessing. The documents are returned in the order of the lines.
+///	The input buffered is bounded by the size of a batch plus the chunks not consumed yet.
+class DocumentLinesAnalyzer
+{
+public:
+	/// \param[in] analyzer_ analyzer of the documents in the lines
+	/// \param[in] dclass document class of the list
+	/// \param[in] errorhnd_ error buffer interface
+	DocumentLinesAnalyzer(
+			const DocumentAnalyzerInstance* analyzer_,
+			const analyzer::DocumentClass& dclass,
+			ErrorBufferInterface* errorhnd_);
+
+	/// \brief Reset for a new input, keeping the buffers allocated
+	/// \param[in] dclass document class of the list
+	void reset( const analyzer::DocumentClass& dclass);
+
+	/// \brief Feed the next chunk of input, copying it
+	void putInput( const char* chunk, std::size_t chunksize, bool eof);
+	/// \brief Feed the next chunk of input without copying it, the chunk must stay valid until consumed
+	void putInputReference( const char* chunk, std::size_t chunksize, bool eof);
+	/// \brief Get the sum of the sizes in bytes of the chunks fed and not consumed yet
+	std::size_t bufferedInputSize() const;
+
+	/// \brief Get the next document analyzed
+	/// \param[out] doc the document
+	/// \return true if a document was returned, false if more input is required or all documents have been returned
+	/// \remark Throws if the analysis of a line failed, the documents of the following lines can still be fetched
+	bool analyzeNext( analyzer::Document& doc);
+
+private:
+	DocumentLinesAnalyzer( const DocumentLinesAnalyzer&){}	//... non copyable
+	void operator=( const DocumentLinesAnalyzer&){}		//... non copyable
+
+	typedef DocumentAnalyzerInstanceInterface::Input Input;
+
+	/// \brief Result of the analysis of a line
+	struct Result
+	{
+		analyzer::Document doc;
+		std::string error;
+		unsigned int lineno;
+
+		Result()
+			:doc(),error(),lineno(0){}
+#if __cplusplus >= 201103L
+		Result( Result&& ) = default;
+		Result( const Result& ) = default;
+		Result& operator= ( Result&& ) = default;
+		Result& operator= ( const Result& ) = default;
+#else
+		Result( const Result& o)
+			:doc(o.doc),error(o.error),lineno(o.lineno){}
+#endif
+	};
+
+	/// \brief Receiver of the results of a batch, appending them to the result list
+	class ResultCollector
+		:public DocumentAnalyzerInstanceInterface::Callback
+	{
+	public:
+		ResultCollector( std::vector<Result>& results_, const std::vector<unsigned int>& linenoar_)
+			:m_results(&results_),m_linenoar(&linenoar_){}
+		virtual ~ResultCollector(){}
+
+		virtual void document( std::size_t inputidx, const analyzer::Document& doc);
+		virtual void error( std::size_t inputidx, const char* msg);
+
+	private:
+		std::vector<Result>* m_results;
+		const std::vector<unsigned int>* m_linenoar;
+	};
+
+	void setDocumentClass( const analyzer::DocumentClass& dclass);
+	bool fetchLine( std::string& line);
+	bool fillBatch();
+	void runBatch();
+
+private:
+	const DocumentAnalyzerInstance* m_analyzer;
+	analyzer::DocumentClass m_lineClass;		///< document class of the documents in the lines
+	InputChunkQueue m_chunks;			///< chunks fed and not consumed yet
+	std::size_t m_chunkpos;				///< position of the first byte not consumed in the front chunk
+	std::string m_carry;				///< start of the current line from chunks released already
+	bool m_eof;
+	unsigned int m_lineno;				///< number of lines fetched
+	unsigned int m_nofThreads;			///< number of threads analyzing a batch
+	std::size_t m_maxBatchLines;			///< number of lines of a complete batch
+	std::vector<Input> m_batch;			///< lines of the next batch to analyze
+	std::vector<unsigned int> m_batchLinenoar;	///< line numbers of the lines in m_batch
+	std::size_t m_batchBytes;			///< sum of the sizes of the lines in m_batch
+	std::vector<Result> m_results;			///< results of the last batch analyzed
+	std::size_t m_resultidx;			///< index of the next result in m_results to return
+	ErrorBufferInterface* m_errorhnd;
+};
+
+}//namespace
+#endif
+
@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Parallel analysis of the parts of a content split by the segmenter (e.g. ranges of rows of a TSV document)
+/// \file documentPartsAnalyzer.cpp
+#include "documentPartsAnalyzer.hpp"
+#include "documentAnalyzerInstance.hpp"
+#include "documentAnalyzerContext.hpp"
+#include "strus/segmenterContextInterface.hpp"
+#include "strus/errorBufferInterface.hpp"
+#include "strus/base/thread.hpp"
+#include "private/internationalization.hpp"
+#include <stdexcept>
+#include <new>
+
+using namespace strus;
+
+DocumentPartsAnalyzer::DocumentPartsAnalyzer(
+		const DocumentAnalyzerInstance* analyzer_,
+		const analyzer::DocumentClass& dclass,
+		const char* content_,
+		std::size_t contentsize_,
+		std::vector<ContentPart>& parts_,
+		unsigned int nofThreads_,
+		ErrorBufferInterface* errorhnd_)
+	:m_analyzer(analyzer_)
+	,m_dclass(dclass)
+	,m_content(content_)
+	,m_contentsize(contentsize_)
+	,m_parts()
+	,m_partidx(0)
+	,m_nofThreads(nofThreads_ ? nofThreads_ : 1)
+	,m_results()
+	,m_resultidx(0)
+	,m_docidx(0)
+	,m_errorhnd(errorhnd_)
+{
+	m_parts.swap( parts_);
+}
+
+std::size_t DocumentPartsAnalyzer::bufferedInputSize() const
+{
+	// ... the header shared by all parts is referenced until the last part has been analyzed
+	return m_partidx < m_parts.size() ? m_contentsize : 0;
+}
+
+void DocumentPartsAnalyzer::analyzePart( std::size_t partidx, Result& result)
+{
+	try
+	{
+		SegmenterContextInterface* segmenter = m_analyzer->segmenter()->createPartContext( m_dclass, m_content, m_contentsize, m_parts[ partidx]);
+		if (!segmenter)
+		{
+			throw strus::runtime_error( _TXT("failed to create segmenter context: %s"), m_errorhnd->fetchError());
+		}
+		DocumentAnalyzerContext context( m_analyzer, segmenter, m_errorhnd);
+		analyzer::Document doc;
+		while (context.analyzeNext( doc))
+		{
+			result.documents.push_back( doc);
+		}
+		if (m_errorhnd->hasError())
+		{
+			result.error = m_errorhnd->fetchError();
+		}
+	}
+	catch (const std::bad_alloc&)
+	{
+		result.error = _TXT("out of memory");
+	}
+	catch (const std::exception& err)
+	{
+		result.error = err.what();
+	}
+}
+
+void DocumentPartsAnalyzer::runWorker( DocumentPartsAnalyzer* self, std::size_t partidx, unsigned int resultidx)
+{
+	if (!self->m_errorhnd->allocContext())
+	{
+		self->m_results[ resultidx].error = _TXT("failed to allocate error context for worker thread");
+		return;
+	}
+	self->analyzePart( partidx, self->m_results[ resultidx]);
+	self->m_errorhnd->releaseContext();
+}
+
+void DocumentPartsAnalyzer::runRound()
+{
+	std::size_t nofParts = m_parts.size() - m_partidx;
+	if (nofParts > m_nofThreads) nofParts = m_nofThreads;
+	m_results.clear();
+	m_results.resize( nofParts);
+	m_resultidx = 0;
+	m_docidx = 0;
+
+	// Analyze the first part in the calling thread, the others in their own threads:
+	std::vector<strus::thread*> workers;
+	try
+	{
+		for (unsigned int ri=1; ri < nofParts; ++ri)
+		{
+			workers.push_back( new strus::thread( &DocumentPartsAnalyzer::runWorker, this, m_partidx + ri, ri));
+		}
+		analyzePart( m_partidx, m_results[ 0]);
+	}
+	catch (const std::exception& err)
+	{
+		m_results[ 0].error = err.what();
+	}
+	std::vector<strus::thread*>::iterator wi = workers.begin(), we = workers.end();
+	for (; wi != we; ++wi)
+	{
+		(*wi)->join();
+		delete *wi;
+	}
+	m_partidx += nofParts;
+}
+
+bool DocumentPartsAnalyzer::analyzeNext( analyzer::Document& doc)
+{
+	for (;;)
+	{
+		if (m_resultidx < m_results.size())
+		{
+			Result& result = m_results[ m_resultidx];
+			if (m_docidx < result.documents.size())
+			{
+				doc.swap( result.documents[ m_docidx++]);
+				return true;
+			}
+			if (!result.error.empty())
+			{
+				std::string errmsg;
+				errmsg.swap( result.error);
+				m_results.clear();
+				m_partidx = m_parts.size();
+				throw strus::runtime_error( _TXT("error in parallel analysis of the parts of the document: %s"), errmsg.c_str());
+			}
+			// Free the memory of delivered results:
+			std::vector<analyzer::Document>().swap( result.documents);
+			++m_resultidx;
+			m_docidx = 0;
+			continue;
+		}
+		if (m_partidx >= m_parts.size()) return false;
+		runRound();
+	}
+}
+
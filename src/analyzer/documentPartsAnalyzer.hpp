@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Parallel analysis of the parts of a content split by the segmenter (e.g. ranges of rows of a TSV document)
+/// \file documentPartsAnalyzer.hpp
+#ifndef _STRUS_DOCUMENT_PARTS_ANALYZER_HPP_INCLUDED
+#define _STRUS_DOCUMENT_PARTS_ANALYZER_HPP_INCLUDED
+#include "strus/segmenterInstanceInterface.hpp"
+#include "strus/analyzer/document.hpp"
+#include "strus/analyzer/documentClass.hpp"
+#include <vector>
+#include <string>
+
+namespace strus
+{
+/// \brief Forward declaration
+class ErrorBufferInterface;
+/// \brief Forward declaration
+class DocumentAnalyzerInstance;
+
+/// \brief Parallel analysis of the parts of a complete content split with SegmenterInstanceInterface::splitContent
+/// \note The parts are analyzed in rounds of one part per thread, each part with its own document analyzer context.
+///	The sub documents are returned in the order of the parts, the sub documents of one round are kept in memory.
+class DocumentPartsAnalyzer
+{
+public:
+	typedef SegmenterInstanceInterface::ContentPart ContentPart;
+
+	/// \param[in] analyzer_ analyzer of the content
+	/// \param[in] dclass document class of the content
+	/// \param[in] content_ the complete content, must stay valid until all parts are analyzed
+	/// \param[in] contentsize_ size of the content in bytes
+	/// \param[in] parts_ parts of the content returned by the segmenter, consumed (swapped) by the constructor
+	/// \param[in] nofThreads_ number of threads analyzing the parts
+	/// \param[in] errorhnd_ error buffer interface
+	DocumentPartsAnalyzer(
+			const DocumentAnalyzerInstance* analyzer_,
+			const analyzer::DocumentClass& dclass,
+			const char* content_,
+			std::size_t contentsize_,
+			std::vector<ContentPart>& parts_,
+			unsigned int nofThreads_,
+			ErrorBufferInterface* errorhnd_);
+
+	/// \brief Get the number of bytes of the content still referenced
+	std::size_t bufferedInputSize() const;
+
+	/// \brief Get the next sub document analyzed
+	/// \param[out] doc the document
+	/// \return true if a document was returned, false if all documents have been returned
+	/// \remark Throws if the analysis of a part failed, no documents are returned after an error
+	bool analyzeNext( analyzer::Document& doc);
+
+private:
+	DocumentPartsAnalyzer( const DocumentPartsAnalyzer&){}	//... non copyable
+	void operator=( const DocumentPartsAnalyzer&){}		//... non copyable
+
+	/// \brief Result of the analysis of a part
+	struct Result
+	{
+		std::vector<analyzer::Document> documents;
+		std::string error;
+
+		Result()
+			:documents(),error(){}
+	};
+
+	void analyzePart( std::size_t partidx, Result& result);
+	static void runWorker( DocumentPartsAnalyzer* self, std::size_t partidx, unsigned int resultidx);
+	void runRound();
+
+private:
+	const DocumentAnalyzerInstance* m_analyzer;
+	analyzer::DocumentClass m_dclass;
+	const char* m_content;
+	std::size_t m_contentsize;
+	std::vector<ContentPart> m_parts;
+	std::size_t m_partidx;			///< index of the first part not analyzed yet
+	unsigned int m_nofThreads;
+	std::vector<Result> m_results;		///< results of the parts of the last round
+	std::size_t m_resultidx;		///< index of the result in m_results to return documents from
+	std::size_t m_docidx;			///< index of the next document in the current result to return
+	ErrorBufferInterface* m_errorhnd;
+};
+
+}//namespace
+#endif
+
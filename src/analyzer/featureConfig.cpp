@@ -9,6 +9,7 @@
 #include "private/internationalization.hpp"
 #include <vector>
 #include <string>
+#include <cstring>
 
 using namespace strus;
 
@@ -55,6 +56,31 @@ FeatureConfig::FeatureConfig(
 	}
 }
 
+std::string FeatureConfig::normalizeMultiValue( const std::string& values, std::vector<NormalizerReference>::const_iterator ci) const
+{
+	std::string reslist;
+	char const* vi = values.c_str();
+	char const* ve = vi + values.size();
+	for (++vi; vi < ve; vi = std::strchr( vi, '\0')+1)
+	{
+		std::string partres = normalize( vi, std::strlen(vi), ci);
+		if (!partres.empty() && partres[0] == '\0')
+		{
+			reslist.append( partres);
+		}
+		else if (reslist.empty())
+		{
+			reslist.push_back( '\0');
+			reslist.append( partres);
+		}
+		else
+		{
+			reslist.append( partres);
+		}
+	}
+	return reslist;
+}
+
 std::string FeatureConfig::normalize( char const* tok, std::size_t toksize, std::vector<NormalizerReference>::const_iterator ci) const
 {
 	std::vector<NormalizerReference>::const_iterator ce = m_normalizerlist.end();
@@ -69,27 +95,7 @@ std::string FeatureConfig::normalize( char const* tok, std::size_t toksize, std:
 		{
 			if (!rt.empty() && rt[0] == '\0')
 			{
-				std::string reslist;
-				char const* vi = rt.c_str();
-				char const* ve = vi + rt.size();
-				for (++vi; vi < ve; vi = std::strchr( vi, '\0')+1)
-				{
-					std::string partres = normalize( vi, std::strlen(vi), ci+1);
-					if (!partres.empty() && partres[0] == '\0')
-					{
-						reslist.append( partres);
-					}
-					else if (reslist.empty())
-					{
-						reslist.push_back( '\0');
-						reslist.append( partres);
-					}
-					else
-					{
-						reslist.append( partres);
-					}
-				}
-				return reslist;
+				return normalizeMultiValue( rt, ci+1);
 			}
 			else
 			{
@@ -112,4 +118,9 @@ std::vector<analyzer::Token> FeatureConfig::tokenize( const char* src, std::size
 	return m_tokenizer->tokenize( src, srcsize);
 }
 
+void FeatureConfig::tokenizeInto( const char* src, std::size_t srcsize, std::vector<analyzer::Token>& res) const
+{
+	m_tokenizer->tokenizeInto( src, srcsize, res);
+}
+
 
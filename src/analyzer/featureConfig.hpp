@@ -62,9 +62,12 @@ public:
 
 	std::string normalize( char const* tok, std::size_t toksize) const;
 	std::vector<analyzer::Token> tokenize( const char* src, std::size_t srcsize) const;
+	/// \brief Tokenize into a buffer passed by the caller, reusing its memory
+	void tokenizeInto( const char* src, std::size_t srcsize, std::vector<analyzer::Token>& res) const;
 
 private:
 	std::string normalize( char const* tok, std::size_t toksize, std::vector<NormalizerReference>::const_iterator ci) const;
+	std::string normalizeMultiValue( const std::string& values, std::vector<NormalizerReference>::const_iterator ci) const;
 
 private:
 	std::string m_name;
@@ -8,6 +8,9 @@
 #include "featureConfigMap.hpp"
 #include "private/internationalization.hpp"
 #include "strus/base/string_conv.hpp"
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
 
 using namespace strus;
 
@@ -20,6 +23,132 @@ const FeatureConfig& FeatureConfigMap::featureConfig( int featidx) const
 	return m_ar[ featidx-1];
 }
 
+std::vector<int> FeatureConfigMap::buildTypeOrder( const std::string& newFeatType) const
+{
+	std::vector<std::string> names;
+	names.reserve( m_ar.size()+1);
+	std::vector<FeatureConfig>::const_iterator fi = m_ar.begin(), fe = m_ar.end();
+	for (; fi != fe; ++fi)
+	{
+		names.push_back( fi->name());
+	}
+	names.push_back( newFeatType);
+	std::sort( names.begin(), names.end());
+	names.erase( std::unique( names.begin(), names.end()), names.end());
+
+	std::vector<int> rt;
+	rt.reserve( m_ar.size()+1);
+	for (fi = m_ar.begin(); fi != fe; ++fi)
+	{
+		rt.push_back( std::lower_bound( names.begin(), names.end(), fi->name()) - names.begin());
+	}
+	rt.push_back( std::lower_bound( names.begin(), names.end(), newFeatType) - names.begin());
+	return rt;
+}
+
+static bool isEqualTokenizer( const TokenizerFunctionInstanceInterface* t1, const TokenizerFunctionInstanceInterface* t2)
+{
+	if (t1 == t2) return true;
+	if (0!=std::strcmp( t1->name(), t2->name())) return false;
+	std::string view1 = t1->view().tostring();
+	// ... an empty view is the result of an error in the introspection, such a tokenizer is not shared
+	return !view1.empty() && view1 == t2->view().tostring();
+}
+
+int FeatureConfigMap::findTokenizerGroup( const std::string& selectexpr, const TokenizerFunctionInstanceInterface* tokenizer) const
+{
+	std::vector<FeatureConfig>::const_iterator fi = m_ar.begin(), fe = m_ar.end();
+	for (int fidx=0; fi != fe; ++fi,++fidx)
+	{
+		if (m_tokenizerGroupAr[ fidx] == fidx+1
+		&&  fi->selectexpr() == selectexpr
+		&&  isEqualTokenizer( fi->tokenizer().get(), tokenizer))
+		{
+			return fidx+1;
+		}
+	}
+	return m_ar.size()+1;
+}
+
+static std::string normalizerKey( const NormalizerFunctionInstanceInterface* normalizer)
+{
+	std::string rt( normalizer->name());
+	rt.push_back( '\n');
+	std::string view = normalizer->view().tostring();
+	if (view.empty())
+	{
+		// ... an empty view is the result of an error in the introspection, such a normalizer gets a key of its own and is not shared
+		char buf[ 64];
+		std::snprintf( buf, sizeof(buf), "%p", (const void*)normalizer);
+		rt.append( buf);
+	}
+	else
+	{
+		rt.append( view);
+	}
+	return rt;
+}
+
+int FeatureConfigMap::insertNormalizerPath(
+		std::vector<NormalizerNode>& nodes,
+		std::vector<int>& path,
+		int tokenizerGroup,
+		const std::vector<NormalizerFunctionInstanceInterface*>& normalizers)
+{
+	int parent = -tokenizerGroup;
+	std::vector<NormalizerFunctionInstanceInterface*>::const_iterator
+		ni = normalizers.begin(), ne = normalizers.end();
+	for (; ni != ne; ++ni)
+	{
+		std::string key = normalizerKey( *ni);
+		std::vector<NormalizerNode>::const_iterator ti = nodes.begin(), te = nodes.end();
+		int nodeidx = 0;
+		for (; ti != te; ++ti,++nodeidx)
+		{
+			if (ti->parent == parent && (ti->normalizer == *ni || ti->key == key)) break;
+		}
+		if (ti == te)
+		{
+			nodeidx = nodes.size();
+			nodes.push_back( NormalizerNode( parent, *ni, key));
+		}
+		nodes[ nodeidx].refcnt += 1;
+		path.push_back( nodeidx);
+		parent = nodeidx;
+	}
+	return assignNormalizerSlots( nodes);
+}
+
+int FeatureConfigMap::assignNormalizerSlots( std::vector<NormalizerNode>& nodes)
+{
+	int nofSlots = 0;
+	std::vector<NormalizerNode>::iterator ti = nodes.begin(), te = nodes.end();
+	for (; ti != te; ++ti)
+	{
+		ti->slot = (ti->refcnt > 1) ? nofSlots++ : -1;
+	}
+	return nofSlots;
+}
+
+int FeatureConfigMap::findNormalizerChain( const std::string& chainKey) const
+{
+	std::vector<std::string>::const_iterator ci = m_normalizerChainKeys.begin(), ce = m_normalizerChainKeys.end();
+	for (int cidx=0; ci != ce; ++ci,++cidx)
+	{
+		if (*ci == chainKey) return cidx;
+	}
+	return -1;
+}
+
+void FeatureConfigMap::defineNormalizerCacheSize( int featidx, unsigned int size)
+{
+	if (featidx <= 0 || (std::size_t)featidx > m_ar.size())
+	{
+		throw std::runtime_error( _TXT("internal: unknown index of feature"));
+	}
+	m_normalizerCacheSizeAr[ featidx-1] = size;
+}
+
 static void freeNormalizers( const std::vector<NormalizerFunctionInstanceInterface*>& normalizers)
 {
 	std::vector<NormalizerFunctionInstanceInterface*>::const_iterator
@@ -54,7 +183,39 @@ unsigned int FeatureConfigMap::defineFeature(
 			throw std::runtime_error( _TXT("number of features defined exceeds maximum limit"));
 		}
 		m_ar.reserve( m_ar.size()+1);
-		m_ar.push_back( FeatureConfig( string_conv::tolower( featType), selectexpr, tokenizer, normalizers, priority, featureClass, options));
+		m_tokenizerGroupAr.reserve( m_ar.size()+1);
+		std::string featTypeName = string_conv::tolower( featType);
+		std::vector<int> typeOrderAr = buildTypeOrder( featTypeName);
+		int tokenizerGroup = findTokenizerGroup( selectexpr, tokenizer);
+		std::vector<NormalizerNode> normalizerNodes( m_normalizerNodes);
+		std::vector<int> normalizerPath;
+		int nofSharedNormalizers = insertNormalizerPath( normalizerNodes, normalizerPath, tokenizerGroup, normalizers);
+		std::string chainKey;
+		std::vector<int>::const_iterator pi = normalizerPath.begin(), pe = normalizerPath.end();
+		for (; pi != pe; ++pi)
+		{
+			chainKey.append( normalizerNodes[ *pi].key);
+			chainKey.push_back( '\1');
+		}
+		int normalizerChain = findNormalizerChain( chainKey);
+		m_normalizerPathAr.reserve( m_ar.size()+1);
+		m_normalizerChainAr.reserve( m_ar.size()+1);
+		m_normalizerCacheSizeAr.reserve( m_ar.size()+1);
+		if (normalizerChain < 0)
+		{
+			normalizerChain = m_normalizerChainKeys.size();
+			m_normalizerChainKeys.push_back( chainKey);
+		}
+		m_ar.push_back( FeatureConfig( featTypeName, selectexpr, tokenizer, normalizers, priority, featureClass, options));
+		m_typeOrderAr.swap( typeOrderAr);
+		m_tokenizerGroupAr.push_back( tokenizerGroup);
+		m_normalizerNodes.swap( normalizerNodes);
+		m_normalizerPathAr.push_back( std::vector<int>());
+		m_normalizerPathAr.back().swap( normalizerPath);
+		m_nofSharedNormalizers = nofSharedNormalizers;
+		m_normalizerChainAr.push_back( normalizerChain);
+		m_normalizerCacheSizeAr.push_back( options.normalizerCacheSize());
+		if (tokenizerGroup != (int)m_ar.size()) ++m_nofSharedTokenizers;
 		return m_ar.size();
 	}
 	catch (const std::bad_alloc&)
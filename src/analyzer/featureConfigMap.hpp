@@ -51,9 +51,15 @@ class FeatureConfigMap
 {
 public:
 	FeatureConfigMap()
-		:m_ar(),m_minPriority(std::numeric_limits<int>::max()){}
+		:m_ar(),m_typeOrderAr(),m_tokenizerGroupAr(),m_nofSharedTokenizers(0)
+		,m_normalizerNodes(),m_normalizerPathAr(),m_nofSharedNormalizers(0)
+		,m_normalizerChainKeys(),m_normalizerChainAr(),m_normalizerCacheSizeAr()
+		,m_minPriority(std::numeric_limits<int>::max()){}
 	FeatureConfigMap( const FeatureConfigMap& o)
-		:m_ar(o.m_ar),m_minPriority(o.m_minPriority){}
+		:m_ar(o.m_ar),m_typeOrderAr(o.m_typeOrderAr),m_tokenizerGroupAr(o.m_tokenizerGroupAr),m_nofSharedTokenizers(o.m_nofSharedTokenizers)
+		,m_normalizerNodes(o.m_normalizerNodes),m_normalizerPathAr(o.m_normalizerPathAr),m_nofSharedNormalizers(o.m_nofSharedNormalizers)
+		,m_normalizerChainKeys(o.m_normalizerChainKeys),m_normalizerChainAr(o.m_normalizerChainAr),m_normalizerCacheSizeAr(o.m_normalizerCacheSizeAr)
+		,m_minPriority(o.m_minPriority){}
 	~FeatureConfigMap(){}
 
 	unsigned int defineFeature(
@@ -67,14 +73,117 @@ public:
 
 	const FeatureConfig& featureConfig( int featidx) const;
 
+	/// \brief Get the rank of the type name of a feature in the lexical order of all type names
+	/// \note Allows to order terms by type comparing integers instead of strings
+	int typeOrder( int featidx) const
+	{
+		return m_typeOrderAr[ featidx-1];
+	}
+
+	/// \brief Get the group of features sharing the tokenization of their segments with a feature
+	/// \note Features with the same selector and the same tokenizer (name and arguments) share the tokenization
+	/// \return the index of the first feature defined in the group
+	int tokenizerGroup( int featidx) const
+	{
+		return m_tokenizerGroupAr[ featidx-1];
+	}
+
+	/// \brief Get the number of features reusing the tokenization of another feature
+	int nofSharedTokenizers() const			{return m_nofSharedTokenizers;}
+
+	/// \brief Get the slot for the result of a normalizer of a feature that is shared with other features
+	/// \note The normalizer lists of the features of a tokenizer group build a prefix tree, the nodes of the tree passed by more than one feature get a slot
+	/// \param[in] featidx index of the feature
+	/// \param[in] step index of the normalizer in the list of normalizers of the feature
+	/// \return the slot index or -1 if the result is not shared
+	int normalizerSlot( int featidx, std::size_t step) const
+	{
+		return m_normalizerNodes[ m_normalizerPathAr[ featidx-1][ step]].slot;
+	}
+
+	/// \brief Get the number of normalizer results shared between features (number of slots)
+	int nofSharedNormalizers() const		{return m_nofSharedNormalizers;}
+
+	/// \brief Get the identifier of the normalizer chain of a feature, features with equal normalizer lists get the same identifier
+	/// \return the identifier, a number from 0 to nofNormalizerChains()-1
+	int normalizerChainId( int featidx) const
+	{
+		return m_normalizerChainAr[ featidx-1];
+	}
+
+	/// \brief Get the number of distinct normalizer chains
+	int nofNormalizerChains() const			{return m_normalizerChainKeys.size();}
+
+	/// \brief Get the maximum number of entries of the cache for the normalization results of a feature
+	/// \return the cache size or 0 if there is no cache used
+	unsigned int normalizerCacheSize( int featidx) const
+	{
+		return m_normalizerCacheSizeAr[ featidx-1];
+	}
+
+	/// \brief Test if any feature uses a cache for its normalization results
+	bool hasNormalizerCache() const
+	{
+		std::vector<unsigned int>::const_iterator ci = m_normalizerCacheSizeAr.begin(), ce = m_normalizerCacheSizeAr.end();
+		for (; ci != ce && !*ci; ++ci){}
+		return ci != ce;
+	}
+
+	/// \brief Define the maximum number of entries of the cache for the normalization results of a feature
+	/// \param[in] featidx index of the feature
+	/// \param[in] size the cache size or 0 if there is no cache to use
+	void defineNormalizerCacheSize( int featidx, unsigned int size);
+
 	typedef std::vector<FeatureConfig>::const_iterator const_iterator;
 	const_iterator begin() const			{return m_ar.begin();}
 	const_iterator end() const			{return m_ar.end();}
 	const std::vector<FeatureConfig>& list() const	{return m_ar;}
 	int minPriority() const				{return m_minPriority;}
 
+private:
+	std::vector<int> buildTypeOrder( const std::string& newFeatType) const;
+	int findTokenizerGroup( const std::string& selectexpr, const TokenizerFunctionInstanceInterface* tokenizer) const;
+
+	/// \brief Node in the prefix tree of normalizers
+	struct NormalizerNode
+	{
+		int parent;		///< index of the parent node or the negative tokenizer group for a root node
+		const NormalizerFunctionInstanceInterface* normalizer;
+		std::string key;	///< name and arguments of the normalizer
+		int refcnt;		///< number of features passing this node
+		int slot;		///< slot of the shared result, -1 if not shared
+
+		NormalizerNode( int parent_, const NormalizerFunctionInstanceInterface* normalizer_, const std::string& key_)
+			:parent(parent_),normalizer(normalizer_),key(key_),refcnt(0),slot(-1){}
+#if __cplusplus >= 201103L
+		NormalizerNode( NormalizerNode&& ) = default;
+		NormalizerNode( const NormalizerNode& ) = default;
+		NormalizerNode& operator= ( NormalizerNode&& ) = default;
+		NormalizerNode& operator= ( const NormalizerNode& ) = default;
+#else
+		NormalizerNode( const NormalizerNode& o)
+			:parent(o.parent),normalizer(o.normalizer),key(o.key),refcnt(o.refcnt),slot(o.slot){}
+#endif
+	};
+	static int insertNormalizerPath(
+			std::vector<NormalizerNode>& nodes,
+			std::vector<int>& path,
+			int tokenizerGroup,
+			const std::vector<NormalizerFunctionInstanceInterface*>& normalizers);
+	static int assignNormalizerSlots( std::vector<NormalizerNode>& nodes);
+	int findNormalizerChain( const std::string& chainKey) const;
+
 private:
 	std::vector<FeatureConfig> m_ar;
+	std::vector<int> m_typeOrderAr;
+	std::vector<int> m_tokenizerGroupAr;
+	int m_nofSharedTokenizers;
+	std::vector<NormalizerNode> m_normalizerNodes;
+	std::vector<std::vector<int> > m_normalizerPathAr;
+	int m_nofSharedNormalizers;
+	std::vector<std::string> m_normalizerChainKeys;
+	std::vector<int> m_normalizerChainAr;
+	std::vector<unsigned int> m_normalizerCacheSizeAr;
 	int m_minPriority;
 };
 
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Bounded cache for the results of normalizer chains of features
+/// \file normalizerCache.cpp
+#include "normalizerCache.hpp"
+#include "featureConfigMap.hpp"
+#include <cstring>
+
+using namespace strus;
+
+NormalizerCache::NormalizerCache( std::size_t maxNofEntries)
+	:m_ar(),m_mask(0),m_hits(0),m_misses(0)
+{
+	std::size_t size = 1;
+	while (size < maxNofEntries && size < (1U<<30)) size <<= 1;
+	m_ar.resize( size);
+	m_mask = size-1;
+}
+
+uint32_t NormalizerCache::hash( const char* tok, std::size_t toksize)
+{
+	// FNV-1a
+	uint32_t rt = 2166136261U;
+	char const* ti = tok;
+	char const* te = tok + toksize;
+	for (; ti != te; ++ti)
+	{
+		rt ^= (unsigned char)*ti;
+		rt *= 16777619U;
+	}
+	return rt;
+}
+
+const std::string* NormalizerCache::get( const char* tok, std::size_t toksize)
+{
+	uint32_t hs = hash( tok, toksize);
+	const Entry& entry = m_ar[ hs & m_mask];
+	if (entry.used && entry.hash == hs && entry.key.size() == toksize
+	&&  0==std::memcmp( entry.key.c_str(), tok, toksize))
+	{
+		++m_hits;
+		return &entry.value;
+	}
+	++m_misses;
+	return 0;
+}
+
+void NormalizerCache::put( const char* tok, std::size_t toksize, const std::string& value)
+{
+	uint32_t hs = hash( tok, toksize);
+	Entry& entry = m_ar[ hs & m_mask];
+	entry.hash = hs;
+	entry.used = true;
+	entry.key.assign( tok, toksize);
+	entry.value = value;
+}
+
+NormalizerCacheMap::NormalizerCacheMap( const FeatureConfigMap& featureConfigMap)
+	:m_cacheAr(),m_featureCacheAr()
+{
+	// Size of the cache of a normalizer chain is the maximum size configured by the features using it:
+	std::vector<unsigned int> chainCacheSizeAr( featureConfigMap.nofNormalizerChains(), 0);
+	int fi = 1, fe = featureConfigMap.list().size()+1;
+	for (; fi != fe; ++fi)
+	{
+		unsigned int& chainCacheSize = chainCacheSizeAr[ featureConfigMap.normalizerChainId( fi)];
+		if (chainCacheSize < featureConfigMap.normalizerCacheSize( fi))
+		{
+			chainCacheSize = featureConfigMap.normalizerCacheSize( fi);
+		}
+	}
+	try
+	{
+		std::vector<int> chainCacheAr( chainCacheSizeAr.size(), -1);
+		std::vector<unsigned int>::const_iterator ci = chainCacheSizeAr.begin(), ce = chainCacheSizeAr.end();
+		for (int cidx=0; ci != ce; ++ci,++cidx)
+		{
+			if (*ci)
+			{
+				chainCacheAr[ cidx] = m_cacheAr.size();
+				m_cacheAr.reserve( m_cacheAr.size()+1);
+				m_cacheAr.push_back( new NormalizerCache( *ci));
+			}
+		}
+		m_featureCacheAr.reserve( featureConfigMap.list().size());
+		for (fi = 1; fi != fe; ++fi)
+		{
+			m_featureCacheAr.push_back( featureConfigMap.normalizerCacheSize( fi)
+					? chainCacheAr[ featureConfigMap.normalizerChainId( fi)] : -1);
+		}
+	}
+	catch (...)
+	{
+		std::vector<NormalizerCache*>::const_iterator ci = m_cacheAr.begin(), ce = m_cacheAr.end();
+		for (; ci != ce; ++ci) delete *ci;
+		throw;
+	}
+}
+
+NormalizerCacheMap::~NormalizerCacheMap()
+{
+	std::vector<NormalizerCache*>::const_iterator ci = m_cacheAr.begin(), ce = m_cacheAr.end();
+	for (; ci != ce; ++ci)
+	{
+		delete *ci;
+	}
+}
+
+void NormalizerCacheMap::fetchStatistics( int64_t& hits, int64_t& misses)
+{
+	hits = 0;
+	misses = 0;
+	std::vector<NormalizerCache*>::const_iterator ci = m_cacheAr.begin(), ce = m_cacheAr.end();
+	for (; ci != ce; ++ci)
+	{
+		hits += (*ci)->hits();
+		misses += (*ci)->misses();
+		(*ci)->resetStatistics();
+	}
+}
+
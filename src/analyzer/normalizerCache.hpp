@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Bounded cache for the results of normalizer chains of features
+/// \file normalizerCache.hpp
+#ifndef _STRUS_ANALYZER_NORMALIZER_CACHE_HPP_INCLUDED
+#define _STRUS_ANALYZER_NORMALIZER_CACHE_HPP_INCLUDED
+#include "strus/base/stdint.h"
+#include "strus/base/atomic.hpp"
+#include "strus/structView.hpp"
+#include <vector>
+#include <string>
+
+namespace strus
+{
+/// \brief Forward declaration
+class FeatureConfigMap;
+
+/// \brief Bounded cache mapping token values to the result of one normalizer chain
+/// \note Implemented as direct mapped hash table, an entry is replaced by a new entry with the same hash slot.
+///	Results are stored as returned by the normalizer chain, including multi value results ('\0' separated lists).
+class NormalizerCache
+{
+public:
+	/// \brief Constructor
+	/// \param[in] maxNofEntries maximum number of entries, rounded up to the next power of two
+	explicit NormalizerCache( std::size_t maxNofEntries);
+
+	/// \brief Get the cached result of a token
+	/// \return a pointer to the result or NULL if not found
+	const std::string* get( const char* tok, std::size_t toksize);
+
+	/// \brief Insert the result of a token
+	void put( const char* tok, std::size_t toksize, const std::string& value);
+
+	/// \brief Get the number of lookups with result found
+	int64_t hits() const				{return m_hits;}
+	/// \brief Get the number of lookups without result found
+	int64_t misses() const				{return m_misses;}
+	/// \brief Reset the hits and misses counters
+	void resetStatistics()				{m_hits = 0; m_misses = 0;}
+
+private:
+	static uint32_t hash( const char* tok, std::size_t toksize);
+
+	struct Entry
+	{
+		uint32_t hash;
+		bool used;
+		std::string key;
+		std::string value;
+
+		Entry()
+			:hash(0),used(false),key(),value(){}
+#if __cplusplus >= 201103L
+		Entry( Entry&& ) = default;
+		Entry( const Entry& ) = default;
+		Entry& operator= ( Entry&& ) = default;
+		Entry& operator= ( const Entry& ) = default;
+#else
+		Entry( const Entry& o)
+			:hash(o.hash),used(o.used),key(o.key),value(o.value){}
+#endif
+	};
+
+private:
+	std::vector<Entry> m_ar;
+	uint32_t m_mask;
+	int64_t m_hits;
+	int64_t m_misses;
+};
+
+/// \brief Set of normalizer caches of an analyzer context, one for every normalizer chain used by features with a cache configured
+class NormalizerCacheMap
+{
+public:
+	explicit NormalizerCacheMap( const FeatureConfigMap& featureConfigMap);
+	~NormalizerCacheMap();
+
+	/// \brief Get the cache to use for a feature
+	/// \return the cache or NULL if the feature has no cache configured
+	NormalizerCache* get( int featidx) const
+	{
+		int cacheidx = m_featureCacheAr[ featidx-1];
+		return cacheidx >= 0 ? m_cacheAr[ cacheidx] : 0;
+	}
+
+	/// \brief Test if any feature has a cache configured
+	bool empty() const
+	{
+		return m_cacheAr.empty();
+	}
+
+	/// \brief Get and reset the statistics of all caches
+	/// \param[out] hits number of lookups with result found since the last call
+	/// \param[out] misses number of lookups without result found since the last call
+	void fetchStatistics( int64_t& hits, int64_t& misses);
+
+private:
+	NormalizerCacheMap( const NormalizerCacheMap&){}	//... non copyable
+	void operator=( const NormalizerCacheMap&){}		//... non copyable
+
+private:
+	std::vector<NormalizerCache*> m_cacheAr;
+	std::vector<int> m_featureCacheAr;
+};
+
+/// \brief Hits and misses of the normalizer caches of all contexts of an analyzer instance
+class NormalizerCacheStatistics
+{
+public:
+	NormalizerCacheStatistics()
+		:m_hits(0),m_misses(0){}
+
+	/// \brief Add the statistics of a cache map collected since the last call
+	void collect( NormalizerCacheMap& cacheMap)
+	{
+		int64_t hits;
+		int64_t misses;
+		cacheMap.fetchStatistics( hits, misses);
+		if (hits) m_hits.increment( hits);
+		if (misses) m_misses.increment( misses);
+	}
+
+	StructView view() const
+	{
+		return StructView()
+			( "hits", (double)m_hits.value())
+			( "misses", (double)m_misses.value());
+	}
+
+private:
+	AtomicCounter<int64_t> m_hits;
+	AtomicCounter<int64_t> m_misses;
+};
+
+}//namespace
+#endif
+
@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Map of source positions (segment,offset) of terms to ordinal positions implemented with sorted flat arrays
+/// \file ordinalPositionMap.cpp
+#include "ordinalPositionMap.hpp"
+#include <algorithm>
+#include <cstring>
+
+using namespace strus;
+
+static inline uint64_t sortKey( uint64_t key)
+{
+	return key;
+}
+static inline uint64_t sortKey( const OrdinalPositionMap::Probe& probe)
+{
+	return probe.key;
+}
+struct SortKeyLess
+{
+	bool operator()( const OrdinalPositionMap::Probe& a, const OrdinalPositionMap::Probe& b) const
+	{
+		return a.key < b.key;
+	}
+	bool operator()( uint64_t a, uint64_t b) const
+	{
+		return a < b;
+	}
+};
+
+/// \brief LSD radix sort with 8 bit digits, skipping passes where all elements have the same digit
+template <class Element>
+static void radixSort( std::vector<Element>& ar, std::vector<Element>& buf)
+{
+	enum {NofDigitBits=8, NofBuckets=(1<<NofDigitBits), NofPasses=(64/NofDigitBits), MinRadixSortSize=64};
+	if (ar.size() < MinRadixSortSize)
+	{
+		std::sort( ar.begin(), ar.end(), SortKeyLess());
+		return;
+	}
+	buf.resize( ar.size());
+	std::size_t count[ NofBuckets];
+	for (int pass=0; pass < NofPasses; ++pass)
+	{
+		int shift = pass * NofDigitBits;
+		std::memset( count, 0, sizeof(count));
+		typename std::vector<Element>::const_iterator ai = ar.begin(), ae = ar.end();
+		for (; ai != ae; ++ai)
+		{
+			++count[ (sortKey(*ai) >> shift) & (NofBuckets-1)];
+		}
+		if (count[ (sortKey(ar[0]) >> shift) & (NofBuckets-1)] == ar.size())
+		{
+			continue; //... all elements have the same digit, nothing to do in this pass
+		}
+		std::size_t sum = 0;
+		for (int bi=0; bi < NofBuckets; ++bi)
+		{
+			std::size_t cnt = count[ bi];
+			count[ bi] = sum;
+			sum += cnt;
+		}
+		for (ai = ar.begin(); ai != ae; ++ai)
+		{
+			buf[ count[ (sortKey(*ai) >> shift) & (NofBuckets-1)]++] = *ai;
+		}
+		ar.swap( buf);
+	}
+}
+
+static void sortUnique( std::vector<uint64_t>& ar, std::vector<uint64_t>& buf)
+{
+	radixSort( ar, buf);
+	ar.erase( std::unique( ar.begin(), ar.end()), ar.end());
+}
+
+void OrdinalPositionMap::clear()
+{
+	m_content.clear();
+	m_unique.clear();
+	m_ar.clear();
+}
+
+void OrdinalPositionMap::collect( const std::vector<BindTerm>& terms)
+{
+	std::vector<BindTerm>::const_iterator ti = terms.begin(), te = terms.end();
+	for (; ti != te; ++ti)
+	{
+		if (ti->posbind() == analyzer::BindContent)
+		{
+			m_content.push_back( packPosition( ti->seg(), ti->ofs()+1));
+		}
+		else if (ti->posbind() == analyzer::BindUnique)
+		{
+			m_unique.push_back( packPosition( ti->seg(), ti->ofs()+1));
+		}
+	}
+}
+
+void OrdinalPositionMap::build()
+{
+	sortUnique( m_content, m_sortbuf);
+	sortUnique( m_unique, m_sortbuf);
+
+	// Merge the unique positions into the content positions:
+	// From every sequence of unique positions not separated by a content position take only the last one:
+	m_ar.clear();
+	m_ar.reserve( m_content.size() + m_unique.size());
+	std::vector<uint64_t>::const_iterator ci = m_content.begin(), ce = m_content.end();
+	std::vector<uint64_t>::const_iterator ui = m_unique.begin(), ue = m_unique.end();
+	for (; ci != ce; ++ci)
+	{
+		if (ui != ue && *ui <= *ci)
+		{
+			for (++ui; ui != ue && *ui <= *ci; ++ui){}
+			uint64_t lastinseq = *(ui-1);
+			if (lastinseq != *ci) m_ar.push_back( lastinseq);
+		}
+		m_ar.push_back( *ci);
+	}
+	if (ui != ue)
+	{
+		m_ar.push_back( m_unique.back());
+	}
+}
+
+void OrdinalPositionMap::assign( std::vector<unsigned int>& res, const std::vector<BindTerm>& terms)
+{
+	// [1] Build the lookup keys, all lookups are mapped to a lower bound search:
+	m_probes.clear();
+	m_probes.reserve( terms.size());
+	std::vector<BindTerm>::const_iterator ti = terms.begin(), te = terms.end();
+	for (unsigned int tidx=0; ti != te; ++ti,++tidx)
+	{
+		switch (ti->posbind())
+		{
+			case analyzer::BindContent:
+			case analyzer::BindUnique:
+			case analyzer::BindSuccessor:
+				// ... first position bigger than (seg,ofs)
+				m_probes.push_back( Probe( packPosition( ti->seg(), ti->ofs()+1), tidx));
+				break;
+			case analyzer::BindPredecessor:
+				// ... predecessor of the first position bigger than (seg,ofs+1)
+				m_probes.push_back( Probe( packPosition( ti->seg(), ti->ofs()+2), tidx));
+				break;
+		}
+	}
+	radixSort( m_probes, m_probebuf);
+
+	// [2] Assign the ordinal positions in one merge of the sorted lookup keys with the sorted positions:
+	res.assign( terms.size(), 0);
+	std::vector<Probe>::const_iterator pi = m_probes.begin(), pe = m_probes.end();
+	std::size_t aidx = 0, asize = m_ar.size();
+	for (; pi != pe; ++pi)
+	{
+		while (aidx < asize && m_ar[ aidx] < pi->key) ++aidx;
+		if (aidx == asize) break;
+
+		unsigned int ordpos = aidx + 1;
+		switch (terms[ pi->idx].posbind())
+		{
+			case analyzer::BindContent:
+				if (m_ar[ aidx] == pi->key)
+				{
+					res[ pi->idx] = ordpos;
+				}
+				break;
+			case analyzer::BindUnique:
+			case analyzer::BindSuccessor:
+				res[ pi->idx] = ordpos;
+				break;
+			case analyzer::BindPredecessor:
+				if (ordpos > 1)
+				{
+					res[ pi->idx] = ordpos - 1;
+				}
+				break;
+		}
+	}
+}
+
+unsigned int OrdinalPositionMap::ordinalPosition( const analyzer::Position& pos) const
+{
+	std::vector<uint64_t>::const_iterator
+		ai = std::lower_bound( m_ar.begin(), m_ar.end(), packPosition( pos.seg(), pos.ofs()));
+	return (ai - m_ar.begin()) + 1;
+}
+
+bool OrdinalPositionMap::assignSmallContent( std::vector<unsigned int>& res, const std::vector<BindTerm>& terms)
+{
+	if (terms.size() > MaxSmallContentSize) return false;
+
+	// The ordinal position of a term is the rank of its position in the sorted set of distinct positions,
+	// this set is built with an insertion sort:
+	uint64_t posar[ MaxSmallContentSize];
+	std::size_t possize = 0;
+	std::vector<BindTerm>::const_iterator ti = terms.begin(), te = terms.end();
+	for (; ti != te; ++ti)
+	{
+		if (ti->posbind() != analyzer::BindContent) return false;
+
+		uint64_t key = packPosition( ti->seg(), ti->ofs()+1);
+		std::size_t pidx = possize;
+		for (; pidx > 0 && posar[ pidx-1] > key; --pidx){}
+		if (pidx > 0 && posar[ pidx-1] == key) continue;
+		std::memmove( posar + pidx + 1, posar + pidx, (possize - pidx) * sizeof(uint64_t));
+		posar[ pidx] = key;
+		++possize;
+	}
+	res.resize( terms.size());
+	std::vector<unsigned int>::iterator oi = res.begin();
+	for (ti = terms.begin(); ti != te; ++ti,++oi)
+	{
+		uint64_t key = packPosition( ti->seg(), ti->ofs()+1);
+		*oi = (std::lower_bound( posar, posar + possize, key) - posar) + 1;
+	}
+	return true;
+}
+
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Map of source positions (segment,offset) of terms to ordinal positions implemented with sorted flat arrays
+/// \file ordinalPositionMap.hpp
+#ifndef _STRUS_ANALYZER_ORDINAL_POSITION_MAP_HPP_INCLUDED
+#define _STRUS_ANALYZER_ORDINAL_POSITION_MAP_HPP_INCLUDED
+#include "bindTerm.hpp"
+#include "strus/analyzer/position.hpp"
+#include "strus/base/stdint.h"
+#include <vector>
+
+namespace strus
+{
+
+/// \brief Map of source positions (segment,offset) of terms to ordinal positions
+/// \note Positions are packed into 64 bit integers and sorted with a radix sort.
+///	The assignment of ordinal positions to terms is done in a single linear merge.
+///	All buffers are kept between calls, so there are no allocations for an instance that is reused.
+class OrdinalPositionMap
+{
+public:
+	OrdinalPositionMap()
+		:m_content(),m_unique(),m_ar(),m_probes(),m_sortbuf(),m_probebuf(){}
+
+	/// \brief Reset the map for a new document
+	void clear();
+
+	/// \brief Collect the positions defined by terms with position bind content or unique
+	/// \param[in] terms list of terms
+	void collect( const std::vector<BindTerm>& terms);
+
+	/// \brief Build the map from the positions collected
+	void build();
+
+	/// \brief Assign ordinal positions to a list of terms
+	/// \param[out] res ordinal positions of the terms indexed like the list of terms, 0 for terms not bound to a position
+	/// \param[in] terms list of terms
+	void assign( std::vector<unsigned int>& res, const std::vector<BindTerm>& terms);
+
+	enum {MaxSmallContentSize=32};
+
+	/// \brief Assign ordinal positions to a small list of terms all bound to content, without building a map
+	/// \param[out] res ordinal positions of the terms indexed like the list of terms
+	/// \param[in] terms list of terms
+	/// \return false, if the list of terms has more than MaxSmallContentSize elements or contains terms not bound to content and nothing was assigned
+	/// \note Used for the few terms of a usual query, the distinct positions are sorted into an array on the stack
+	static bool assignSmallContent( std::vector<unsigned int>& res, const std::vector<BindTerm>& terms);
+
+	/// \brief Get the ordinal position of the first position in the map bigger or equal to a position
+	/// \param[in] pos source position
+	/// \return the ordinal position or size()+1 if there is no bigger or equal position in the map
+	unsigned int ordinalPosition( const analyzer::Position& pos) const;
+
+	/// \brief Get the number of distinct ordinal positions
+	std::size_t size() const
+	{
+		return m_ar.size();
+	}
+
+	static uint64_t packPosition( int seg, int ofs)
+	{
+		return ((uint64_t)(uint32_t)seg << 32) | (uint64_t)(uint32_t)ofs;
+	}
+
+public:
+	struct Probe
+	{
+		uint64_t key;
+		unsigned int idx;
+
+		Probe()
+			:key(0),idx(0){}
+		Probe( uint64_t key_, unsigned int idx_)
+			:key(key_),idx(idx_){}
+	};
+
+private:
+	std::vector<uint64_t> m_content;	///< positions of terms bound to content
+	std::vector<uint64_t> m_unique;		///< positions of terms with unique position bind
+	std::vector<uint64_t> m_ar;		///< sorted distinct positions, the ordinal position is the index + 1
+	std::vector<Probe> m_probes;		///< buffer for lookup keys of terms
+	std::vector<uint64_t> m_sortbuf;	///< buffer for sorting positions
+	std::vector<Probe> m_probebuf;		///< buffer for sorting lookup keys
+};
+
+}//namespace
+#endif
+
@@ -0,0 +1,270 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Parallel tokenization and normalization of the segments of big documents
+/// \file parallelSegmentProcessor.cpp
+#include "parallelSegmentProcessor.hpp"
+#include "strus/errorBufferInterface.hpp"
+#include "strus/base/thread.hpp"
+#include "private/errorUtils.hpp"
+#include "private/internationalization.hpp"
+#include <stdexcept>
+#include <new>
+
+using namespace strus;
+
+ParallelSegmentProcessor::ParallelSegmentProcessor(
+		const FeatureConfigMap& featureConfigMap_,
+		unsigned int nofThreads_,
+		ErrorBufferInterface* errorhnd_)
+	:m_featureConfigMap(&featureConfigMap_)
+	,m_nofThreads(nofThreads_ ? nofThreads_ : 1)
+	,m_items()
+	,m_content()
+	,m_lastSegmentPtr(0)
+	,m_processors()
+	,m_errors(m_nofThreads)
+	,m_ranges(m_nofThreads)
+	,m_workers()
+	,m_mutex()
+	,m_startCond()
+	,m_doneCond()
+	,m_jobcnt(0)
+	,m_nofRunning(0)
+	,m_terminate(false)
+	,m_errorhnd(errorhnd_)
+{
+	try
+	{
+		m_processors.reserve( m_nofThreads);
+		for (unsigned int pi=0; pi < m_nofThreads; ++pi)
+		{
+			m_processors.push_back( new SegmentProcessor( *m_featureConfigMap, m_errorhnd));
+		}
+	}
+	catch (...)
+	{
+		std::vector<SegmentProcessor*>::const_iterator pi = m_processors.begin(), pe = m_processors.end();
+		for (; pi != pe; ++pi) delete *pi;
+		throw;
+	}
+}
+
+ParallelSegmentProcessor::~ParallelSegmentProcessor()
+{
+	terminateWorkers();
+	std::vector<SegmentProcessor*>::const_iterator pi = m_processors.begin(), pe = m_processors.end();
+	for (; pi != pe; ++pi)
+	{
+		delete *pi;
+	}
+}
+
+void ParallelSegmentProcessor::clear()
+{
+	m_items.clear();
+	m_content.clear();
+	m_lastSegmentPtr = 0;
+	std::vector<SegmentProcessor*>::const_iterator pi = m_processors.begin(), pe = m_processors.end();
+	for (; pi != pe; ++pi)
+	{
+		(*pi)->clearTermMaps();
+	}
+}
+
+void ParallelSegmentProcessor::push( int featidx, std::size_t segmentpos, const char* segmentptr, std::size_t segmentsize, bool referenced)
+{
+	if (m_lastSegmentPtr == segmentptr
+	&&  m_items.back().segmentpos == segmentpos
+	&&  m_items.back().contentsize == segmentsize)
+	{
+		// ... same segment selected by another feature, share the content, so that the segment processor can share its tokenization
+		const Item& last = m_items.back();
+		m_items.push_back( Item( featidx, segmentpos, last.segmentptr, last.contentofs, segmentsize));
+	}
+	else if (referenced)
+	{
+		m_items.push_back( Item( featidx, segmentpos, segmentptr, 0, segmentsize));
+		m_lastSegmentPtr = segmentptr;
+	}
+	else
+	{
+		m_items.push_back( Item( featidx, segmentpos, 0, m_content.size(), segmentsize));
+		m_content.append( segmentptr, segmentsize);
+		m_lastSegmentPtr = segmentptr;
+	}
+}
+
+void ParallelSegmentProcessor::processRange( unsigned int workeridx)
+{
+	SegmentProcessor* processor = m_processors[ workeridx];
+	const Range& range = m_ranges[ workeridx];
+	try
+	{
+		std::vector<Item>::const_iterator ii = m_items.begin() + range.start, ie = m_items.begin() + range.end;
+		for (; ii != ie; ++ii)
+		{
+			const char* segmentptr = ii->segmentptr ? ii->segmentptr : (m_content.c_str() + ii->contentofs);
+			processor->processDocumentSegment( ii->featidx, ii->segmentpos, segmentptr, ii->contentsize);
+		}
+		if (m_errorhnd->hasError())
+		{
+			m_errors[ workeridx] = m_errorhnd->fetchError();
+		}
+	}
+	catch (const std::bad_alloc&)
+	{
+		m_errors[ workeridx] = _TXT("out of memory");
+	}
+	catch (const std::exception& err)
+	{
+		m_errors[ workeridx] = err.what();
+	}
+}
+
+void ParallelSegmentProcessor::runWorker( unsigned int workeridx)
+{
+	unsigned int jobcnt = 0;
+	for (;;)
+	{
+		{
+			strus::unique_lock lock( m_mutex);
+			while (!m_terminate && m_jobcnt == jobcnt)
+			{
+				m_startCond.wait( lock);
+			}
+			if (m_terminate) return;
+			jobcnt = m_jobcnt;
+		}
+		Range& range = m_ranges[ workeridx];
+		// ... the error context is only allocated while processing, because idle workers of many contexts would occupy the slots of the error buffer
+		if (range.start < range.end && m_errorhnd->allocContext())
+		{
+			processRange( workeridx);
+			m_errorhnd->releaseContext();
+			range.processed = true;
+		}
+		strus::scoped_lock lock( m_mutex);
+		if (--m_nofRunning == 0)
+		{
+			m_doneCond.notify_all();
+		}
+	}
+}
+
+void ParallelSegmentProcessor::startWorkers()
+{
+	try
+	{
+		m_workers.reserve( m_nofThreads-1);
+		for (unsigned int wi=1; wi < m_nofThreads; ++wi)
+		{
+			m_workers.push_back( new strus::thread( &ParallelSegmentProcessor::runWorker, this, wi));
+		}
+	}
+	catch (...)
+	{
+		terminateWorkers();
+		throw;
+	}
+}
+
+void ParallelSegmentProcessor::terminateWorkers()
+{
+	{
+		strus::scoped_lock lock( m_mutex);
+		m_terminate = true;
+		m_startCond.notify_all();
+	}
+	std::vector<strus::thread*>::iterator wi = m_workers.begin(), we = m_workers.end();
+	for (; wi != we; ++wi)
+	{
+		(*wi)->join();
+		delete *wi;
+	}
+	m_workers.clear();
+	m_terminate = false;
+}
+
+void ParallelSegmentProcessor::run( SegmentProcessor& dest)
+{
+	if (m_items.empty()) return;
+
+	// Split the segments into contiguous ranges of about equal size in bytes:
+	std::size_t totalsize = 0;
+	std::vector<Item>::const_iterator ii = m_items.begin(), ie = m_items.end();
+	for (; ii != ie; ++ii)
+	{
+		totalsize += ii->contentsize;
+	}
+	std::size_t rangesize = totalsize / m_nofThreads + 1;
+	std::size_t bytes = 0;
+	unsigned int nofRanges = 1;
+	m_ranges[ 0].start = 0;
+	ii = m_items.begin();
+	for (std::size_t iidx=0; ii != ie; ++ii,++iidx)
+	{
+		bytes += ii->contentsize;
+		if (bytes >= rangesize && nofRanges < m_nofThreads && iidx+1 < m_items.size())
+		{
+			m_ranges[ nofRanges-1].end = iidx+1;
+			m_ranges[ nofRanges++].start = iidx+1;
+			bytes = 0;
+		}
+	}
+	m_ranges[ nofRanges-1].end = m_items.size();
+	for (unsigned int ri=0; ri < m_nofThreads; ++ri)
+	{
+		if (ri >= nofRanges) m_ranges[ ri].start = m_ranges[ ri].end = 0;
+		m_ranges[ ri].processed = false;
+	}
+
+	// Process the first range in the calling thread, the others by the workers:
+	if (nofRanges > 1)
+	{
+		if (m_workers.empty())
+		{
+			startWorkers();
+		}
+		strus::scoped_lock lock( m_mutex);
+		m_nofRunning = m_workers.size();
+		++m_jobcnt;
+		m_startCond.notify_all();
+	}
+	processRange( 0);
+	if (nofRanges > 1)
+	{
+		strus::unique_lock lock( m_mutex);
+		while (m_nofRunning > 0)
+		{
+			m_doneCond.wait( lock);
+		}
+	}
+	// Process the ranges of workers that could not allocate an error buffer context in the calling thread:
+	for (unsigned int ri=1; ri < nofRanges; ++ri)
+	{
+		if (!m_ranges[ ri].processed) processRange( ri);
+	}
+	std::string errmsg;
+	std::vector<std::string>::iterator ei = m_errors.begin(), ee = m_errors.end();
+	for (; ei != ee; ++ei)
+	{
+		if (errmsg.empty()) errmsg.swap( *ei); else ei->clear();
+	}
+	if (!errmsg.empty())
+	{
+		clear();
+		throw strus::runtime_error( _TXT("error in parallel processing of document segments: %s"), errmsg.c_str());
+	}
+	// Append the results in the order of the ranges:
+	for (unsigned int ri=0; ri < nofRanges; ++ri)
+	{
+		dest.appendTerms( *m_processors[ ri]);
+	}
+	clear();
+}
+
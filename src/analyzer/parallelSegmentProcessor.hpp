@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Parallel tokenization and normalization of the segments of big documents
+/// \file parallelSegmentProcessor.hpp
+#ifndef _STRUS_ANALYZER_PARALLEL_SEGMENT_PROCESSOR_HPP_INCLUDED
+#define _STRUS_ANALYZER_PARALLEL_SEGMENT_PROCESSOR_HPP_INCLUDED
+#include "segmentProcessor.hpp"
+#include "featureConfigMap.hpp"
+#include "strus/base/thread.hpp"
+#include <vector>
+#include <string>
+
+namespace strus
+{
+/// \brief Forward declaration
+class ErrorBufferInterface;
+
+/// \brief Collects the segments of a document to process and processes them in parallel
+/// \note The segments are split into contiguous ranges of about equal size in bytes, one for every thread.
+///	Each thread processes its range with its own segment processor. The terms of the ranges are appended
+///	in the order of the ranges to the document segment processor, so the result is the same as
+///	with sequential processing. The worker threads are started with the first document processed
+///	and kept alive until the destruction of the processor.
+class ParallelSegmentProcessor
+{
+public:
+	ParallelSegmentProcessor(
+			const FeatureConfigMap& featureConfigMap_,
+			unsigned int nofThreads_,
+			ErrorBufferInterface* errorhnd_);
+	~ParallelSegmentProcessor();
+
+	/// \brief Reset the state for a new document
+	void clear();
+
+	/// \brief Add a segment to process
+	/// \param[in] referenced true, if the segment stays valid until the call of run (it points into the input referenced by the caller), the content is copied otherwise
+	void push( int featidx, std::size_t segmentpos, const char* segmentptr, std::size_t segmentsize, bool referenced);
+
+	/// \brief Get the number of segments collected
+	std::size_t size() const
+	{
+		return m_items.size();
+	}
+
+	/// \brief Process all segments collected, append the resulting terms to a segment processor and reset the state
+	/// \param[in,out] dest where to append the terms to
+	void run( SegmentProcessor& dest);
+
+private:
+	ParallelSegmentProcessor( const ParallelSegmentProcessor&){}	//... non copyable
+	void operator=( const ParallelSegmentProcessor&){}		//... non copyable
+
+	void processRange( unsigned int workeridx);
+	void startWorkers();
+	void terminateWorkers();
+	void runWorker( unsigned int workeridx);
+
+private:
+	struct Item
+	{
+		int featidx;
+		std::size_t segmentpos;
+		const char* segmentptr;		///< pointer to the segment if referenced, NULL if copied to m_content
+		std::size_t contentofs;		///< offset of the segment in m_content if copied
+		std::size_t contentsize;
+
+		Item( int featidx_, std::size_t segmentpos_, const char* segmentptr_, std::size_t contentofs_, std::size_t contentsize_)
+			:featidx(featidx_),segmentpos(segmentpos_),segmentptr(segmentptr_),contentofs(contentofs_),contentsize(contentsize_){}
+#if __cplusplus >= 201103L
+		Item( Item&& ) = default;
+		Item( const Item& ) = default;
+		Item& operator= ( Item&& ) = default;
+		Item& operator= ( const Item& ) = default;
+#else
+		Item( const Item& o)
+			:featidx(o.featidx),segmentpos(o.segmentpos),segmentptr(o.segmentptr),contentofs(o.contentofs),contentsize(o.contentsize){}
+#endif
+	};
+	/// \brief Range of items processed by one thread
+	struct Range
+	{
+		std::size_t start;
+		std::size_t end;
+		bool processed;		///< false if the worker could not process the range
+
+		Range()
+			:start(0),end(0),processed(false){}
+	};
+
+private:
+	const FeatureConfigMap* m_featureConfigMap;
+	unsigned int m_nofThreads;
+	std::vector<Item> m_items;
+	std::string m_content;				///< content of the segments not referenced
+	const char* m_lastSegmentPtr;			///< last segment pushed, for sharing the content of segments passed to multiple features
+	std::vector<SegmentProcessor*> m_processors;	///< one segment processor per thread, kept between documents
+	std::vector<std::string> m_errors;		///< one error message per thread, empty if no error occurred
+	std::vector<Range> m_ranges;			///< one range of items per thread, the first one processed by the thread calling run
+	std::vector<strus::thread*> m_workers;		///< worker threads processing the ranges 1..n, started on demand
+	strus::mutex m_mutex;
+	strus::condition_variable m_startCond;		///< signals a new job or the termination to the workers
+	strus::condition_variable m_doneCond;		///< signals the completion of a job by all workers
+	unsigned int m_jobcnt;				///< counter of the jobs started, protected by m_mutex
+	unsigned int m_nofRunning;			///< number of workers still processing the current job, protected by m_mutex
+	bool m_terminate;				///< true if the workers have to terminate, protected by m_mutex
+	ErrorBufferInterface* m_errorhnd;
+};
+
+}//namespace
+#endif
+
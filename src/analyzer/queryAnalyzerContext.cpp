@@ -23,6 +23,7 @@
 #include <iostream>
 #include <sstream>
 #include <algorithm>
+#include <cstdio>
 
 #define STRUS_DBGTRACE_COMPONENT_NAME "analyzer"
 #define DEBUG_OPEN( NAME) if (m_debugtrace) m_debugtrace->open( NAME);
@@ -41,9 +42,15 @@ using namespace strus;
 QueryAnalyzerContext::QueryAnalyzerContext( const QueryAnalyzerInstance* analyzer_, ErrorBufferInterface* errorhnd_)
 	:m_analyzer(analyzer_)
 	,m_fields(),m_groups()
+	,m_normalizerCacheMap(analyzer_->featureConfigMap())
+	,m_segmentProcessor(analyzer_->featureConfigMap(),errorhnd_)
 	,m_errorhnd(errorhnd_)
 	,m_debugtrace(0)
 {
+	if (!m_normalizerCacheMap.empty())
+	{
+		m_segmentProcessor.setNormalizerCache( &m_normalizerCacheMap);
+	}
 	DebugTraceInterface* dbgi = m_errorhnd->debugTrace();
 	if (dbgi) m_debugtrace = dbgi->createTraceContext( STRUS_DBGTRACE_COMPONENT_NAME);
 }
@@ -438,34 +445,31 @@ static QueryTree buildQueryTree(
 }
 
 
-std::vector<SegmentProcessor::QueryElement> QueryAnalyzerContext::analyzeQueryFields() const
+void QueryAnalyzerContext::analyzeQueryFields( std::vector<SegmentProcessor::QueryElement>& res)
 {
-	typedef QueryAnalyzerInstance::FieldTypeFeatureMap FieldTypeFeatureMap;
-
-	SegmentProcessor segmentProcessor( m_analyzer->featureConfigMap(), m_errorhnd);
+	m_segmentProcessor.clearTermMaps();
 
 	std::vector<Field>::const_iterator fi = m_fields.begin(), fe = m_fields.end();
-	unsigned int fidx=0;
-	for (fidx=0; fi != fe; ++fi,++fidx)
+	for (; fi != fe; ++fi)
 	{
-		std::pair<FieldTypeFeatureMap::const_iterator,FieldTypeFeatureMap::const_iterator>
-			range = m_analyzer->fieldTypeFeatureMap().equal_range( fi->fieldType);
-		FieldTypeFeatureMap::const_iterator ti = range.first, te = range.second;
-		if (ti == te)
+		QueryFieldTypeMap::FeatureRange range = m_analyzer->fieldTypeMap().find( fi->fieldType);
+		if (range.empty())
 		{
 			throw strus::runtime_error_ec( ErrorCodeUnknownIdentifier, _TXT("analyzer query field '%s' is undefined"), fi->fieldType.c_str());
 		}
-		else
+		const int* ti = range.begin;
+		for (; ti != range.end; ++ti)
 		{
-			for (;ti != te; ++ti)
-			{
-				segmentProcessor.processDocumentSegment(
-					ti->second/*feature type index*/, fi->fieldNo/*segment pos = fieldNo*/, 
-					fi->content.c_str(), fi->content.size());
-			}
+			m_segmentProcessor.processDocumentSegment(
+				*ti/*feature type index*/, fi->fieldNo/*segment pos = fieldNo*/, 
+				fi->content.c_str(), fi->content.size());
 		}
 	}
-	return segmentProcessor.fetchQuery();
+	if (!m_normalizerCacheMap.empty())
+	{
+		m_analyzer->normalizerCacheStatistics().collect( m_normalizerCacheMap);
+	}
+	m_segmentProcessor.fetchQuery( res);
 }
 
 static void buildQueryInstructions( analyzer::QueryTermExpression& qry, const std::vector<SegmentProcessor::QueryElement>& elems, const QueryTree& queryTree, unsigned int nodeidx)
@@ -520,73 +524,142 @@ static void eliminateCoveredElements( std::vector<SegmentProcessor::QueryElement
 	elems = rt;
 }
 
+static void appendKeyNumber( std::string& dest, int num)
+{
+	char numbuf[ 32];
+	std::snprintf( numbuf, sizeof(numbuf), "%d:", num);
+	dest.append( numbuf);
+}
+
+static void appendKeyString( std::string& dest, const std::string& str)
+{
+	appendKeyNumber( dest, str.size());
+	dest.append( str);
+}
+
+std::string QueryAnalyzerContext::resultCacheKey() const
+{
+	// ... all arguments of the putField and groupElements calls in the order of the calls, strings prefixed by their size
+	std::string rt;
+	std::vector<Field>::const_iterator fi = m_fields.begin(), fe = m_fields.end();
+	for (; fi != fe; ++fi)
+	{
+		rt.push_back( 'F');
+		appendKeyNumber( rt, fi->fieldNo);
+		appendKeyString( rt, fi->fieldType);
+		appendKeyString( rt, fi->content);
+	}
+	std::vector<Group>::const_iterator gi = m_groups.begin(), ge = m_groups.end();
+	for (; gi != ge; ++gi)
+	{
+		rt.push_back( 'G');
+		appendKeyNumber( rt, gi->groupId);
+		appendKeyNumber( rt, (int)gi->groupBy);
+		appendKeyNumber( rt, gi->groupSingle ? 1:0);
+		appendKeyNumber( rt, gi->fieldNoList.size());
+		std::vector<int>::const_iterator ni = gi->fieldNoList.begin(), ne = gi->fieldNoList.end();
+		for (; ni != ne; ++ni)
+		{
+			appendKeyNumber( rt, *ni);
+		}
+	}
+	return rt;
+}
+
 analyzer::QueryTermExpression QueryAnalyzerContext::analyze()
 {
 	try
 	{
-		DEBUG_OPEN( "analyze");
-		analyzer::QueryTermExpression rt;
-		std::vector<SegmentProcessor::QueryElement> elems = analyzeQueryFields();
+		QueryAnalyzerResultCache& cache = m_analyzer->resultCache();
+		if (cache.enabled())
+		{
+			analyzer::QueryTermExpression rt;
+			std::string key = resultCacheKey();
+			if (cache.find( key, rt))
+			{
+				DEBUG_EVENT2( "result-cache", "%s %d", "hit", (int)rt.instructions().size());
+				return rt;
+			}
+			rt = analyzeQuery();
+			if (!m_errorhnd->hasError())
+			{
+				// ... errors of normalizers are reported without exception, a result of a failed analysis is not cached
+				cache.insert( key, rt);
+			}
+			return rt;
+		}
+		else
+		{
+			return analyzeQuery();
+		}
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error analyzing query: %s"), *m_errorhnd, analyzer::QueryTermExpression());
+}
 
-		eliminateCoveredElements( elems);
-		if (m_groups.empty())
+analyzer::QueryTermExpression QueryAnalyzerContext::analyzeQuery()
+{
+	DEBUG_OPEN( "analyze");
+	analyzer::QueryTermExpression rt;
+	std::vector<SegmentProcessor::QueryElement> elems;
+	analyzeQueryFields( elems);
+
+	eliminateCoveredElements( elems);
+	if (m_groups.empty())
+	{
+		// Groups are empty, so we just copy the elements into the instructions
+		// and avoid building the query tree for the same result:
+		std::vector<SegmentProcessor::QueryElement>::const_iterator
+			ei = elems.begin(), ee = elems.end();
+		for ( ;ei!=ee; ++ei)
 		{
-			// Groups are empty, so we just copy the elements into the instructions
-			// and avoid building the query tree for the same result:
+			rt.pushTerm( *ei);
+		}
+	}
+	else
+	{
+		if (m_debugtrace)
+		{
+			DEBUG_OPEN( "elements");
 			std::vector<SegmentProcessor::QueryElement>::const_iterator
 				ei = elems.begin(), ee = elems.end();
 			for ( ;ei!=ee; ++ei)
 			{
-				rt.pushTerm( *ei);
+				DEBUG_EVENT5( "elem", "type='%s' value='%s' len='%d' fieldno=%d pos=%u",
+						ei->type().c_str(), ei->value().c_str(), ei->len(), ei->fieldno(), ei->pos());
 			}
+			DEBUG_CLOSE();
 		}
-		else
+		QueryTree queryTree = buildQueryTree( m_groups, m_fields, elems, m_debugtrace);
+		std::vector<unsigned int>::const_iterator ri = queryTree.root.begin(), re = queryTree.root.end();
+		for (; ri != re; ++ri)
 		{
-			if (m_debugtrace)
-			{
-				DEBUG_OPEN( "elements");
-				std::vector<SegmentProcessor::QueryElement>::const_iterator
-					ei = elems.begin(), ee = elems.end();
-				for ( ;ei!=ee; ++ei)
-				{
-					DEBUG_EVENT5( "elem", "type='%s' value='%s' len='%d' fieldno=%d pos=%u",
-							ei->type().c_str(), ei->value().c_str(), ei->len(), ei->fieldno(), ei->pos());
-				}
-				DEBUG_CLOSE();
-			}
-			QueryTree queryTree = buildQueryTree( m_groups, m_fields, elems, m_debugtrace);
-			std::vector<unsigned int>::const_iterator ri = queryTree.root.begin(), re = queryTree.root.end();
-			for (; ri != re; ++ri)
-			{
-				buildQueryInstructions( rt, elems, queryTree, *ri);
-			}
+			buildQueryInstructions( rt, elems, queryTree, *ri);
 		}
-		if (m_debugtrace)
+	}
+	if (m_debugtrace)
+	{
+		DEBUG_OPEN( "instructions");
+		std::vector<analyzer::QueryTermExpression::Instruction>::const_iterator
+			pi = rt.instructions().begin(), pe = rt.instructions().end();
+		for (; pi != pe; ++pi)
 		{
-			DEBUG_OPEN( "instructions");
-			std::vector<analyzer::QueryTermExpression::Instruction>::const_iterator
-				pi = rt.instructions().begin(), pe = rt.instructions().end();
-			for (; pi != pe; ++pi)
+			switch (pi->opCode())
 			{
-				switch (pi->opCode())
+				case analyzer::QueryTermExpression::Instruction::Term:
 				{
-					case analyzer::QueryTermExpression::Instruction::Term:
-					{
-						const analyzer::QueryTerm& term = rt.term( pi->idx());
-						DEBUG_EVENT2( "term", "type='%s' value='%s'", term.type().c_str(), term.value().c_str());
-						break;
-					}
-					case analyzer::QueryTermExpression::Instruction::Operator:
-						DEBUG_EVENT2( "operator", "%d %d", pi->idx(), pi->nofOperands());
-						break;
+					const analyzer::QueryTerm& term = rt.term( pi->idx());
+					DEBUG_EVENT2( "term", "type='%s' value='%s'", term.type().c_str(), term.value().c_str());
+					break;
 				}
+				case analyzer::QueryTermExpression::Instruction::Operator:
+					DEBUG_EVENT2( "operator", "%d %d", pi->idx(), pi->nofOperands());
+					break;
 			}
-			DEBUG_CLOSE();
 		}
 		DEBUG_CLOSE();
-		return rt;
 	}
-	CATCH_ERROR_MAP_RETURN( _TXT("error analyzing query: %s"), *m_errorhnd, analyzer::QueryTermExpression());
+	DEBUG_CLOSE();
+	return rt;
 }
 
 
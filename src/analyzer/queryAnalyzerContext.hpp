@@ -11,6 +11,7 @@
 #define _STRUS_ANALYZER_QUERY_ANALYZER_CONTEXT_IMPLEMENTATION_HPP_INCLUDED
 #include "strus/queryAnalyzerContextInterface.hpp"
 #include "segmentProcessor.hpp"
+#include "normalizerCache.hpp"
 #include <vector>
 #include <string>
 
@@ -40,7 +41,9 @@ public:
 	virtual analyzer::QueryTermExpression analyze();
 
 private:
-	std::vector<SegmentProcessor::QueryElement> analyzeQueryFields() const;
+	void analyzeQueryFields( std::vector<SegmentProcessor::QueryElement>& res);
+	analyzer::QueryTermExpression analyzeQuery();
+	std::string resultCacheKey() const;
 
 public:
 	struct Field
@@ -81,6 +84,8 @@ private:
 	const QueryAnalyzerInstance* m_analyzer;
 	std::vector<Field> m_fields;
 	std::vector<Group> m_groups;
+	NormalizerCacheMap m_normalizerCacheMap;	///< cache for normalization results, kept between queries
+	SegmentProcessor m_segmentProcessor;		///< processor of the query fields, buffers kept between queries
 	ErrorBufferInterface* m_errorhnd;
 	DebugTraceContextInterface* m_debugtrace;
 };
@@ -31,12 +31,43 @@ void QueryAnalyzerInstance::addElement(
 	try
 	{
 		unsigned int featidx = m_featureConfigMap.defineFeature( FeatSearchIndexTerm, termtype, fieldtype, tokenizer, normalizers, priority, analyzer::FeatureOptions());
-		m_fieldTypeFeatureMap.insert( FieldTypeFeatureDef( fieldtype, featidx));
+		m_fieldTypeMap.define( fieldtype, featidx);
 		m_searchIndexTermTypeSet.insert( string_conv::tolower( termtype));
+		m_resultCache.clear();
 	}
 	CATCH_ERROR_MAP( _TXT("error adding feature: %s"), *m_errorhnd);
 }
 
+void QueryAnalyzerInstance::defineNormalizerCache( const std::string& termtype, unsigned int maxNofEntries)
+{
+	try
+	{
+		std::string termtypeId = string_conv::tolower( termtype);
+		if (m_searchIndexTermTypeSet.find( termtypeId) == m_searchIndexTermTypeSet.end())
+		{
+			throw strus::runtime_error_ec( ErrorCodeUnknownIdentifier, _TXT("undefined query term type '%s'"), termtype.c_str());
+		}
+		std::vector<FeatureConfig>::const_iterator fi = m_featureConfigMap.begin(), fe = m_featureConfigMap.end();
+		for (int featidx=1; fi != fe; ++fi,++featidx)
+		{
+			if (fi->name() == termtypeId)
+			{
+				m_featureConfigMap.defineNormalizerCacheSize( featidx, maxNofEntries);
+			}
+		}
+	}
+	CATCH_ERROR_MAP( _TXT("error defining normalizer cache: %s"), *m_errorhnd);
+}
+
+void QueryAnalyzerInstance::defineResultCache( std::size_t maxMemory)
+{
+	try
+	{
+		m_resultCache.configure( maxMemory);
+	}
+	CATCH_ERROR_MAP( _TXT("error defining query analyzer result cache: %s"), *m_errorhnd);
+}
+
 std::vector<std::string> QueryAnalyzerInstance::queryTermTypes() const
 {
 	try
@@ -114,7 +145,16 @@ StructView QueryAnalyzerInstance::view() const
 					break;
 			}
 		}
-		return analyzer::QueryAnalyzerView( elements, patternLexems);
+		StructView rt = analyzer::QueryAnalyzerView( elements, patternLexems);
+		if (m_featureConfigMap.hasNormalizerCache())
+		{
+			rt( "normalizercache", m_normalizerCacheStatistics.view());
+		}
+		if (m_resultCache.enabled())
+		{
+			rt( "resultcache", m_resultCache.view());
+		}
+		return rt;
 	}
 	CATCH_ERROR_MAP_RETURN( _TXT("error in query analyzer create view: %s"), *m_errorhnd, StructView());
 }
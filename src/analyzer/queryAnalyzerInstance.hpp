@@ -12,6 +12,9 @@
 #include "strus/tokenizerFunctionInstanceInterface.hpp"
 #include "strus/analyzer/token.hpp"
 #include "featureConfigMap.hpp"
+#include "normalizerCache.hpp"
+#include "queryAnalyzerResultCache.hpp"
+#include "queryFieldTypeMap.hpp"
 #include <vector>
 #include <string>
 #include <utility>
@@ -30,8 +33,10 @@ class QueryAnalyzerInstance
 public:
 	explicit QueryAnalyzerInstance( ErrorBufferInterface* errorhnd)
 		:m_featureConfigMap()
-		,m_fieldTypeFeatureMap()
+		,m_fieldTypeMap()
 		,m_searchIndexTermTypeSet()
+		,m_normalizerCacheStatistics()
+		,m_resultCache()
 		,m_errorhnd(errorhnd){}
 	virtual ~QueryAnalyzerInstance(){}
 
@@ -42,6 +47,10 @@ public:
 			const std::vector<NormalizerFunctionInstanceInterface*>& normalizers,
 			int priority);
 
+	virtual void defineNormalizerCache( const std::string& termtype, unsigned int maxNofEntries);
+
+	virtual void defineResultCache( std::size_t maxMemory);
+
 	virtual std::vector<std::string> queryTermTypes() const;
 
 	virtual std::vector<std::string> queryFieldTypes() const;
@@ -51,17 +60,19 @@ public:
 	virtual StructView view() const;
 
 public:/*QueryAnalyzerContext*/
-	typedef std::pair<std::string,int> FieldTypeFeatureDef;
-	typedef std::multimap<std::string,int> FieldTypeFeatureMap;
 	typedef std::set<std::string> TermTypeSet;
 
 	const FeatureConfigMap& featureConfigMap() const				{return m_featureConfigMap;}
-	const FieldTypeFeatureMap& fieldTypeFeatureMap() const				{return m_fieldTypeFeatureMap;}
+	const QueryFieldTypeMap& fieldTypeMap() const					{return m_fieldTypeMap;}
+	NormalizerCacheStatistics& normalizerCacheStatistics() const			{return m_normalizerCacheStatistics;}
+	QueryAnalyzerResultCache& resultCache() const					{return m_resultCache;}
 
 private:
 	FeatureConfigMap m_featureConfigMap;
-	FieldTypeFeatureMap m_fieldTypeFeatureMap;
+	QueryFieldTypeMap m_fieldTypeMap;
 	TermTypeSet m_searchIndexTermTypeSet;
+	mutable NormalizerCacheStatistics m_normalizerCacheStatistics;
+	mutable QueryAnalyzerResultCache m_resultCache;
 	ErrorBufferInterface* m_errorhnd;
 };
 
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Cache for the results of query analysis shared by all contexts of a query analyzer
+/// \file queryAnalyzerResultCache.cpp
+#include "queryAnalyzerResultCache.hpp"
+
+using namespace strus;
+
+#define ENTRY_MEMORY_OVERHEAD 128
+
+uint32_t QueryAnalyzerResultCache::hash( const std::string& key)
+{
+	// FNV-1a
+	uint32_t rt = 2166136261U;
+	std::string::const_iterator ki = key.begin(), ke = key.end();
+	for (; ki != ke; ++ki)
+	{
+		rt ^= (unsigned char)*ki;
+		rt *= 16777619U;
+	}
+	return rt;
+}
+
+std::size_t QueryAnalyzerResultCache::memoryUsage( const std::string& key, const analyzer::QueryTermExpression& value)
+{
+	// ... the key is stored twice, in the map and in the entry
+	std::size_t rt = ENTRY_MEMORY_OVERHEAD + 2 * key.size();
+	rt += value.instructions().size() * sizeof( analyzer::QueryTermExpression::Instruction);
+	std::vector<analyzer::QueryTermExpression::Instruction>::const_iterator
+		ii = value.instructions().begin(), ie = value.instructions().end();
+	for (; ii != ie; ++ii)
+	{
+		if (ii->opCode() == analyzer::QueryTermExpression::Instruction::Term)
+		{
+			const analyzer::QueryTerm& term = value.term( ii->idx());
+			rt += sizeof( analyzer::QueryTerm) + term.type().size() + term.value().size();
+		}
+	}
+	return rt;
+}
+
+void QueryAnalyzerResultCache::configure( std::size_t maxMemory)
+{
+	clear();
+	m_hits.set( 0);
+	m_misses.set( 0);
+	m_maxMemory = maxMemory;
+}
+
+void QueryAnalyzerResultCache::clear()
+{
+	for (int si=0; si < NofShards; ++si)
+	{
+		Shard& shard = m_shards[ si];
+		strus::scoped_lock lock( shard.mutex);
+		shard.lru.clear();
+		shard.map.clear();
+		shard.memory = 0;
+	}
+}
+
+bool QueryAnalyzerResultCache::find( const std::string& key, analyzer::QueryTermExpression& result)
+{
+	Shard& shard = m_shards[ hash( key) % NofShards];
+	{
+		strus::scoped_lock lock( shard.mutex);
+		EntryMap::iterator mi = shard.map.find( key);
+		if (mi != shard.map.end())
+		{
+			shard.lru.splice( shard.lru.begin(), shard.lru, mi->second);
+			result = mi->second->value;
+			m_hits.increment();
+			return true;
+		}
+	}
+	m_misses.increment();
+	return false;
+}
+
+void QueryAnalyzerResultCache::insert( const std::string& key, const analyzer::QueryTermExpression& result)
+{
+	std::size_t maxShardMemory = m_maxMemory / NofShards;
+	std::size_t memsize = memoryUsage( key, result);
+	if (memsize > maxShardMemory) return;
+
+	Shard& shard = m_shards[ hash( key) % NofShards];
+	strus::scoped_lock lock( shard.mutex);
+	if (shard.map.find( key) != shard.map.end())
+	{
+		// ... inserted by another thread analyzing the same query
+		return;
+	}
+	while (!shard.lru.empty() && shard.memory + memsize > maxShardMemory)
+	{
+		Entry& last = shard.lru.back();
+		shard.memory -= last.memsize;
+		shard.map.erase( last.key);
+		shard.lru.pop_back();
+	}
+	shard.lru.push_front( Entry( key, result, memsize));
+	try
+	{
+		shard.map[ key] = shard.lru.begin();
+	}
+	catch (const std::bad_alloc&)
+	{
+		shard.lru.pop_front();
+		throw;
+	}
+	shard.memory += memsize;
+}
+
+StructView QueryAnalyzerResultCache::view() const
+{
+	int64_t nofEntries = 0;
+	int64_t memory = 0;
+	for (int si=0; si < NofShards; ++si)
+	{
+		strus::scoped_lock lock( m_shards[ si].mutex);
+		nofEntries += m_shards[ si].map.size();
+		memory += m_shards[ si].memory;
+	}
+	return StructView()
+		( "hits", (double)m_hits.value())
+		( "misses", (double)m_misses.value())
+		( "entries", (double)nofEntries)
+		( "memory", (double)memory)
+		( "maxmemory", (double)m_maxMemory);
+}
+
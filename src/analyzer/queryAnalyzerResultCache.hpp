@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Cache for the results of query analysis shared by all contexts of a query analyzer
+/// \file queryAnalyzerResultCache.hpp
+#ifndef _STRUS_ANALYZER_QUERY_ANALYZER_RESULT_CACHE_HPP_INCLUDED
+#define _STRUS_ANALYZER_QUERY_ANALYZER_RESULT_CACHE_HPP_INCLUDED
+#include "strus/analyzer/queryTermExpression.hpp"
+#include "strus/base/stdint.h"
+#include "strus/base/atomic.hpp"
+#include "strus/base/thread.hpp"
+#include "strus/structView.hpp"
+#include <string>
+#include <list>
+#include <map>
+#include <cstddef>
+
+namespace strus
+{
+
+/// \brief Thread safe LRU cache mapping the canonical description of a query to the result of its analysis
+/// \note The cache is split into shards selected by a hash of the key, each with its own lock and LRU list,
+///	so that concurrent lookups of different queries rarely wait for each other.
+///	The memory budget is split equally among the shards, the least recently used entries of a shard are evicted when it is exceeded.
+class QueryAnalyzerResultCache
+{
+public:
+	enum {NofShards=16};
+
+	QueryAnalyzerResultCache()
+		:m_hits(0),m_misses(0),m_maxMemory(0){}
+
+	/// \brief Define the memory budget of the cache, clearing its content and statistics
+	/// \param[in] maxMemory maximum memory used by the entries in bytes (estimated), 0 for disabling the cache
+	void configure( std::size_t maxMemory);
+
+	/// \brief Remove all entries, e.g. after a change of the query analyzer configuration
+	void clear();
+
+	/// \brief Test if the cache is enabled
+	bool enabled() const
+	{
+		return m_maxMemory != 0;
+	}
+
+	/// \brief Find the result of a query
+	/// \param[in] key canonical description of the query
+	/// \param[out] result the analysis result found
+	/// \return true if found
+	bool find( const std::string& key, analyzer::QueryTermExpression& result);
+
+	/// \brief Insert the result of a query, evicting the least recently used entries if needed
+	/// \param[in] key canonical description of the query
+	/// \param[in] result the analysis result
+	void insert( const std::string& key, const analyzer::QueryTermExpression& result);
+
+	/// \brief Get the statistics of the cache for introspection
+	StructView view() const;
+
+private:
+	QueryAnalyzerResultCache( const QueryAnalyzerResultCache&){}	//... non copyable
+	void operator=( const QueryAnalyzerResultCache&){}		//... non copyable
+
+	struct Entry
+	{
+		std::string key;
+		analyzer::QueryTermExpression value;
+		std::size_t memsize;
+
+		Entry( const std::string& key_, const analyzer::QueryTermExpression& value_, std::size_t memsize_)
+			:key(key_),value(value_),memsize(memsize_){}
+#if __cplusplus >= 201103L
+		Entry( Entry&& ) = default;
+		Entry( const Entry& ) = default;
+		Entry& operator= ( Entry&& ) = default;
+		Entry& operator= ( const Entry& ) = default;
+#else
+		Entry( const Entry& o)
+			:key(o.key),value(o.value),memsize(o.memsize){}
+#endif
+	};
+	typedef std::list<Entry> LruList;
+	typedef std::map<std::string,LruList::iterator> EntryMap;
+
+	struct Shard
+	{
+		strus::mutex mutex;
+		LruList lru;			///< entries, most recently used first
+		EntryMap map;			///< map of the keys to the entries
+		std::size_t memory;		///< estimated memory used by the entries
+
+		Shard()
+			:mutex(),lru(),map(),memory(0){}
+	};
+
+	static uint32_t hash( const std::string& key);
+	static std::size_t memoryUsage( const std::string& key, const analyzer::QueryTermExpression& value);
+
+private:
+	mutable Shard m_shards[ NofShards];
+	AtomicCounter<int64_t> m_hits;
+	AtomicCounter<int64_t> m_misses;
+	std::size_t m_maxMemory;
+};
+
+}//namespace
+#endif
+
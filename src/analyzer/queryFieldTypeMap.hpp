@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Map of query field types to the features processing them, compiled to flat arrays
+/// \file queryFieldTypeMap.hpp
+#ifndef _STRUS_ANALYZER_QUERY_FIELD_TYPE_MAP_HPP_INCLUDED
+#define _STRUS_ANALYZER_QUERY_FIELD_TYPE_MAP_HPP_INCLUDED
+#include <vector>
+#include <string>
+#include <algorithm>
+
+namespace strus
+{
+
+/// \brief Map of query field types to the indices of the features (in FeatureConfigMap) processing them
+/// \note The field types are kept sorted, the features of a field type are stored in one contiguous array
+///	in the order of their definition. The map is built once with the query analyzer configuration,
+///	a lookup is a binary search without any allocation.
+class QueryFieldTypeMap
+{
+public:
+	QueryFieldTypeMap()
+		:m_types(),m_start(1,0),m_features(){}
+
+	/// \brief Range of feature indices of a field type
+	struct FeatureRange
+	{
+		const int* begin;
+		const int* end;
+
+		FeatureRange()
+			:begin(0),end(0){}
+		FeatureRange( const int* begin_, const int* end_)
+			:begin(begin_),end(end_){}
+
+		bool empty() const	{return begin == end;}
+	};
+
+	/// \brief Add a feature processing a field type
+	/// \param[in] fieldtype name of the field type
+	/// \param[in] featidx index of the feature in the FeatureConfigMap
+	void define( const std::string& fieldtype, int featidx)
+	{
+		std::vector<std::string>::iterator ti = std::lower_bound( m_types.begin(), m_types.end(), fieldtype);
+		std::size_t typeidx = ti - m_types.begin();
+		if (ti == m_types.end() || *ti != fieldtype)
+		{
+			m_types.insert( ti, fieldtype);
+			m_start.insert( m_start.begin() + typeidx + 1, m_start[ typeidx]);
+		}
+		m_features.insert( m_features.begin() + m_start[ typeidx+1], featidx);
+		std::vector<int>::iterator si = m_start.begin() + typeidx + 1, se = m_start.end();
+		for (; si != se; ++si) ++*si;
+	}
+
+	/// \brief Get the features processing a field type
+	/// \param[in] fieldtype name of the field type
+	/// \return the range of feature indices, empty if the field type is not defined
+	FeatureRange find( const std::string& fieldtype) const
+	{
+		std::vector<std::string>::const_iterator ti = std::lower_bound( m_types.begin(), m_types.end(), fieldtype);
+		if (ti == m_types.end() || *ti != fieldtype) return FeatureRange();
+		std::size_t typeidx = ti - m_types.begin();
+		const int* base = &m_features[0];
+		return FeatureRange( base + m_start[ typeidx], base + m_start[ typeidx+1]);
+	}
+
+private:
+	std::vector<std::string> m_types;	///< sorted list of field types
+	std::vector<int> m_start;		///< start of the features of each field type in m_features, one element more than m_types
+	std::vector<int> m_features;		///< indices of the features grouped by field type
+};
+
+}//namespace
+#endif
+
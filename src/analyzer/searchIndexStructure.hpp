@@ -13,6 +13,10 @@
 #include "strus/structView.hpp"
 #include <vector>
 #include <string>
+#include <map>
+#include <algorithm>
+
+#define FIELD_ID_SEPARATOR ','
 
 namespace strus
 {
@@ -117,11 +121,36 @@ private:
 	Type m_structureType;
 };
 
+/// \brief Map of field id strings of a document to integers, ids are resolved when assigned to a field
+class SearchIndexFieldIdMap
+{
+public:
+	SearchIndexFieldIdMap()
+		:m_map(){}
+
+	/// \brief Get the integer assigned to an id string, assign a new one if not defined yet
+	/// \return the integer id, starting with 1 (0 is reserved for fields without id)
+	int get( const char* id, std::size_t idsize)
+	{
+		std::pair<std::map<std::string,int>::iterator,bool> ins
+			= m_map.insert( std::pair<std::string,int>( std::string( id, idsize), m_map.size()+1));
+		return ins.first->second;
+	}
+
+	void clear()
+	{
+		m_map.clear();
+	}
+
+private:
+	std::map<std::string,int> m_map;
+};
+
 class SearchIndexField
 {
 public:
 	SearchIndexField( int configIdx_, int scopeIdx_)
-		:m_configIdx(configIdx_),m_scopeIdx(scopeIdx_),m_id(),m_start(),m_end(){}
+		:m_configIdx(configIdx_),m_scopeIdx(scopeIdx_),m_id(),m_idlist(),m_start(),m_end(){}
 #if __cplusplus >= 201103L
 	SearchIndexField( SearchIndexField&& ) = default;
 	SearchIndexField( const SearchIndexField& ) = default;
@@ -129,18 +158,34 @@ public:
 	SearchIndexField& operator= ( const SearchIndexField& ) = default;
 #else
 	SearchIndexField( const SearchIndexField& o)
-		:m_configIdx(o.m_configIdx),m_scopeIdx(o.m_scopeIdx),m_id(o.m_id),m_start(o.m_start),m_end(o.m_end){}
+		:m_configIdx(o.m_configIdx),m_scopeIdx(o.m_scopeIdx),m_id(o.m_id),m_idlist(o.m_idlist),m_start(o.m_start),m_end(o.m_end){}
 #endif
 	int configIdx() const					{return m_configIdx;}
 	int scopeIdx() const					{return m_scopeIdx;}
 	const std::string& id() const				{return m_id;}
+	/// \brief Sorted list of the integer ids of the field, empty if the field has no id
+	const std::vector<int>& idlist() const			{return m_idlist;}
 	const analyzer::Position& start() const			{return m_start;}
 	const analyzer::Position& end() const			{return m_end;}
 
-	void setId( const std::string& id_)
+	/// \brief Add an id (or a list of ids separated by FIELD_ID_SEPARATOR) to the field
+	void setId( const std::string& id_, SearchIndexFieldIdMap& idmap)
 	{
-		if (!m_id.empty()) m_id.push_back(',');
-		m_id.append(id_);
+		if (m_id.empty() && id_.empty()) return;
+		if (!m_id.empty()) m_id.push_back( FIELD_ID_SEPARATOR);
+		m_id.append( id_);
+
+		char const* ii = id_.c_str();
+		char const* ie = ii + id_.size();
+		for (;;)
+		{
+			char const* in = std::find( ii, ie, FIELD_ID_SEPARATOR);
+			m_idlist.push_back( idmap.get( ii, in - ii));
+			if (in == ie) break;
+			ii = in + 1;
+		}
+		std::sort( m_idlist.begin(), m_idlist.end());
+		m_idlist.erase( std::unique( m_idlist.begin(), m_idlist.end()), m_idlist.end());
 	}
 	void setStart( const analyzer::Position& start_)	{m_start = start_;}
 	void setEnd( const analyzer::Position& end_)		{m_end = end_;}
@@ -149,6 +194,7 @@ private:
 	int m_configIdx;
 	int m_scopeIdx;
 	std::string m_id;
+	std::vector<int> m_idlist;
 	analyzer::Position m_start;
 	analyzer::Position m_end;
 };
@@ -0,0 +1,580 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Builder of the structures of a document from the fields collected
+/// \file searchIndexStructureBuilder.cpp
+#include "searchIndexStructureBuilder.hpp"
+#include <algorithm>
+#include <functional>
+
+using namespace strus;
+
+typedef SearchIndexStructureBuilder::Area Area;
+
+/// \brief Order of the fields, the same as the set of fields traversed by the structure building before
+struct AreaOrder
+{
+	bool operator()( const Area& a, const Area& b) const
+	{
+		if (!(a.end() == b.end())) return a.end() < b.end();
+		if (!(a.start() == b.start())) return a.start() < b.start();
+		if (a.type != b.type) return (int)a.type < (int)b.type;
+		if (a.idlist->empty() || b.idlist->empty())
+		{
+			// ... fields without id in the same area are considered as one
+			return a.idlist->empty() && !b.idlist->empty();
+		}
+		return a.fieldIdx < b.fieldIdx;
+	}
+};
+
+struct AreaEqual
+{
+	bool operator()( const Area& a, const Area& b) const
+	{
+		AreaOrder order;
+		return !order( a, b) && !order( b, a);
+	}
+};
+
+/// \brief Order of contents by start ascending and end descending
+struct AreaStartOrder
+{
+	explicit AreaStartOrder( const std::vector<Area>& areas_) :areas(areas_){}
+	bool operator()( int aa, int bb) const
+	{
+		const Area& a = areas[ aa];
+		const Area& b = areas[ bb];
+		if (!(a.start() == b.start())) return a.start() < b.start();
+		if (!(a.end() == b.end())) return a.end() > b.end();
+		return aa < bb;
+	}
+	bool operator()( int aa, const analyzer::Position& pos) const
+	{
+		return areas[ aa].start() < pos;
+	}
+	const std::vector<Area>& areas;
+};
+
+/// \brief Order of contents by end ascending and start descending
+struct AreaEndOrder
+{
+	explicit AreaEndOrder( const std::vector<Area>& areas_) :areas(areas_){}
+	bool operator()( int aa, int bb) const
+	{
+		const Area& a = areas[ aa];
+		const Area& b = areas[ bb];
+		if (!(a.end() == b.end())) return a.end() < b.end();
+		if (!(a.start() == b.start())) return a.start() > b.start();
+		return aa < bb;
+	}
+	bool operator()( const analyzer::Position& pos, int aa) const
+	{
+		return pos < areas[ aa].end();
+	}
+	const std::vector<Area>& areas;
+};
+
+struct GroupIdOrder
+{
+	bool operator()( const SearchIndexStructureBuilder::Group& group, int id) const
+	{
+		return group.id < id;
+	}
+};
+
+static bool matchIdLists( const std::vector<int>& a, const std::vector<int>& b)
+{
+	if (a.empty() || b.empty()) return a.empty() && b.empty();
+	std::vector<int>::const_iterator ai = a.begin(), ae = a.end();
+	std::vector<int>::const_iterator bi = b.begin(), be = b.end();
+	while (ai != ae && bi != be)
+	{
+		if (*ai == *bi) return true;
+		if (*ai < *bi) ++ai; else ++bi;
+	}
+	return false;
+}
+
+void SearchIndexStructureBuilder::PositionTree::init( const std::vector<analyzer::Position>& values)
+{
+	m_size = values.size();
+	m_min.resize( 4 * m_size + 1);
+	m_max.resize( 4 * m_size + 1);
+	if (m_size) build( 1, 0, m_size, values);
+}
+
+void SearchIndexStructureBuilder::PositionTree::build( int node, int left, int right, const std::vector<analyzer::Position>& values)
+{
+	if (right - left == 1)
+	{
+		m_min[ node] = values[ left];
+		m_max[ node] = values[ left];
+	}
+	else
+	{
+		int mid = (left + right) / 2;
+		build( 2*node, left, mid, values);
+		build( 2*node+1, mid, right, values);
+		m_min[ node] = m_min[ 2*node] < m_min[ 2*node+1] ? m_min[ 2*node] : m_min[ 2*node+1];
+		m_max[ node] = m_max[ 2*node] > m_max[ 2*node+1] ? m_max[ 2*node] : m_max[ 2*node+1];
+	}
+}
+
+int SearchIndexStructureBuilder::PositionTree::find( int node, int left, int right, int from, int to, const analyzer::Position* lo, const analyzer::Position& hi, bool hiIncluded) const
+{
+	if (right <= from || left >= to) return -1;
+	if (lo && m_max[ node] <= *lo) return -1;
+	if (hiIncluded ? m_min[ node] > hi : m_min[ node] >= hi) return -1;
+	if (right - left == 1) return left;
+
+	int mid = (left + right) / 2;
+	int rt = find( 2*node, left, mid, from, to, lo, hi, hiIncluded);
+	if (rt < 0)
+	{
+		rt = find( 2*node+1, mid, right, from, to, lo, hi, hiIncluded);
+	}
+	return rt;
+}
+
+void SearchIndexStructureBuilder::collectAreas(
+		int configIdx,
+		const std::vector<SeachIndexFieldConfig>& fieldConfigs,
+		const std::vector<SearchIndexField>& fields)
+{
+	m_areas.clear();
+	m_headers.clear();
+	m_members.clear();
+	m_groups.clear();
+
+	std::vector<SearchIndexField>::const_iterator fi = fields.begin(), fe = fields.end();
+	for (int fidx=0; fi != fe; ++fi,++fidx)
+	{
+		const SeachIndexFieldConfig& config = fieldConfigs[ fi->configIdx()];
+		PositionRange posrange( fi->start(), fi->end());
+		std::vector<int>::const_iterator
+			hi = config.headerStructureList().begin(),
+			he = config.headerStructureList().end();
+		for (; hi != he; ++hi)
+		{
+			if (*hi == configIdx)
+			{
+				m_areas.push_back( Area( Area::HeaderType, fidx, posrange, &fi->idlist()));
+			}
+		}
+		std::vector<int>::const_iterator
+			ci = config.contentStructureList().begin(),
+			ce = config.contentStructureList().end();
+		for (; ci != ce; ++ci)
+		{
+			if (*ci == configIdx)
+			{
+				m_areas.push_back( Area( Area::ContentType, fidx, posrange, &fi->idlist()));
+			}
+		}
+	}
+	std::sort( m_areas.begin(), m_areas.end(), AreaOrder());
+	m_areas.erase( std::unique( m_areas.begin(), m_areas.end(), AreaEqual()), m_areas.end());
+
+	// Group the contents by id, contents without id get the id 0:
+	std::vector<Area>::const_iterator ai = m_areas.begin(), ae = m_areas.end();
+	for (int aidx=0; ai != ae; ++ai,++aidx)
+	{
+		if (ai->type == Area::HeaderType)
+		{
+			m_headers.push_back( aidx);
+		}
+		else if (ai->idlist->empty())
+		{
+			m_members.push_back( std::pair<int,int>( 0, aidx));
+		}
+		else
+		{
+			std::vector<int>::const_iterator ii = ai->idlist->begin(), ie = ai->idlist->end();
+			for (; ii != ie; ++ii)
+			{
+				m_members.push_back( std::pair<int,int>( *ii, aidx));
+			}
+		}
+	}
+	std::sort( m_members.begin(), m_members.end());
+	std::size_t mi = 0, me = m_members.size();
+	while (mi != me)
+	{
+		std::size_t start = mi;
+		for (++mi; mi != me && m_members[ mi].first == m_members[ start].first; ++mi){}
+		m_groups.push_back( Group( m_members[ start].first, (int)start, (int)mi));
+	}
+}
+
+void SearchIndexStructureBuilder::initGroupsByStart( bool withEndTree)
+{
+	AreaStartOrder order( m_areas);
+	m_byStart.clear();
+	std::vector<std::pair<int,int> >::const_iterator mi = m_members.begin(), me = m_members.end();
+	for (; mi != me; ++mi)
+	{
+		m_byStart.push_back( mi->second);
+	}
+	std::vector<Group>::const_iterator gi = m_groups.begin(), ge = m_groups.end();
+	for (; gi != ge; ++gi)
+	{
+		std::sort( m_byStart.begin() + gi->start, m_byStart.begin() + gi->end, order);
+	}
+	if (withEndTree)
+	{
+		m_treeValues.clear();
+		std::vector<int>::const_iterator si = m_byStart.begin(), se = m_byStart.end();
+		for (; si != se; ++si)
+		{
+			m_treeValues.push_back( m_areas[ *si].end());
+		}
+		m_tree.init( m_treeValues);
+	}
+}
+
+void SearchIndexStructureBuilder::initGroupsByEnd()
+{
+	AreaEndOrder order( m_areas);
+	m_byEnd.clear();
+	std::vector<std::pair<int,int> >::const_iterator mi = m_members.begin(), me = m_members.end();
+	for (; mi != me; ++mi)
+	{
+		m_byEnd.push_back( mi->second);
+	}
+	std::vector<Group>::const_iterator gi = m_groups.begin(), ge = m_groups.end();
+	for (; gi != ge; ++gi)
+	{
+		std::sort( m_byEnd.begin() + gi->start, m_byEnd.begin() + gi->end, order);
+	}
+	m_treeValues.clear();
+	std::vector<int>::const_iterator ei = m_byEnd.begin(), ee = m_byEnd.end();
+	for (; ei != ee; ++ei)
+	{
+		m_treeValues.push_back( m_areas[ *ei].start());
+	}
+	m_tree.init( m_treeValues);
+}
+
+void SearchIndexStructureBuilder::initGroupsSuffixMin()
+{
+	m_suffixMin.resize( m_byStart.size());
+	std::vector<Group>::const_iterator gi = m_groups.begin(), ge = m_groups.end();
+	for (; gi != ge; ++gi)
+	{
+		int minidx = m_byStart[ gi->end-1];
+		for (int si = gi->end; si > gi->start; --si)
+		{
+			if (m_byStart[ si-1] < minidx) minidx = m_byStart[ si-1];
+			m_suffixMin[ si-1] = minidx;
+		}
+	}
+}
+
+void SearchIndexStructureBuilder::initGroupsMaximal()
+{
+	m_maximal.clear();
+	std::vector<Group>::iterator gi = m_groups.begin(), ge = m_groups.end();
+	for (; gi != ge; ++gi)
+	{
+		gi->maximalStart = m_maximal.size();
+		for (int si = gi->start; si != gi->end; ++si)
+		{
+			const Area& area = m_areas[ m_byStart[ si]];
+			if (si == gi->start || area.end() > m_areas[ m_maximal.back()].end())
+			{
+				m_maximal.push_back( m_byStart[ si]);
+			}
+		}
+		gi->maximalEnd = m_maximal.size();
+	}
+}
+
+const SearchIndexStructureBuilder::Group* SearchIndexStructureBuilder::findGroup( int id) const
+{
+	std::vector<Group>::const_iterator gi = std::lower_bound( m_groups.begin(), m_groups.end(), id, GroupIdOrder());
+	return (gi != m_groups.end() && gi->id == id) ? &*gi : 0;
+}
+
+void SearchIndexStructureBuilder::collectCoverCandidates( const Group& group, const Area& header)
+{
+	// Outermost contents starting inside the header and ending before its end:
+	int si = std::lower_bound( m_byStart.begin() + group.start, m_byStart.begin() + group.end, header.start(), AreaStartOrder( m_areas)) - m_byStart.begin();
+	const analyzer::Position* lastEnd = 0;
+	for (;;)
+	{
+		int found = m_tree.findFirst( si, group.end, lastEnd, header.end(), false);
+		if (found < 0) break;
+		m_candidates.push_back( m_byStart[ found]);
+		lastEnd = &m_areas[ m_byStart[ found]].end();
+		si = found + 1;
+	}
+}
+
+void SearchIndexStructureBuilder::collectLabelCandidates( const Group& group, const Area& header)
+{
+	// Innermost contents ending after the header and starting before or with it:
+	int ei = std::upper_bound( m_byEnd.begin() + group.start, m_byEnd.begin() + group.end, header.end(), AreaEndOrder( m_areas)) - m_byEnd.begin();
+	const analyzer::Position* lastStart = 0;
+	for (;;)
+	{
+		int found = m_tree.findFirst( ei, group.end, lastStart, header.start(), true);
+		if (found < 0) break;
+		m_candidates.push_back( m_byEnd[ found]);
+		lastStart = &m_areas[ m_byEnd[ found]].start();
+		ei = found + 1;
+	}
+}
+
+int SearchIndexStructureBuilder::findSpanEnd( const Group& group, const Area& header) const
+{
+	// First content in the order of the fields starting after the header:
+	int si = std::lower_bound( m_byStart.begin() + group.start, m_byStart.begin() + group.end, header.end(), AreaStartOrder( m_areas)) - m_byStart.begin();
+	return si < group.end ? m_suffixMin[ si] : -1;
+}
+
+void SearchIndexStructureBuilder::collectAssociativeCandidates( const Group& group, const Area& header)
+{
+	bool hasEqual = false;
+	for (int mi = group.maximalStart; mi != group.maximalEnd; ++mi)
+	{
+		if (m_areas[ m_maximal[ mi]].range == header.range)
+		{
+			hasEqual = true;
+			break;
+		}
+	}
+	if (!hasEqual)
+	{
+		m_candidates.insert( m_candidates.end(), m_maximal.begin() + group.maximalStart, m_maximal.begin() + group.maximalEnd);
+	}
+	else
+	{
+		// Contents with the same area as the header are not candidates, they may cover others:
+		const Area* last = 0;
+		for (int si = group.start; si != group.end; ++si)
+		{
+			const Area& area = m_areas[ m_byStart[ si]];
+			if (area.range == header.range) continue;
+			if (!last || area.end() > last->end())
+			{
+				m_candidates.push_back( m_byStart[ si]);
+				last = &area;
+			}
+		}
+	}
+}
+
+void SearchIndexStructureBuilder::selectOuterCandidates( bool reverse)
+{
+	if (m_candidates.size() > 1)
+	{
+		// Keep only the contents not covered by another candidate, one of contents with the same area:
+		std::sort( m_candidates.begin(), m_candidates.end(), AreaStartOrder( m_areas));
+		std::vector<int>::iterator ci = m_candidates.begin(), ce = m_candidates.end(), cn = m_candidates.begin();
+		const analyzer::Position* maxEnd = 0;
+		for (; ci != ce; ++ci)
+		{
+			const Area& area = m_areas[ *ci];
+			if (!maxEnd || area.end() > *maxEnd)
+			{
+				maxEnd = &area.end();
+				*cn++ = *ci;
+			}
+		}
+		m_candidates.erase( cn, ce);
+	}
+	// Restore the order of traversal:
+	if (reverse)
+	{
+		std::sort( m_candidates.begin(), m_candidates.end(), std::greater<int>());
+	}
+	else
+	{
+		std::sort( m_candidates.begin(), m_candidates.end());
+	}
+}
+
+void SearchIndexStructureBuilder::selectInnerCandidates()
+{
+	if (m_candidates.size() > 1)
+	{
+		// Keep only the contents not covering another candidate, one of contents with the same area:
+		std::sort( m_candidates.begin(), m_candidates.end(), AreaEndOrder( m_areas));
+		std::vector<int>::iterator ci = m_candidates.begin(), ce = m_candidates.end(), cn = m_candidates.begin();
+		const analyzer::Position* maxStart = 0;
+		for (; ci != ce; ++ci)
+		{
+			const Area& area = m_areas[ *ci];
+			if (!maxStart || area.start() > *maxStart)
+			{
+				maxStart = &area.start();
+				*cn++ = *ci;
+			}
+		}
+		m_candidates.erase( cn, ce);
+	}
+	std::sort( m_candidates.begin(), m_candidates.end());
+}
+
+void SearchIndexStructureBuilder::flushCandidates( std::vector<SearchIndexStructure>& dest, int configIdx, const Area& header) const
+{
+	std::vector<int>::const_iterator ci = m_candidates.begin(), ce = m_candidates.end();
+	for (; ci != ce; ++ci)
+	{
+		dest.push_back( SearchIndexStructure( configIdx, header.range, m_areas[ *ci].range));
+	}
+}
+
+void SearchIndexStructureBuilder::build(
+		std::vector<SearchIndexStructure>& dest,
+		int configIdx,
+		StructureType structureType,
+		const std::vector<SeachIndexFieldConfig>& fieldConfigs,
+		const std::vector<SearchIndexField>& fields)
+{
+	collectAreas( configIdx, fieldConfigs, fields);
+	if (m_headers.empty()) return;
+
+	switch (structureType)
+	{
+		case DocumentAnalyzerInstanceInterface::StructureCover:
+		{
+			// Find header covering content completely (not equal)
+			initGroupsByStart( true);
+			std::vector<int>::const_reverse_iterator hi = m_headers.rbegin(), he = m_headers.rend();
+			for (; hi != he; ++hi)
+			{
+				const Area& header = m_areas[ *hi];
+				m_candidates.clear();
+				std::size_t ii = 0, ie = header.idlist->empty() ? 1 : header.idlist->size();
+				for (; ii != ie; ++ii)
+				{
+					const Group* group = findGroup( header.idlist->empty() ? 0 : (*header.idlist)[ ii]);
+					if (group) collectCoverCandidates( *group, header);
+				}
+				selectOuterCandidates( true/*reverse*/);
+				flushCandidates( dest, configIdx, header);
+			}
+			break;
+		}
+		case DocumentAnalyzerInstanceInterface::StructureLabel:
+		{
+			// Find header inside content (covered by content, not equal)
+			initGroupsByEnd();
+			std::vector<int>::const_iterator hi = m_headers.begin(), he = m_headers.end();
+			for (; hi != he; ++hi)
+			{
+				const Area& header = m_areas[ *hi];
+				m_candidates.clear();
+				std::size_t ii = 0, ie = header.idlist->empty() ? 1 : header.idlist->size();
+				for (; ii != ie; ++ii)
+				{
+					const Group* group = findGroup( header.idlist->empty() ? 0 : (*header.idlist)[ ii]);
+					if (group) collectLabelCandidates( *group, header);
+				}
+				selectInnerCandidates();
+				flushCandidates( dest, configIdx, header);
+			}
+			// ... no break here, label structures get the structures of StructureHeader too (as always)
+		}
+		case DocumentAnalyzerInstanceInterface::StructureHeader:
+		{
+			// Find content following the header up to the next header
+			std::vector<int>::const_iterator hi = m_headers.begin(), he = m_headers.end();
+			for (; hi != he; ++hi)
+			{
+				const Area& header = m_areas[ *hi];
+				m_candidates.clear();
+				std::size_t ai = *hi + 1, ae = m_areas.size();
+				for (; ai != ae && m_areas[ ai].type == Area::ContentType; ++ai)
+				{
+					if (m_areas[ ai].start() >= header.end()
+					&&  matchIdLists( *m_areas[ ai].idlist, *header.idlist))
+					{
+						m_candidates.push_back( ai);
+					}
+				}
+				selectOuterCandidates( false/*reverse*/);
+				flushCandidates( dest, configIdx, header);
+			}
+			break;
+		}
+		case DocumentAnalyzerInstanceInterface::StructureFooter:
+		{
+			// Find content preceding the footer down to the previous header
+			std::vector<int>::const_reverse_iterator hi = m_headers.rbegin(), he = m_headers.rend();
+			for (; hi != he; ++hi)
+			{
+				const Area& header = m_areas[ *hi];
+				m_candidates.clear();
+				std::size_t ai = *hi;
+				for (; ai && m_areas[ ai-1].type == Area::ContentType; --ai)
+				{
+					if (m_areas[ ai-1].end() <= header.start()
+					&&  matchIdLists( *m_areas[ ai-1].idlist, *header.idlist))
+					{
+						m_candidates.push_back( ai-1);
+					}
+				}
+				selectOuterCandidates( true/*reverse*/);
+				flushCandidates( dest, configIdx, header);
+			}
+			break;
+		}
+		case DocumentAnalyzerInstanceInterface::StructureSpan:
+		{
+			// Find the next content after the header marking the end of the span
+			initGroupsByStart( false);
+			initGroupsSuffixMin();
+			std::vector<int>::const_iterator hi = m_headers.begin(), he = m_headers.end();
+			for (; hi != he; ++hi)
+			{
+				const Area& header = m_areas[ *hi];
+				int spanEnd = -1;
+				std::size_t ii = 0, ie = header.idlist->empty() ? 1 : header.idlist->size();
+				for (; ii != ie; ++ii)
+				{
+					const Group* group = findGroup( header.idlist->empty() ? 0 : (*header.idlist)[ ii]);
+					if (group)
+					{
+						int aidx = findSpanEnd( *group, header);
+						if (aidx >= 0 && (spanEnd < 0 || aidx < spanEnd)) spanEnd = aidx;
+					}
+				}
+				PositionRange posrange( header.start(), spanEnd >= 0
+							? m_areas[ spanEnd].start()
+							: analyzer::Position::endOfDocument());
+				//... if no end marker found, set end position to end of document
+				dest.push_back( SearchIndexStructure( configIdx, header.range, posrange));
+			}
+			break;
+		}
+		case DocumentAnalyzerInstanceInterface::StructureAssociative:
+		{
+			// Find all contents with a matching id
+			initGroupsByStart( false);
+			initGroupsMaximal();
+			std::vector<int>::const_iterator hi = m_headers.begin(), he = m_headers.end();
+			for (; hi != he; ++hi)
+			{
+				const Area& header = m_areas[ *hi];
+				m_candidates.clear();
+				std::size_t ii = 0, ie = header.idlist->empty() ? 1 : header.idlist->size();
+				for (; ii != ie; ++ii)
+				{
+					const Group* group = findGroup( header.idlist->empty() ? 0 : (*header.idlist)[ ii]);
+					if (group) collectAssociativeCandidates( *group, header);
+				}
+				selectOuterCandidates( false/*reverse*/);
+				flushCandidates( dest, configIdx, header);
+			}
+			break;
+		}
+	}
+}
+
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Builder of the structures of a document from the fields collected
+/// \file searchIndexStructureBuilder.hpp
+#ifndef _STRUS_ANALYZER_SEARCH_INDEX_STRUCTURE_BUILDER_HPP_INCLUDED
+#define _STRUS_ANALYZER_SEARCH_INDEX_STRUCTURE_BUILDER_HPP_INCLUDED
+#include "searchIndexStructure.hpp"
+#include "strus/documentAnalyzerInstanceInterface.hpp"
+#include "strus/analyzer/position.hpp"
+#include <vector>
+#include <utility>
+
+namespace strus
+{
+
+/// \brief Builder of the structures of a structure configuration from the fields collected in a scope
+/// \note The fields are sorted by position once. Every header queries only the content fields sharing an id
+///	with it, using binary search and a tree of position ranges instead of comparing it with all other fields.
+///	The buffers are kept between calls.
+class SearchIndexStructureBuilder
+{
+public:
+	typedef DocumentAnalyzerInstanceInterface::StructureType StructureType;
+
+	SearchIndexStructureBuilder()
+		:m_areas(),m_headers(),m_members(),m_groups(),m_byStart(),m_byEnd()
+		,m_suffixMin(),m_maximal(),m_treeValues(),m_tree(),m_candidates(){}
+
+	/// \brief Build the structures of a structure configuration
+	/// \param[in,out] dest where to append the structures built to
+	/// \param[in] configIdx index of the structure configuration
+	/// \param[in] structureType type of the structure
+	/// \param[in] fieldConfigs list of all field configurations
+	/// \param[in] fields list of fields collected
+	void build(
+			std::vector<SearchIndexStructure>& dest,
+			int configIdx,
+			StructureType structureType,
+			const std::vector<SeachIndexFieldConfig>& fieldConfigs,
+			const std::vector<SearchIndexField>& fields);
+
+private:
+	SearchIndexStructureBuilder( const SearchIndexStructureBuilder&){}	//... non copyable
+	void operator=( const SearchIndexStructureBuilder&){}			//... non copyable
+
+public:
+	typedef SearchIndexStructure::PositionRange PositionRange;
+
+	/// \brief Header or content field of a structure
+	struct Area
+	{
+		enum Type {HeaderType,ContentType};
+		Type type;
+		int fieldIdx;
+		PositionRange range;
+		const std::vector<int>* idlist;
+
+		Area( Type type_, int fieldIdx_, const PositionRange& range_, const std::vector<int>* idlist_)
+			:type(type_),fieldIdx(fieldIdx_),range(range_),idlist(idlist_){}
+#if __cplusplus >= 201103L
+		Area( Area&& ) = default;
+		Area( const Area& ) = default;
+		Area& operator= ( Area&& ) = default;
+		Area& operator= ( const Area& ) = default;
+#else
+		Area( const Area& o)
+			:type(o.type),fieldIdx(o.fieldIdx),range(o.range),idlist(o.idlist){}
+#endif
+		const analyzer::Position& start() const		{return range.first;}
+		const analyzer::Position& end() const		{return range.second;}
+	};
+
+	/// \brief Range of the contents with the same id in the member arrays
+	struct Group
+	{
+		int id;
+		int start;
+		int end;
+		int maximalStart;
+		int maximalEnd;
+
+		Group( int id_, int start_, int end_)
+			:id(id_),start(start_),end(end_),maximalStart(0),maximalEnd(0){}
+#if __cplusplus >= 201103L
+		Group( Group&& ) = default;
+		Group( const Group& ) = default;
+		Group& operator= ( Group&& ) = default;
+		Group& operator= ( const Group& ) = default;
+#else
+		Group( const Group& o)
+			:id(o.id),start(o.start),end(o.end),maximalStart(o.maximalStart),maximalEnd(o.maximalEnd){}
+#endif
+	};
+
+	/// \brief Tree of the minimum and maximum of an array of positions for finding the first element in a range of values
+	class PositionTree
+	{
+	public:
+		PositionTree()
+			:m_min(),m_max(),m_size(0){}
+
+		/// \brief Build the tree
+		void init( const std::vector<analyzer::Position>& values);
+
+		/// \brief Find the first index in [from,to) with a value in the range (lo,hi) or (lo,hi]
+		/// \param[in] lo lower bound (excluded) or NULL, if there is no lower bound
+		/// \param[in] hi upper bound
+		/// \param[in] hiIncluded true if the upper bound is part of the range
+		/// \return the index found or -1
+		int findFirst( int from, int to, const analyzer::Position* lo, const analyzer::Position& hi, bool hiIncluded) const
+		{
+			return m_size ? find( 1, 0, m_size, from, to, lo, hi, hiIncluded) : -1;
+		}
+
+	private:
+		void build( int node, int left, int right, const std::vector<analyzer::Position>& values);
+		int find( int node, int left, int right, int from, int to, const analyzer::Position* lo, const analyzer::Position& hi, bool hiIncluded) const;
+
+	private:
+		std::vector<analyzer::Position> m_min;
+		std::vector<analyzer::Position> m_max;
+		int m_size;
+	};
+
+private:
+	void collectAreas(
+			int configIdx,
+			const std::vector<SeachIndexFieldConfig>& fieldConfigs,
+			const std::vector<SearchIndexField>& fields);
+	void initGroupsByStart( bool withEndTree);
+	void initGroupsByEnd();
+	void initGroupsSuffixMin();
+	void initGroupsMaximal();
+	const Group* findGroup( int id) const;
+
+	void collectCoverCandidates( const Group& group, const Area& header);
+	void collectLabelCandidates( const Group& group, const Area& header);
+	int findSpanEnd( const Group& group, const Area& header) const;
+	void collectAssociativeCandidates( const Group& group, const Area& header);
+	void selectOuterCandidates( bool reverse);
+	void selectInnerCandidates();
+	void flushCandidates( std::vector<SearchIndexStructure>& dest, int configIdx, const Area& header) const;
+
+private:
+	std::vector<Area> m_areas;			///< all fields sorted by end, start and type
+	std::vector<int> m_headers;			///< indices of the headers in m_areas
+	std::vector<std::pair<int,int> > m_members;	///< pairs (id, index in m_areas) of the contents sorted
+	std::vector<Group> m_groups;			///< ranges of contents with the same id in m_members, m_byStart, m_byEnd, m_suffixMin
+	std::vector<int> m_byStart;			///< indices of contents in m_areas sorted per group by start ascending and end descending
+	std::vector<int> m_byEnd;			///< indices of contents in m_areas sorted per group by end ascending and start descending
+	std::vector<int> m_suffixMin;			///< smallest index in m_areas of the contents in m_byStart from a position to the end of its group
+	std::vector<int> m_maximal;			///< indices of the contents in m_areas not covered by another content of the same group
+	std::vector<analyzer::Position> m_treeValues;	///< buffer for the values of m_tree
+	PositionTree m_tree;				///< tree on the ends of m_byStart or on the starts of m_byEnd
+	std::vector<int> m_candidates;			///< indices of the contents in m_areas selected for the current header
+};
+
+}//namespace
+#endif
+
@@ -14,9 +14,10 @@
 #include "strus/errorBufferInterface.hpp"
 #include "strus/debugTraceInterface.hpp"
 #include "strus/analyzer/position.hpp"
-#include <set>
+#include "strus/documentSinkInterface.hpp"
 #include <iostream>
 #include <algorithm>
+#include <cstring>
 
 using namespace strus;
 
@@ -35,6 +36,30 @@ SegmentProcessor::SegmentProcessor(
 		ErrorBufferInterface* errorhnd_)
 	:m_featureConfigMap(&featureConfigMap_)
 	,m_concatenatedMap()
+	,m_searchTerms()
+	,m_forwardTerms()
+	,m_metadataTerms()
+	,m_attributeTerms()
+	,m_valueBuffer()
+	,m_tokens()
+	,m_tokenizerGroup(0)
+	,m_tokenSegmentPtr(0)
+	,m_tokenSegmentSize(0)
+	,m_tokenSegmentPos(0)
+	,m_normalizerResults()
+	,m_normalizerResultValid()
+	,m_normalizerCacheMap(0)
+	,m_normalizedValues()
+	,m_normalizedNext()
+	,m_cachedValues()
+	,m_fallbackValues()
+	,m_normalizerInput()
+	,m_normalizerInputToken()
+	,m_itemToken()
+	,m_tokenStartStep()
+	,m_positionMap()
+	,m_ordposbuf()
+	,m_searchPositionCount()
 	,m_errorhnd(errorhnd_)
 	,m_debugtrace(0)
 {
@@ -54,6 +79,9 @@ void SegmentProcessor::clearTermMaps()
 	m_forwardTerms.clear();
 	m_metadataTerms.clear();
 	m_attributeTerms.clear();
+	m_valueBuffer.clear();
+	m_tokenizerGroup = 0;
+	m_normalizerResultValid.clear();
 }
 
 void SegmentProcessor::concatDocumentSegment(
@@ -75,146 +103,49 @@ void SegmentProcessor::concatDocumentSegment(
 	}
 }
 
-static void fillPositionSet( std::set<analyzer::Position>& pset, std::set<analyzer::Position>& pset_unique, const std::vector<BindTerm>& terms)
+static void appendRelocatedTerms( std::vector<BindTerm>& dest, const std::vector<BindTerm>& terms, std::size_t bufferofs)
 {
-	std::vector<BindTerm>::const_iterator ri = terms.begin(), re = terms.end();
-	for (; ri != re; ++ri)
+	std::size_t destidx = dest.size();
+	dest.insert( dest.end(), terms.begin(), terms.end());
+	std::vector<BindTerm>::iterator di = dest.begin() + destidx, de = dest.end();
+	for (; di != de; ++di)
 	{
-		if (ri->posbind() == analyzer::BindContent)
-		{
-			pset.insert( analyzer::Position( ri->seg(), ri->ofs()+1));
-		}
-		else if (ri->posbind() == analyzer::BindUnique)
-		{
-			pset_unique.insert( analyzer::Position( ri->seg(), ri->ofs()+1));
-		}
+		di->relocateValue( bufferofs);
 	}
 }
 
-static void mergeUniquePositionSet( std::set<analyzer::Position>& pset, const std::set<analyzer::Position>& pset_unique)
+void SegmentProcessor::appendTerms( const SegmentProcessor& o)
 {
-	std::set<analyzer::Position>::const_iterator si = pset.begin(), se = pset.end();
-	std::set<analyzer::Position>::const_iterator ui = pset_unique.begin(), ue = pset_unique.end();
-	while (si != se && ui != ue)
-	{
-		while (*si < *ui && si != se) ++si;
-		if (si != se)
-		{
-			for (++ui; ui != ue && *ui <= *si; ++ui){}
-			// ... take only the last of a unique sequence
-			std::set<analyzer::Position>::const_iterator lastinseq = ui;
-			--lastinseq;
-			pset.insert( *lastinseq);
-		}
-	}
-	if (ui != ue)
-	{
-		std::set<analyzer::Position>::const_iterator lastinseq = ue;
-		--lastinseq;
-		pset.insert( *lastinseq);
-	}
+	std::size_t bufferofs = m_valueBuffer.append( o.m_valueBuffer);
+	appendRelocatedTerms( m_searchTerms, o.m_searchTerms, bufferofs);
+	appendRelocatedTerms( m_forwardTerms, o.m_forwardTerms, bufferofs);
+	appendRelocatedTerms( m_metadataTerms, o.m_metadataTerms, bufferofs);
+	appendRelocatedTerms( m_attributeTerms, o.m_attributeTerms, bufferofs);
 }
 
-typedef std::map<analyzer::Position, unsigned int> PositionMap;
-
-static PositionMap getPositionMap( const std::set<analyzer::Position>& pset)
-{
-	PositionMap posmap;
-	std::set<analyzer::Position>::const_iterator pi = pset.begin(), pe = pset.end();
-	unsigned int pcnt = 0;
-	for (; pi != pe; ++pi)
-	{
-		posmap[ *pi] = ++pcnt;
-	}
-	return posmap;
-}
-
-static std::set<int> getOrdinalPositionSet(
+static void feedTermsDocument(
+		DocumentSinkInterface& sink,
+		FeatureClass featureClass,
 		const std::vector<BindTerm>& terms,
-		const PositionMap& posmap, std::size_t posofs)
+		const std::vector<unsigned int>& ordposar,
+		const FeatureConfigMap& featmap,
+		const BindTermValueBuffer& valuebuf)
 {
-	std::set<int> rt;
 	std::vector<BindTerm>::const_iterator ri = terms.begin(), re = terms.end();
-	for (; ri != re; ++ri)
+	std::vector<unsigned int>::const_iterator oi = ordposar.begin();
+	for (; ri != re; ++ri,++oi)
 	{
-		switch (ri->posbind())
+		if (*oi)
 		{
-			case analyzer::BindContent:
+			const std::string& type = featmap.featureConfig( ri->typeidx()).name();
+			const char* value = valuebuf.value( ri->valueofs());
+			if (featureClass == FeatSearchIndexTerm)
 			{
-				PositionMap::const_iterator
-					mi = posmap.find( analyzer::Position( ri->seg(), ri->ofs()+1));
-				if (mi != posmap.end())
-				{
-					rt.insert( (int)(mi->second + posofs));
-				}
-				break;
+				sink.addSearchIndexTerm( type.c_str(), type.size(), value, ri->valuesize(), *oi);
 			}
-			case analyzer::BindUnique:
-			case analyzer::BindSuccessor:
+			else
 			{
-				PositionMap::const_iterator
-					mi = posmap.upper_bound( analyzer::Position( ri->seg(), ri->ofs()));
-				if (mi != posmap.end())
-				{
-					rt.insert( (int)(mi->second + posofs));
-				}
-				break;
-			}
-			case analyzer::BindPredecessor:
-			{
-				PositionMap::const_iterator
-					mi = posmap.upper_bound( analyzer::Position( ri->seg(), ri->ofs()+1));
-				if (mi != posmap.end() && mi->second + posofs > 1)
-				{
-					rt.insert( (int)(mi->second + posofs - 1));
-				}
-				break;
-			}
-		}
-	}
-	return rt;
-}
-
-static void fillTermsDocument(
-		std::vector<analyzer::DocumentTerm>& res,
-		const std::vector<BindTerm>& terms,
-		const PositionMap& posmap, std::size_t posofs)
-{
-	std::vector<BindTerm>::const_iterator ri = terms.begin(), re = terms.end();
-	for (; ri != re; ++ri)
-	{
-		switch (ri->posbind())
-		{
-			case analyzer::BindContent:
-			{
-				PositionMap::const_iterator
-					mi = posmap.find( analyzer::Position( ri->seg(), ri->ofs()+1));
-				if (mi != posmap.end())
-				{
-					res.push_back( analyzer::DocumentTerm( ri->type(), ri->value(), mi->second + posofs));
-				}
-				break;
-			}
-			case analyzer::BindUnique:
-			case analyzer::BindSuccessor:
-			{
-				PositionMap::const_iterator
-					mi = posmap.upper_bound( analyzer::Position( ri->seg(), ri->ofs()));
-				if (mi != posmap.end())
-				{
-					res.push_back( analyzer::DocumentTerm( ri->type(), ri->value(), mi->second + posofs));
-				}
-				break;
-			}
-			case analyzer::BindPredecessor:
-			{
-				PositionMap::const_iterator
-					mi = posmap.upper_bound( analyzer::Position( ri->seg(), ri->ofs()+1));
-				if (mi != posmap.end() && mi->second + posofs > 1)
-				{
-					res.push_back( analyzer::DocumentTerm( ri->type(), ri->value(), mi->second + posofs - 1));
-				}
-				break;
+				sink.addForwardIndexTerm( type.c_str(), type.size(), value, ri->valuesize(), *oi);
 			}
 		}
 	}
@@ -223,101 +154,123 @@ static void fillTermsDocument(
 static void fillTermsQuery( 
 		std::vector<SegmentProcessor::QueryElement>& res,
 		const std::vector<BindTerm>& terms,
-		const PositionMap& posmap, std::size_t posofs)
+		const std::vector<unsigned int>& ordposar,
+		const FeatureConfigMap& featmap,
+		const BindTermValueBuffer& valuebuf)
 {
 	std::vector<BindTerm>::const_iterator ri = terms.begin(), re = terms.end();
-	for (; ri != re; ++ri)
+	std::vector<unsigned int>::const_iterator oi = ordposar.begin();
+	for (; ri != re; ++ri,++oi)
 	{
 		if (ri->posbind() != analyzer::BindContent)
 		{
 			throw std::runtime_error( _TXT("only position bind content expected in query"));
 		}
-		PositionMap::const_iterator
-			mi = posmap.find( analyzer::Position( ri->seg(), ri->ofs()+1));
-		res.push_back( SegmentProcessor::QueryElement( ri->seg(), mi->second + posofs, ri->priority(), analyzer::QueryTerm( ri->type(), ri->value(), ri->ordlen())));
+		analyzer::QueryTerm term(
+				featmap.featureConfig( ri->typeidx()).name(),
+				std::string( valuebuf.value( ri->valueofs()), ri->valuesize()),
+				ri->ordlen());
+		res.push_back( SegmentProcessor::QueryElement( ri->seg(), *oi, ri->priority(), term));
 	}
 }
 
-void SegmentProcessor::eliminateCovered()
-{
-	BindTerm::eliminateCoveredElements( m_searchTerms);
-	BindTerm::eliminateCoveredElements( m_forwardTerms);
-	BindTerm::eliminateCoveredElements( m_attributeTerms);
-	BindTerm::eliminateCoveredElements( m_metadataTerms);
-}
-
-static analyzer::DocumentStructure::Position getOrdinalPosition( const PositionMap& posmap, const analyzer::Position& pos)
+/// \brief Mark the ordinal positions of a list of terms and count them, so that the
+///	existence of a position in a range can be tested with one subtraction
+static void fillOrdinalPositionCount(
+		std::vector<unsigned int>& res,
+		const std::vector<unsigned int>& ordposar,
+		std::size_t nofPositions)
 {
-	PositionMap::const_iterator pi = posmap.lower_bound( pos);
-	if (pi == posmap.end())
+	res.assign( nofPositions+2, 0);
+	std::vector<unsigned int>::const_iterator oi = ordposar.begin(), oe = ordposar.end();
+	for (; oi != oe; ++oi)
 	{
-		return posmap.empty() ? 1 : posmap.rbegin()->second+1;
+		if (*oi) res[ *oi] = 1;
 	}
-	else
+	// ... res[i] = number of distinct ordinal positions smaller than i
+	unsigned int cnt = 0;
+	std::vector<unsigned int>::iterator ci = res.begin(), ce = res.end();
+	for (; ci != ce; ++ci)
 	{
-		return pi->second;
+		unsigned int flag = *ci;
+		*ci = cnt;
+		cnt += flag;
 	}
 }
 
-static analyzer::DocumentStructure::PositionRange getOrdinalPositionRange( const PositionMap& posmap, const SearchIndexStructure::PositionRange& posrange)
+static bool hasOrdinalPositionInRange(
+		const std::vector<unsigned int>& poscount,
+		const analyzer::DocumentStructure::PositionRange& range)
+{
+	return range.start() < range.end()
+		&& poscount[ range.end()] > poscount[ range.start()];
+}
+
+void SegmentProcessor::eliminateCovered()
+{
+	BindTerm::eliminateCoveredElements( m_searchTerms, m_valueBuffer);
+	BindTerm::eliminateCoveredElements( m_forwardTerms, m_valueBuffer);
+	BindTerm::eliminateCoveredElements( m_attributeTerms, m_valueBuffer);
+	BindTerm::eliminateCoveredElements( m_metadataTerms, m_valueBuffer);
+}
+
+static analyzer::DocumentStructure::PositionRange getOrdinalPositionRange( const OrdinalPositionMap& posmap, const SearchIndexStructure::PositionRange& posrange)
 {
 	return analyzer::DocumentStructure::PositionRange( 
-			getOrdinalPosition( posmap, posrange.first),
-			getOrdinalPosition( posmap, posrange.second));
+			posmap.ordinalPosition( posrange.first),
+			posmap.ordinalPosition( posrange.second));
 }
 
-analyzer::Document SegmentProcessor::fetchDocument(
+void SegmentProcessor::fetchDocument(
+		DocumentSinkInterface& sink,
 		const std::vector<SeachIndexStructureConfig>& structureConfigs,
 		const std::vector<SearchIndexStructure>& structures)
 {
-	analyzer::Document rt;
-
-	std::set<analyzer::Position> pset;
-	std::set<analyzer::Position> pset_unique;
-	fillPositionSet( pset, pset_unique, m_searchTerms);
-	fillPositionSet( pset, pset_unique, m_forwardTerms);
-	mergeUniquePositionSet( pset, pset_unique);
-	PositionMap posmap = getPositionMap( pset);
-
-	std::size_t posofs = 0;
-	std::vector<analyzer::DocumentTerm> seterms;
-	fillTermsDocument( seterms, m_searchTerms, posmap, posofs);
-	std::vector<analyzer::DocumentTerm> fwterms;
-	fillTermsDocument( fwterms, m_forwardTerms, posmap, posofs);
+	m_positionMap.clear();
+	m_positionMap.collect( m_searchTerms);
+	m_positionMap.collect( m_forwardTerms);
+	m_positionMap.build();
 
-	std::set<int> pset_search = getOrdinalPositionSet( m_searchTerms, posmap, posofs);
+	m_positionMap.assign( m_ordposbuf, m_searchTerms);
+	feedTermsDocument( sink, FeatSearchIndexTerm, m_searchTerms, m_ordposbuf, *m_featureConfigMap, m_valueBuffer);
+	fillOrdinalPositionCount( m_searchPositionCount, m_ordposbuf, m_positionMap.size());
 
-	rt.addSearchIndexTerms( seterms);
-	rt.addForwardIndexTerms( fwterms);
+	m_positionMap.assign( m_ordposbuf, m_forwardTerms);
+	feedTermsDocument( sink, FeatForwardIndexTerm, m_forwardTerms, m_ordposbuf, *m_featureConfigMap, m_valueBuffer);
 
 	std::vector<BindTerm>::const_iterator mi = m_metadataTerms.begin(), me = m_metadataTerms.end();
 	for (; mi != me; ++mi)
 	{
 		NumericVariant value;
-		if (!value.initFromString( mi->value().c_str()))
+		const char* valuestr = m_valueBuffer.value( mi->valueofs());
+		if (!value.initFromString( valuestr))
 		{
-			throw strus::runtime_error(_TXT("cannot convert normalized item to number (metadata element): %s"), mi->value().c_str());
+			throw strus::runtime_error(_TXT("cannot convert normalized item to number (metadata element): %s"), valuestr);
 		}
-		rt.setMetaData( mi->type(), value);
+		const std::string& name = termType( *mi);
+		sink.setMetaData( name.c_str(), name.size(), value);
 	}
 	std::string accessListStr;
 	std::vector<BindTerm>::const_iterator ai = m_attributeTerms.begin(), ae = m_attributeTerms.end();
 	for (; ai != ae; ++ai)
 	{
-		if (ai->type() == analyzer::Document::attribute_access())
+		const std::string& name = termType( *ai);
+		const char* value = m_valueBuffer.value( ai->valueofs());
+		if (name == analyzer::Document::attribute_access())
 		{
 			if (!accessListStr.empty()) accessListStr.push_back(',');
-			accessListStr.append( ai->value());
-			rt.addAccess( ai->value());
+			accessListStr.append( value, ai->valuesize());
+			sink.addAccess( value, ai->valuesize());
 		}
 		else
 		{
-			rt.setAttribute( ai->type(), ai->value());
+			sink.setAttribute( name.c_str(), name.size(), value, ai->valuesize());
 		}
 	}
 	if (!accessListStr.empty())
 	{
-		rt.setAttribute( analyzer::Document::attribute_access(), accessListStr);
+		const char* name = analyzer::Document::attribute_access();
+		sink.setAttribute( name, std::strlen( name), accessListStr.c_str(), accessListStr.size());
 	}
 	std::vector<SearchIndexStructure>::const_iterator si = structures.begin(), se = structures.end();
 	for (; si != se; ++si)
@@ -325,38 +278,33 @@ analyzer::Document SegmentProcessor::fetchDocument(
 		const std::string&
 			nn = structureConfigs[ si->configIdx()].structureName();
 		analyzer::DocumentStructure::PositionRange
-			hh = getOrdinalPositionRange( posmap, si->source());
+			hh = getOrdinalPositionRange( m_positionMap, si->source());
 		analyzer::DocumentStructure::PositionRange
-			cc = getOrdinalPositionRange( posmap, si->sink());
-		if (hh.defined() && cc.defined())
+			cc = getOrdinalPositionRange( m_positionMap, si->sink());
+		if (hh.defined() && cc.defined()
+		&&  hasOrdinalPositionInRange( m_searchPositionCount, hh)
+		&&  hasOrdinalPositionInRange( m_searchPositionCount, cc))
 		{
-			std::set<int>::const_iterator qi = pset_search.lower_bound( (int)hh.start());
-			if (qi != pset_search.end() && *qi < (int)hh.end())
-			{
-				qi = pset_search.lower_bound( (int)cc.start());
-				if (qi != pset_search.end() && *qi < (int)cc.end())
-				{
-					rt.addSearchIndexStructure( nn, hh, cc);
-				}
-			}
+			sink.addSearchIndexStructure( nn.c_str(), nn.size(), hh, cc);
 		}
 	}
 	clearTermMaps();
-	return rt;
 }
 
-std::vector<SegmentProcessor::QueryElement> SegmentProcessor::fetchQuery() const
+void SegmentProcessor::fetchQuery( std::vector<QueryElement>& res)
 {
-	std::set<analyzer::Position> pset;
-	std::set<analyzer::Position> pset_unique;
-	fillPositionSet( pset, pset_unique, m_searchTerms);
-	fillPositionSet( pset, pset_unique, m_metadataTerms);
-	mergeUniquePositionSet( pset, pset_unique);
-	PositionMap posmap = getPositionMap( pset);
-
-	std::vector<QueryElement> rt;
-	fillTermsQuery( rt, m_searchTerms, posmap, 0/*position offset*/);
-	return rt;
+	res.clear();
+	res.reserve( m_searchTerms.size());
+	// ... the few terms of a usual query get their ordinal positions without building the position map
+	if (!m_metadataTerms.empty() || !OrdinalPositionMap::assignSmallContent( m_ordposbuf, m_searchTerms))
+	{
+		m_positionMap.clear();
+		m_positionMap.collect( m_searchTerms);
+		m_positionMap.collect( m_metadataTerms);
+		m_positionMap.build();
+		m_positionMap.assign( m_ordposbuf, m_searchTerms);
+	}
+	fillTermsQuery( res, m_searchTerms, m_ordposbuf, *m_featureConfigMap, m_valueBuffer);
 }
 
 static const char* featureClassType( FeatureClass featclass)
@@ -371,14 +319,18 @@ static const char* featureClassType( FeatureClass featclass)
 	return 0;
 }
 
-void SegmentProcessor::processContentTokens( std::vector<BindTerm>& result, const FeatureConfig& feat, const std::vector<analyzer::Token>& tokens, const char* segsrc, std::size_t segmentpos, const std::vector<SegPosDef>& concatposmap) const
+void SegmentProcessor::processContentTokens( std::vector<BindTerm>& result, int featidx, const FeatureConfig& feat, const std::vector<analyzer::Token>& tokens, const char* segsrc, std::size_t segmentpos, const std::vector<SegPosDef>& concatposmap)
 {
+	int typeord = m_featureConfigMap->typeOrder( featidx);
 	DEBUG_OPEN( featureClassType( feat.featureClass()))
+	normalizeTokens( feat, featidx, tokens, segsrc);
+
 	std::vector<SegPosDef>::const_iterator
 		ci = concatposmap.begin(), ce = concatposmap.end();
 	std::vector<analyzer::Token>::const_iterator
 		ti = tokens.begin(), te = tokens.end();
-	for (; ti != te; ++ti)
+	std::size_t vi = 0, ve = m_normalizerInput.size();
+	for (std::size_t tidx=0; ti != te; ++ti,++tidx)
 	{
 		// Calculate string position of segment start for concatenated segments:
 		int str_position = 0;
@@ -391,65 +343,316 @@ void SegmentProcessor::processContentTokens( std::vector<BindTerm>& result, cons
 				segmentpos = ci->segpos;
 			}
 		}
-		std::string termval( feat.normalize( segsrc + ti->origpos().ofs(), ti->origsize()));
-		if (!termval.empty() && termval[0] == '\0')
+		std::size_t vstart = vi;
+		for (; vi != ve && m_normalizerInputToken[ vi] == tidx; ++vi){}
+		bool multiValue = (vi - vstart != 1);
+		if (multiValue)
 		{
 			// ... handle normalizers with multiple results
 			DEBUG_OPEN( "terms")
-			char const* vi = termval.c_str();
-			char const* ve = vi + termval.size();
-			for (++vi; vi < ve; vi = std::strchr( vi, '\0')+1)
-			{
-				int ofs = ti->origpos().ofs() - str_position/*ofs*/;
-				BindTerm term(
-					segmentpos, ofs, ofs + ti->origsize(), 1/*len*/,
-					feat.priority(), feat.options().positionBind(),
-					feat.name()/*type*/, vi/*value*/);
-				DEBUG_EVENT4( "term", "[%d %d] %s '%s'", (int)term.seg(), (int)term.ofs(), term.type().c_str(), term.value().c_str());
-				result.push_back( term);
-			}
-			DEBUG_CLOSE()
 		}
-		else
+		for (std::size_t vidx = vstart; vidx != vi; ++vidx)
 		{
+			const analyzer::TokenSpan& value = m_normalizerInput[ vidx];
 			int ofs = ti->origpos().ofs() - str_position/*ofs*/;
 			BindTerm term(
 				segmentpos, ofs, ofs + ti->origsize(), 1/*len*/,
 				feat.priority(), feat.options().positionBind(),
-				feat.name()/*type*/, termval/*value*/);
-			DEBUG_EVENT4( "term", "[%d %d] %s '%s'", (int)term.seg(), (int)term.ofs(), term.type().c_str(), term.value().c_str());
+				featidx/*type*/, typeord, m_valueBuffer.append( value.ptr(), value.size())/*value*/, value.size());
+			DEBUG_EVENT4( "term", "[%d %d] %s '%s'", (int)term.seg(), (int)term.ofs(), feat.name().c_str(), m_valueBuffer.value( term.valueofs()));
 			result.push_back( term);
 		}
+		if (multiValue)
+		{
+			DEBUG_CLOSE()
+		}
 	}
 	DEBUG_CLOSE()
 }
 
+void SegmentProcessor::resetSharedNormalizerResults()
+{
+	std::size_t nofSlots = m_featureConfigMap->nofSharedNormalizers();
+	if (m_tokenizerGroup && nofSlots)
+	{
+		std::size_t size = m_tokens.size() * nofSlots;
+		m_normalizerResultValid.assign( size, 0);
+		if (m_normalizerResults.size() < size)
+		{
+			m_normalizerResults.resize( size);
+		}
+	}
+	else
+	{
+		m_normalizerResultValid.clear();
+	}
+}
+
+void SegmentProcessor::pushNormalizerInput( const analyzer::TokenSpan& value, std::size_t tokidx)
+{
+	m_normalizerInput.push_back( value);
+	m_normalizerInputToken.push_back( tokidx);
+}
+
+void SegmentProcessor::pushNormalizerInput( const std::string& values, std::size_t tokidx)
+{
+	if (!values.empty() && values[0] == '\0')
+	{
+		// ... multiple results of a normalizer
+		char const* vi = values.c_str();
+		char const* ve = vi + values.size();
+		for (++vi; vi < ve; vi = std::strchr( vi, '\0')+1)
+		{
+			pushNormalizerInput( analyzer::TokenSpan( vi, std::strlen( vi)), tokidx);
+		}
+	}
+	else
+	{
+		pushNormalizerInput( analyzer::TokenSpan( values.c_str(), values.size()), tokidx);
+	}
+}
+
+static std::string normalizeResultString( const std::vector<analyzer::TokenSpan>& values, std::size_t vi, std::size_t ve)
+{
+	std::string rt;
+	if (ve - vi == 1 && !(values[ vi].size() && values[ vi].ptr()[0] == '\0'))
+	{
+		rt.append( values[ vi].ptr(), values[ vi].size());
+	}
+	else if (vi == ve)
+	{
+		rt.push_back( '\0');
+	}
+	else
+	{
+		for (; vi != ve; ++vi)
+		{
+			rt.push_back( '\0');
+			rt.append( values[ vi].ptr(), values[ vi].size());
+		}
+	}
+	return rt;
+}
+
+void SegmentProcessor::normalizeTokens( const FeatureConfig& feat, int featidx, const std::vector<analyzer::Token>& tokens, const char* segsrc)
+{
+	// The tokens are normalized in batches, one call of normalizeBatch per normalizer in the list.
+	// Each normalizer gets all values of the previous normalizer as input, multiple results of a normalizer are
+	// passed as separate inputs to the next normalizer. The result is stored in m_normalizerInput with the
+	// token index of each value in m_normalizerInputToken.
+	// Tokens with a normalizer not being the last in the list returning not exactly one value are normalized
+	// with FeatureConfig::normalize, that concatenates the single value results of the following normalizers.
+	const std::vector<FeatureConfig::NormalizerReference>& normalizers = feat.normalizerlist();
+	std::size_t nofSteps = normalizers.size();
+	std::size_t nofSlots = m_featureConfigMap->nofSharedNormalizers();
+	std::size_t cachedStep = nofSteps+1;
+	std::size_t fallbackStep = nofSteps+2;
+	bool sharing = !m_normalizerResultValid.empty();
+	NormalizerCache* cache = m_normalizerCacheMap ? m_normalizerCacheMap->get( featidx) : 0;
+
+	m_normalizedValues.clear();
+	m_cachedValues.clear();
+	m_itemToken.clear();
+	m_tokenStartStep.resize( tokens.size());
+
+	// Find the first normalizer to apply for each token:
+	std::vector<analyzer::Token>::const_iterator ti = tokens.begin(), te = tokens.end();
+	for (std::size_t tidx=0; ti != te; ++ti,++tidx)
+	{
+		std::size_t& startStep = m_tokenStartStep[ tidx];
+		if (cache)
+		{
+			const std::string* value = cache->get( segsrc + ti->origpos().ofs(), ti->origsize());
+			if (value)
+			{
+				m_cachedValues.addNormalizeResult( *value);
+				startStep = cachedStep;
+				continue;
+			}
+		}
+		startStep = 0;
+		if (sharing)
+		{
+			// Normalizer lists of features with the same tokenization build a prefix tree. Results of nodes shared
+			// by several features are stored per token and reused by the features processing the same tokens later.
+			// Find the longest prefix of the list of normalizers with a result computed already:
+			std::size_t slotbase = tidx * nofSlots;
+			for (startStep = nofSteps; startStep > 0; --startStep)
+			{
+				int slot = m_featureConfigMap->normalizerSlot( featidx, startStep-1);
+				if (slot >= 0 && m_normalizerResultValid[ slotbase + slot]) break;
+			}
+		}
+	}
+	bool hasFallback = false;
+	for (std::size_t step=0; step <= nofSteps; ++step)
+	{
+		if (step == nofSteps && hasFallback)
+		{
+			// Normalize the tokens with not exactly one intermediate value as FeatureConfig::normalize does:
+			m_fallbackValues.clear();
+			for (ti = tokens.begin(); ti != te; ++ti)
+			{
+				if (m_tokenStartStep[ ti - tokens.begin()] == fallbackStep)
+				{
+					m_fallbackValues.addNormalizeResult( feat.normalize( segsrc + ti->origpos().ofs(), ti->origsize()));
+				}
+			}
+		}
+		// Collect the input of the normalizer, adding the values of the tokens starting with this step:
+		m_normalizerInput.clear();
+		m_normalizerInputToken.clear();
+		std::size_t itemidx = 0, nofItems = m_itemToken.size();
+		std::size_t cachedidx = 0;
+		std::size_t fallbackidx = 0;
+		for (ti = tokens.begin(); ti != te; ++ti)
+		{
+			std::size_t tidx = ti - tokens.begin();
+			std::size_t startStep = m_tokenStartStep[ tidx];
+			std::size_t inputStart = m_normalizerInput.size();
+			if (startStep == cachedStep)
+			{
+				if (step == nofSteps)
+				{
+					std::size_t vi = m_cachedValues.valuesStart( cachedidx), ve = m_cachedValues.valuesEnd( cachedidx);
+					for (; vi != ve; ++vi) pushNormalizerInput( m_cachedValues.value( vi), tidx);
+				}
+				++cachedidx;
+				continue;
+			}
+			else if (startStep == fallbackStep)
+			{
+				if (step == nofSteps)
+				{
+					std::size_t vi = m_fallbackValues.valuesStart( fallbackidx), ve = m_fallbackValues.valuesEnd( fallbackidx);
+					for (; vi != ve; ++vi) pushNormalizerInput( m_fallbackValues.value( vi), tidx);
+					++fallbackidx;
+				}
+				continue;
+			}
+			else if (startStep < step)
+			{
+				for (; itemidx < nofItems && m_itemToken[ itemidx] == tidx; ++itemidx)
+				{
+					std::size_t vi = m_normalizedValues.valuesStart( itemidx), ve = m_normalizedValues.valuesEnd( itemidx);
+					for (; vi != ve; ++vi) pushNormalizerInput( m_normalizedValues.value( vi), tidx);
+				}
+			}
+			else if (startStep == step)
+			{
+				if (step == 0)
+				{
+					pushNormalizerInput( analyzer::TokenSpan( segsrc + ti->origpos().ofs(), ti->origsize()), tidx);
+				}
+				else
+				{
+					int slot = m_featureConfigMap->normalizerSlot( featidx, step-1);
+					pushNormalizerInput( m_normalizerResults[ tidx * nofSlots + slot], tidx);
+				}
+			}
+			if (step > 0 && step < nofSteps && startStep <= step && m_normalizerInput.size() - inputStart != 1)
+			{
+				// ... the previous normalizer returned not exactly one value and is not the last one
+				m_normalizerInput.resize( inputStart);
+				m_normalizerInputToken.resize( inputStart);
+				m_tokenStartStep[ tidx] = fallbackStep;
+				hasFallback = true;
+			}
+		}
+		if (step == nofSteps) break;
+
+		// Apply the normalizer:
+		m_normalizedNext.clear();
+		if (!m_normalizerInput.empty())
+		{
+			normalizers[ step]->normalizeBatch( &m_normalizerInput[0], m_normalizerInput.size(), m_normalizedNext);
+		}
+		if (m_normalizedNext.nofTokens() != m_normalizerInput.size())
+		{
+			const char* errmsg = m_errorhnd->hasError() ? m_errorhnd->fetchError() : _TXT("incomplete result");
+			throw strus::runtime_error( _TXT("error in normalizer '%s': %s"), normalizers[ step]->name(), errmsg);
+		}
+		m_normalizedValues.swap( m_normalizedNext);
+		m_itemToken.swap( m_normalizerInputToken);
+
+		// Store the results of normalizers shared by several features:
+		int slot = sharing ? m_featureConfigMap->normalizerSlot( featidx, step) : -1;
+		if (slot >= 0)
+		{
+			std::size_t ii = 0, ie = m_itemToken.size();
+			while (ii != ie)
+			{
+				std::size_t tidx = m_itemToken[ ii];
+				std::size_t vi = m_normalizedValues.valuesStart( ii);
+				for (++ii; ii != ie && m_itemToken[ ii] == tidx; ++ii){}
+				std::size_t ve = m_normalizedValues.valuesEnd( ii-1);
+				m_normalizerResults[ tidx * nofSlots + slot] = m_normalizedValues.normalizeResult( vi, ve);
+				m_normalizerResultValid[ tidx * nofSlots + slot] = 1;
+			}
+		}
+	}
+	if (cache)
+	{
+		// Insert the results of the tokens not found in the cache:
+		std::size_t vi = 0, ve = m_normalizerInput.size();
+		for (ti = tokens.begin(); ti != te; ++ti)
+		{
+			std::size_t tidx = ti - tokens.begin();
+			std::size_t vstart = vi;
+			for (; vi != ve && m_normalizerInputToken[ vi] == tidx; ++vi){}
+			if (m_tokenStartStep[ tidx] != cachedStep)
+			{
+				cache->put( segsrc + ti->origpos().ofs(), ti->origsize(), normalizeResultString( m_normalizerInput, vstart, vi));
+			}
+		}
+	}
+}
+
 void SegmentProcessor::processDocumentSegment( int featidx, std::size_t segmentpos, const char* segsrc, std::size_t segsrcsize, const std::vector<SegPosDef>& concatposmap)
 {
 	const FeatureConfig& feat = m_featureConfigMap->featureConfig( featidx);
 	DEBUG_EVENT2_STR( "segment", "%s [%s]", feat.name().c_str(), strus::getStringContentStart( std::string( segsrc, segsrcsize), 200));
 
-	std::vector<analyzer::Token> tokens = feat.tokenize( segsrc, segsrcsize);
+	// Features with the same selector and tokenizer get the same segments one after the other, they share the tokenization:
+	int tokenizerGroup = concatposmap.empty() ? m_featureConfigMap->tokenizerGroup( featidx) : 0;
+	if (!tokenizerGroup
+	||  tokenizerGroup != m_tokenizerGroup
+	||  segsrc != m_tokenSegmentPtr
+	||  segsrcsize != m_tokenSegmentSize
+	||  segmentpos != m_tokenSegmentPos)
+	{
+		feat.tokenizeInto( segsrc, segsrcsize, m_tokens);
+		m_tokenizerGroup = tokenizerGroup;
+		resetSharedNormalizerResults();
+		m_tokenSegmentPtr = segsrc;
+		m_tokenSegmentSize = segsrcsize;
+		m_tokenSegmentPos = segmentpos;
+	}
+	else
+	{
+		DEBUG_EVENT1( "shared-tokens", "%d", (int)m_tokens.size());
+	}
+	const std::vector<analyzer::Token>& tokens = m_tokens;
 	switch (feat.featureClass())
 	{
 		case FeatMetaData:
 		{
-			processContentTokens( m_metadataTerms, feat, tokens, segsrc, segmentpos, concatposmap);
+			processContentTokens( m_metadataTerms, featidx, feat, tokens, segsrc, segmentpos, concatposmap);
 			break;
 		}
 		case FeatAttribute:
 		{
-			processContentTokens( m_attributeTerms, feat, tokens, segsrc, segmentpos, concatposmap);
+			processContentTokens( m_attributeTerms, featidx, feat, tokens, segsrc, segmentpos, concatposmap);
 			break;
 		}
 		case FeatSearchIndexTerm:
 		{
-			processContentTokens( m_searchTerms, feat, tokens, segsrc, segmentpos, concatposmap);
+			processContentTokens( m_searchTerms, featidx, feat, tokens, segsrc, segmentpos, concatposmap);
 			break;
 		}
 		case FeatForwardIndexTerm:
 		{
-			processContentTokens( m_forwardTerms, feat, tokens, segsrc, segmentpos, concatposmap);
+			processContentTokens( m_forwardTerms, featidx, feat, tokens, segsrc, segmentpos, concatposmap);
 			break;
 		}
 	}
@@ -10,10 +10,14 @@
 #include "featureConfigMap.hpp"
 #include "searchIndexStructure.hpp"
 #include "bindTerm.hpp"
+#include "ordinalPositionMap.hpp"
+#include "normalizerCache.hpp"
 #include "strus/analyzer/document.hpp"
 #include "strus/analyzer/queryTermExpression.hpp"
 #include "strus/analyzer/positionBind.hpp"
 #include "strus/analyzer/token.hpp"
+#include "strus/analyzer/tokenSpan.hpp"
+#include "strus/analyzer/normalizedOutput.hpp"
 #include <vector>
 #include <string>
 #include <map>
@@ -24,6 +28,8 @@ namespace strus
 class ErrorBufferInterface;
 /// \brief Forward declaration
 class DebugTraceContextInterface;
+/// \brief Forward declaration
+class DocumentSinkInterface;
 
 struct SegPosDef
 {
@@ -67,8 +73,21 @@ public:
 	void processConcatenated();
 	void eliminateCovered();
 
-	/// \brief Fetch the currently processed document
-	analyzer::Document fetchDocument(
+	/// \brief Define the caches to use for normalization results
+	/// \param[in] cacheMap the caches (not owned, the caller is responsible for its lifetime), NULL if not used
+	void setNormalizerCache( NormalizerCacheMap* cacheMap)
+	{
+		m_normalizerCacheMap = (cacheMap && !cacheMap->empty()) ? cacheMap : 0;
+	}
+
+	/// \brief Append the terms of another segment processor, processing segments that follow the ones processed by this
+	/// \param[in] o segment processor to take the terms from
+	void appendTerms( const SegmentProcessor& o);
+
+	/// \brief Pass the elements of the currently processed document to a sink and reset the document processing state
+	/// \note Does not call startDocument/endDocument of the sink
+	void fetchDocument(
+		DocumentSinkInterface& sink,
 		const std::vector<SeachIndexStructureConfig>& structureConfigs,
 		const std::vector<SearchIndexStructure>& structures);
 
@@ -120,15 +139,25 @@ public:
 	};
 
 	/// \brief Fetch the currently processed query
-	/// \return the query object without grouping
-	std::vector<QueryElement> fetchQuery() const;
+	/// \param[out] res where to write the query elements without grouping to
+	/// \note Short queries are mapped to ordinal positions with a sorted array on the stack
+	void fetchQuery( std::vector<QueryElement>& res);
 
 	const std::vector<BindTerm>& searchTerms() const	{return m_searchTerms;}
 	const std::vector<BindTerm>& forwardTerms() const	{return m_forwardTerms;}
+	const BindTermValueBuffer& valueBuffer() const		{return m_valueBuffer;}
 
 private:
 	void processDocumentSegment( int featidx, std::size_t segmentpos, const char* elem, std::size_t elemsize, const std::vector<SegPosDef>& concatposmap);
-	void processContentTokens( std::vector<BindTerm>& result, const FeatureConfig& feat, const std::vector<analyzer::Token>& tokens, const char* segsrc, std::size_t segmentpos, const std::vector<SegPosDef>& concatposmap) const;
+	void processContentTokens( std::vector<BindTerm>& result, int featidx, const FeatureConfig& feat, const std::vector<analyzer::Token>& tokens, const char* segsrc, std::size_t segmentpos, const std::vector<SegPosDef>& concatposmap);
+	void resetSharedNormalizerResults();
+	void normalizeTokens( const FeatureConfig& feat, int featidx, const std::vector<analyzer::Token>& tokens, const char* segsrc);
+	void pushNormalizerInput( const analyzer::TokenSpan& value, std::size_t tokidx);
+	void pushNormalizerInput( const std::string& values, std::size_t tokidx);
+	const std::string& termType( const BindTerm& term) const
+	{
+		return m_featureConfigMap->featureConfig( term.typeidx()).name();
+	}
 
 private:
 	struct Chunk
@@ -165,6 +194,26 @@ private:
 	std::vector<BindTerm> m_forwardTerms;
 	std::vector<BindTerm> m_metadataTerms;
 	std::vector<BindTerm> m_attributeTerms;
+	BindTermValueBuffer m_valueBuffer;
+	std::vector<analyzer::Token> m_tokens;		///< tokens of the last segment processed, buffer reused for all segments
+	int m_tokenizerGroup;				///< tokenizer group (FeatureConfigMap::tokenizerGroup) of m_tokens, 0 if not shareable
+	const char* m_tokenSegmentPtr;			///< segment tokenized to m_tokens
+	std::size_t m_tokenSegmentSize;			///< size of the segment tokenized to m_tokens
+	std::size_t m_tokenSegmentPos;			///< position of the segment tokenized to m_tokens
+	std::vector<std::string> m_normalizerResults;	///< normalizer results shared between features, per token of m_tokens and slot (FeatureConfigMap::normalizerSlot)
+	std::vector<char> m_normalizerResultValid;	///< flags marking the valid elements of m_normalizerResults, empty if sharing is disabled
+	NormalizerCacheMap* m_normalizerCacheMap;	///< caches for normalization results (not owned), NULL if not used
+	analyzer::NormalizedOutput m_normalizedValues;	///< values of the tokens after the last normalizer applied, one list per item of m_itemToken
+	analyzer::NormalizedOutput m_normalizedNext;	///< output of the normalizer applied
+	analyzer::NormalizedOutput m_cachedValues;	///< values of the tokens found in the normalizer cache, in the order of the tokens
+	analyzer::NormalizedOutput m_fallbackValues;	///< values of the tokens normalized with FeatureConfig::normalize, in the order of the tokens
+	std::vector<analyzer::TokenSpan> m_normalizerInput;	///< values passed to the next normalizer, or the final values after normalization
+	std::vector<std::size_t> m_normalizerInputToken;	///< token index of each element of m_normalizerInput
+	std::vector<std::size_t> m_itemToken;			///< token index of each list of values in m_normalizedValues
+	std::vector<std::size_t> m_tokenStartStep;		///< index of the first normalizer to apply per token, or a value bigger than the number of normalizers if the result was found in the cache or is computed with FeatureConfig::normalize
+	OrdinalPositionMap m_positionMap;
+	std::vector<unsigned int> m_ordposbuf;
+	std::vector<unsigned int> m_searchPositionCount;
 	ErrorBufferInterface* m_errorhnd;
 	DebugTraceContextInterface* m_debugtrace;
 };
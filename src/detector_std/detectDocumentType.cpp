@@ -38,6 +38,49 @@ static bool isDocumentJson( char const* ci, const char* ce)
 	return false;
 }
 
+/// \brief Get the end of the first JSON document of a content starting with a JSON object
+static char const* skipJsonObject( char const* ci, const char* ce)
+{
+	int depth = 0;
+	for (; ci != ce; ++ci)
+	{
+		switch (*ci)
+		{
+			case '"':
+				for (++ci; ci != ce && *ci != '"'; ++ci)
+				{
+					if (*ci == '\\' && ci+1 != ce) ++ci;
+				}
+				if (ci == ce) return 0;
+				break;
+			case '{':
+			case '[':
+				++depth;
+				break;
+			case '}':
+			case ']':
+				if (--depth == 0) return ci+1;
+				break;
+		}
+	}
+	return 0;
+}
+
+/// \brief Test for a list of JSON documents with one document per line (NDJSON, JSON Lines)
+/// \note Detected if a JSON object is followed by another one on the next line
+/// \note Only the start of the content passed is inspected, a list with a first line longer than that is detected as a single JSON document (application/json).
+///	The end of the first object is not known then and a single object can not be told apart from a list. Pass the document class explicitly for such lists.
+static bool isDocumentJsonLines( char const* ci, const char* ce)
+{
+	if (!isDocumentJson( ci, ce)) return false;
+	ci = skipJsonObject( ci, ce);
+	if (!ci) return false;
+	for (; ci != ce && (*ci == ' ' || *ci == '\t' || *ci == '\r'); ++ci){}
+	if (ci == ce || *ci != '\n') return false;
+	for (++ci; ci != ce && (unsigned char)*ci <= 32; ++ci){}
+	return ci != ce && *ci == '{';
+}
+
 static int checkDocumentTSV( char const* ci, const char* ce)
 {
 	unsigned int seps[2];
@@ -204,7 +247,11 @@ DocumentType strus::detectDocumentType( const char* src, std::size_t srcsize, bo
 	char const* si = src+BOMsize;
 	const char* se = src+srcsize-BOMsize;
 
-	if (isDocumentJson( si, se))
+	if (isDocumentJsonLines( si, se))
+	{
+		return DocumentType( DocumentType::MimeNDJSON, "application/x-ndjson", encoding);
+	}
+	else if (isDocumentJson( si, se))
 	{
 		return DocumentType( DocumentType::MimeJSON, "application/json", encoding);
 	}
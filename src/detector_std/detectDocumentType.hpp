@@ -18,7 +18,7 @@ namespace strus
 
 struct DocumentType
 {
-	enum MimeType {MimeBinary,MimeXML,MimeJSON,MimeTSV,MimeTEXT};
+	enum MimeType {MimeBinary,MimeXML,MimeJSON,MimeNDJSON,MimeTSV,MimeTEXT};
 
 	MimeType mimetypeid;
 	const char* mimetype;
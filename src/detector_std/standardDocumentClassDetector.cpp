@@ -242,6 +242,15 @@ bool StandardDocumentClassDetector::detect( analyzer::DocumentClass& dclass, con
 						(void)detectSchema( m_jsonSegmenter.get(), dclass, contentBegin, contentBeginSize, isComplete);
 					}
 					break;
+				case DocumentType::MimeNDJSON:
+					if (m_jsonSegmenter.get())
+					{
+						// ... the schema is detected from the first document in the list
+						const char* eoln = (const char*)std::memchr( contentBegin, '\n', contentBeginSize);
+						std::size_t firstLineSize = eoln ? (eoln - contentBegin) : contentBeginSize;
+						(void)detectSchema( m_jsonSegmenter.get(), dclass, contentBegin, firstLineSize, isComplete || eoln != 0);
+					}
+					break;
 				case DocumentType::MimeTSV:
 					if (m_tsvSegmenter.get())
 					{
@@ -37,6 +37,9 @@ public:
 
 	typedef const char* (*ExceptionsF)( unsigned int chr);
 	std::string rewrite( const char* src, std::size_t srcsize, ExceptionsF exceptions, ErrorBufferInterface* errorhnd) const;
+	/// \brief Append the rewritten input to an output with std::string like append methods, throws on error
+	template <class Output>
+	void rewrite( Output& out, const char* src, std::size_t srcsize, ExceptionsF exceptions) const;
 	const char* name() const	{return m_name;}
 
 private:
@@ -65,8 +68,8 @@ class CharMapNormalizerInstance
 	:public NormalizerFunctionInstanceInterface
 {
 public:
-	CharMapNormalizerInstance( const char* name_, CharMap::ConvType maptype_, CharMap::ExceptionsF exceptions_, ErrorBufferInterface* errorhnd_)
-		:m_name(name_),m_map(CharMap::getMap(maptype_)),m_maptype(maptype_),m_exceptions(exceptions_),m_errorhnd(errorhnd_){}
+	CharMapNormalizerInstance( const char* name_, CharMap::ConvType maptype_, CharMap::ExceptionsF exceptions_, const char* language_, ErrorBufferInterface* errorhnd_)
+		:m_name(name_),m_map(CharMap::getMap(maptype_)),m_maptype(maptype_),m_exceptions(exceptions_),m_language(language_),m_errorhnd(errorhnd_){}
 
 	virtual std::string normalize(
 			const char* src,
@@ -75,13 +78,37 @@ public:
 		return m_map->rewrite( src, srcsize, m_exceptions, m_errorhnd);
 	}
 
+	virtual void normalizeBatch(
+			const analyzer::TokenSpan* in,
+			std::size_t n,
+			analyzer::NormalizedOutput& out) const
+	{
+		try
+		{
+			for (std::size_t ii=0; ii < n; ++ii)
+			{
+				m_map->rewrite( out, in[ ii].ptr(), in[ ii].size(), m_exceptions);
+				out.closeValue();
+				out.closeToken();
+			}
+		}
+		CATCH_ERROR_MAP( _TXT("error in normalizer: %s"), *m_errorhnd);
+	}
+
 	virtual const char* name() const	{return m_name;}
 
 	virtual StructView view() const
 	{
 		try
 		{
-			return StructView()("name", name());
+			StructView rt;
+			rt( "name", name());
+			if (m_language)
+			{
+				// ... the language selects the exceptions of the mapping, instances with a different language normalize differently
+				rt( "language", m_language);
+			}
+			return rt;
 		}
 		CATCH_ERROR_MAP_RETURN( _TXT("error in introspection: %s"), *m_errorhnd, StructView());
 	}
@@ -91,6 +118,7 @@ private:
 	const CharMap* m_map;
 	CharMap::ConvType m_maptype;
 	CharMap::ExceptionsF m_exceptions;
+	const char* m_language;			///< language of the exceptions or NULL if there are none
 	ErrorBufferInterface* m_errorhnd;
 };
 
@@ -4371,44 +4399,50 @@ void CharMap::load( ConvType type)
 	}
 }
 
-std::string CharMap::rewrite( const char* src, std::size_t srcsize, CharMap::ExceptionsF exceptions, ErrorBufferInterface* errorhnd) const
+template <class Output>
+void CharMap::rewrite( Output& out, const char* src, std::size_t srcsize, CharMap::ExceptionsF exceptions) const
 {
-	try
-	{
-		std::string rt;
-		textwolf::charset::UTF8 utf8;
-		char buf[16];
-		unsigned int bufpos;
-		textwolf::CStringIterator itr( src, srcsize);
+	textwolf::charset::UTF8 utf8;
+	char buf[16];
+	unsigned int bufpos;
+	textwolf::CStringIterator itr( src, srcsize);
 
-		while (*itr)
+	while (*itr)
+	{
+		bufpos = 0;
+		textwolf::UChar value = utf8.value( buf, bufpos, itr);
+		if (exceptions)
 		{
-			bufpos = 0;
-			textwolf::UChar value = utf8.value( buf, bufpos, itr);
-			if (exceptions)
-			{
-				const char* res = (*exceptions)(value);
-				if (res)
-				{
-					rt.append(res);
-					continue;
-				}
-			}
-			std::map<unsigned int,std::size_t>::const_iterator mi = m_map.find( value);
-			if (mi == m_map.end())
+			const char* res = (*exceptions)(value);
+			if (res)
 			{
-				if (value == textwolf::charset::UTF8::MaxChar)
-				{
-					std::string tok( src, srcsize);
-					throw strus::runtime_error( _TXT( "illegal UTF-8 character in input: '%s'"), tok.c_str());
-				}
-				rt.append( buf, bufpos);
+				out.append(res);
+				continue;
 			}
-			else
+		}
+		std::map<unsigned int,std::size_t>::const_iterator mi = m_map.find( value);
+		if (mi == m_map.end())
+		{
+			if (value == textwolf::charset::UTF8::MaxChar)
 			{
-				rt.append( m_strings.c_str() + mi->second);
+				std::string tok( src, srcsize);
+				throw strus::runtime_error( _TXT( "illegal UTF-8 character in input: '%s'"), tok.c_str());
 			}
+			out.append( buf, bufpos);
+		}
+		else
+		{
+			out.append( m_strings.c_str() + mi->second);
 		}
+	}
+}
+
+std::string CharMap::rewrite( const char* src, std::size_t srcsize, CharMap::ExceptionsF exceptions, ErrorBufferInterface* errorhnd) const
+{
+	try
+	{
+		std::string rt;
+		rewrite( rt, src, srcsize, exceptions);
 		return rt;
 	}
 	CATCH_ERROR_MAP_RETURN( _TXT("error in normalizer: %s"), *errorhnd, std::string());
@@ -4423,7 +4457,7 @@ NormalizerFunctionInstanceInterface* LowercaseNormalizerFunction::createInstance
 	}
 	try
 	{
-		return new CharMapNormalizerInstance( "lc", CharMap::Lowercase, 0, m_errorhnd);
+		return new CharMapNormalizerInstance( "lc", CharMap::Lowercase, 0, 0, m_errorhnd);
 	}
 	catch (const std::bad_alloc&)
 	{
@@ -4452,7 +4486,7 @@ NormalizerFunctionInstanceInterface* UppercaseNormalizerFunction::createInstance
 	}
 	try
 	{
-		return new CharMapNormalizerInstance( "uc", CharMap::Uppercase, 0, m_errorhnd);
+		return new CharMapNormalizerInstance( "uc", CharMap::Uppercase, 0, 0, m_errorhnd);
 	}
 	catch (const std::bad_alloc&)
 	{
@@ -4497,18 +4531,18 @@ NormalizerFunctionInstanceInterface* DiacriticalNormalizerFunction::createInstan
 		}
 		if (args.size() == 0)
 		{
-			return new CharMapNormalizerInstance( "convdia", CharMap::Diacritical, 0, m_errorhnd);
+			return new CharMapNormalizerInstance( "convdia", CharMap::Diacritical, 0, 0, m_errorhnd);
 		}
 		else
 		{
 			std::string language_lo = string_conv::tolower( args[0]);
 			if (language_lo == "de")
 			{
-				return new CharMapNormalizerInstance( "convdia", CharMap::Diacritical, germanUmlautExceptions, m_errorhnd);
+				return new CharMapNormalizerInstance( "convdia", CharMap::Diacritical, germanUmlautExceptions, "de", m_errorhnd);
 			}
 			else
 			{
-				return new CharMapNormalizerInstance( "convdia", CharMap::Diacritical, 0, m_errorhnd);
+				return new CharMapNormalizerInstance( "convdia", CharMap::Diacritical, 0, 0, m_errorhnd);
 			}
 		}
 	}
@@ -4649,35 +4683,29 @@ public:
 		try
 		{
 			std::string rt;
-			textwolf::charset::UTF8 utf8;
-			char buf[16];
-			unsigned int bufpos;
-			textwolf::CStringIterator itr( src, srcsize);
-			bool selected = false;
-	
-			while (*itr)
-			{
-				bufpos = 0;
-				textwolf::UChar value = utf8.value( buf, bufpos, itr);
-				if (m_set.isMember( value))
-				{
-					rt.append( buf, bufpos);
-					selected = true;
-				}
-				else
-				{
-					if (selected)
-					{
-						rt.push_back( ' ');
-					}
-					selected = false;
-				}
-			}
+			select( rt, src, srcsize);
 			return rt;
 		}
 		CATCH_ERROR_ARG1_MAP_RETURN( _TXT("error in '%s' normalizer: %s"), "charselect", *m_errorhnd, 0);
 	}
 
+	virtual void normalizeBatch(
+			const analyzer::TokenSpan* in,
+			std::size_t n,
+			analyzer::NormalizedOutput& out) const
+	{
+		try
+		{
+			for (std::size_t ii=0; ii < n; ++ii)
+			{
+				select( out, in[ ii].ptr(), in[ ii].size());
+				out.closeValue();
+				out.closeToken();
+			}
+		}
+		CATCH_ERROR_ARG1_MAP( _TXT("error in '%s' normalizer: %s"), "charselect", *m_errorhnd);
+	}
+
 	virtual const char* name() const	{return "charselect";}
 	virtual StructView view() const
 	{
@@ -4691,6 +4719,36 @@ public:
 		CATCH_ERROR_MAP_RETURN( _TXT("error in introspection: %s"), *m_errorhnd, StructView());
 	}
 
+private:
+	template <class Output>
+	void select( Output& out, const char* src, std::size_t srcsize) const
+	{
+		textwolf::charset::UTF8 utf8;
+		char buf[16];
+		unsigned int bufpos;
+		textwolf::CStringIterator itr( src, srcsize);
+		bool selected = false;
+
+		while (*itr)
+		{
+			bufpos = 0;
+			textwolf::UChar value = utf8.value( buf, bufpos, itr);
+			if (m_set.isMember( value))
+			{
+				out.append( buf, bufpos);
+				selected = true;
+			}
+			else
+			{
+				if (selected)
+				{
+					out.push_back( ' ');
+				}
+				selected = false;
+			}
+		}
+	}
+
 private:
 	CharSet m_set;
 	std::vector<std::string> m_setnames;
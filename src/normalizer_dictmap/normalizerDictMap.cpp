@@ -31,6 +31,9 @@ public:
 	virtual ~KeyMap(){}
 	virtual bool set( const std::string& key, const std::string& value)=0;
 	virtual bool get( const std::string& key, std::string& value) const=0;
+	/// \brief Find the value of a key without copying it
+	/// \return pointer to the null terminated value or NULL if not found
+	virtual const char* find( const std::string& key) const=0;
 };
 
 
@@ -42,6 +45,7 @@ public:
 
 	virtual bool set( const std::string& key, const std::string& value);
 	virtual bool get( const std::string& key, std::string& value) const;
+	virtual const char* find( const std::string& key) const;
 
 private:
 	conotrie::CompactNodeTrie m_map;
@@ -60,12 +64,19 @@ bool DictMap::set( const std::string& key, const std::string& value)
 
 bool DictMap::get( const std::string& key, std::string& value) const
 {
-	conotrie::CompactNodeTrie::NodeData validx;
-	if (!m_map.get( key.c_str(), validx)) return false;
-	value.append( m_value_strings.c_str() + validx);
+	const char* res = find( key);
+	if (!res) return false;
+	value.append( res);
 	return true;
 }
 
+const char* DictMap::find( const std::string& key) const
+{
+	conotrie::CompactNodeTrie::NodeData validx;
+	if (!m_map.get( key.c_str(), validx)) return 0;
+	return m_value_strings.c_str() + validx;
+}
+
 
 class HashMap :public KeyMap
 {
@@ -76,6 +87,7 @@ public:
 
 	virtual bool set( const std::string& key, const std::string& value);
 	virtual bool get( const std::string& key, std::string& value) const;
+	virtual const char* find( const std::string& key) const;
 
 private:
 	SymbolTable m_symtab;
@@ -97,12 +109,19 @@ bool HashMap::set( const std::string& key, const std::string& value)
 
 bool HashMap::get( const std::string& key, std::string& value) const
 {
-	uint32_t id = m_symtab.get( key);
-	if (!id) return false;
-	value.append( m_value_strings.c_str() + m_value_refs[ id-1]);
+	const char* res = find( key);
+	if (!res) return false;
+	value.append( res);
 	return true;
 }
 
+const char* HashMap::find( const std::string& key) const
+{
+	uint32_t id = m_symtab.get( key);
+	if (!id) return 0;
+	return m_value_strings.c_str() + m_value_refs[ id-1];
+}
+
 static void loadFile( KeyMap* keymap, const std::string& filename)
 {
 	std::string content;
@@ -200,6 +219,36 @@ public:
 		CATCH_ERROR_ARG1_MAP_RETURN( _TXT("error in '%s' normalizer: %s"), NORMALIZER_NAME, *m_errorhnd, std::string());
 	}
 
+	virtual void normalizeBatch(
+			const analyzer::TokenSpan* in,
+			std::size_t n,
+			analyzer::NormalizedOutput& out) const
+	{
+		try
+		{
+			std::string key;	// ... buffer reused for all tokens of the batch
+			for (std::size_t ii=0; ii < n; ++ii)
+			{
+				key.assign( in[ ii].ptr(), in[ ii].size());
+				const char* res = m_map->find( key);
+				if (res)
+				{
+					out.addValue( res, std::strlen( res));
+				}
+				else if (m_defaultOrig)
+				{
+					out.addValue( key.c_str(), key.size());
+				}
+				else
+				{
+					out.addValue( m_defaultResult.c_str(), m_defaultResult.size());
+				}
+				out.closeToken();
+			}
+		}
+		CATCH_ERROR_ARG1_MAP( _TXT("error in '%s' normalizer: %s"), NORMALIZER_NAME, *m_errorhnd);
+	}
+
 	virtual const char* name() const	{return NORMALIZER_NAME;}
 	virtual StructView view() const
 	{
@@ -49,23 +49,7 @@ public:
 		try
 		{
 			std::string tok;
-			if (m_config.withStart)
-			{
-				tok.push_back( '_');
-			}
-			tok.append( src, srcsize);
-			if (m_config.withEnd)
-			{
-				tok.push_back( '_');
-			}
-			if (m_config.roundRobin)
-			{
-				std::size_t ii=0;
-				for (;ii+1<m_config.width; ++ii)
-				{
-					tok.push_back( tok[ii]);
-				}
-			}
+			expandToken( tok, src, srcsize);
 			std::string rt;
 			std::size_t ti = 0, te = tok.size();
 			if (te < m_config.width)
@@ -86,6 +70,35 @@ public:
 		CATCH_ERROR_MAP_RETURN( _TXT("error in normalize: %s"), *m_errorhnd, std::string());
 	}
 
+	virtual void normalizeBatch(
+			const analyzer::TokenSpan* in,
+			std::size_t n,
+			analyzer::NormalizedOutput& out) const
+	{
+		try
+		{
+			std::string tok;	// ... buffer reused for all tokens of the batch
+			for (std::size_t ii=0; ii < n; ++ii)
+			{
+				expandToken( tok, in[ ii].ptr(), in[ ii].size());
+				std::size_t ti = 0, te = tok.size();
+				if (te < m_config.width)
+				{
+					out.addValue( tok.c_str(), tok.size());
+				}
+				else
+				{
+					for (; ti+m_config.width <= te; ++ti)
+					{
+						out.addValue( tok.c_str()+ti, m_config.width);
+					}
+				}
+				out.closeToken();
+			}
+		}
+		CATCH_ERROR_MAP( _TXT("error in normalize: %s"), *m_errorhnd);
+	}
+
 	virtual const char* name() const	{return NORMALIZER_NAME;}
 	virtual StructView view() const
 	{
@@ -102,6 +115,30 @@ public:
 		CATCH_ERROR_MAP_RETURN( _TXT("error in introspection: %s"), *m_errorhnd, StructView());
 	}
 
+private:
+	/// \brief Build the string to split into ngrams in a buffer
+	void expandToken( std::string& tok, const char* src, std::size_t srcsize) const
+	{
+		tok.clear();
+		if (m_config.withStart)
+		{
+			tok.push_back( '_');
+		}
+		tok.append( src, srcsize);
+		if (m_config.withEnd)
+		{
+			tok.push_back( '_');
+		}
+		if (m_config.roundRobin)
+		{
+			std::size_t ii=0;
+			for (;ii+1<m_config.width; ++ii)
+			{
+				tok.push_back( tok[ii]);
+			}
+		}
+	}
+
 private:
 	NgramConfiguration m_config;
 	ErrorBufferInterface* m_errorhnd;
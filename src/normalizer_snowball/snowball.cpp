@@ -60,6 +60,33 @@ public:
 		}
 	}
 
+	virtual void normalizeBatch( const analyzer::TokenSpan* in, std::size_t n, analyzer::NormalizedOutput& out) const
+	{
+		try
+		{
+			// The stemmer environment is initialized once and reused for all tokens of the batch:
+			sb_stemmer_env env;
+			sb_stemmer_UTF_8_init_env( m_stemmer, &env);
+			for (std::size_t ii=0; ii < n; ++ii)
+			{
+				const sb_symbol* res = sb_stemmer_stem_threadsafe( m_stemmer, &env, (const sb_symbol*)in[ ii].ptr(), in[ ii].size());
+				if (!res)
+				{
+					out.addValue( in[ ii].ptr(), in[ ii].size());
+				}
+				else
+				{
+					out.addValue( (const char*)res, (std::size_t)sb_stemmer_length_threadsafe( &env));
+				}
+				out.closeToken();
+			}
+		}
+		catch (const std::bad_alloc& )
+		{
+			m_errorhnd->report( ErrorCodeOutOfMem, "memory allocation error in stemmer");
+		}
+	}
+
 	virtual const char* name() const	{return "stem";}
 	virtual StructView view() const
 	{
@@ -48,6 +48,23 @@ public:
 		CATCH_ERROR_ARG1_MAP_RETURN( _TXT("error in %s normalize: %s"), NORMALIZER_NAME, *m_errorhnd, std::string());
 	}
 
+	virtual void normalizeBatch(
+			const analyzer::TokenSpan* in,
+			std::size_t n,
+			analyzer::NormalizedOutput& out) const
+	{
+		try
+		{
+			for (std::size_t ii=0; ii < n; ++ii)
+			{
+				std::pair<const char*,const char*> boundaries = trim( in[ ii].ptr(), in[ ii].ptr() + in[ ii].size());
+				out.addValue( boundaries.first, boundaries.second - boundaries.first);
+				out.closeToken();
+			}
+		}
+		CATCH_ERROR_ARG1_MAP( _TXT("error in %s normalize: %s"), NORMALIZER_NAME, *m_errorhnd);
+	}
+
 	virtual const char* name() const	{return NORMALIZER_NAME;}
 	virtual StructView view() const
 	{
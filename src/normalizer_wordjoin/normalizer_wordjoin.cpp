@@ -36,27 +36,29 @@ public:
 		try
 		{
 			std::string rt;
-			char const* si = skipToToken( src, src+srcsize);
-			const char* se = src+srcsize;
-		
-			for (;si < se; si = skipToToken(si,se))
-			{
-				const char* start = si;
-				while (si < se && !wordBoundaryDelimiter( si, se))
-				{
-					si = skipChar( si);
-				}
-				if (!rt.empty())
-				{
-					rt.append( m_jointoken);
-				}
-				rt.append( start, si);
-			}
+			join( rt, src, srcsize);
 			return rt;
 		}
 		CATCH_ERROR_ARG1_MAP_RETURN( _TXT("error in %s normalize: %s"), NORMALIZER_NAME, *m_errorhnd, std::string());
 	}
 
+	virtual void normalizeBatch(
+			const analyzer::TokenSpan* in,
+			std::size_t n,
+			analyzer::NormalizedOutput& out) const
+	{
+		try
+		{
+			for (std::size_t ii=0; ii < n; ++ii)
+			{
+				join( out, in[ ii].ptr(), in[ ii].size());
+				out.closeValue();
+				out.closeToken();
+			}
+		}
+		CATCH_ERROR_ARG1_MAP( _TXT("error in %s normalize: %s"), NORMALIZER_NAME, *m_errorhnd);
+	}
+
 	virtual const char* name() const	{return NORMALIZER_NAME;}
 	virtual StructView view() const
 	{
@@ -70,6 +72,31 @@ public:
 		CATCH_ERROR_MAP_RETURN( _TXT("error in introspection: %s"), *m_errorhnd, StructView());
 	}
 
+private:
+	/// \brief Append the words of the input joined to an output with std::string like append methods
+	template <class Output>
+	void join( Output& out, const char* src, std::size_t srcsize) const
+	{
+		char const* si = skipToToken( src, src+srcsize);
+		const char* se = src+srcsize;
+		bool first = true;
+
+		for (;si < se; si = skipToToken(si,se))
+		{
+			const char* start = si;
+			while (si < se && !wordBoundaryDelimiter( si, se))
+			{
+				si = skipChar( si);
+			}
+			if (!first)
+			{
+				out.append( m_jointoken.c_str(), m_jointoken.size());
+			}
+			out.append( start, si - start);
+			first = false;
+		}
+	}
+
 private:
 	std::string m_jointoken;
 	ErrorBufferInterface* m_errorhnd;
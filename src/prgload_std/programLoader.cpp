@@ -299,15 +299,23 @@ static analyzer::FeatureOptions parseFeatureOptions( ProgramLexer& lexer)
 					throw strus::runtime_error( _TXT("assign '=' instead of %s expected after open curly brackets '{' and option identifier"), tokenName( lexer.current()));
 				}
 				cur = lexer.next();
-				if (cur.isString() || cur.isToken( TokIdentifier))
+				if (cur.isString() || cur.isToken( TokIdentifier) || cur.isToken( TokInteger))
 				{
 					optval = cur.value();
 				}
 				else
 				{
-					throw strus::runtime_error( _TXT("identifier or string expected instead of %s as option value"), tokenName( lexer.current()));
+					throw strus::runtime_error( _TXT("identifier, integer or string expected instead of %s as option value"), tokenName( lexer.current()));
 				}
-				if (strus::caseInsensitiveEquals( optname, "position"))
+				if (strus::caseInsensitiveEquals( optname, "cache"))
+				{
+					if (!cur.isToken( TokInteger))
+					{
+						throw strus::runtime_error( _TXT("integer expected instead of %s as 'cache' option value"), optval.c_str());
+					}
+					rt.defineNormalizerCacheSize( numstring_conv::touint( optval, analyzer::FeatureOptions::MaxNormalizerCacheSize));
+				}
+				else if (strus::caseInsensitiveEquals( optname, "position"))
 				{
 					if (strus::caseInsensitiveEquals( optval, "succ"))
 					{
@@ -38,7 +38,7 @@ static void getTextwolfValue( std::vector<TextwolfItem>& tiar, cJSON const* nd,
 	}
 }
 
-void strus::getTextwolfItems( std::vector<TextwolfItem>& itemar, cJSON const* nd)
+void strus::getTextwolfItems( std::vector<TextwolfItem>& itemar, std::deque<std::string>& idxstrings, cJSON const* nd)
 {
 	typedef textwolf::XMLScannerBase TX;
 	switch (nd->type & 0x7F)
@@ -74,19 +74,21 @@ void strus::getTextwolfItems( std::vector<TextwolfItem>& itemar, cJSON const* nd
 				for (;chnd; chnd = chnd->next)
 				{
 					itemar.push_back( TextwolfItem( TX::OpenTag, nd->string));
-					getTextwolfItems( itemar, chnd);
+					getTextwolfItems( itemar, idxstrings, chnd);
 					itemar.push_back( TextwolfItem( TX::CloseTag, nd->string));
 				}
 			}
 			else
 			{
 				unsigned int idx=0;
-				char idxstr[ 64];
-				for (;chnd; chnd = chnd->next)
+				char idxbuf[ 64];
+				for (;chnd; chnd = chnd->next,++idx)
 				{
-					snprintf( idxstr, sizeof( idxstr), "%u", idx);
+					snprintf( idxbuf, sizeof( idxbuf), "%u", idx);
+					idxstrings.push_back( idxbuf);
+					const char* idxstr = idxstrings.back().c_str();
 					itemar.push_back( TextwolfItem( TX::OpenTag, idxstr));
-					getTextwolfItems( itemar, chnd);
+					getTextwolfItems( itemar, idxstrings, chnd);
 					itemar.push_back( TextwolfItem( TX::CloseTag, idxstr));
 				}
 			}
@@ -100,7 +102,7 @@ void strus::getTextwolfItems( std::vector<TextwolfItem>& itemar, cJSON const* nd
 				itemar.push_back( TextwolfItem( TX::OpenTag, nd->string));
 				for (;chnd; chnd = chnd->next)
 				{
-					getTextwolfItems( itemar, chnd);
+					getTextwolfItems( itemar, idxstrings, chnd);
 				}
 				itemar.push_back( TextwolfItem( TX::CloseTag, nd->string));
 			}
@@ -108,7 +110,7 @@ void strus::getTextwolfItems( std::vector<TextwolfItem>& itemar, cJSON const* nd
 			{
 				for (;chnd; chnd = chnd->next)
 				{
-					getTextwolfItems( itemar, chnd);
+					getTextwolfItems( itemar, idxstrings, chnd);
 				}
 			}
 			break;
@@ -11,6 +11,7 @@
 #include "cjson/cJSON.h"
 #include <cstdlib>
 #include <vector>
+#include <deque>
 #include <string>
 
 #define SEGMENTER_NAME "cjson"
@@ -38,7 +39,11 @@ struct TextwolfItem
 };
 
 
-void getTextwolfItems( std::vector<TextwolfItem>& itemar, cJSON const* nd);
+/// \brief Get the list of textwolf XML events of a cJSON tree
+/// \param[out] itemar where to append the events to
+/// \param[in,out] idxstrings where to keep the strings of the index tags of elements of arrays without name, the items refer to them
+/// \param[in] nd cJSON tree
+void getTextwolfItems( std::vector<TextwolfItem>& itemar, std::deque<std::string>& idxstrings, cJSON const* nd);
 
 cJSON* parseJsonTree( const std::string& content);
 
@@ -37,6 +37,7 @@ ContentIterator::ContentIterator(
 	,m_expressions(expressions_)
 	,m_encoder(encoder_)
 	,m_ar()
+	,m_idxstrings()
 	,m_tree(0)
 	,m_stm(&m_attributes)
 	,m_path()
@@ -54,7 +55,7 @@ ContentIterator::ContentIterator(
 		}
 		m_tree = strus::parseJsonTree( m_content);
 
-		strus::getTextwolfItems( m_ar, m_tree);
+		strus::getTextwolfItems( m_ar, m_idxstrings, m_tree);
 		m_elemitr = m_ar.begin();
 
 		if (!expressions_.empty())
@@ -21,6 +21,7 @@
 #include "cjson2textwolf.hpp"
 #include <cstdlib>
 #include <vector>
+#include <deque>
 #include <set>
 #include <setjmp.h>
 
@@ -62,6 +63,7 @@ private:
 	std::vector<std::string> m_expressions;
 	strus::Reference<strus::utils::TextEncoderBase> m_encoder;
 	std::vector<TextwolfItem> m_ar;
+	std::deque<std::string> m_idxstrings;
 	std::vector<TextwolfItem>::const_iterator m_elemitr;
 	cJSON* m_tree;
 	ContentIteratorStm m_stm;
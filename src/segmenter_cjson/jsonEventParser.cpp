@@ -0,0 +1,637 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Incremental parser of a JSON document into a stream of XML events
+/// \file jsonEventParser.cpp
+#include "jsonEventParser.hpp"
+#include "private/internationalization.hpp"
+#include <cstring>
+#include <cstdio>
+
+using namespace strus;
+
+#define CJSON_NESTING_LIMIT 1000
+
+typedef textwolf::XMLScannerBase TX;
+
+JsonEventParser::JsonEventParser()
+	:m_buf(),m_bufpos(0),m_scanpos(0),m_eof(false),m_line(1),m_column(1)
+	,m_state(StateStart),m_stack(),m_key(),m_hasKey(false),m_value()
+	,m_events(),m_eventidx(0),m_eventbuf()
+{
+	m_stack.push_back( Frame());
+}
+
+void JsonEventParser::clear()
+{
+	m_buf.clear();
+	m_bufpos = 0;
+	m_scanpos = 0;
+	m_eof = false;
+	m_line = 1;
+	m_column = 1;
+	m_state = StateStart;
+	m_stack.resize( 1);
+	m_key.clear();
+	m_hasKey = false;
+	m_value.clear();
+	m_events.clear();
+	m_eventidx = 0;
+	m_eventbuf.clear();
+}
+
+void JsonEventParser::compact()
+{
+	if (!m_bufpos) return;
+	char const* si = m_buf.c_str();
+	const char* se = si + m_bufpos;
+	for (; si != se; ++si)
+	{
+		if (*si == '\n')
+		{
+			++m_line;
+			m_column = 1;
+		}
+		else
+		{
+			++m_column;
+		}
+	}
+	m_buf.erase( 0, m_bufpos);
+	m_scanpos = m_scanpos > m_bufpos ? (m_scanpos - m_bufpos) : 0;
+	m_bufpos = 0;
+}
+
+void JsonEventParser::putInput( const char* chunk, std::size_t chunksize, bool eof)
+{
+	if (m_eof)
+	{
+		throw strus::runtime_error( _TXT("feeding more input after end of input"));
+	}
+	m_eof = eof;
+	if (m_state == StateDone) return;
+
+	compact();
+	m_buf.append( chunk, chunksize);
+}
+
+void JsonEventParser::throwError( const char* msg) const
+{
+	std::size_t line = m_line, col = m_column;
+	char const* si = m_buf.c_str();
+	const char* se = si + m_bufpos;
+	for (; si != se; ++si)
+	{
+		if (*si == '\n')
+		{
+			++line;
+			col = 1;
+		}
+		else
+		{
+			++col;
+		}
+	}
+	throw strus::runtime_error( _TXT( "error in JSON at line %u, column %u: %s"), (unsigned int)line, (unsigned int)col, msg);
+}
+
+bool JsonEventParser::needMoreInput() const
+{
+	if (m_eof)
+	{
+		throwError( _TXT("unexpected end of input"));
+	}
+	return false;
+}
+
+void JsonEventParser::skipSpaces()
+{
+	std::size_t bufsize = m_buf.size();
+	while (m_bufpos < bufsize && (unsigned char)m_buf[ m_bufpos] <= 32) ++m_bufpos;
+}
+
+int JsonEventParser::matchLiteral( const char* literal, std::size_t literalsize) const
+{
+	std::size_t avail = m_buf.size() - m_bufpos;
+	std::size_t cmpsize = avail < literalsize ? avail : literalsize;
+	if (0!=std::memcmp( m_buf.c_str() + m_bufpos, literal, cmpsize)) return 0;
+	if (cmpsize == literalsize) return 1;
+	return m_eof ? 0 : -1;
+}
+
+static bool isTokenChar( unsigned char chr)
+{
+	unsigned char lochr = chr|32;
+	if (lochr >= 'a' && lochr <= 'z') return true;
+	if (chr == '-' || chr == '+' || chr == '_') return true;
+	if (chr >= '0' && chr <= '9') return true;
+	return false;
+}
+
+static bool isTokenDelimiter( char chr)
+{
+	return chr == '\0' || 0!=std::strchr( "{}[],;=\"\'\n\t \b\r-+/()", chr);
+}
+
+static int parseHex4( const char* src)
+{
+	int rt = 0;
+	int ii = 0;
+	for (; ii < 4; ++ii)
+	{
+		unsigned char chr = src[ ii];
+		rt <<= 4;
+		if (chr >= '0' && chr <= '9')
+		{
+			rt += chr - '0';
+		}
+		else if (chr >= 'A' && chr <= 'F')
+		{
+			rt += 10 + chr - 'A';
+		}
+		else if (chr >= 'a' && chr <= 'f')
+		{
+			rt += 10 + chr - 'a';
+		}
+		else
+		{
+			return 0;
+		}
+	}
+	return rt;
+}
+
+static void appendUtf8( std::string& dest, unsigned long codepoint)
+{
+	if (codepoint < 0x80)
+	{
+		dest.push_back( (char)codepoint);
+	}
+	else if (codepoint < 0x800)
+	{
+		dest.push_back( (char)(0xC0 | (codepoint >> 6)));
+		dest.push_back( (char)(0x80 | (codepoint & 0x3F)));
+	}
+	else if (codepoint < 0x10000)
+	{
+		dest.push_back( (char)(0xE0 | (codepoint >> 12)));
+		dest.push_back( (char)(0x80 | ((codepoint >> 6) & 0x3F)));
+		dest.push_back( (char)(0x80 | (codepoint & 0x3F)));
+	}
+	else
+	{
+		dest.push_back( (char)(0xF0 | (codepoint >> 18)));
+		dest.push_back( (char)(0x80 | ((codepoint >> 12) & 0x3F)));
+		dest.push_back( (char)(0x80 | ((codepoint >> 6) & 0x3F)));
+		dest.push_back( (char)(0x80 | (codepoint & 0x3F)));
+	}
+}
+
+bool JsonEventParser::parseString( std::string& dest)
+{
+	// ... find the end of the string first, remembering how far we got for the next chunk
+	const char* src = m_buf.c_str();
+	std::size_t bufsize = m_buf.size();
+	std::size_t start = m_bufpos + 1;
+	std::size_t end = m_scanpos > start ? m_scanpos : start;
+	bool complete = false;
+	while (end < bufsize)
+	{
+		if (src[ end] == '\"')
+		{
+			complete = true;
+			break;
+		}
+		else if (src[ end] == '\\')
+		{
+			if (end + 1 >= bufsize) break;
+			end += 2;
+		}
+		else
+		{
+			++end;
+		}
+	}
+	if (!complete)
+	{
+		m_scanpos = end;
+		return needMoreInput();
+	}
+	// ... decode the string
+	dest.clear();
+	std::size_t si = start;
+	while (si < end)
+	{
+		std::size_t chunkend = si;
+		while (chunkend < end && src[ chunkend] != '\\') ++chunkend;
+		dest.append( src + si, chunkend - si);
+		si = chunkend;
+		if (si == end) break;
+
+		switch (src[ si+1])
+		{
+			case 'b': dest.push_back( '\b'); si += 2; break;
+			case 'f': dest.push_back( '\f'); si += 2; break;
+			case 'n': dest.push_back( '\n'); si += 2; break;
+			case 'r': dest.push_back( '\r'); si += 2; break;
+			case 't': dest.push_back( '\t'); si += 2; break;
+			case '\"':
+			case '\\':
+			case '/':
+				dest.push_back( src[ si+1]);
+				si += 2;
+				break;
+			case 'u':
+			{
+				if (end - si < 6)
+				{
+					m_bufpos = si;
+					throwError( _TXT("invalid UTF-16 literal in string"));
+				}
+				unsigned long codepoint = parseHex4( src + si + 2);
+				if (codepoint >= 0xDC00 && codepoint <= 0xDFFF)
+				{
+					m_bufpos = si;
+					throwError( _TXT("invalid UTF-16 literal in string"));
+				}
+				if (codepoint >= 0xD800 && codepoint <= 0xDBFF)
+				{
+					if (end - si < 12 || src[ si+6] != '\\' || src[ si+7] != 'u')
+					{
+						m_bufpos = si;
+						throwError( _TXT("invalid UTF-16 surrogate pair in string"));
+					}
+					unsigned long second = parseHex4( src + si + 8);
+					if (second < 0xDC00 || second > 0xDFFF)
+					{
+						m_bufpos = si;
+						throwError( _TXT("invalid UTF-16 surrogate pair in string"));
+					}
+					codepoint = 0x10000 + (((codepoint & 0x3FF) << 10) | (second & 0x3FF));
+					si += 12;
+				}
+				else
+				{
+					si += 6;
+				}
+				appendUtf8( dest, codepoint);
+				break;
+			}
+			default:
+				m_bufpos = si;
+				throwError( _TXT("invalid escape sequence in string"));
+		}
+	}
+	// ... values are C strings in the cJSON tree, so a value is cut at the first null character
+	std::size_t nullpos = dest.find( '\0');
+	if (nullpos != std::string::npos) dest.resize( nullpos);
+
+	m_bufpos = end + 1;
+	m_scanpos = 0;
+	return true;
+}
+
+bool JsonEventParser::parseToken( std::string& dest)
+{
+	const char* src = m_buf.c_str();
+	std::size_t bufsize = m_buf.size();
+	std::size_t end = m_scanpos > m_bufpos ? m_scanpos : m_bufpos;
+	while (end < bufsize && !isTokenDelimiter( src[ end])) ++end;
+	if (end == bufsize && !m_eof)
+	{
+		m_scanpos = end;
+		return false;
+	}
+	dest.assign( src + m_bufpos, end - m_bufpos);
+	m_bufpos = end;
+	m_scanpos = 0;
+	return true;
+}
+
+void JsonEventParser::pushEvent( ElementType type, const char* value, std::size_t valuesize)
+{
+	m_events.push_back( Event( type, m_eventbuf.size(), valuesize, true));
+	m_eventbuf.append( value, valuesize);
+}
+
+void JsonEventParser::pushEvent( ElementType type)
+{
+	m_events.push_back( Event( type, 0, 0, false));
+}
+
+void JsonEventParser::pushElementTag( ElementType type, const Frame& frame)
+{
+	if (frame.hasName)
+	{
+		pushEvent( type, frame.name.c_str(), frame.name.size());
+	}
+	else
+	{
+		char idxstr[ 32];
+		std::size_t idxlen = std::snprintf( idxstr, sizeof( idxstr), "%u", frame.index);
+		pushEvent( type, idxstr, idxlen);
+	}
+}
+
+void JsonEventParser::beginValue()
+{
+	const Frame& top = m_stack.back();
+	if (top.type == FrameArray)
+	{
+		pushElementTag( TX::OpenTag, top);
+	}
+}
+
+void JsonEventParser::endValue()
+{
+	Frame& top = m_stack.back();
+	m_hasKey = false;
+	switch (top.type)
+	{
+		case FrameRoot:
+			m_state = StateDone;
+			// ... the rest of the input is ignored as in cJSON_Parse
+			m_buf.clear();
+			m_bufpos = 0;
+			m_scanpos = 0;
+			break;
+		case FrameArray:
+			pushElementTag( TX::CloseTag, top);
+			++top.index;
+			m_state = StateCommaOrEnd;
+			break;
+		case FrameObject:
+			m_state = StateCommaOrEnd;
+			break;
+	}
+}
+
+void JsonEventParser::scalarValue( const char* value, std::size_t valuesize)
+{
+	beginValue();
+	if (m_hasKey)
+	{
+		if (!m_key.empty() && m_key[0] == '-')
+		{
+			pushEvent( TX::TagAttribName, m_key.c_str()+1, m_key.size()-1);
+			pushEvent( TX::TagAttribValue, value, valuesize);
+		}
+		else if (m_key == "#text")
+		{
+			pushEvent( TX::Content, value, valuesize);
+		}
+		else
+		{
+			pushEvent( TX::OpenTag, m_key.c_str(), m_key.size());
+			pushEvent( TX::Content, value, valuesize);
+			pushEvent( TX::CloseTag, m_key.c_str(), m_key.size());
+		}
+	}
+	else
+	{
+		pushEvent( TX::Content, value, valuesize);
+	}
+	endValue();
+}
+
+void JsonEventParser::nullValue()
+{
+	beginValue();
+	if (m_hasKey && (m_key.empty() || (m_key[0] != '-' && m_key[0] != '#')))
+	{
+		pushEvent( TX::OpenTag, m_key.c_str(), m_key.size());
+		pushEvent( TX::CloseTagIm);
+	}
+	endValue();
+}
+
+void JsonEventParser::openArray()
+{
+	if (m_stack.size() > CJSON_NESTING_LIMIT)
+	{
+		throwError( _TXT("maximum nesting depth of arrays and objects exceeded"));
+	}
+	beginValue();
+	++m_bufpos;
+	m_stack.push_back( Frame());
+	Frame& frame = m_stack.back();
+	frame.type = FrameArray;
+	frame.hasName = m_hasKey;
+	if (m_hasKey) frame.name = m_key;
+	m_hasKey = false;
+	m_state = StateValueOrEnd;
+}
+
+void JsonEventParser::openObject()
+{
+	if (m_stack.size() > CJSON_NESTING_LIMIT)
+	{
+		throwError( _TXT("maximum nesting depth of arrays and objects exceeded"));
+	}
+	beginValue();
+	++m_bufpos;
+	if (m_hasKey)
+	{
+		pushEvent( TX::OpenTag, m_key.c_str(), m_key.size());
+	}
+	m_stack.push_back( Frame());
+	Frame& frame = m_stack.back();
+	frame.type = FrameObject;
+	frame.hasName = m_hasKey;
+	if (m_hasKey) frame.name = m_key;
+	m_hasKey = false;
+	m_state = StateMemberNameOrEnd;
+}
+
+void JsonEventParser::closeArray()
+{
+	++m_bufpos;
+	m_stack.pop_back();
+	endValue();
+}
+
+void JsonEventParser::closeObject()
+{
+	++m_bufpos;
+	const Frame& top = m_stack.back();
+	if (top.hasName)
+	{
+		pushEvent( TX::CloseTag, top.name.c_str(), top.name.size());
+	}
+	m_stack.pop_back();
+	endValue();
+}
+
+bool JsonEventParser::parseValue()
+{
+	int match;
+	if (0!=(match = matchLiteral( "null", 4)))
+	{
+		if (match < 0) return false;
+		m_bufpos += 4;
+		nullValue();
+	}
+	else if (0!=(match = matchLiteral( "false", 5)))
+	{
+		if (match < 0) return false;
+		m_bufpos += 5;
+		scalarValue( "false", 5);
+	}
+	else if (0!=(match = matchLiteral( "true", 4)))
+	{
+		if (match < 0) return false;
+		m_bufpos += 4;
+		scalarValue( "true", 4);
+	}
+	else
+	{
+		char chr = m_buf[ m_bufpos];
+		if (chr == '\"')
+		{
+			if (!parseString( m_value)) return false;
+			scalarValue( m_value.c_str(), m_value.size());
+		}
+		else if (isTokenChar( chr))
+		{
+			if (!parseToken( m_value)) return false;
+			scalarValue( m_value.c_str(), m_value.size());
+		}
+		else if (chr == '[')
+		{
+			openArray();
+		}
+		else if (chr == '{')
+		{
+			openObject();
+		}
+		else
+		{
+			throwError( _TXT("value expected"));
+		}
+	}
+	return true;
+}
+
+bool JsonEventParser::parseStep()
+{
+	if (m_state == StateDone) return false;
+	if (m_state == StateStart)
+	{
+		if (m_buf.size() < 3 && !m_eof) return false;
+		if (m_buf.size() >= 3 && 0==std::memcmp( m_buf.c_str(), "\xEF\xBB\xBF", 3))
+		{
+			m_bufpos = 3;
+		}
+		m_state = StateValue;
+	}
+	skipSpaces();
+	if (m_bufpos == m_buf.size()) return needMoreInput();
+
+	switch (m_state)
+	{
+		case StateValue:
+			return parseValue();
+		case StateValueOrEnd:
+			if (m_buf[ m_bufpos] == ']')
+			{
+				closeArray();
+			}
+			else
+			{
+				m_state = StateValue;
+			}
+			return true;
+		case StateMemberNameOrEnd:
+			if (m_buf[ m_bufpos] == '}')
+			{
+				closeObject();
+			}
+			else
+			{
+				m_state = StateMemberName;
+			}
+			return true;
+		case StateMemberName:
+			if (m_buf[ m_bufpos] != '\"')
+			{
+				throwError( _TXT("string expected as name of object member"));
+			}
+			if (!parseString( m_key)) return false;
+			m_hasKey = true;
+			m_state = StateColon;
+			return true;
+		case StateColon:
+			if (m_buf[ m_bufpos] != ':')
+			{
+				throwError( _TXT("':' expected after name of object member"));
+			}
+			++m_bufpos;
+			m_state = StateValue;
+			return true;
+		case StateCommaOrEnd:
+		{
+			char chr = m_buf[ m_bufpos];
+			if (m_stack.back().type == FrameArray)
+			{
+				if (chr == ',')
+				{
+					++m_bufpos;
+					m_state = StateValue;
+				}
+				else if (chr == ']')
+				{
+					closeArray();
+				}
+				else
+				{
+					throwError( _TXT("',' or ']' expected in array"));
+				}
+			}
+			else
+			{
+				if (chr == ',')
+				{
+					++m_bufpos;
+					m_state = StateMemberName;
+				}
+				else if (chr == '}')
+				{
+					closeObject();
+				}
+				else
+				{
+					throwError( _TXT("',' or '}' expected in object"));
+				}
+			}
+			return true;
+		}
+		case StateStart:
+		case StateDone:
+			break;
+	}
+	return false;
+}
+
+bool JsonEventParser::getNext( ElementType& type, const char*& value, std::size_t& valuesize)
+{
+	if (m_eventidx == m_events.size())
+	{
+		m_events.clear();
+		m_eventbuf.clear();
+		m_eventidx = 0;
+		while (m_events.empty())
+		{
+			if (!parseStep()) return false;
+		}
+	}
+	const Event& ev = m_events[ m_eventidx++];
+	type = ev.type;
+	value = ev.hasValue ? (m_eventbuf.c_str() + ev.valueofs) : 0;
+	valuesize = ev.valuesize;
+	return true;
+}
+
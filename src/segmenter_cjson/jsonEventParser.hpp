@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Incremental parser of a JSON document into a stream of XML events
+/// \file jsonEventParser.hpp
+#ifndef _STRUS_SEGMENTER_JSON_EVENT_PARSER_HPP_INCLUDED
+#define _STRUS_SEGMENTER_JSON_EVENT_PARSER_HPP_INCLUDED
+#include "textwolf/xmlscanner.hpp"
+#include <vector>
+#include <string>
+#include <cstdlib>
+
+namespace strus
+{
+
+/// \brief Incremental parser of a JSON document into the stream of XML events fed to an XPathAutomatonContext
+/// \note The events are the same as the ones created by getTextwolfItems (cjson2textwolf.hpp) from a cJSON tree:
+///	Members with a name starting with '-' are attributes, members with the name '#text' are content,
+///	other members are tags, elements of arrays with a name are repeated tags with the name of the array,
+///	elements of arrays without a name are tags with the index of the element as name.
+///	The input is parsed as it arrives, only the start of a token not complete yet is kept between chunks.
+///	The syntax accepted is the one of the cJSON parser used for the tree (e.g. values without quotes are accepted as strings).
+class JsonEventParser
+{
+public:
+	typedef textwolf::XMLScannerBase::ElementType ElementType;
+
+	JsonEventParser();
+
+	/// \brief Reset the state for parsing a new document, keeping the buffers allocated
+	void clear();
+
+	/// \brief Feed the next chunk of input
+	/// \param[in] chunk pointer to the chunk (copied)
+	/// \param[in] chunksize size of the chunk in bytes
+	/// \param[in] eof true if this is the last chunk of the document
+	void putInput( const char* chunk, std::size_t chunksize, bool eof);
+
+	/// \brief Fetch the next event
+	/// \param[out] type type of the event
+	/// \param[out] value value of the event or NULL for events without value, valid until the next call of getNext or putInput
+	/// \param[out] valuesize size of the value in bytes
+	/// \return true if an event was returned, false if more input is required or the document is complete
+	/// \remark Throws on syntax errors
+	bool getNext( ElementType& type, const char*& value, std::size_t& valuesize);
+
+	/// \brief Test if the whole document has been parsed
+	bool finished() const
+	{
+		return m_state == StateDone && m_eventidx == m_events.size();
+	}
+
+	/// \brief Get the number of bytes of input buffered and not parsed yet
+	std::size_t bufferedSize() const
+	{
+		return m_buf.size() - m_bufpos;
+	}
+
+private:
+	enum State
+	{
+		StateStart,		///< start of document, before an optional BOM
+		StateValue,		///< expecting a value
+		StateValueOrEnd,	///< expecting the first element of an array or the end of the array
+		StateMemberName,	///< expecting the name of an object member
+		StateMemberNameOrEnd,	///< expecting the name of the first object member or the end of the object
+		StateColon,		///< expecting the ':' between member name and value
+		StateCommaOrEnd,	///< expecting a ',' or the end of the array or object
+		StateDone		///< document complete, the rest of the input is ignored
+	};
+	enum FrameType {FrameRoot,FrameObject,FrameArray};
+
+	/// \brief Open array or object or the document root
+	struct Frame
+	{
+		FrameType type;
+		std::string name;	///< name of the object member that is the array or object
+		bool hasName;		///< true if the array or object is an object member
+		unsigned int index;	///< index of the current element of an array
+
+		Frame()
+			:type(FrameRoot),name(),hasName(false),index(0){}
+#if __cplusplus >= 201103L
+		Frame( Frame&& ) = default;
+		Frame( const Frame& ) = default;
+		Frame& operator= ( Frame&& ) = default;
+		Frame& operator= ( const Frame& ) = default;
+#else
+		Frame( const Frame& o)
+			:type(o.type),name(o.name),hasName(o.hasName),index(o.index){}
+#endif
+	};
+
+	/// \brief Event with its value in m_eventbuf
+	struct Event
+	{
+		ElementType type;
+		std::size_t valueofs;
+		std::size_t valuesize;
+		bool hasValue;
+
+		Event( ElementType type_, std::size_t valueofs_, std::size_t valuesize_, bool hasValue_)
+			:type(type_),valueofs(valueofs_),valuesize(valuesize_),hasValue(hasValue_){}
+#if __cplusplus >= 201103L
+		Event( Event&& ) = default;
+		Event( const Event& ) = default;
+		Event& operator= ( Event&& ) = default;
+		Event& operator= ( const Event& ) = default;
+#else
+		Event( const Event& o)
+			:type(o.type),valueofs(o.valueofs),valuesize(o.valuesize),hasValue(o.hasValue){}
+#endif
+	};
+
+	bool parseStep();
+	bool parseValue();
+	bool parseString( std::string& dest);
+	bool parseToken( std::string& dest);
+	int matchLiteral( const char* literal, std::size_t literalsize) const;
+	bool needMoreInput() const;
+
+	void beginValue();
+	void endValue();
+	void scalarValue( const char* value, std::size_t valuesize);
+	void nullValue();
+	void openArray();
+	void openObject();
+	void closeArray();
+	void closeObject();
+
+	void pushEvent( ElementType type, const char* value, std::size_t valuesize);
+	void pushEvent( ElementType type);
+	void pushElementTag( ElementType type, const Frame& frame);
+
+	void skipSpaces();
+	void compact();
+	void throwError( const char* msg) const;
+
+private:
+	std::string m_buf;		///< input not consumed yet, starting with the token currently parsed
+	std::size_t m_bufpos;		///< current parse position in m_buf
+	std::size_t m_scanpos;		///< position in m_buf up to which the token currently parsed was scanned already
+	bool m_eof;			///< true if the last chunk of input was fed
+	std::size_t m_line;		///< line number of the start of m_buf
+	std::size_t m_column;		///< column of the start of m_buf
+	State m_state;			///< parser state
+	std::vector<Frame> m_stack;	///< open arrays and objects, the document root as first element
+	std::string m_key;		///< name of the object member of the current value
+	bool m_hasKey;			///< true if the current value is an object member
+	std::string m_value;		///< buffer for the current string value
+	std::vector<Event> m_events;	///< events of the last parse step
+	std::size_t m_eventidx;		///< index of the next event of m_events to return
+	std::string m_eventbuf;		///< values of the events of m_events
+};
+
+}//namespace
+#endif
+
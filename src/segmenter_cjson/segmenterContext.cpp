@@ -6,7 +6,6 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  */
 #include "segmenterContext.hpp"
-#include "cjson2textwolf.hpp"
 #include "strus/errorBufferInterface.hpp"
 #include "segmenter.hpp"
 #include "private/xpathAutomaton.hpp"
@@ -14,7 +13,6 @@
 #include "private/internationalization.hpp"
 #include <cstdlib>
 #include <cstring>
-#include <setjmp.h>
 #undef STRUS_LOWLEVEL_DEBUG
 #ifdef STRUS_LOWLEVEL_DEBUG
 #include <iostream>
@@ -26,48 +24,62 @@ void JsonSegmenterContext::putInput( const char* chunk, std::size_t chunksize, b
 {
 	try
 	{
-		m_content.append( chunk, chunksize);
-		if (eof)
+		if (m_eof)
 		{
-			m_eof = true;
-			if (m_encoder.get())
+			m_errorhnd->report( ErrorCodeOperationOrder, _TXT( "feeded chunk after declared end of input"));
+			return;
+		}
+		m_eof = eof;
+		if (m_encoder.get())
+		{
+			// ... the decoder needs the whole input
+			m_content.append( chunk, chunksize);
+			if (eof)
 			{
-				m_content = m_encoder->convert( m_content.c_str(), m_content.size(), true);
+				std::string converted = m_encoder->convert( m_content.c_str(), m_content.size(), true);
+				m_content.clear();
+				m_parser.putInput( converted.c_str(), converted.size(), true);
 			}
 		}
+		else
+		{
+			m_parser.putInput( chunk, chunksize, eof);
+		}
 	}
 	CATCH_ERROR_MAP( _TXT("error in put input of JSON segmenter: %s"), *m_errorhnd);
 }
 
-static void getSegmenterItems( const XPathAutomaton* automaton, std::vector<JsonSegmenterContext::Item>& resar, const cJSON* tree)
+void JsonSegmenterContext::fetchItems()
 {
-	if (!tree) return;
-
-	XPathAutomatonContext xpathselect( automaton->createContext());
-	std::vector<TextwolfItem> itemar;
-	getTextwolfItems( itemar, tree);
-	SegmenterPosition pos = 0;
-	std::vector<TextwolfItem>::const_iterator ti = itemar.begin(), te = itemar.end();
-	for (; ti != te; ++ti)
+	JsonEventParser::ElementType type;
+	const char* value;
+	std::size_t valuesize;
+	while (m_itemar.empty() && m_parser.getNext( type, value, valuesize))
 	{
 #ifdef STRUS_LOWLEVEL_DEBUG
-		const char* elemtypenam = textwolf::XMLScannerBase::getElementTypeName(ti->type);
-		std::cout << "input " << elemtypenam << " " << ti->value << std::endl;
+		const char* elemtypenam = textwolf::XMLScannerBase::getElementTypeName( type);
+		std::cout << "input " << elemtypenam << " " << std::string( value?value:"", valuesize) << std::endl;
 #endif
-		std::size_t valuesize = ti->value?std::strlen(ti->value):0;
-		xpathselect.putElement( ti->type, ti->value, valuesize);
+		m_xpathselect.putElement( type, value, valuesize);
 		int segid;
-		while (xpathselect.getNext( segid))
+		std::size_t segmentofs = m_valuebuf.size();
+		if (m_xpathselect.getNext( segid))
 		{
-			resar.push_back( JsonSegmenterContext::Item( segid, pos, ti->value, valuesize));
+			// ... the value is stored once for all expressions selecting it
+			if (value) m_valuebuf.append( value, valuesize);
+			do
+			{
+				m_itemar.push_back( Item( segid, m_pos, segmentofs, valuesize, value != 0));
+			}
+			while (m_xpathselect.getNext( segid));
 		}
-		if (ti->type != textwolf::XMLScannerBase::CloseTag)
+		if (type != textwolf::XMLScannerBase::CloseTag)
 		{
-			pos += valuesize+1;
+			m_pos += valuesize+1;
 		}
 		else
 		{
-			pos += 1;
+			m_pos += 1;
 		}
 	}
 }
@@ -76,40 +88,24 @@ bool JsonSegmenterContext::getNext( int& id, SegmenterPosition& pos, const char*
 {
 	try
 	{
-		if (!m_eof) return false;
-	AGAIN:
-		if (m_itemidx < m_itemar.size())
+		if (m_itemidx == m_itemar.size())
 		{
-			const Item& curitem = m_itemar[ m_itemidx];
-			id = curitem.id;
-			pos = curitem.pos;
-			segment = curitem.segment;
-			segmentsize = curitem.segmentsize;
-			++m_itemidx;
-			return true;
+			// ... the segment returned by the last call stays valid until here
+			m_itemar.clear();
+			m_itemidx = 0;
+			m_valuebuf.clear();
+			fetchItems();
+			if (m_itemar.empty()) return false;
 		}
-		else if (m_itemidx == m_itemar.size())
-		{
-			if (!m_tree)
-			{
-				m_tree = parseJsonTree( m_content);
-				getSegmenterItems( m_automaton, m_itemar, m_tree);
+		const Item& curitem = m_itemar[ m_itemidx++];
+		id = curitem.id;
+		pos = curitem.pos;
+		segment = curitem.hasSegment ? (m_valuebuf.c_str() + curitem.segmentofs) : 0;
+		segmentsize = curitem.segmentsize;
 #ifdef STRUS_LOWLEVEL_DEBUG
-				std::cout << "got " << m_itemar.size() << " items" << std::endl;
-				std::vector<Item>::const_iterator ti = m_itemar.begin(), te = m_itemar.end();
-				for (; ti != te; ++ti)
-				{
-					std::cout << "item " << ti->id << " at " << ti->pos << " " << std::string( ti->segment, ti->segmentsize) << std::endl;
-				}
+		std::cout << "item " << id << " at " << pos << " " << std::string( segment?segment:"", segmentsize) << std::endl;
 #endif
-				goto AGAIN;
-			}
-			return false;
-		}
-		else
-		{
-			return false;
-		}
+		return true;
 	}
 	CATCH_ERROR_MAP_RETURN( _TXT("error in JSON segmenter get next: %s"), *m_errorhnd, false);
 }
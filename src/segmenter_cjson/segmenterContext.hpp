@@ -11,44 +11,56 @@
 #include "strus/errorBufferInterface.hpp"
 #include "strus/reference.hpp"
 #include "private/textEncoder.hpp"
-#include "cjson/cJSON.h"
 #include "private/xpathAutomaton.hpp"
+#include "jsonEventParser.hpp"
 #include <cstdlib>
-#include <setjmp.h>
+#include <vector>
+#include <string>
 
 namespace strus
 {
 
+/// \brief Segmenter context for JSON feeding the events of an incremental JSON parser to the XPath automaton
+/// \note Segments are returned as soon as the input selecting them has been fed.
+///	Only the start of a token not complete yet is kept of the input consumed.
+///	Input in an encoding other than UTF-8 is collected until the end of input, because it is converted as a whole.
 class JsonSegmenterContext
 	:public SegmenterContextInterface
 {
 public:
 	explicit JsonSegmenterContext( ErrorBufferInterface* errorhnd, const XPathAutomaton* automaton_, const strus::Reference<strus::utils::TextEncoderBase>& encoder_)
-		:m_automaton(automaton_)
+		:m_parser()
+		,m_xpathselect(automaton_->createContext())
 		,m_content()
-		,m_tree(0)
 		,m_eof(false)
 		,m_encoder(encoder_)
+		,m_pos(0)
+		,m_itemar()
 		,m_itemidx(0)
+		,m_valuebuf()
 		,m_errorhnd(errorhnd)
 	{}
 
-	virtual ~JsonSegmenterContext()
-	{
-		if (m_tree) cJSON_Delete( m_tree);
-	}
+	virtual ~JsonSegmenterContext(){}
 
 	virtual void putInput( const char* chunk, std::size_t chunksize, bool eof);
 
+	virtual std::size_t bufferedInputSize() const
+	{
+		return m_content.size() + m_parser.bufferedSize();
+	}
+
 	virtual bool getNext( int& id, SegmenterPosition& pos, const char*& segment, std::size_t& segmentsize);
 
 public:
+	/// \brief Segment selected, with its value in m_valuebuf
 	struct Item
 	{
 		int id;
 		SegmenterPosition pos;
-		const char* segment;
+		std::size_t segmentofs;
 		std::size_t segmentsize;
+		bool hasSegment;
 
 #if __cplusplus >= 201103L
 		Item( Item&& ) = default;
@@ -57,25 +69,32 @@ public:
 		Item& operator= ( const Item& ) = default;
 #else
 		Item( const Item& o)
-			:id(o.id),pos(o.pos),segment(o.segment),segmentsize(o.segmentsize){}
+			:id(o.id),pos(o.pos),segmentofs(o.segmentofs),segmentsize(o.segmentsize),hasSegment(o.hasSegment){}
 #endif
-		Item( int id_, SegmenterPosition pos_, const char* segment_, std::size_t segmentsize_)
-			:id(id_),pos(pos_),segment(segment_),segmentsize(segmentsize_){}
+		Item( int id_, SegmenterPosition pos_, std::size_t segmentofs_, std::size_t segmentsize_, bool hasSegment_)
+			:id(id_),pos(pos_),segmentofs(segmentofs_),segmentsize(segmentsize_),hasSegment(hasSegment_){}
 	};
 
 private:
-	const XPathAutomaton* m_automaton;
-	std::string m_content;
-	cJSON* m_tree;
+	JsonSegmenterContext( const JsonSegmenterContext&);	//... non copyable
+	void operator=( const JsonSegmenterContext&);		//... non copyable
+
+	void fetchItems();
+
+private:
+	JsonEventParser m_parser;		///< incremental parser of the input into XML events
+	XPathAutomatonContext m_xpathselect;	///< selection of the segments from the XML events
+	std::string m_content;			///< input collected for conversion to UTF-8 at the end of input
 	bool m_eof;
 	strus::Reference<strus::utils::TextEncoderBase> m_encoder;
+	SegmenterPosition m_pos;		///< position of the next event, the sum of the sizes of the values of the events before plus one per event (close tag values not counted)
 
-	std::vector<Item> m_itemar;
-	std::size_t m_itemidx;
+	std::vector<Item> m_itemar;		///< segments selected by the last event consumed
+	std::size_t m_itemidx;			///< index of the next item in m_itemar to return
+	std::string m_valuebuf;			///< values of the items in m_itemar
 	ErrorBufferInterface* m_errorhnd;	///< error buffer interface
 };
 
 }//namespace
 #endif
 
-
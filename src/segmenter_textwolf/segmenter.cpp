@@ -10,10 +10,12 @@
 #include "contentIterator.hpp"
 #include "strus/analyzer/documentClass.hpp"
 #include "strus/base/string_conv.hpp"
+#include "strus/base/numstring.hpp"
 #include "textwolf/charset.hpp"
 #include "private/errorUtils.hpp"
 #include "private/internationalization.hpp"
 #include "segmenterMarkupContext.hpp"
+#include <limits>
 
 using namespace strus;
 
@@ -23,9 +25,10 @@ StructView TextwolfSegmenterInstance::view() const
 {
 	try
 	{
-		return StructView()
-			("name", name())
-		;
+		StructView rt;
+		rt("name", name());
+		if (m_maxBufferedInputSize) rt("maxbuffer", (double)m_maxBufferedInputSize);
+		return rt;
 	}
 	CATCH_ERROR_MAP_RETURN( _TXT("error in introspection: %s"), *m_errorhnd, StructView());
 }
@@ -72,7 +75,7 @@ SegmenterContextInterface* TextwolfSegmenterInstance::createContext( const analy
 
 		if (dclass.encoding().empty())
 		{
-			return new TextwolfSegmenterContext<UTF8>( m_errorhnd, &m_automaton);
+			return new TextwolfSegmenterContext<UTF8>( m_errorhnd, &m_automaton, m_maxBufferedInputSize, dclass.encoding());
 		}
 		else
 		{
@@ -92,41 +95,41 @@ SegmenterContextInterface* TextwolfSegmenterInstance::createContext( const analy
 						throw strus::runtime_error( _TXT("parse error in character set encoding: '%s'"), dclass.encoding().c_str());
 					}
 				}
-				return new TextwolfSegmenterContext<IsoLatin>( m_errorhnd, &m_automaton, IsoLatin(codepage));
+				return new TextwolfSegmenterContext<IsoLatin>( m_errorhnd, &m_automaton, m_maxBufferedInputSize, dclass.encoding(), IsoLatin(codepage));
 			}
 			else if (strus::caseInsensitiveEquals( dclass.encoding(), "UTF-8"))
 			{
-				return new TextwolfSegmenterContext<UTF8>( m_errorhnd, &m_automaton);
+				return new TextwolfSegmenterContext<UTF8>( m_errorhnd, &m_automaton, m_maxBufferedInputSize, dclass.encoding());
 			}
 			else if (strus::caseInsensitiveEquals( dclass.encoding(), "UTF-16")
 			||       strus::caseInsensitiveEquals( dclass.encoding(), "UTF-16BE"))
 			{
-				return new TextwolfSegmenterContext<UTF16BE>( m_errorhnd, &m_automaton);
+				return new TextwolfSegmenterContext<UTF16BE>( m_errorhnd, &m_automaton, m_maxBufferedInputSize, dclass.encoding());
 			}
 			else if (strus::caseInsensitiveEquals( dclass.encoding(), "UTF-16LE"))
 			{
-				return new TextwolfSegmenterContext<UTF16LE>( m_errorhnd, &m_automaton);
+				return new TextwolfSegmenterContext<UTF16LE>( m_errorhnd, &m_automaton, m_maxBufferedInputSize, dclass.encoding());
 			}
 			else if (strus::caseInsensitiveEquals( dclass.encoding(), "UCS-2")
 			||       strus::caseInsensitiveEquals( dclass.encoding(), "UCS-2BE"))
 			{
-				return new TextwolfSegmenterContext<UCS2BE>( m_errorhnd, &m_automaton);
+				return new TextwolfSegmenterContext<UCS2BE>( m_errorhnd, &m_automaton, m_maxBufferedInputSize, dclass.encoding());
 			}
 			else if (strus::caseInsensitiveEquals( dclass.encoding(), "UCS-2LE"))
 			{
-				return new TextwolfSegmenterContext<UCS2LE>( m_errorhnd, &m_automaton);
+				return new TextwolfSegmenterContext<UCS2LE>( m_errorhnd, &m_automaton, m_maxBufferedInputSize, dclass.encoding());
 			}
 			else if (strus::caseInsensitiveEquals( dclass.encoding(), "UCS-4")
 			||       strus::caseInsensitiveEquals( dclass.encoding(), "UCS-4BE")
 			||       strus::caseInsensitiveEquals( dclass.encoding(), "UTF-32")
 			||       strus::caseInsensitiveEquals( dclass.encoding(), "UTF-32BE"))
 			{
-				return new TextwolfSegmenterContext<UCS4BE>( m_errorhnd, &m_automaton);
+				return new TextwolfSegmenterContext<UCS4BE>( m_errorhnd, &m_automaton, m_maxBufferedInputSize, dclass.encoding());
 			}
 			else if (strus::caseInsensitiveEquals( dclass.encoding(), "UCS-4LE")
 			||       strus::caseInsensitiveEquals( dclass.encoding(), "UTF-32LE"))
 			{
-				return new TextwolfSegmenterContext<UCS4LE>( m_errorhnd, &m_automaton);
+				return new TextwolfSegmenterContext<UCS4LE>( m_errorhnd, &m_automaton, m_maxBufferedInputSize, dclass.encoding());
 			}
 			else
 			{
@@ -222,8 +225,20 @@ SegmenterInstanceInterface* TextwolfSegmenter::createInstance( const analyzer::S
 {
 	try
 	{
-		if (!opts.items().empty()) throw strus::runtime_error(_TXT("no options defined for segmenter '%s'"), SEGMENTER_NAME);
-		return new TextwolfSegmenterInstance( m_errorhnd);
+		std::size_t maxBufferedInputSize = 0;
+		std::vector<analyzer::SegmenterOptions::Item>::const_iterator oi = opts.items().begin(), oe = opts.items().end();
+		for (; oi != oe; ++oi)
+		{
+			if (strus::caseInsensitiveEquals( oi->first, "maxbuffer"))
+			{
+				maxBufferedInputSize = numstring_conv::touint( oi->second, std::numeric_limits<int>::max());
+			}
+			else
+			{
+				throw strus::runtime_error(_TXT("unknown option '%s' for segmenter '%s'"), oi->first.c_str(), SEGMENTER_NAME);
+			}
+		}
+		return new TextwolfSegmenterInstance( m_errorhnd, maxBufferedInputSize);
 	}
 	CATCH_ERROR_ARG1_MAP_RETURN( _TXT("error in '%s' segmenter: %s"), SEGMENTER_NAME, *m_errorhnd, 0);
 }
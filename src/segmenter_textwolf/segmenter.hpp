@@ -23,8 +23,9 @@ class TextwolfSegmenterInstance
 	:public SegmenterInstanceInterface
 {
 public:
-	TextwolfSegmenterInstance( ErrorBufferInterface* errorhnd)
-		:m_errorhnd(errorhnd){}
+	/// \param[in] maxBufferedInputSize_ maximum number of bytes of input fed and not consumed yet by a context or 0 for no limit
+	TextwolfSegmenterInstance( ErrorBufferInterface* errorhnd, std::size_t maxBufferedInputSize_)
+		:m_maxBufferedInputSize(maxBufferedInputSize_),m_errorhnd(errorhnd){}
 	virtual ~TextwolfSegmenterInstance(){}
 
 	virtual void defineSelectorExpression( int id, const std::string& expression);
@@ -41,6 +42,7 @@ private:
 
 private:
 	XPathAutomaton m_automaton;
+	std::size_t m_maxBufferedInputSize;
 	ErrorBufferInterface* m_errorhnd;
 };
 
@@ -11,14 +11,16 @@
 #include "private/internationalization.hpp"
 #include "private/errorUtils.hpp"
 #include "strus/errorBufferInterface.hpp"
+#include "strus/analyzer/documentClass.hpp"
+#include "strus/base/string_conv.hpp"
 #include "segmenter.hpp"
 #include "private/xpathAutomaton.hpp"
 #include "private/textEncoder.hpp"
 #include "private/contentIteratorStm.hpp"
+#include "private/inputChunkQueue.hpp"
 #include "textwolf/charset.hpp"
 #include "textwolf/sourceiterator.hpp"
 #include <cstdlib>
-#include <list>
 #include <setjmp.h>
 
 #define SEGMENTER_NAME "textwolf"
@@ -31,8 +33,12 @@ class TextwolfSegmenterContext
 	:public SegmenterContextInterface
 {
 public:
-	TextwolfSegmenterContext( ErrorBufferInterface* errorhnd, const XPathAutomaton* automaton_, const CharsetEncoding& charset_=CharsetEncoding())
+	/// \param[in] maxBufferedInputSize_ maximum number of bytes of input fed and not consumed yet or 0 for no limit
+	/// \param[in] encoding_ character set encoding of the document class the context is created for
+	TextwolfSegmenterContext( ErrorBufferInterface* errorhnd, const XPathAutomaton* automaton_, std::size_t maxBufferedInputSize_, const std::string& encoding_, const CharsetEncoding& charset_=CharsetEncoding())
 		:m_automaton(automaton_)
+		,m_encoding(encoding_)
+		,m_charset(charset_)
 		,m_xpathselect(automaton_->createContext())
 		,m_srciter()
 		,m_scanner(charset_,textwolf::SrcIterator())
@@ -40,17 +46,43 @@ public:
 		,m_end()
 		,m_eof(false)
 		,m_initialized(false)
+		,m_finalChunk(false)
 		,m_eom()
 		,m_chunkbuf()
+		,m_maxBufferedInputSize(maxBufferedInputSize_)
 		,m_errorhnd(errorhnd)
 	{}
 
 	virtual ~TextwolfSegmenterContext()
 	{}
 
-	void initScanner( char const* src, std::size_t srcsize)
+	virtual bool reset( const analyzer::DocumentClass& dclass)
 	{
-		m_srciter.putInput( src, srcsize, &m_eom);
+		try
+		{
+			if (!strus::caseInsensitiveEquals( dclass.encoding(), m_encoding))
+			{
+				// ... the character set encoding is a template parameter, a context for another encoding has to be created
+				return false;
+			}
+			m_xpathselect.reset();
+			m_scanner = XMLScanner( m_charset, textwolf::SrcIterator());
+			m_itr = typename XMLScanner::iterator();
+			m_end = typename XMLScanner::iterator();
+			m_eof = false;
+			m_initialized = false;
+			m_finalChunk = false;
+			m_chunkbuf.clear();
+			return true;
+		}
+		CATCH_ERROR_ARG1_MAP_RETURN( _TXT("error in reset of '%s' segmenter: %s"), SEGMENTER_NAME, *m_errorhnd, false);
+	}
+
+	/// \param[in] finalChunk true if the chunk is the last one of the input, the scanner sees its end as end of input then, without a longjmp to m_eom
+	void initScanner( char const* src, std::size_t srcsize, bool finalChunk)
+	{
+		m_finalChunk = finalChunk;
+		m_srciter.putInput( src, srcsize, finalChunk ? 0 : &m_eom);
 		m_scanner.setSource( m_srciter);
 		m_itr = m_scanner.begin(false);
 		m_end = m_scanner.end();
@@ -60,18 +92,33 @@ public:
 		if (m_chunkbuf.empty())
 		{
 			m_initialized = false;
-			initScanner( "", 0);
+			initScanner( "", 0, false);
 			return false;
 		}
 		else
 		{
-			initScanner( m_chunkbuf.front().c_str(), m_chunkbuf.front().size());
+			initScanner( m_chunkbuf.frontPtr(), m_chunkbuf.frontSize(), m_eof && m_chunkbuf.size() == 1);
 			m_initialized = true;
 			return true;
 		}
 	}
 
 	virtual void putInput( const char* chunk, std::size_t chunksize, bool eof)
+	{
+		putChunk( chunk, chunksize, eof, true/*copy*/);
+	}
+
+	virtual void putInputReference( const char* chunk, std::size_t chunksize, bool eof)
+	{
+		putChunk( chunk, chunksize, eof, false/*copy*/);
+	}
+
+	virtual std::size_t bufferedInputSize() const
+	{
+		return m_chunkbuf.bufferedSize();
+	}
+
+	void putChunk( const char* chunk, std::size_t chunksize, bool eof, bool copy)
 	{
 		try
 		{
@@ -80,9 +127,22 @@ public:
 				m_errorhnd->report( ErrorCodeOperationOrder, _TXT( "feeded chunk after declared end of input"));
 				return;
 			}
+			if (m_maxBufferedInputSize && !m_chunkbuf.empty()
+			&&  m_chunkbuf.bufferedSize() + chunksize > m_maxBufferedInputSize)
+			{
+				m_errorhnd->report( ErrorCodeBufferOverflow, _TXT( "input buffered in '%s' segmenter exceeds the limit of %u bytes, input has to be consumed before feeding more"), SEGMENTER_NAME, (unsigned int)m_maxBufferedInputSize);
+				return;
+			}
 			try
 			{
-				m_chunkbuf.push_back( std::string( chunk, chunksize));
+				if (copy)
+				{
+					m_chunkbuf.pushCopy( chunk, chunksize);
+				}
+				else
+				{
+					m_chunkbuf.pushReference( chunk, chunksize);
+				}
 				m_eof = eof;
 			}
 			catch (const std::bad_alloc&)
@@ -102,25 +162,29 @@ public:
 		try
 		{
 		AGAIN:
-			if (setjmp(m_eom) != 0)
+			if (!m_finalChunk)
 			{
-				if (m_chunkbuf.empty())
-				{
-					if (!m_eof) m_errorhnd->report( ErrorCodeUnexpectedEof, _TXT( "unexpected end of input in '%s' segmenter"), SEGMENTER_NAME);
-					return false;
-				}
-				else
+				// ... the end of a chunk that is not the last one is signalled by a longjmp out of the scanner
+				if (setjmp(m_eom) != 0)
 				{
-					if (m_initialized)
+					if (m_chunkbuf.empty())
 					{
-						m_chunkbuf.pop_front();
-						m_initialized = false;
+						if (!m_eof) m_errorhnd->report( ErrorCodeUnexpectedEof, _TXT( "unexpected end of input in '%s' segmenter"), SEGMENTER_NAME);
+						return false;
 					}
-					if (!feedNextInputChunk())
+					else
 					{
-						return false;
+						if (m_initialized)
+						{
+							m_chunkbuf.pop_front();
+							m_initialized = false;
+						}
+						if (!feedNextInputChunk())
+						{
+							return false;
+						}
+						goto AGAIN; //... to set setjmp context again
 					}
-					goto AGAIN; //... to set setjmp context again
 				}
 			}
 			while (!m_xpathselect.getNext( id))
@@ -159,6 +223,8 @@ private:
 		> XMLScanner;
 
 	const XPathAutomaton* m_automaton;
+	std::string m_encoding;
+	CharsetEncoding m_charset;
 	XPathAutomatonContext m_xpathselect;
 	textwolf::SrcIterator m_srciter;
 	XMLScanner m_scanner;
@@ -166,8 +232,10 @@ private:
 	typename XMLScanner::iterator m_end;
 	bool m_eof;
 	bool m_initialized;
+	bool m_finalChunk;		///< true if the chunk scanned is the last one of the input and the scanner needs no setjmp context
 	jmp_buf m_eom;
-	std::list<std::string> m_chunkbuf;
+	InputChunkQueue m_chunkbuf;
+	std::size_t m_maxBufferedInputSize;
 	ErrorBufferInterface* m_errorhnd;
 };
 
@@ -8,6 +8,7 @@
 
 #include "tsvSegmenter.hpp"
 #include "strus/base/string_conv.hpp"
+#include "strus/base/local_ptr.hpp"
 #include "private/errorUtils.hpp"
 #include "private/internationalization.hpp"
 #include "strus/errorBufferInterface.hpp"
@@ -20,6 +21,7 @@
 
 #include <algorithm>
 #include <cstring>
+#include <cstdio>
 #include <iterator>
 
 #define SEGMENTER_NAME "tsv"
@@ -29,16 +31,15 @@ using namespace strus;
 // TSVParserDefinition
 
 TSVParserDefinition::TSVParserDefinition( )
-	: m_map( ), m_it( m_map.end( ) ), m_end( m_map.end( ) ),
-	m_startId( 0 ), m_endId( 0 )
+	: m_selectors( ), m_startId( 0 ), m_endId( 0 )
 {
 }
 
 void TSVParserDefinition::printDefinitions( )
 {
 #ifdef STRUS_LOWLEVEL_DEBUG
-	std::cout << "DEBUG: definition multimap contains: ";
-	for( std::multimap<std::string, int>::const_iterator it = m_map.begin( ); it != m_map.end( ); it++ ) {
+	std::cout << "DEBUG: definitions contain: ";
+	for( std::vector<std::pair<std::string, int> >::const_iterator it = m_selectors.begin( ); it != m_selectors.end( ); it++ ) {
 		std::cout << "[" << it->first << ", " << it->second << "], ";
 	}
 	std::cout << std::endl;
@@ -50,7 +51,7 @@ void TSVParserDefinition::defineSelectorExpression( int id, const std::string &e
 #ifdef STRUS_LOWLEVEL_DEBUG	
 	std::cout << "DEBUG: adding selector expression: " << id << ", " << expression << std::endl;
 #endif
-	m_map.insert( std::make_pair( expression, id ) );
+	m_selectors.push_back( std::make_pair( expression, id ) );
 
 #ifdef STRUS_LOWLEVEL_DEBUG	
 	printDefinitions( );
@@ -69,101 +70,112 @@ void TSVParserDefinition::defineSubSection( int startId, int endId, const std::s
 	m_endId = endId;
 }
 
-int TSVParserDefinition::getNextId( const std::string &definition )
+void TSVParserDefinition::getIds( std::vector<int>& ids, const std::string &name ) const
 {
-#ifdef STRUS_LOWLEVEL_DEBUG	
-	std::cout << "DEBUG: lookup expression for: " << definition << std::endl;
-#endif
-	int id = 0;
-	if( m_it != m_map.end( ) ) {
-		m_it++;
-		if( m_it != m_end ) {
-			id = m_it->second;
-		} else {
-			m_it = m_map.end( );
-			m_end = m_map.end( );
-		}
-	} else {		
-		std::pair <std::multimap<std::string, int>::const_iterator, std::multimap<std::string, int>::const_iterator> ret;
-		ret = m_map.equal_range( definition );
-		if( ret.first == ret.second ) {
-			m_it = m_map.end( );
-			m_end = m_map.end( );
-		} else if( ret.first->first == definition ) {
-			m_it = ret.first;
-			m_end = ret.second;
-			id = m_it->second;
-		} else {
-			m_it = m_map.end( );
-			m_end = m_map.end( );
+	std::vector<std::pair<std::string, int> >::const_iterator it = m_selectors.begin( ), end = m_selectors.end( );
+	for( ; it != end; ++it ) {
+		if( it->first == name ) {
+			ids.push_back( it->second );
 		}
 	}
 #ifdef STRUS_LOWLEVEL_DEBUG	
-	std::cout << "DEBUG: got number for '" << definition << "' to be " << id << std::endl;
+	std::cout << "DEBUG: got " << ids.size( ) << " selector expressions for '" << name << "'" << std::endl;
 #endif
-	return id;
 }
 
-bool TSVParserDefinition::moreOftheSame( )
-{
-#ifdef STRUS_LOWLEVEL_DEBUG	
-	std::cout << "DEBUG: moreOftheSame is " <<  ( m_it != m_map.end( ) && m_it != m_end ) << std::endl;
-#endif
-	return m_it != m_map.end( ) && m_it != m_end;
-}
-
-// TSVSegmenterContext
-
-TSVSegmenterContext::TSVSegmenterContext( const TSVParserDefinition& parserDefinition, const strus::Reference<strus::utils::TextEncoderBase>& decoder_, strus::ErrorBufferInterface *errbuf, bool errorReporting )
-	: m_errorhnd( errbuf ), m_errorReporting( errorReporting), m_parser( ),
-	m_parserDefinition( parserDefinition ), m_pos( -3 ),
-	m_decoder(decoder_), m_eof(false), m_buf()
-{}
+// TSVParser
 
-TSVSegmenterContext::~TSVSegmenterContext( )
+bool TSVParser::fetchLine( const char*& line, std::size_t& linesize)
 {
+	while (!m_chunks.empty())
+	{
+		if (m_chunkpos == m_chunks.frontSize())
+		{
+			// ... the chunk is released only here, because the columns of the last row may point into it
+			m_chunks.pop_front();
+			m_chunkpos = 0;
+			continue;
+		}
+		const char* ptr = m_chunks.frontPtr() + m_chunkpos;
+		std::size_t size = m_chunks.frontSize() - m_chunkpos;
+		const char* eoln = (const char*)std::memchr( ptr, '\n', size);
+		if (eoln)
+		{
+			m_chunkpos += eoln - ptr + 1;
+			if (m_carry.empty())
+			{
+				line = ptr;
+				linesize = eoln - ptr;
+			}
+			else
+			{
+				m_row.swap( m_carry);
+				m_row.append( ptr, eoln - ptr);
+				m_carry.clear();
+				line = m_row.c_str();
+				linesize = m_row.size();
+			}
+			return true;
+		}
+		// ... the row continues in the next chunk
+		m_carry.append( ptr, size);
+		m_chunkpos += size;
+	}
+	return false;
 }
 
-std::vector<std::string> TSVParser::splitLine( const std::string& line)
+void TSVParser::splitLine( const char* line, std::size_t linesize)
 {
-	std::vector<std::string> rt;
-	char const* si = line.c_str();
-	char const* sn = std::strchr( si, '\t');
-	if (!*si) return std::vector<std::string>();
-
-	for (; sn; sn = std::strchr( si=sn+1, '\t'))
+	std::size_t ci = 0, ce = m_header.size();
+	char const* si = line;
+	const char* se = line + linesize;
+	for (; ci != ce; ++ci)
+	{
+		const char* sn = (const char*)std::memchr( si, '\t', se - si);
+		if (!sn)
+		{
+			m_data[ ci++] = Column( si, se - si);
+			break;
+		}
+		m_data[ ci] = Column( si, sn - si);
+		si = sn + 1;
+	}
+	for (; ci != ce; ++ci)
 	{
-		rt.push_back( std::string( si, sn-si));
+		m_data[ ci] = Column();
 	}
-	rt.push_back( si);
-	return rt;
 }
 
-void TSVParser::parseHeader()
+void TSVParser::parseHeader( const char* line, std::size_t linesize)
 {
-	std::string line;
-	std::getline( m_is, line);
-	if(m_is.eof())
+	m_header.clear();
+	if (linesize)
 	{
-		m_eof = true;
-		return;
+		char const* si = line;
+		const char* se = line + linesize;
+		const char* sn = (const char*)std::memchr( si, '\t', se - si);
+		for (; sn; sn = (const char*)std::memchr( si, '\t', se - si))
+		{
+			m_header.push_back( std::string( si, sn-si));
+			si = sn + 1;
+		}
+		m_header.push_back( std::string( si, se-si));
 	}
-	m_header = splitLine( line);
+	m_data.resize( m_header.size());
+	m_hasHeader = true;
 }
 
 bool TSVParser::nextLine()
 {
-	if (m_eof) return false;
-
-	std::string line;
-	std::getline( m_is, line);
-	if(m_is.eof())
+	const char* line;
+	std::size_t linesize;
+	if (!m_hasHeader)
 	{
-		m_eof = true;
-		return false;
+		if (!fetchLine( line, linesize)) return false;
+		parseHeader( line, linesize);
 	}
-	m_data = splitLine( line);
-	m_data.resize( m_header.size());
+	if (!fetchLine( line, linesize)) return false;
+	splitLine( line, linesize);
 	++m_lineno;
 	return true;
 }
@@ -174,108 +186,100 @@ const char* TSVParser::linenostr()
 	return m_linenostr;
 }
 
-void TSVSegmenterContext::putInput( const char *chunk, std::size_t chunksize, bool eof )
+// TSVSegmenterContext
+
+TSVSegmenterContext::TSVSegmenterContext( const TSVParserDefinition& parserDefinition, const strus::Reference<strus::utils::TextEncoderBase>& decoder_, strus::ErrorBufferInterface *errbuf, bool errorReporting )
+	: m_errorhnd( errbuf ), m_errorReporting( errorReporting), m_parser( ),
+	m_parserDefinition( parserDefinition ), m_selection( ), m_selectionDefined( false ),
+	m_state( FetchRow ), m_selidx( 0 ),
+	m_decoder(decoder_), m_eof(false), m_buf()
+{}
+
+TSVSegmenterContext::~TSVSegmenterContext( )
+{
+}
+
+void TSVSegmenterContext::putInputChunk( const char *chunk, std::size_t chunksize, bool eof, bool reference )
 {
-	try
-	{	
 #ifdef STRUS_LOWLEVEL_DEBUG	
 	std::cout << "DEBUG: putInput '" << chunksize << " (eof: " << eof << ")" << std::endl;
 #endif
-	
 	if( m_eof ) {
 		m_errorhnd->report( ErrorCodeOperationOrder, _TXT("fed chunk after declared end of input" ));
 		return;
 	}
-	m_buf.append( chunk, chunksize );
-	if (eof)
+	m_eof = eof;
+	if (m_decoder.get())
 	{
-		if (m_decoder.get())
+		// ... the decoder needs the whole input
+		m_buf.append( chunk, chunksize );
+		if (eof)
 		{
 			m_buf = m_decoder->convert( m_buf.c_str(), m_buf.size(), true );
+			m_parser.putInputReference( m_buf.c_str(), m_buf.size(), true );
 		}
-		m_eof = true;
-		m_parser.init( m_buf );
 	}
+	else if (reference)
+	{
+		m_parser.putInputReference( chunk, chunksize, eof );
+	}
+	else
+	{
+		m_parser.putInput( chunk, chunksize, eof );
 	}
-	CATCH_ERROR_ARG1_MAP( _TXT("error in put input of '%s' segmenter: %s"), SEGMENTER_NAME, *m_errorhnd);
 }
 
-
-bool TSVSegmenterContext::parseData( int &id, strus::SegmenterPosition &pos, const char *&segment, std::size_t &segmentsize )
+void TSVSegmenterContext::putInput( const char *chunk, std::size_t chunksize, bool eof )
 {
-	// start of line, emit start of section
-	segment = 0;
-	segmentsize = 0;
-
-	if( m_pos == -2 ) {
-		id = m_parserDefinition.getStartId( );
-		if( id != 0 ) {
-			m_pos++;
-			return true;
-		}
-		
-		// no subsection definition, continue
-		m_pos++;
+	try
+	{	
+		putInputChunk( chunk, chunksize, eof, false );
 	}
+	CATCH_ERROR_ARG1_MAP( _TXT("error in put input of '%s' segmenter: %s"), SEGMENTER_NAME, *m_errorhnd);
+}
 
-	// hard-coded field line number (not present in the TSV file itself)
-	if( m_pos == -1 ) {
-		id = m_parserDefinition.getNextId( "lineno" );
-		if( id != 0 ) {
-			if( !m_parserDefinition.moreOftheSame( ) ) {
-				m_pos++;
-			}
-			segment = m_parser.linenostr();
-			segmentsize = strlen( segment );
-			return true;
-		}
-
-		if( !m_parserDefinition.moreOftheSame( ) ) {
-			m_pos++;
-		}
+void TSVSegmenterContext::putInputReference( const char *chunk, std::size_t chunksize, bool eof )
+{
+	try
+	{	
+		putInputChunk( chunk, chunksize, eof, true );
 	}
+	CATCH_ERROR_ARG1_MAP( _TXT("error in put input of '%s' segmenter: %s"), SEGMENTER_NAME, *m_errorhnd);
+}
 
-	while (m_pos < m_parser.cols()) {
-		std::string headerName = m_parser.header( m_pos);
-#ifdef STRUS_LOWLEVEL_DEBUG	
-		std::cout << "DEBUG: field " << m_linepos << ":" << m_pos << "'" << headerName << "': '" << m_parser.col( m_pos) << "'" << std::endl;
-#endif
-		id = m_parserDefinition.getNextId( headerName );
-		if( id == 0 ) {
-			m_pos++;
-		}
-		else
-		{
-			break;
-		}
-		
+void TSVSegmenterContext::putInputPart( const char *content, std::size_t headersize, const strus::SegmenterInstanceInterface::ContentPart& part )
+{
+	if( m_eof ) {
+		throw std::runtime_error( _TXT("fed chunk after declared end of input" ));
 	}
-	if( id != 0 ) {
-		// TODO: think whether we should not return the character position into the TSV here
-		pos = m_parser.lineno() * m_parser.cols() + m_pos;
-		segment = m_parser.col( m_pos).c_str( );
-		segmentsize = m_parser.col( m_pos).size( );
-		if( !m_parserDefinition.moreOftheSame( ) ) {
-			m_pos++;
-		}
-		if(m_pos >= m_parser.cols()) {
-			m_pos = -3;
-			id = m_parserDefinition.getEndId( );
-			if( id != 0 ) {
-				return true;
-			}
-		}
-		return true;
+	m_eof = true;
+	m_parser.putInputReference( content, headersize, false );
+	m_parser.putInputReference( content + part.start, part.end - part.start, true );
+	m_parser.setLineno( part.index );
+}
+
+std::size_t TSVSegmenterContext::bufferedInputSize( ) const
+{
+	// ... with a decoder the input is collected in m_buf until the end and then converted and fed to the parser
+	return (m_decoder.get() && !m_eof) ? m_buf.size( ) : m_parser.bufferedSize( );
+}
+
+void TSVSegmenterContext::defineSelection( )
+{
+	std::vector<int> ids;
+	m_parserDefinition.getIds( ids, "lineno" );
+	std::vector<int>::const_iterator ii = ids.begin( ), ie = ids.end( );
+	for( ; ii != ie; ++ii ) {
+		m_selection.push_back( Selection( -1, *ii ) );
 	}
-	m_pos++;
-	if( m_pos >= m_parser.cols() ) {
-		m_pos = -3;
-		id = m_parserDefinition.getEndId( );
-		if( id != 0 ) {
-			return true;
+	for( int column = 0; column < m_parser.cols( ); ++column ) {
+		ids.clear( );
+		m_parserDefinition.getIds( ids, m_parser.header( column ) );
+		for( ii = ids.begin( ), ie = ids.end( ); ii != ie; ++ii ) {
+			m_selection.push_back( Selection( column, *ii ) );
 		}
 	}
-	return false;
+	m_selectionDefined = true;
 }
 
 bool TSVSegmenterContext::getNext( int &id, strus::SegmenterPosition &pos, const char *&segment, std::size_t &segmentsize )
@@ -284,15 +288,66 @@ bool TSVSegmenterContext::getNext( int &id, strus::SegmenterPosition &pos, const
 	{
 	for (;;)
 	{
-		if (m_parser.eof()) return false;
-	
-		if (m_pos < -2)
+		// TODO: think whether we should not return the character position into the TSV here
+		strus::SegmenterPosition rowpos = m_parser.lineno() * m_parser.cols();
+		switch (m_state)
 		{
-			if (!m_parser.nextLine()) return false;
-			m_pos = -2;
-		}
-		if ( parseData( id, pos, segment, segmentsize ) ) {
-			return true;
+			case FetchRow:
+				if (!m_parser.nextLine()) return false;
+				if (!m_selectionDefined) defineSelection();
+				m_selidx = 0;
+				m_state = RowStart;
+				break;
+
+			case RowStart:
+				// start of line, emit start of section
+				m_state = RowColumns;
+				id = m_parserDefinition.getStartId( );
+				if( id != 0 ) {
+					pos = rowpos;
+					segment = 0;
+					segmentsize = 0;
+					return true;
+				}
+				break;
+
+			case RowColumns:
+				if (m_selidx < m_selection.size())
+				{
+					const Selection& sel = m_selection[ m_selidx++];
+					id = sel.id;
+					if (sel.column < 0)
+					{
+						// hard-coded field line number (not present in the TSV file itself)
+						pos = rowpos;
+						segment = m_parser.linenostr();
+						segmentsize = std::strlen( segment );
+					}
+					else
+					{
+#ifdef STRUS_LOWLEVEL_DEBUG	
+						std::cout << "DEBUG: field " << m_parser.lineno() << ":" << sel.column << "'" << m_parser.header( sel.column) << "': '" << std::string( m_parser.col( sel.column), m_parser.colsize( sel.column)) << "'" << std::endl;
+#endif
+						pos = rowpos + sel.column;
+						segment = m_parser.col( sel.column);
+						segmentsize = m_parser.colsize( sel.column);
+					}
+					return true;
+				}
+				m_state = RowEnd;
+				break;
+
+			case RowEnd:
+				// end of line, emit end of section
+				m_state = FetchRow;
+				id = m_parserDefinition.getEndId( );
+				if( id != 0 ) {
+					pos = m_parser.cols() ? (rowpos + m_parser.cols() - 1) : rowpos;
+					segment = 0;
+					segmentsize = 0;
+					return true;
+				}
+				break;
 		}
 	}
 	}
@@ -338,6 +393,81 @@ strus::SegmenterContextInterface* TSVSegmenterInstance::createContext( const str
 	CATCH_ERROR_ARG1_MAP_RETURN( _TXT("error creating context of '%s' segmenter: %s"), SEGMENTER_NAME, *m_errorhnd, 0);
 }
 
+static bool isUtf8Encoding( const strus::analyzer::DocumentClass &dclass )
+{
+	return dclass.encoding().empty() || strus::caseInsensitiveEquals( dclass.encoding(), "utf-8");
+}
+
+/// \brief Get the size of the first line of a content including the end of line or 0, if the line is not terminated
+static std::size_t lineSize( const char* content, std::size_t contentsize )
+{
+	const char* eoln = (const char*)std::memchr( content, '\n', contentsize);
+	return eoln ? (eoln - content + 1) : 0;
+}
+
+bool TSVSegmenterInstance::splitContent( std::vector<ContentPart>& parts, const strus::analyzer::DocumentClass& dclass, const char* content, std::size_t contentsize, unsigned int nofParts) const
+{
+	try
+	{
+	// ... a decoder needs the whole input, the rows can only be found in UTF-8 content without converting it first
+	if (!isUtf8Encoding( dclass) || nofParts == 0) return false;
+	std::size_t start = lineSize( content, contentsize );
+	if (!start) return false;
+
+	// ... only rows terminated by an end of line are parsed
+	std::size_t end = contentsize;
+	while (end > start && content[ end-1] != '\n') --end;
+	if (end == start) return false;
+
+	std::size_t partsize = (end - start + nofParts - 1) / nofParts;
+	int index = 0;
+	while (start < end)
+	{
+		std::size_t partend = start + partsize;
+		if (partend >= end)
+		{
+			partend = end;
+		}
+		else
+		{
+			// ... align the end of the part to the end of the row containing the last byte
+			partend = lineSize( content + partend - 1, end - partend + 1 ) + partend - 1;
+		}
+		parts.push_back( ContentPart( start, partend, index ));
+
+		char const* ri = content + start;
+		const char* re = content + partend;
+		for (; ri != re; ++ri,++index)
+		{
+			ri = (const char*)std::memchr( ri, '\n', re - ri);
+		}
+		start = partend;
+	}
+	return true;
+	}
+	CATCH_ERROR_ARG1_MAP_RETURN( _TXT("error splitting content for '%s' segmenter: %s"), SEGMENTER_NAME, *m_errorhnd, false);
+}
+
+strus::SegmenterContextInterface* TSVSegmenterInstance::createPartContext( const strus::analyzer::DocumentClass& dclass, const char* content, std::size_t contentsize, const ContentPart& part) const
+{
+	try
+	{
+	if (!isUtf8Encoding( dclass))
+	{
+		throw std::runtime_error( _TXT("only content in UTF-8 encoding can be segmented in parts"));
+	}
+	std::size_t headersize = lineSize( content, contentsize );
+	if (!headersize || part.start < headersize || part.end < part.start || part.end > contentsize)
+	{
+		throw std::runtime_error( _TXT("invalid part of content to segment"));
+	}
+	strus::local_ptr<TSVSegmenterContext> rt( new TSVSegmenterContext( m_parserDefinition, strus::Reference<strus::utils::TextEncoderBase>(), m_errorhnd, m_errorReporting ));
+	rt->putInputPart( content, headersize, part );
+	return rt.release();
+	}
+	CATCH_ERROR_ARG1_MAP_RETURN( _TXT("error creating part context of '%s' segmenter: %s"), SEGMENTER_NAME, *m_errorhnd, 0);
+}
+
 strus::SegmenterMarkupContextInterface* TSVSegmenterInstance::createMarkupContext( const strus::analyzer::DocumentClass& dclass, const std::string& content) const
 {
 	try
@@ -433,7 +563,7 @@ TSVContentIterator::TSVContentIterator(
 		{
 			m_content = std::string( content_, contentsize_);
 		}
-		m_parser.init( m_content);
+		m_parser.putInputReference( m_content.c_str(), m_content.size(), true);
 	}
 	CATCH_ERROR_ARG1_MAP( _TXT("error fetching next element of content iterator of '%s' segmenter: %s"), SEGMENTER_NAME, *m_errorhnd);
 }
@@ -444,8 +574,6 @@ bool TSVContentIterator::getNext(
 {
 	try
 	{
-		if (m_parser.eof()) return false;
-
 		if (m_pos >= m_parser.cols())
 		{
 			m_pos = -3;
@@ -463,14 +591,11 @@ bool TSVContentIterator::getNext(
 		{
 			expression = m_parser.header( m_pos).c_str();
 			expressionsize = m_parser.header( m_pos).size();
-			segment = m_parser.col( m_pos).c_str();
-			segmentsize = m_parser.col( m_pos).size();
+			segment = m_parser.col( m_pos);
+			segmentsize = m_parser.colsize( m_pos);
 			++m_pos;
 		}
 		return true;
 	}
 	CATCH_ERROR_ARG1_MAP_RETURN( _TXT("error fetching next element of content iterator of '%s' segmenter: %s"), SEGMENTER_NAME, *m_errorhnd, false);
 }
-
-
-
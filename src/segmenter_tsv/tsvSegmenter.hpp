@@ -18,13 +18,12 @@
 #include "strus/analyzer/documentClass.hpp"
 #include "strus/reference.hpp"
 #include "private/textEncoder.hpp"
+#include "private/inputChunkQueue.hpp"
 
 #include <string> 
 #include <vector> 
-#include <map>
 #include <set>
 #include <stdexcept>
-#include <sstream>
 
 class TSVParserException : public std::runtime_error {
 	
@@ -39,23 +38,20 @@ class TSVParserDefinition
 	public:
 		TSVParserDefinition( );
 		TSVParserDefinition( const TSVParserDefinition& o)
-			:m_map(o.m_map),m_startId(o.m_startId),m_endId(o.m_endId)
-		{
-			m_it = m_map.end();
-			m_end = m_map.end();
-		}
+			:m_selectors(o.m_selectors),m_startId(o.m_startId),m_endId(o.m_endId){}
 
 		void defineSelectorExpression( int id, const std::string &expression );
 		void defineSubSection( int startId, int endId, const std::string &expression );
-		int getNextId( const std::string &definition );
-		bool moreOftheSame( );
+		/// \brief Get the identifiers of the selector expressions addressing a column, in the order of their definition
+		/// \param[out] ids where to append the identifiers to
+		/// \param[in] name name of the column or "lineno" for the line number
+		void getIds( std::vector<int>& ids, const std::string &name ) const;
 		int getStartId( ) const { return m_startId; }
 		int getEndId( ) const { return m_endId; }
 	
 	private:
 	
-		std::multimap<std::string, int> m_map;
-		std::multimap<std::string, int>::const_iterator m_it, m_end;
+		std::vector<std::pair<std::string, int> > m_selectors;
 		int m_startId;
 		int m_endId;
 
@@ -63,29 +59,65 @@ class TSVParserDefinition
 		
 };
 
+/// \brief Incremental parser of TSV content fed in chunks
+/// \note Rows are found with memchr on the chunks fed. The columns of a row point into the chunk containing the row,
+///	only a row spanning chunks is copied. The input buffered is bounded by the chunks not consumed yet plus the longest row.
+///	As before, only rows terminated by a newline are returned.
 class TSVParser
 {
 public:
-	TSVParser() :m_is(),m_header(),m_data(),m_lineno(0),m_eof(true){}
+	TSVParser() :m_chunks(),m_chunkpos(0),m_carry(),m_row(),m_header(),m_data(),m_hasHeader(false),m_lineno(0),m_eof(false){}
 	~TSVParser(){}
 
-	void init( const std::string& content)	{m_is.str(content); m_eof=false; m_lineno=0; parseHeader();}
-	bool eof() const			{return m_eof;}
+	/// \brief Feed the next chunk of input, copying it
+	void putInput( const char* chunk, std::size_t chunksize, bool eof)		{if (chunksize) m_chunks.pushCopy( chunk, chunksize); m_eof=eof;}
+	/// \brief Feed the next chunk of input without copying it, the chunk must stay valid until consumed
+	void putInputReference( const char* chunk, std::size_t chunksize, bool eof)	{if (chunksize) m_chunks.pushReference( chunk, chunksize); m_eof=eof;}
+	/// \brief Get the sum of the sizes in bytes of the chunks fed and not consumed yet
+	std::size_t bufferedSize() const	{return m_chunks.bufferedSize() - m_chunkpos;}
+
+	bool eof() const			{return m_eof && m_chunks.empty() && m_carry.empty();}
+	bool hasHeader() const			{return m_hasHeader;}
 	int cols() const			{return m_header.size();}
-	const std::string& col( int id)		{return m_data[id];}
-	const std::string& header( int id)	{return m_header[id];}
+	const char* col( int id) const		{return m_data[id].ptr;}
+	std::size_t colsize( int id) const	{return m_data[id].size;}
+	const std::string& header( int id) const{return m_header[id];}
+	/// \brief Fetch the next row, parsing the header first
+	/// \return true, if a row was fetched, false if more input is required or all rows have been fetched
+	/// \remark The columns of the row stay valid until the next call of nextLine
 	bool nextLine();
 	int lineno() const			{return m_lineno;}
+	/// \brief Set the number of rows preceding the input, for parsing a part of a content
+	void setLineno( int lineno_)		{m_lineno = lineno_;}
 	const char* linenostr();
 
 private:
-	void parseHeader();
-	static std::vector<std::string> splitLine( const std::string& line);
+	TSVParser( const TSVParser&){}		//... non copyable
+	void operator=( const TSVParser&){}	//... non copyable
+
+	bool fetchLine( const char*& line, std::size_t& linesize);
+	void parseHeader( const char* line, std::size_t linesize);
+	void splitLine( const char* line, std::size_t linesize);
 
 private:
-	std::istringstream m_is;
+	struct Column
+	{
+		const char* ptr;
+		std::size_t size;
+
+		Column()
+			:ptr(""),size(0){}
+		Column( const char* ptr_, std::size_t size_)
+			:ptr(ptr_),size(size_){}
+	};
+
+	strus::InputChunkQueue m_chunks;	///< chunks fed and not consumed yet
+	std::size_t m_chunkpos;			///< position of the first byte not consumed in the front chunk
+	std::string m_carry;			///< start of the current row from chunks already consumed
+	std::string m_row;			///< last row fetched, if it spans chunks
 	std::vector<std::string> m_header;
-	std::vector<std::string> m_data;
+	std::vector<Column> m_data;		///< columns of the last row fetched
+	bool m_hasHeader;
 	int m_lineno;
 	char m_linenostr[32];
 	bool m_eof;
@@ -100,20 +132,48 @@ class TSVSegmenterContext : public strus::SegmenterContextInterface
 		virtual ~TSVSegmenterContext( );
 		
 		virtual void putInput( const char *chunk, std::size_t chunksize, bool eof );
+
+		virtual void putInputReference( const char *chunk, std::size_t chunksize, bool eof );
+
+		virtual std::size_t bufferedInputSize( ) const;
 		
 		virtual bool getNext( int &id, strus::SegmenterPosition &pos, const char *&segment, std::size_t &segmentsize );
+
+		/// \brief Feed the header and a range of rows of a content as complete input, without copying them
+		void putInputPart( const char *content, std::size_t headersize, const strus::SegmenterInstanceInterface::ContentPart& part );
 	
 	private:
+		/// \brief Selection of a column by a selector expression
+		struct Selection
+		{
+			int column;	///< index of the column, -1 for the line number
+			int id;		///< identifier of the selector expression
+
+			Selection( int column_, int id_)
+				:column(column_),id(id_){}
+		};
+
+		enum State {
+			FetchRow,	///< fetch the next row
+			RowStart,	///< emit the start of the subsection of the row
+			RowColumns,	///< emit the columns selected
+			RowEnd		///< emit the end of the subsection of the row
+		};
+
 		strus::ErrorBufferInterface *m_errorhnd;
 		bool m_errorReporting;
 		TSVParser m_parser;
 		TSVParserDefinition m_parserDefinition;
-		int m_pos;
+		std::vector<Selection> m_selection;	///< columns selected in the order of emission, built once from the header
+		bool m_selectionDefined;
+		State m_state;
+		std::size_t m_selidx;			///< index of the next element in m_selection to emit
 		strus::Reference<strus::utils::TextEncoderBase> m_decoder;
 		bool m_eof;
-		std::string m_buf;
+		std::string m_buf;			///< input to convert, if a decoder is defined
 
-		bool parseData( int &id, strus::SegmenterPosition &pos, const char *&segment, std::size_t &segmentsize );
+		void defineSelection( );
+		void putInputChunk( const char *chunk, std::size_t chunksize, bool eof, bool reference );
 };
 
 
@@ -129,6 +189,9 @@ class TSVSegmenterInstance : public strus::SegmenterInstanceInterface
 		virtual strus::SegmenterContextInterface* createContext( const strus::analyzer::DocumentClass &dclass) const;
 		virtual strus::SegmenterMarkupContextInterface* createMarkupContext( const strus::analyzer::DocumentClass& dclass, const std::string& content) const;
 
+		virtual bool splitContent( std::vector<ContentPart>& parts, const strus::analyzer::DocumentClass& dclass, const char* content, std::size_t contentsize, unsigned int nofParts) const;
+		virtual strus::SegmenterContextInterface* createPartContext( const strus::analyzer::DocumentClass& dclass, const char* content, std::size_t contentsize, const ContentPart& part) const;
+
 		virtual const char* name() const	{return "tsv";}
 		virtual strus::StructView view() const;
 
@@ -8,14 +8,17 @@
 #include "private/xpathAutomaton.hpp"
 #include "private/errorUtils.hpp"
 #include "private/internationalization.hpp"
+#include "strus/base/stdint.h"
 #include <cstdlib>
 #include <setjmp.h>
 
 using namespace strus;
 
-XPathAutomatonContext::XPathAutomatonContext( const Automaton* automaton_)
+XPathAutomatonContext::XPathAutomatonContext( const Automaton* automaton_, const XPathTagFilter* tagFilter_)
 	:m_automaton(automaton_)
+	,m_tagFilter(tagFilter_)
 	,m_pathselect(automaton_)
+	,m_skipDepth(0)
 {
 	m_selitr = m_selend = m_pathselect.end();
 }
@@ -25,6 +28,27 @@ void XPathAutomatonContext::putElement(
 	const char* elem_,
 	std::size_t elemsize_)
 {
+	if (m_skipDepth)
+	{
+		// ... inside the subtree of a tag not referenced by any expression, nothing can be selected here
+		if (elemtype == textwolf::XMLScannerBase::OpenTag)
+		{
+			++m_skipDepth;
+		}
+		else if (elemtype == textwolf::XMLScannerBase::CloseTag || elemtype == textwolf::XMLScannerBase::CloseTagIm)
+		{
+			--m_skipDepth;
+		}
+		m_selitr = m_selend;
+		return;
+	}
+	if (elemtype == textwolf::XMLScannerBase::OpenTag
+	&&  m_tagFilter->enabled() && !m_tagFilter->contains( elem_, elemsize_))
+	{
+		m_skipDepth = 1;
+		m_selitr = m_selend;
+		return;
+	}
 	m_selitr = m_pathselect.push( elemtype, elem_, elemsize_);
 	m_selend = m_pathselect.end();
 }
@@ -37,6 +61,13 @@ bool XPathAutomatonContext::getNext( int& id)
 	return true;
 }
 
+void XPathAutomatonContext::reset()
+{
+	m_pathselect = XMLPathSelect( m_automaton);
+	m_selitr = m_selend = m_pathselect.end();
+	m_skipDepth = 0;
+}
+
 
 static bool isTagNameChar( char ch)
 {
@@ -54,6 +85,161 @@ static void skipSpaces( char const*& si, const char* se)
 	for (; si != se && isSpace(*si); ++si){}
 }
 
+static bool isFilterTagNameChar( char ch)
+{
+	return isTagNameChar( ch) && !isSpace( ch) && ch != '~' && ch != '*' && ch != '=' && ch != '\'' && ch != '"';
+}
+
+static unsigned char toLowerAscii( char ch)
+{
+	return (ch >= 'A' && ch <= 'Z') ? (unsigned char)(ch - 'A' + 'a') : (unsigned char)ch;
+}
+
+static std::size_t tagNameHash( const char* tagname, std::size_t tagnamesize)
+{
+	uint32_t hash = 2166136261U;
+	char const* ti = tagname;
+	const char* te = tagname + tagnamesize;
+	for (; ti != te; ++ti) hash = (hash ^ toLowerAscii( *ti)) * 16777619U;
+	return hash;
+}
+
+static bool tagNameEquals( const std::string& lcname, const char* tagname, std::size_t tagnamesize)
+{
+	if (lcname.size() != tagnamesize) return false;
+	std::string::const_iterator li = lcname.begin();
+	char const* ti = tagname;
+	const char* te = tagname + tagnamesize;
+	for (; ti != te; ++ti,++li) if ((unsigned char)*li != toLowerAscii( *ti)) return false;
+	return true;
+}
+
+void XPathTagFilter::insert( const char* tagname, std::size_t tagnamesize)
+{
+	if (contains( tagname, tagnamesize)) return;
+	if ((m_size + 1) * 2 > m_table.size())
+	{
+		// ... grow the table keeping a load factor of at most 1/2
+		std::vector<std::string> oldtable;
+		oldtable.swap( m_table);
+		m_table.resize( oldtable.empty() ? 16 : oldtable.size() * 2);
+		m_size = 0;
+		std::vector<std::string>::const_iterator oi = oldtable.begin(), oe = oldtable.end();
+		for (; oi != oe; ++oi)
+		{
+			if (!oi->empty()) insert( oi->c_str(), oi->size());
+		}
+	}
+	std::size_t mask = m_table.size() - 1;
+	std::size_t idx = tagNameHash( tagname, tagnamesize) & mask;
+	while (!m_table[ idx].empty())
+	{
+		idx = (idx + 1) & mask;
+	}
+	std::string& slot = m_table[ idx];
+	slot.reserve( tagnamesize);
+	char const* ti = tagname;
+	const char* te = tagname + tagnamesize;
+	for (; ti != te; ++ti) slot.push_back( (char)toLowerAscii( *ti));
+	++m_size;
+}
+
+bool XPathTagFilter::contains( const char* tagname, std::size_t tagnamesize) const
+{
+	if (m_table.empty()) return false;
+	std::size_t mask = m_table.size() - 1;
+	std::size_t idx = tagNameHash( tagname, tagnamesize) & mask;
+	for (; !m_table[ idx].empty(); idx = (idx + 1) & mask)
+	{
+		if (tagNameEquals( m_table[ idx], tagname, tagnamesize)) return true;
+	}
+	return false;
+}
+
+void XPathTagFilter::addExpression( const std::string& expression)
+{
+	// Accept only absolute paths of named tags with attribute conditions, attribute, content or end tag selections,
+	// disable the filter for anything else:
+	char const* si = expression.c_str();
+	char const* se = si + expression.size();
+	skipSpaces( si, se);
+	if (si == se || *si != '/')
+	{
+		m_enabled = false;
+		return;
+	}
+	while (si != se)
+	{
+		if (*si == '/')
+		{
+			++si;
+			skipSpaces( si, se);
+			if (si != se && isFilterTagNameChar( *si))
+			{
+				char const* ti = si;
+				for (++si; si != se && isFilterTagNameChar( *si); ++si){}
+				insert( ti, si-ti);
+			}
+			else if (si == se || (*si != '@' && *si != '('))
+			{
+				// ... descendant step '//', wildcard '*' or unknown syntax
+				m_enabled = false;
+				return;
+			}
+		}
+		else if (*si == '[')
+		{
+			// Skip conditions, values in quotes may contain any characters:
+			for (++si; si != se && *si != ']'; ++si)
+			{
+				if (*si == '\'' || *si == '"')
+				{
+					char eb = *si;
+					for (++si; si != se && *si != eb; ++si){}
+					if (si == se) break;
+				}
+			}
+			if (si == se)
+			{
+				m_enabled = false;
+				return;
+			}
+			++si;
+		}
+		else if (*si == '@')
+		{
+			++si;
+			skipSpaces( si, se);
+			if (si == se || !isFilterTagNameChar( *si))
+			{
+				m_enabled = false;
+				return;
+			}
+			for (++si; si != se && isFilterTagNameChar( *si); ++si){}
+		}
+		else if (*si == '(')
+		{
+			++si;
+			skipSpaces( si, se);
+			if (si == se || *si != ')')
+			{
+				m_enabled = false;
+				return;
+			}
+			++si;
+		}
+		else if (*si == '~' || isSpace( *si))
+		{
+			++si;
+		}
+		else
+		{
+			m_enabled = false;
+			return;
+		}
+	}
+}
+
 
 enum ExpressionClass
 {
@@ -124,6 +310,7 @@ static ExpressionClass getExpressionClass( const std::string& expression, std::v
 
 void XPathAutomaton::addExpression( int id, const std::string& expression)
 {
+	m_tagFilter.addExpression( expression);
 	int errorpos = m_automaton.addExpression( id, expression.c_str(), expression.size());
 	if (errorpos)
 	{
@@ -168,7 +355,7 @@ void XPathAutomaton::defineSubSection( int startId, int endId, const std::string
 
 XPathAutomatonContext XPathAutomaton::createContext() const
 {
-	return XPathAutomatonContext( &m_automaton);
+	return XPathAutomatonContext( &m_automaton, &m_tagFilter);
 }
 
 
@@ -36,6 +36,7 @@
 #include "strus/base/fileio.hpp"
 #include "strus/base/utf8.hpp"
 #include "private/errorUtils.hpp"
+#include "private/documentLines.hpp"
 #include "private/tokenizeHelpers.hpp"
 #include "private/internationalization.hpp"
 #include <stdexcept>
@@ -558,14 +559,20 @@ public:
 
 	virtual std::vector<analyzer::Token>
 			tokenize( const char* src, std::size_t srcsize) const
+	{
+		std::vector<analyzer::Token> rt;
+		tokenizeInto( src, srcsize, rt);
+		return rt;
+	}
+
+	virtual void tokenizeInto( const char* src, std::size_t srcsize, std::vector<analyzer::Token>& rt) const
 	{
 		try
 		{
-			std::vector<analyzer::Token> rt;
+			rt.clear();
 			rt.push_back( analyzer::Token( 0/*ord*/, analyzer::Position(0/*seg*/, 0/*ofs*/), srcsize));
-			return rt;
 		}
-		CATCH_ERROR_ARG1_MAP_RETURN( _TXT("error in '%s' tokenizer: %s"), "all", *m_errorhnd, std::vector<analyzer::Token>());
+		CATCH_ERROR_ARG1_MAP( _TXT("error in '%s' tokenizer: %s"), "all", *m_errorhnd);
 	}
 
 	virtual bool concatBeforeTokenize() const
@@ -635,9 +642,17 @@ public:
 
 	virtual std::vector<analyzer::Token>
 			tokenize( const char* src, std::size_t srcsize) const
+	{
+		std::vector<analyzer::Token> rt;
+		tokenizeInto( src, srcsize, rt);
+		return rt;
+	}
+
+	virtual void tokenizeInto( const char* src, std::size_t srcsize, std::vector<analyzer::Token>& rt) const
 	{
 		try
 		{
+			rt.clear();
 			char const* si = src;
 			char const* se = src + srcsize;
 			while (si < se && strus::whiteSpaceDelimiter( si, se))
@@ -648,14 +663,12 @@ public:
 			{
 				--se;
 			}
-			std::vector<analyzer::Token> rt;
 			if (si != se)
 			{
 				rt.push_back( analyzer::Token( 0/*ord*/, analyzer::Position(0/*seg*/, 0/*ofs*/), srcsize));
 			}
-			return rt;
 		}
-		CATCH_ERROR_ARG1_MAP_RETURN( _TXT("error in '%s' tokenizer: %s"), "content", *m_errorhnd, std::vector<analyzer::Token>());
+		CATCH_ERROR_ARG1_MAP( _TXT("error in '%s' tokenizer: %s"), "content", *m_errorhnd);
 	}
 
 	virtual bool concatBeforeTokenize() const
@@ -1056,6 +1069,15 @@ const SegmenterInterface* TextProcessor::getSegmenterByMimeType( const std::stri
 		std::map<std::string,SegmenterInterface*>::const_iterator
 			ti = m_mimeSegmenterMap.find( string_conv::tolower( mimetype));
 		if (ti == m_mimeSegmenterMap.end())
+		{
+			// ... a list with one document per line is segmented line by line with the segmenter of its documents
+			const char* lineMimeType = utils::documentLineMimeType( mimetype);
+			if (lineMimeType)
+			{
+				ti = m_mimeSegmenterMap.find( lineMimeType);
+			}
+		}
+		if (ti == m_mimeSegmenterMap.end())
 		{
 			if (m_mimeSegmenterMap.size() < 8)
 			{
@@ -19,10 +19,18 @@ using namespace strus;
 std::vector<analyzer::Token>
 	PunctuationTokenizerInstance_de::tokenize(
 		const char* src, std::size_t srcsize) const
+{
+	std::vector<analyzer::Token> rt;
+	tokenizeInto( src, srcsize, rt);
+	return rt;
+}
+
+void PunctuationTokenizerInstance_de::tokenizeInto(
+		const char* src, std::size_t srcsize, std::vector<analyzer::Token>& rt) const
 {
 	try
 	{
-		std::vector<analyzer::Token> rt;
+		rt.clear();
 	
 		textwolf::UChar ch0;
 		CharWindow scanner( src, srcsize, &m_punctuation_char);
@@ -171,9 +179,8 @@ std::vector<analyzer::Token>
 #endif
 			}
 		}
-		return rt;
 	}
-	CATCH_ERROR_MAP_RETURN( _TXT("error in 'punctuation' tokenizer: %s"), *m_errorhnd, std::vector<analyzer::Token>());
+	CATCH_ERROR_MAP( _TXT("error in 'punctuation' tokenizer: %s"), *m_errorhnd);
 }
 
 StructView PunctuationTokenizerInstance_de::view() const
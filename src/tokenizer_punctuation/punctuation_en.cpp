@@ -1064,10 +1064,18 @@ PunctuationTokenizerInstance_en::PunctuationTokenizerInstance_en(
 std::vector<analyzer::Token>
 	PunctuationTokenizerInstance_en::tokenize(
 		const char* src, std::size_t srcsize) const
+{
+	std::vector<analyzer::Token> rt;
+	tokenizeInto( src, srcsize, rt);
+	return rt;
+}
+
+void PunctuationTokenizerInstance_en::tokenizeInto(
+		const char* src, std::size_t srcsize, std::vector<analyzer::Token>& rt) const
 {
 	try
 	{
-		std::vector<analyzer::Token> rt;
+		rt.clear();
 	
 		textwolf::UChar ch0;
 		CharWindow scanner( src, srcsize, &m_punctuation_char);
@@ -1271,9 +1279,8 @@ std::vector<analyzer::Token>
 				rt.push_back( analyzer::Token( pos/*ordpos*/, analyzer::Position(0/*seg*/, pos), 1));
 			}
 		}
-		return rt;
 	}
-	CATCH_ERROR_MAP_RETURN( _TXT("error in 'punctuation' tokenizer: %s"), *m_errorhnd, std::vector<analyzer::Token>());
+	CATCH_ERROR_MAP( _TXT("error in 'punctuation' tokenizer: %s"), *m_errorhnd);
 }
 
 StructView PunctuationTokenizerInstance_en::view() const
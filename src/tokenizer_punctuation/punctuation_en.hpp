@@ -35,6 +35,7 @@ public:
 	}
 
 	virtual std::vector<analyzer::Token> tokenize( const char* src, std::size_t srcsize) const;
+	virtual void tokenizeInto( const char* src, std::size_t srcsize, std::vector<analyzer::Token>& res) const;
 
 	virtual const char* name() const	{return "punctuation";}
 	virtual StructView view() const;
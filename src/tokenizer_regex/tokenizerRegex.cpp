@@ -40,10 +40,17 @@ public:
 	}
 
 	virtual std::vector<analyzer::Token> tokenize( const char* src, std::size_t srcsize) const
+	{
+		std::vector<analyzer::Token> rt;
+		tokenizeInto( src, srcsize, rt);
+		return rt;
+	}
+
+	virtual void tokenizeInto( const char* src, std::size_t srcsize, std::vector<analyzer::Token>& rt) const
 	{
 		try
 		{
-			std::vector<analyzer::Token> rt;
+			rt.clear();
 			char const* si = src;
 			char const* se = src + srcsize;
 			RegexSearch::Match mt = m_search.find( si, se);
@@ -53,9 +60,8 @@ public:
 				rt.push_back( analyzer::Token( abspos/*ord*/, analyzer::Position(0/*seg*/, abspos), mt.len));
 				if (abspos + mt.len >= srcsize) break;
 			}
-			return rt;
 		}
-		CATCH_ERROR_ARG1_MAP_RETURN( _TXT("error executing \"%s\" tokenizer function: %s"), TOKENIZER_NAME, *m_errorhnd, std::vector<analyzer::Token>());
+		CATCH_ERROR_ARG1_MAP( _TXT("error executing \"%s\" tokenizer function: %s"), TOKENIZER_NAME, *m_errorhnd);
 	}
 
 	virtual const char* name() const	{return "regex";}
@@ -56,6 +56,7 @@ public:
 	const char* skipToToken( char const* si, const char* se) const;
 
 	std::vector<Token> tokenize( const char* src, std::size_t srcsize) const;
+	void tokenizeInto( const char* src, std::size_t srcsize, std::vector<Token>& res) const;
 
 	virtual bool concatBeforeTokenize() const
 	{
@@ -134,10 +135,17 @@ const char* TextcatTokenizerInstance::skipToToken( char const* si, const char* s
 }
 
 std::vector<Token> TextcatTokenizerInstance::tokenize( const char* src, std::size_t srcsize) const
+{
+	std::vector<Token> rt;
+	tokenizeInto( src, srcsize, rt);
+	return rt;
+}
+
+void TextcatTokenizerInstance::tokenizeInto( const char* src, std::size_t srcsize, std::vector<Token>& rt) const
 {
 	try
 	{
-		std::vector<Token> rt;
+		rt.clear();
 
 		char *languages;
 
@@ -148,7 +156,7 @@ std::vector<Token> TextcatTokenizerInstance::tokenize( const char* src, std::siz
 #ifdef STRUS_LOWLEVEL_DEBUG
 			std::cout << "textcat: unknown language" << std::endl;
 #endif
-			return rt;
+			return;
 		} else if( strcmp( languages, _TEXTCAT_RESULT_SHORT ) == 0 ) {
 			// text too short in textcat
 			// TODO: can I issue warnings in error handler?
@@ -161,7 +169,7 @@ std::vector<Token> TextcatTokenizerInstance::tokenize( const char* src, std::siz
 			std::cout << "textcat: detected languages don't match '" << m_language << "'"
 				<< "(" << languages << ")" << std::endl;
 #endif
-			return rt;
+			return;
 		}
 
 		char const* si = skipToToken( src, src+srcsize);
@@ -183,10 +191,8 @@ std::vector<Token> TextcatTokenizerInstance::tokenize( const char* src, std::siz
 				<< std::endl;
 #endif
 		}
-		
-		return rt;
 	}
-	CATCH_ERROR_MAP_RETURN( _TXT("error in tokenizer: %s"), *m_errorhnd, std::vector<Token>());
+	CATCH_ERROR_MAP( _TXT("error in tokenizer: %s"), *m_errorhnd);
 
 }
 
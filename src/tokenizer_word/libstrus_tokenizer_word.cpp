@@ -40,6 +40,7 @@ public:
 	const char* skipToToken( char const* si, const char* se) const;
 
 	virtual std::vector<Token> tokenize( const char* src, std::size_t srcsize) const;
+	virtual void tokenizeInto( const char* src, std::size_t srcsize, std::vector<Token>& res) const;
 
 	virtual bool concatBeforeTokenize() const
 	{
@@ -111,10 +112,17 @@ const char* SeparationTokenizerInstance::skipToToken( char const* si, const char
 }
 
 std::vector<Token> SeparationTokenizerInstance::tokenize( const char* src, std::size_t srcsize) const
+{
+	std::vector<Token> rt;
+	tokenizeInto( src, srcsize, rt);
+	return rt;
+}
+
+void SeparationTokenizerInstance::tokenizeInto( const char* src, std::size_t srcsize, std::vector<Token>& rt) const
 {
 	try
 	{
-		std::vector<Token> rt;
+		rt.clear();
 		char const* si = skipToToken( src, src+srcsize);
 		const char* se = src+srcsize;
 	
@@ -130,9 +138,8 @@ std::vector<Token> SeparationTokenizerInstance::tokenize( const char* src, std::
 				rt.push_back( Token( start-src, analyzer::Position(0/*seg*/, start-src), si-start));
 			}
 		}
-		return rt;
 	}
-	CATCH_ERROR_MAP_RETURN( _TXT("error in tokenizer: %s"), *m_errorhnd, std::vector<Token>());
+	CATCH_ERROR_MAP( _TXT("error in tokenizer: %s"), *m_errorhnd);
 }
 
 
@@ -146,6 +153,13 @@ public:
 	virtual std::vector<Token> tokenize( const char* src, std::size_t srcsize) const
 	{
 		std::vector<Token> rt;
+		tokenizeInto( src, srcsize, rt);
+		return rt;
+	}
+
+	virtual void tokenizeInto( const char* src, std::size_t srcsize, std::vector<Token>& rt) const
+	{
+		rt.clear();
 		int pos = 0;
 		int ordpos = 0;
 		SourceSpan item;
@@ -153,7 +167,6 @@ public:
 		{
 			rt.push_back( Token( ++ordpos, analyzer::Position( 0/*seg*/, item.pos), item.len));
 		}
-		return rt;
 	}
 
 	virtual bool concatBeforeTokenize() const
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Read only memory mapping of a file for sequential processing
+#include "private/mappedFile.hpp"
+#include "private/internationalization.hpp"
+#include "strus/base/fileio.hpp"
+#include <cstring>
+#include <cerrno>
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace strus;
+using namespace strus::utils;
+
+#if !defined(_WIN32)
+void MappedFile::open( const std::string& path)
+{
+	close();
+	int fd = ::open( path.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		throw strus::runtime_error( _TXT("failed to open file '%s' for mapping: %s"), path.c_str(), ::strerror( errno));
+	}
+	struct stat st;
+	if (0!=::fstat( fd, &st))
+	{
+		int ec = errno;
+		::close( fd);
+		throw strus::runtime_error( _TXT("failed to get size of file '%s' for mapping: %s"), path.c_str(), ::strerror( ec));
+	}
+	if (st.st_size == 0)
+	{
+		// ... empty files cannot be mapped
+		::close( fd);
+		m_ptr = "";
+		m_size = 0;
+		return;
+	}
+	void* addr = ::mmap( 0, (std::size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	int ec = errno;
+	::close( fd);
+	if (addr == MAP_FAILED)
+	{
+		throw strus::runtime_error( _TXT("failed to map file '%s': %s"), path.c_str(), ::strerror( ec));
+	}
+	// ... the input is read once from start to end, a failing advice is no error
+	(void)::madvise( addr, (std::size_t)st.st_size, MADV_SEQUENTIAL);
+	m_ptr = (const char*)addr;
+	m_size = (std::size_t)st.st_size;
+	m_mapped = true;
+}
+
+void MappedFile::close()
+{
+	if (m_mapped)
+	{
+		::munmap( const_cast<char*>( m_ptr), m_size);
+		m_mapped = false;
+	}
+	m_buf.clear();
+	m_ptr = 0;
+	m_size = 0;
+}
+
+#else
+void MappedFile::open( const std::string& path)
+{
+	close();
+	int ec = strus::readFile( path, m_buf);
+	if (ec)
+	{
+		throw strus::runtime_error( _TXT("failed to read file '%s': %s"), path.c_str(), ::strerror( ec));
+	}
+	m_ptr = m_buf.c_str();
+	m_size = m_buf.size();
+}
+
+void MappedFile::close()
+{
+	m_buf.clear();
+	m_ptr = 0;
+	m_size = 0;
+}
+#endif
+
@@ -0,0 +1,426 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Test of the aggregated meta data accumulated in one pass over the search index terms against the evaluation on the complete document
+/// \file testAggregation.cpp
+#include "strus/lib/analyzer_objbuild.hpp"
+#include "strus/lib/error.hpp"
+#include "strus/lib/filelocator.hpp"
+#include "strus/errorBufferInterface.hpp"
+#include "strus/fileLocatorInterface.hpp"
+#include "strus/segmenterInterface.hpp"
+#include "strus/documentAnalyzerInstanceInterface.hpp"
+#include "strus/documentAnalyzerContextInterface.hpp"
+#include "strus/documentSinkInterface.hpp"
+#include "strus/analyzer/documentClass.hpp"
+#include "strus/analyzer/document.hpp"
+#include "strus/textProcessorInterface.hpp"
+#include "strus/normalizerFunctionInterface.hpp"
+#include "strus/normalizerFunctionInstanceInterface.hpp"
+#include "strus/tokenizerFunctionInterface.hpp"
+#include "strus/tokenizerFunctionInstanceInterface.hpp"
+#include "strus/aggregatorFunctionInterface.hpp"
+#include "strus/aggregatorFunctionInstanceInterface.hpp"
+#include "strus/aggregatorAccumulatorInterface.hpp"
+#include "strus/analyzerObjectBuilderInterface.hpp"
+#include "strus/analyzer/featureOptions.hpp"
+#include "strus/base/local_ptr.hpp"
+#include "strus/base/pseudoRandom.hpp"
+#include <string>
+#include <vector>
+#include <cstring>
+#include <stdexcept>
+#include <iostream>
+#include <sstream>
+
+static strus::ErrorBufferInterface* g_errorhnd = 0;
+static strus::FileLocatorInterface* g_fileLocator = 0;
+static strus::PseudoRandom g_random;
+
+static void printUsage( int argc, const char* argv[])
+{
+	std::cerr << "usage: " << argv[0] << " <nofDocs>" << std::endl;
+	std::cerr << "<nofDocs> = number of random documents to test" << std::endl;
+}
+
+/// \brief Aggregator definition "<function> <arg1> <arg2> ...", functions marked with evaluated have no accumulator
+struct AggregatorDef
+{
+	const char* name;
+	const char* function;
+	bool evaluated;
+};
+
+static const AggregatorDef g_aggregators[] = {
+	{"tfword", "sumsquaretf word", false},
+	{"tforig", "sumsquaretf orig", false},
+	{"tfnone", "sumsquaretf none", false},
+	{"types", "typeset word orig none", false},
+	{"values", "valueset word w1 w3 w7 w11", false},
+	{"valuesorig", "valueset orig W2 w2", false},
+	{"doclen", "count word", true},
+	{0,0,false}
+};
+
+static std::vector<std::string> splitArgs( const char* def)
+{
+	std::vector<std::string> rt;
+	char const* si = def;
+	char const* sn = std::strchr( si, ' ');
+	for (; sn; si=sn+1,sn=std::strchr( si, ' '))
+	{
+		rt.push_back( std::string( si, sn-si));
+	}
+	rt.push_back( si);
+	return rt;
+}
+
+static strus::AggregatorFunctionInstanceInterface* createAggregator( const strus::TextProcessorInterface* textproc, const char* def)
+{
+	std::vector<std::string> args = splitArgs( def);
+	const strus::AggregatorFunctionInterface* func = textproc->getAggregator( args[0]);
+	if (!func) throw std::runtime_error( std::string("unknown aggregator function: ") + args[0]);
+	strus::AggregatorFunctionInstanceInterface* rt = func->createInstance( std::vector<std::string>( args.begin()+1, args.end()));
+	if (!rt) throw std::runtime_error( std::string("failed to create aggregator: ") + def);
+	return rt;
+}
+
+static std::string randomWord()
+{
+	std::ostringstream out;
+	out << (g_random.get( 0, 4) == 0 ? "W" : "w") << g_random.get( 0, 12);
+	return out.str();
+}
+
+/// \brief Create a document with search index terms of the types 'word' and 'orig' with random values
+static strus::analyzer::Document createRandomDocument()
+{
+	strus::analyzer::Document rt;
+	unsigned int ti = 0, te = g_random.get( 0, 60);
+	for (; ti < te; ++ti)
+	{
+		rt.addSearchIndexTerm( g_random.get( 0, 3) == 0 ? "orig" : "word", randomWord(), ti+1);
+	}
+	return rt;
+}
+
+static bool isEqualValue( const strus::NumericVariant& a, const strus::NumericVariant& b)
+{
+	return a.tostring( 6) == b.tostring( 6);
+}
+
+/// \brief Compare the result of accumulators, reused for all documents, with the result of the evaluation of the aggregator functions on a document
+static void testAccumulators( const strus::TextProcessorInterface* textproc, unsigned int nofDocs)
+{
+	std::vector<strus::AggregatorFunctionInstanceInterface*> funcs;
+	std::vector<strus::AggregatorAccumulatorInterface*> accus;
+	std::vector<std::vector<std::string> > accuTypes;
+	try
+	{
+		AggregatorDef const* gi = g_aggregators;
+		for (; gi->name; ++gi)
+		{
+			funcs.push_back( createAggregator( textproc, gi->function));
+			accus.push_back( funcs.back()->createAccumulator());
+			if (!accus.back() != gi->evaluated)
+			{
+				if (g_errorhnd->hasError()) throw std::runtime_error( g_errorhnd->fetchError());
+				throw std::runtime_error( std::string("accumulator of aggregator '") + gi->function + "' not as expected");
+			}
+			accuTypes.push_back( accus.back() ? accus.back()->featureTypes() : std::vector<std::string>());
+		}
+		unsigned int di = 0;
+		for (; di < nofDocs; ++di)
+		{
+			strus::analyzer::Document doc = createRandomDocument();
+			std::size_t ai = 0, ae = funcs.size();
+			for (; ai != ae; ++ai)
+			{
+				if (!accus[ ai]) continue;
+				accus[ ai]->clear();
+				std::vector<strus::analyzer::DocumentTerm>::const_iterator
+					ti = doc.searchIndexTerms().begin(), te = doc.searchIndexTerms().end();
+				for (; ti != te; ++ti)
+				{
+					std::vector<std::string>::const_iterator
+						xi = accuTypes[ ai].begin(), xe = accuTypes[ ai].end();
+					for (int typeidx=0; xi != xe; ++xi,++typeidx)
+					{
+						if (*xi == ti->type())
+						{
+							accus[ ai]->add( typeidx, ti->value().c_str(), ti->value().size());
+						}
+					}
+				}
+				strus::NumericVariant accumulated = accus[ ai]->result();
+				strus::NumericVariant evaluated = funcs[ ai]->evaluate( doc);
+				if (g_errorhnd->hasError()) throw std::runtime_error( g_errorhnd->fetchError());
+				if (!isEqualValue( accumulated, evaluated))
+				{
+					std::ostringstream msg;
+					msg << "document " << di << ": accumulated value " << accumulated.tostring( 6)
+						<< " of aggregator '" << g_aggregators[ ai].function << "' differs from evaluated " << evaluated.tostring( 6);
+					throw std::runtime_error( msg.str());
+				}
+			}
+		}
+	}
+	catch (...)
+	{
+		std::vector<strus::AggregatorAccumulatorInterface*>::const_iterator ci = accus.begin(), ce = accus.end();
+		for (; ci != ce; ++ci) delete *ci;
+		std::vector<strus::AggregatorFunctionInstanceInterface*>::const_iterator fi = funcs.begin(), fe = funcs.end();
+		for (; fi != fe; ++fi) delete *fi;
+		throw;
+	}
+	std::vector<strus::AggregatorAccumulatorInterface*>::const_iterator ci = accus.begin(), ce = accus.end();
+	for (; ci != ce; ++ci) delete *ci;
+	std::vector<strus::AggregatorFunctionInstanceInterface*>::const_iterator fi = funcs.begin(), fe = funcs.end();
+	for (; fi != fe; ++fi) delete *fi;
+}
+
+static void defineFeature( strus::DocumentAnalyzerInstanceInterface* analyzer, const strus::TextProcessorInterface* textproc, const char* name, const char* normalizer, const char* path)
+{
+	const strus::TokenizerFunctionInterface* tk = textproc->getTokenizer( "word");
+	if (!tk) throw std::runtime_error( "unknown tokenizer: 'word'");
+	strus::local_ptr<strus::TokenizerFunctionInstanceInterface> tki( tk->createInstance( std::vector<std::string>(), textproc));
+	const strus::NormalizerFunctionInterface* nm = textproc->getNormalizer( normalizer);
+	if (!nm) throw std::runtime_error( std::string("unknown normalizer: '") + normalizer + "'");
+	strus::local_ptr<strus::NormalizerFunctionInstanceInterface> nmi( nm->createInstance( std::vector<std::string>(), textproc));
+	if (!tki.get() || !nmi.get()) throw std::runtime_error( "failed to create feature functions");
+	std::vector<strus::NormalizerFunctionInstanceInterface*> normalizers( 1, nmi.release());
+	analyzer->addSearchIndexFeature( name, path, tki.release(), normalizers, 0/*priority*/, strus::analyzer::FeatureOptions());
+}
+
+/// \brief Create a content with sub documents with random words in the text selected by the features 'word' and 'orig'
+static std::string createRandomContent( unsigned int nofDocs)
+{
+	std::ostringstream content;
+	content << "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n<list>";
+	unsigned int di = 0;
+	for (; di < nofDocs; ++di)
+	{
+		content << "<doc><text>";
+		unsigned int wi = 0, we = g_random.get( 0, 40);
+		for (; wi < we; ++wi)
+		{
+			content << " " << randomWord();
+		}
+		content << "</text><orig>";
+		for (wi = 0, we = g_random.get( 0, 10); wi < we; ++wi)
+		{
+			content << " " << randomWord();
+		}
+		content << "</orig></doc>";
+	}
+	content << "</list>";
+	return content.str();
+}
+
+/// \brief Document sink collecting the search index terms and the meta data of the documents
+class TestDocumentSink
+	:public strus::DocumentSinkInterface
+{
+public:
+	TestDocumentSink()
+		:m_docs(){}
+	virtual ~TestDocumentSink(){}
+
+	virtual void startDocument( const char*, std::size_t)
+	{
+		m_docs.push_back( strus::analyzer::Document());
+	}
+	virtual void addSearchIndexTerm( const char* type, std::size_t typesize, const char* value, std::size_t valuesize, unsigned int pos)
+	{
+		m_docs.back().addSearchIndexTerm( std::string( type, typesize), std::string( value, valuesize), pos);
+	}
+	virtual void addForwardIndexTerm( const char*, std::size_t, const char*, std::size_t, unsigned int){}
+	virtual void setMetaData( const char* name, std::size_t namesize, const strus::NumericVariant& value)
+	{
+		m_docs.back().setMetaData( std::string( name, namesize), value);
+	}
+	virtual void setAttribute( const char*, std::size_t, const char*, std::size_t){}
+	virtual void addAccess( const char*, std::size_t){}
+	virtual void addSearchIndexStructure( const char*, std::size_t, const strus::analyzer::DocumentStructure::PositionRange&, const strus::analyzer::DocumentStructure::PositionRange&){}
+	virtual void endDocument(){}
+
+	const std::vector<strus::analyzer::Document>& documents() const
+	{
+		return m_docs;
+	}
+
+private:
+	std::vector<strus::analyzer::Document> m_docs;
+};
+
+static const strus::analyzer::DocumentMetaData* findMetaData( const strus::analyzer::Document& doc, const std::string& name)
+{
+	std::vector<strus::analyzer::DocumentMetaData>::const_iterator mi = doc.metadata().begin(), me = doc.metadata().end();
+	for (; mi != me; ++mi)
+	{
+		if (mi->name() == name) return &*mi;
+	}
+	return 0;
+}
+
+static void checkAggregatedMetaData( const std::vector<strus::analyzer::Document>& docs, const std::vector<strus::AggregatorFunctionInstanceInterface*>& funcs, const std::vector<const char*>& names, const char* method)
+{
+	std::vector<strus::analyzer::Document>::const_iterator di = docs.begin(), de = docs.end();
+	for (int docidx=0; di != de; ++di,++docidx)
+	{
+		std::size_t ai = 0, ae = funcs.size();
+		for (; ai != ae; ++ai)
+		{
+			const strus::analyzer::DocumentMetaData* md = findMetaData( *di, names[ ai]);
+			if (!md) throw std::runtime_error( std::string("aggregated meta data '") + names[ ai] + "' missing in document analyzed with " + method);
+			strus::NumericVariant evaluated = funcs[ ai]->evaluate( *di);
+			if (!isEqualValue( md->value(), evaluated))
+			{
+				std::ostringstream msg;
+				msg << "document " << docidx << " analyzed with " << method << ": aggregated meta data '" << names[ ai] << "' "
+					<< md->value().tostring( 6) << " differs from evaluated " << evaluated.tostring( 6);
+				throw std::runtime_error( msg.str());
+			}
+		}
+	}
+}
+
+/// \brief Compare the aggregated meta data of documents analyzed with the evaluation of the aggregator functions on the documents
+/// \param[in] withEvaluated true, if an aggregator without accumulator is defined, evaluated on the complete document by the analyzer
+static void testAnalyzer( const strus::AnalyzerObjectBuilderInterface* objbuild, bool withEvaluated, unsigned int nofDocs)
+{
+	const strus::TextProcessorInterface* textproc = objbuild->getTextProcessor();
+	const strus::SegmenterInterface* segmenter = textproc->getSegmenterByName( "textwolf");
+	strus::local_ptr<strus::DocumentAnalyzerInstanceInterface> analyzer( objbuild->createDocumentAnalyzer( segmenter));
+	if (!analyzer.get()) throw std::runtime_error("failed to create document analyzer");
+	analyzer->defineSubDocument( "doc", "/list/doc");
+	defineFeature( analyzer.get(), textproc, "word", "lc", "/list/doc/text()");
+	defineFeature( analyzer.get(), textproc, "orig", "orig", "/list/doc/orig()");
+
+	std::vector<strus::AggregatorFunctionInstanceInterface*> funcs;
+	std::vector<const char*> names;
+	try
+	{
+		AggregatorDef const* gi = g_aggregators;
+		for (; gi->name; ++gi)
+		{
+			if (gi->evaluated && !withEvaluated) continue;
+			analyzer->defineAggregatedMetaData( gi->name, createAggregator( textproc, gi->function));
+			funcs.push_back( createAggregator( textproc, gi->function));
+			names.push_back( gi->name);
+		}
+		if (g_errorhnd->hasError()) throw std::runtime_error( g_errorhnd->fetchError());
+
+		strus::analyzer::DocumentClass dclass( "application/xml", "UTF-8");
+		std::string content = createRandomContent( nofDocs);
+
+		strus::local_ptr<strus::DocumentAnalyzerContextInterface> context( analyzer->createContext( dclass));
+		if (!context.get()) throw std::runtime_error("failed to create document analyzer context");
+		context->putInput( content.c_str(), content.size(), true);
+		std::vector<strus::analyzer::Document> docs;
+		strus::analyzer::Document doc;
+		while (context->analyzeNext( doc))
+		{
+			docs.push_back( doc);
+		}
+		if (g_errorhnd->hasError()) throw std::runtime_error( g_errorhnd->fetchError());
+		if (docs.size() != nofDocs) throw std::runtime_error( "number of documents analyzed not as expected");
+		checkAggregatedMetaData( docs, funcs, names, "analyzeNext(Document)");
+
+		TestDocumentSink sink;
+		strus::local_ptr<strus::DocumentAnalyzerContextInterface> sinkContext( analyzer->createContext( dclass));
+		if (!sinkContext.get()) throw std::runtime_error("failed to create document analyzer context");
+		sinkContext->putInput( content.c_str(), content.size(), true);
+		while (sinkContext->analyzeNext( sink)){}
+		if (g_errorhnd->hasError()) throw std::runtime_error( g_errorhnd->fetchError());
+		if (sink.documents().size() != nofDocs) throw std::runtime_error( "number of documents passed to sink not as expected");
+		checkAggregatedMetaData( sink.documents(), funcs, names, "analyzeNext(DocumentSinkInterface)");
+	}
+	catch (...)
+	{
+		std::vector<strus::AggregatorFunctionInstanceInterface*>::const_iterator fi = funcs.begin(), fe = funcs.end();
+		for (; fi != fe; ++fi) delete *fi;
+		throw;
+	}
+	std::vector<strus::AggregatorFunctionInstanceInterface*>::const_iterator fi = funcs.begin(), fe = funcs.end();
+	for (; fi != fe; ++fi) delete *fi;
+}
+
+static unsigned int getUintValue( const char* arg)
+{
+	unsigned int rt = 0, prev = 0;
+	char const* cc = arg;
+	for (; *cc; ++cc)
+	{
+		if (*cc < '0' || *cc > '9') throw std::runtime_error( std::string( "parameter is not a non negative integer number: ") + arg);
+		rt = (rt * 10) + (*cc - '0');
+		if (rt < prev) throw std::runtime_error( std::string( "parameter out of range: ") + arg);
+		prev = rt;
+	}
+	return rt;
+}
+
+int main( int argc, const char* argv[])
+{
+	int rt = 0;
+	if (argc <= 1 || std::strcmp( argv[1], "-h") == 0 || std::strcmp( argv[1], "--help") == 0)
+	{
+		printUsage( argc, argv);
+		return 0;
+	}
+	else if (argc > 2)
+	{
+		std::cerr << "ERROR too many parameters" << std::endl;
+		printUsage( argc, argv);
+		return 1;
+	}
+	try
+	{
+		g_errorhnd = strus::createErrorBuffer_standard( 0, 2, NULL);
+		if (!g_errorhnd) throw std::runtime_error("failed to create error buffer object");
+		g_fileLocator = strus::createFileLocator_std( g_errorhnd);
+		if (!g_fileLocator) throw std::runtime_error("failed to create file locator");
+
+		unsigned int nofDocs = getUintValue( argv[1]);
+		strus::local_ptr<strus::AnalyzerObjectBuilderInterface> objbuild(
+			strus::createAnalyzerObjectBuilder_default( g_fileLocator, g_errorhnd));
+		if (!objbuild.get()) throw std::runtime_error("failed to create analyzer object builder");
+
+		testAccumulators( objbuild->getTextProcessor(), nofDocs);
+		// ... all aggregators accumulated while the terms are passed to the sink:
+		testAnalyzer( objbuild.get(), false/*withEvaluated*/, nofDocs);
+		// ... aggregators evaluated on the complete document mixed with aggregators accumulated:
+		testAnalyzer( objbuild.get(), true/*withEvaluated*/, nofDocs);
+		std::cerr << "OK" << std::endl;
+		rt = 0;
+	}
+	catch (const std::bad_alloc&)
+	{
+		std::cerr << "ERROR memory allocation error" << std::endl;
+		rt = 2;
+	}
+	catch (const std::runtime_error& e)
+	{
+		std::cerr << "ERROR " << e.what() << std::endl;
+		rt = 1;
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "EXCEPTION " << e.what() << std::endl;
+		rt = 1;
+	}
+	if (g_fileLocator)
+	{
+		delete g_fileLocator;
+	}
+	if (g_errorhnd)
+	{
+		delete g_errorhnd;
+	}
+	return rt;
+}
+
@@ -0,0 +1,260 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Test of the parallel analysis of a list of documents, checking the order of the results and the delivery of errors
+/// \file testAnalyzeBatch.cpp
+#include "strus/lib/analyzer_objbuild.hpp"
+#include "strus/lib/error.hpp"
+#include "strus/lib/filelocator.hpp"
+#include "strus/errorBufferInterface.hpp"
+#include "strus/fileLocatorInterface.hpp"
+#include "strus/segmenterInterface.hpp"
+#include "strus/documentAnalyzerInstanceInterface.hpp"
+#include "strus/analyzer/documentClass.hpp"
+#include "strus/analyzer/document.hpp"
+#include "strus/textProcessorInterface.hpp"
+#include "strus/normalizerFunctionInterface.hpp"
+#include "strus/normalizerFunctionInstanceInterface.hpp"
+#include "strus/tokenizerFunctionInterface.hpp"
+#include "strus/tokenizerFunctionInstanceInterface.hpp"
+#include "strus/analyzerObjectBuilderInterface.hpp"
+#include "strus/base/local_ptr.hpp"
+#include "strus/analyzer/featureOptions.hpp"
+#include <string>
+#include <vector>
+#include <cstring>
+#include <stdexcept>
+#include <iostream>
+#include <sstream>
+
+static strus::ErrorBufferInterface* g_errorhnd = 0;
+static strus::FileLocatorInterface* g_fileLocator = 0;
+
+#define MAX_NOF_THREADS 8
+
+static void printUsage( int argc, const char* argv[])
+{
+	std::cerr << "usage: " << argv[0] << " <nofInputs>" << std::endl;
+	std::cerr << "<nofInputs> = number of input documents of the batch" << std::endl;
+}
+
+static void defineFeature( strus::DocumentAnalyzerInstanceInterface* analyzer, const strus::TextProcessorInterface* textproc, bool isAttribute, const char* name, const char* tokenizer, const char* path)
+{
+	const strus::TokenizerFunctionInterface* tk = textproc->getTokenizer( tokenizer);
+	if (!tk) throw std::runtime_error( std::string("unknown tokenizer: '") + tokenizer + "'");
+	strus::local_ptr<strus::TokenizerFunctionInstanceInterface> tki( tk->createInstance( std::vector<std::string>(), textproc));
+	const strus::NormalizerFunctionInterface* nm = textproc->getNormalizer( "orig");
+	if (!nm) throw std::runtime_error( "unknown normalizer: 'orig'");
+	strus::local_ptr<strus::NormalizerFunctionInstanceInterface> nmi( nm->createInstance( std::vector<std::string>(), textproc));
+	if (!tki.get() || !nmi.get()) throw std::runtime_error( "failed to create feature functions");
+	std::vector<strus::NormalizerFunctionInstanceInterface*> normalizers( 1, nmi.release());
+	if (isAttribute)
+	{
+		analyzer->defineAttribute( name, path, tki.release(), normalizers);
+	}
+	else
+	{
+		analyzer->addSearchIndexFeature( name, path, tki.release(), normalizers, 0/*priority*/, strus::analyzer::FeatureOptions());
+	}
+}
+
+/// \brief Create the input documents, every input with (inputidx % 3 + 1) sub documents.
+///	Every 13th input has an invalid encoding and fails, every 50th input is big and slow to analyze.
+static std::vector<strus::DocumentAnalyzerInstanceInterface::Input> createInputs( unsigned int nofInputs)
+{
+	std::vector<strus::DocumentAnalyzerInstanceInterface::Input> rt;
+	unsigned int ii = 0;
+	for (; ii < nofInputs; ++ii)
+	{
+		std::ostringstream content;
+		content << "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n<list>";
+		unsigned int di = 0, de = ii % 3 + 1;
+		for (; di < de; ++di)
+		{
+			content << "<doc><title>input " << ii << " document " << di << "</title><text>";
+			unsigned int wi = 0, we = (ii % 50 == 7) ? 100000 : (ii % 17) * 20;
+			for (; wi < we; ++wi)
+			{
+				content << " word" << (wi % 31);
+			}
+			content << "</text></doc>";
+		}
+		content << "</list>";
+		const char* encoding = (ii % 13 == 5) ? "ISO-8859-X" : "UTF-8";
+		rt.push_back( strus::DocumentAnalyzerInstanceInterface::Input( content.str(), strus::analyzer::DocumentClass( "application/xml", encoding)));
+	}
+	return rt;
+}
+
+/// \brief Callback writing the results to a list of strings and checking that the results are delivered in the order of the inputs
+class TestCallback
+	:public strus::DocumentAnalyzerInstanceInterface::Callback
+{
+public:
+	TestCallback()
+		:m_results(),m_lastInputIdx(0),m_nofErrors(0){}
+	virtual ~TestCallback(){}
+
+	virtual void document( std::size_t inputidx, const strus::analyzer::Document& doc)
+	{
+		checkOrder( inputidx);
+		std::ostringstream out;
+		out << "[" << inputidx << "] DOC " << doc.subDocumentTypeName();
+		std::vector<strus::analyzer::DocumentAttribute>::const_iterator
+			ai = doc.attributes().begin(), ae = doc.attributes().end();
+		for (; ai != ae; ++ai)
+		{
+			out << " " << ai->name() << "='" << ai->value() << "'";
+		}
+		std::vector<strus::analyzer::DocumentTerm>::const_iterator
+			ti = doc.searchIndexTerms().begin(), te = doc.searchIndexTerms().end();
+		unsigned int possum = 0;
+		for (; ti != te; ++ti)
+		{
+			possum += ti->pos();
+		}
+		out << " terms " << doc.searchIndexTerms().size() << " possum " << possum;
+		m_results.push_back( out.str());
+	}
+
+	virtual void error( std::size_t inputidx, const char* msg)
+	{
+		checkOrder( inputidx);
+		std::ostringstream out;
+		out << "[" << inputidx << "] ERROR";
+		m_results.push_back( out.str());
+		++m_nofErrors;
+	}
+
+	const std::vector<std::string>& results() const		{return m_results;}
+	unsigned int nofErrors() const				{return m_nofErrors;}
+
+private:
+	void checkOrder( std::size_t inputidx)
+	{
+		if (inputidx < m_lastInputIdx) throw std::runtime_error( "results not delivered in the order of the inputs");
+		m_lastInputIdx = inputidx;
+	}
+
+private:
+	std::vector<std::string> m_results;
+	std::size_t m_lastInputIdx;
+	unsigned int m_nofErrors;
+};
+
+static unsigned int getUintValue( const char* arg)
+{
+	unsigned int rt = 0, prev = 0;
+	char const* cc = arg;
+	for (; *cc; ++cc)
+	{
+		if (*cc < '0' || *cc > '9') throw std::runtime_error( std::string( "parameter is not a non negative integer number: ") + arg);
+		rt = (rt * 10) + (*cc - '0');
+		if (rt < prev) throw std::runtime_error( std::string( "parameter out of range: ") + arg);
+		prev = rt;
+	}
+	return rt;
+}
+
+int main( int argc, const char* argv[])
+{
+	int rt = 0;
+	if (argc <= 1 || std::strcmp( argv[1], "-h") == 0 || std::strcmp( argv[1], "--help") == 0)
+	{
+		printUsage( argc, argv);
+		return 0;
+	}
+	else if (argc > 2)
+	{
+		std::cerr << "ERROR too many parameters" << std::endl;
+		printUsage( argc, argv);
+		return 1;
+	}
+	try
+	{
+		g_errorhnd = strus::createErrorBuffer_standard( 0, MAX_NOF_THREADS+1, NULL);
+		if (!g_errorhnd) throw std::runtime_error("failed to create error buffer object");
+		g_fileLocator = strus::createFileLocator_std( g_errorhnd);
+		if (!g_fileLocator) throw std::runtime_error("failed to create file locator");
+
+		unsigned int nofInputs = getUintValue( argv[1]);
+		strus::local_ptr<strus::AnalyzerObjectBuilderInterface> objbuild(
+			strus::createAnalyzerObjectBuilder_default( g_fileLocator, g_errorhnd));
+		if (!objbuild.get()) throw std::runtime_error("failed to create analyzer object builder");
+		const strus::TextProcessorInterface* textproc = objbuild->getTextProcessor();
+		const strus::SegmenterInterface* segmenter = textproc->getSegmenterByName( "textwolf");
+		strus::local_ptr<strus::DocumentAnalyzerInstanceInterface> analyzer( objbuild->createDocumentAnalyzer( segmenter));
+		if (!analyzer.get()) throw std::runtime_error("failed to create document analyzer");
+		analyzer->defineSubDocument( "doc", "/list/doc");
+		defineFeature( analyzer.get(), textproc, true/*attribute*/, "title", "content", "/list/doc/title()");
+		defineFeature( analyzer.get(), textproc, false/*search index*/, "word", "word", "/list/doc/text()");
+
+		std::vector<strus::DocumentAnalyzerInstanceInterface::Input> inputs = createInputs( nofInputs);
+		std::vector<std::string> expected;
+		unsigned int expectedNofErrors = 0;
+		unsigned int nofThreadsAr[] = {1,2,3,MAX_NOF_THREADS,0};
+		for (unsigned int ti=0; nofThreadsAr[ ti]; ++ti)
+		{
+			unsigned int nofThreads = nofThreadsAr[ ti];
+			TestCallback callback;
+			if (!analyzer->analyzeBatch( inputs, nofThreads, callback))
+			{
+				throw std::runtime_error( g_errorhnd->fetchError());
+			}
+			if (ti == 0)
+			{
+				expected = callback.results();
+				expectedNofErrors = callback.nofErrors();
+				if (expectedNofErrors != (nofInputs + 7) / 13)
+				{
+					throw std::runtime_error( "number of errors delivered not as expected");
+				}
+			}
+			else if (callback.results() != expected || callback.nofErrors() != expectedNofErrors)
+			{
+				std::vector<std::string>::const_iterator ri = callback.results().begin(), re = callback.results().end();
+				std::vector<std::string>::const_iterator ei = expected.begin(), ee = expected.end();
+				for (; ri != re && ei != ee && *ri == *ei; ++ri,++ei){}
+				std::cerr << "first difference with " << nofThreads << " threads:" << std::endl
+						<< "EXPECTED " << (ei == ee ? std::string("<end>") : *ei) << std::endl
+						<< "GOT " << (ri == re ? std::string("<end>") : *ri) << std::endl;
+				throw std::runtime_error( "results of batch analysis with multiple threads differ from sequential analysis");
+			}
+			if (g_errorhnd->hasError())
+			{
+				throw std::runtime_error( g_errorhnd->fetchError());
+			}
+		}
+		std::cerr << "OK" << std::endl;
+		rt = 0;
+	}
+	catch (const std::bad_alloc&)
+	{
+		std::cerr << "ERROR memory allocation error" << std::endl;
+		rt = 2;
+	}
+	catch (const std::runtime_error& e)
+	{
+		std::cerr << "ERROR " << e.what() << std::endl;
+		rt = 1;
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "EXCEPTION " << e.what() << std::endl;
+		rt = 1;
+	}
+	if (g_fileLocator)
+	{
+		delete g_fileLocator;
+	}
+	if (g_errorhnd)
+	{
+		delete g_errorhnd;
+	}
+	return rt;
+}
+
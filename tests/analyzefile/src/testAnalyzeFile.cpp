@@ -0,0 +1,246 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Test of the analysis of files with analyzeFile, checking the results and that no file stays mapped after the call, on success as on failure
+/// \file testAnalyzeFile.cpp
+#include "strus/lib/analyzer_objbuild.hpp"
+#include "strus/lib/error.hpp"
+#include "strus/lib/filelocator.hpp"
+#include "strus/errorBufferInterface.hpp"
+#include "strus/fileLocatorInterface.hpp"
+#include "strus/segmenterInterface.hpp"
+#include "strus/documentAnalyzerInstanceInterface.hpp"
+#include "strus/analyzer/documentClass.hpp"
+#include "strus/analyzer/document.hpp"
+#include "strus/textProcessorInterface.hpp"
+#include "strus/normalizerFunctionInterface.hpp"
+#include "strus/normalizerFunctionInstanceInterface.hpp"
+#include "strus/tokenizerFunctionInterface.hpp"
+#include "strus/tokenizerFunctionInstanceInterface.hpp"
+#include "strus/analyzerObjectBuilderInterface.hpp"
+#include "strus/base/local_ptr.hpp"
+#include "strus/base/fileio.hpp"
+#include "strus/analyzer/featureOptions.hpp"
+#include <string>
+#include <vector>
+#include <cstring>
+#include <cstdio>
+#include <stdexcept>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+
+static strus::ErrorBufferInterface* g_errorhnd = 0;
+static strus::FileLocatorInterface* g_fileLocator = 0;
+
+static void printUsage( int argc, const char* argv[])
+{
+	std::cerr << "usage: " << argv[0] << " <nofFiles>" << std::endl;
+	std::cerr << "<nofFiles> = number of files analyzed, more than the number of contexts kept in the pool of the analyzer" << std::endl;
+}
+
+static void defineFeature( strus::DocumentAnalyzerInstanceInterface* analyzer, const strus::TextProcessorInterface* textproc, bool isAttribute, const char* name, const char* tokenizer, const char* path)
+{
+	const strus::TokenizerFunctionInterface* tk = textproc->getTokenizer( tokenizer);
+	if (!tk) throw std::runtime_error( std::string("unknown tokenizer: '") + tokenizer + "'");
+	strus::local_ptr<strus::TokenizerFunctionInstanceInterface> tki( tk->createInstance( std::vector<std::string>(), textproc));
+	const strus::NormalizerFunctionInterface* nm = textproc->getNormalizer( "orig");
+	if (!nm) throw std::runtime_error( "unknown normalizer: 'orig'");
+	strus::local_ptr<strus::NormalizerFunctionInstanceInterface> nmi( nm->createInstance( std::vector<std::string>(), textproc));
+	if (!tki.get() || !nmi.get()) throw std::runtime_error( "failed to create feature functions");
+	std::vector<strus::NormalizerFunctionInstanceInterface*> normalizers( 1, nmi.release());
+	if (isAttribute)
+	{
+		analyzer->defineAttribute( name, path, tki.release(), normalizers);
+	}
+	else
+	{
+		analyzer->addSearchIndexFeature( name, path, tki.release(), normalizers, 0/*priority*/, strus::analyzer::FeatureOptions());
+	}
+}
+
+static std::string documentString( const strus::analyzer::Document& doc)
+{
+	std::ostringstream out;
+	out << "DOC";
+	std::vector<strus::analyzer::DocumentAttribute>::const_iterator
+		ai = doc.attributes().begin(), ae = doc.attributes().end();
+	for (; ai != ae; ++ai)
+	{
+		out << " " << ai->name() << "='" << ai->value() << "'";
+	}
+	std::vector<strus::analyzer::DocumentTerm>::const_iterator
+		ti = doc.searchIndexTerms().begin(), te = doc.searchIndexTerms().end();
+	for (; ti != te; ++ti)
+	{
+		out << " " << ti->type() << ":" << ti->value() << "@" << ti->pos();
+	}
+	return out.str();
+}
+
+/// \brief Create the content of a file, every 3rd is not valid JSON and fails
+static std::string createContent( unsigned int fileidx)
+{
+	std::ostringstream out;
+	out << "{\"id\":\"" << fileidx << "\",\"text\":\"";
+	unsigned int wi = 0, we = 20 + (fileidx % 7) * 100;
+	for (; wi < we; ++wi)
+	{
+		out << " word" << ((wi + fileidx) % 31);
+	}
+	out << "\"";
+	if (fileidx % 3 != 1)
+	{
+		out << "}";
+	}
+	return out.str();
+}
+
+static std::string fileName( unsigned int fileidx)
+{
+	char buf[ 64];
+	std::snprintf( buf, sizeof(buf), "testAnalyzeFile_%u.json", fileidx);
+	return std::string( buf);
+}
+
+/// \brief Get the lines of the memory mappings of this process referring to a file name
+/// \return false, if the memory mappings of the process cannot be inspected on this platform
+static bool getMappings( std::vector<std::string>& result, const std::string& filename)
+{
+	std::ifstream maps( "/proc/self/maps");
+	if (!maps) return false;
+	std::string line;
+	while (std::getline( maps, line))
+	{
+		if (line.find( filename) != std::string::npos) result.push_back( line);
+	}
+	return true;
+}
+
+static unsigned int getUintValue( const char* arg)
+{
+	unsigned int rt = 0, prev = 0;
+	char const* cc = arg;
+	for (; *cc; ++cc)
+	{
+		if (*cc < '0' || *cc > '9') throw std::runtime_error( std::string( "parameter is not a non negative integer number: ") + arg);
+		rt = (rt * 10) + (*cc - '0');
+		if (rt < prev) throw std::runtime_error( std::string( "parameter out of range: ") + arg);
+		prev = rt;
+	}
+	return rt;
+}
+
+int main( int argc, const char* argv[])
+{
+	int rt = 0;
+	std::vector<std::string> files;
+	if (argc <= 1 || std::strcmp( argv[1], "-h") == 0 || std::strcmp( argv[1], "--help") == 0)
+	{
+		printUsage( argc, argv);
+		return 0;
+	}
+	else if (argc > 2)
+	{
+		std::cerr << "ERROR too many parameters" << std::endl;
+		printUsage( argc, argv);
+		return 1;
+	}
+	try
+	{
+		g_errorhnd = strus::createErrorBuffer_standard( 0, 1, NULL);
+		if (!g_errorhnd) throw std::runtime_error("failed to create error buffer object");
+		g_fileLocator = strus::createFileLocator_std( g_errorhnd);
+		if (!g_fileLocator) throw std::runtime_error("failed to create file locator");
+
+		unsigned int nofFiles = getUintValue( argv[1]);
+		strus::local_ptr<strus::AnalyzerObjectBuilderInterface> objbuild(
+			strus::createAnalyzerObjectBuilder_default( g_fileLocator, g_errorhnd));
+		if (!objbuild.get()) throw std::runtime_error("failed to create analyzer object builder");
+		const strus::TextProcessorInterface* textproc = objbuild->getTextProcessor();
+		const strus::SegmenterInterface* segmenter = textproc->getSegmenterByName( "cjson");
+		if (!segmenter) throw std::runtime_error("unknown segmenter: 'cjson'");
+		strus::local_ptr<strus::DocumentAnalyzerInstanceInterface> analyzer( objbuild->createDocumentAnalyzer( segmenter));
+		if (!analyzer.get()) throw std::runtime_error("failed to create document analyzer");
+		defineFeature( analyzer.get(), textproc, true/*attribute*/, "id", "content", "/id()");
+		defineFeature( analyzer.get(), textproc, false/*search index*/, "word", "word", "/text()");
+		// ... fewer contexts pooled than files analyzed, so that contexts are pooled after success and after failure
+		analyzer->defineContextPool( nofFiles / 2 + 1);
+		if (g_errorhnd->hasError()) throw std::runtime_error( g_errorhnd->fetchError());
+
+		strus::analyzer::DocumentClass dclass( "application/json", "UTF-8");
+		bool checkMappings = true;
+		unsigned int fileidx = 0;
+		for (; fileidx < nofFiles; ++fileidx)
+		{
+			std::string content = createContent( fileidx);
+			std::string filename = fileName( fileidx);
+			int ec = strus::writeFile( filename, content);
+			if (ec) throw std::runtime_error( std::string("error writing file ") + filename + ": " + ::strerror(ec));
+			files.push_back( filename);
+
+			strus::analyzer::Document expectedDoc = analyzer->analyze( content, dclass);
+			bool expectedError = g_errorhnd->hasError();
+			if (expectedError) (void)g_errorhnd->fetchError();
+			if (expectedError != (fileidx % 3 == 1))
+			{
+				throw std::runtime_error( std::string("unexpected result of the analysis of the content of file ") + filename);
+			}
+			strus::analyzer::Document doc = analyzer->analyzeFile( filename, dclass);
+			bool error = g_errorhnd->hasError();
+			if (error) (void)g_errorhnd->fetchError();
+			if (error != expectedError || (!error && documentString( doc) != documentString( expectedDoc)))
+			{
+				std::cerr << "EXPECTED " << (expectedError ? std::string("<error>") : documentString( expectedDoc)) << std::endl;
+				std::cerr << "GOT " << (error ? std::string("<error>") : documentString( doc)) << std::endl;
+				throw std::runtime_error( std::string("result of analyzeFile differs from the analysis of the content of file ") + filename);
+			}
+			std::vector<std::string> mappings;
+			if (checkMappings && !getMappings( mappings, filename))
+			{
+				std::cerr << "memory mappings of the process cannot be inspected, the check for files left mapped is skipped" << std::endl;
+				checkMappings = false;
+			}
+			if (!mappings.empty())
+			{
+				std::cerr << "MAPPING " << mappings[0] << std::endl;
+				throw std::runtime_error( std::string("file still mapped after analyzeFile ") + (error ? "failed: " : "succeeded: ") + filename);
+			}
+		}
+		std::cerr << "OK" << std::endl;
+		rt = 0;
+	}
+	catch (const std::bad_alloc&)
+	{
+		std::cerr << "ERROR memory allocation error" << std::endl;
+		rt = 2;
+	}
+	catch (const std::runtime_error& e)
+	{
+		std::cerr << "ERROR " << e.what() << std::endl;
+		rt = 1;
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "EXCEPTION " << e.what() << std::endl;
+		rt = 1;
+	}
+	std::vector<std::string>::const_iterator fi = files.begin(), fe = files.end();
+	for (; fi != fe; ++fi)
+	{
+		(void)strus::removeFile( *fi, false/*fail_ifnofexist*/);
+	}
+	if (g_fileLocator)
+	{
+		delete g_fileLocator;
+	}
+	if (g_errorhnd)
+	{
+		delete g_errorhnd;
+	}
+	return rt;
+}
@@ -0,0 +1,317 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Test of the analysis of a list of JSON documents with one document per line (NDJSON), checking the order of the results and the delivery of errors
+/// \file testAnalyzeLines.cpp
+#include "strus/lib/analyzer_objbuild.hpp"
+#include "strus/lib/error.hpp"
+#include "strus/lib/filelocator.hpp"
+#include "strus/errorBufferInterface.hpp"
+#include "strus/fileLocatorInterface.hpp"
+#include "strus/segmenterInterface.hpp"
+#include "strus/documentAnalyzerInstanceInterface.hpp"
+#include "strus/documentAnalyzerContextInterface.hpp"
+#include "strus/analyzer/documentClass.hpp"
+#include "strus/analyzer/document.hpp"
+#include "strus/textProcessorInterface.hpp"
+#include "strus/normalizerFunctionInterface.hpp"
+#include "strus/normalizerFunctionInstanceInterface.hpp"
+#include "strus/tokenizerFunctionInterface.hpp"
+#include "strus/tokenizerFunctionInstanceInterface.hpp"
+#include "strus/analyzerObjectBuilderInterface.hpp"
+#include "strus/base/local_ptr.hpp"
+#include "strus/analyzer/featureOptions.hpp"
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <stdexcept>
+#include <iostream>
+#include <sstream>
+
+static strus::ErrorBufferInterface* g_errorhnd = 0;
+static strus::FileLocatorInterface* g_fileLocator = 0;
+
+#define MAX_NOF_THREADS 4
+
+static void printUsage( int argc, const char* argv[])
+{
+	std::cerr << "usage: " << argv[0] << " <nofLines>" << std::endl;
+	std::cerr << "<nofLines> = number of lines of the NDJSON document" << std::endl;
+}
+
+static void defineFeature( strus::DocumentAnalyzerInstanceInterface* analyzer, const strus::TextProcessorInterface* textproc, bool isAttribute, const char* name, const char* tokenizer, const char* path)
+{
+	const strus::TokenizerFunctionInterface* tk = textproc->getTokenizer( tokenizer);
+	if (!tk) throw std::runtime_error( std::string("unknown tokenizer: '") + tokenizer + "'");
+	strus::local_ptr<strus::TokenizerFunctionInstanceInterface> tki( tk->createInstance( std::vector<std::string>(), textproc));
+	const strus::NormalizerFunctionInterface* nm = textproc->getNormalizer( "orig");
+	if (!nm) throw std::runtime_error( "unknown normalizer: 'orig'");
+	strus::local_ptr<strus::NormalizerFunctionInstanceInterface> nmi( nm->createInstance( std::vector<std::string>(), textproc));
+	if (!tki.get() || !nmi.get()) throw std::runtime_error( "failed to create feature functions");
+	std::vector<strus::NormalizerFunctionInstanceInterface*> normalizers( 1, nmi.release());
+	if (isAttribute)
+	{
+		analyzer->defineAttribute( name, path, tki.release(), normalizers);
+	}
+	else
+	{
+		analyzer->addSearchIndexFeature( name, path, tki.release(), normalizers, 0/*priority*/, strus::analyzer::FeatureOptions());
+	}
+}
+
+/// \brief Create the lines of the NDJSON document.
+///	Every 11th line is empty or contains only spaces, every 37th line is not valid JSON and fails.
+///	Every 50th line is long and spans many chunks. The last line has no end of line.
+static std::vector<std::string> createLines( unsigned int nofLines)
+{
+	std::vector<std::string> rt;
+	unsigned int li = 0;
+	for (; li < nofLines; ++li)
+	{
+		if (li % 11 == 4)
+		{
+			rt.push_back( (li % 2) ? std::string( "  \t") : std::string());
+			continue;
+		}
+		std::ostringstream line;
+		line << "{\"id\":\"" << li << "\",\"text\":\"";
+		unsigned int wi = 0, we = (li % 50 == 7) ? 10000 : (li % 13) * 5;
+		for (; wi < we; ++wi)
+		{
+			line << " word" << (wi % 31);
+		}
+		line << "\"";
+		if (li % 37 != 20)
+		{
+			line << "}";
+		}
+		rt.push_back( line.str());
+	}
+	return rt;
+}
+
+static std::string documentString( const strus::analyzer::Document& doc)
+{
+	std::ostringstream out;
+	out << "DOC";
+	std::vector<strus::analyzer::DocumentAttribute>::const_iterator
+		ai = doc.attributes().begin(), ae = doc.attributes().end();
+	for (; ai != ae; ++ai)
+	{
+		out << " " << ai->name() << "='" << ai->value() << "'";
+	}
+	std::vector<strus::analyzer::DocumentTerm>::const_iterator
+		ti = doc.searchIndexTerms().begin(), te = doc.searchIndexTerms().end();
+	unsigned int possum = 0;
+	for (; ti != te; ++ti)
+	{
+		possum += ti->pos();
+	}
+	out << " terms " << doc.searchIndexTerms().size() << " possum " << possum;
+	return out.str();
+}
+
+static std::string errorString( unsigned int lineno)
+{
+	char buf[ 64];
+	std::snprintf( buf, sizeof(buf), "ERROR line %u", lineno);
+	return std::string( buf);
+}
+
+static bool isErrorResult( const std::string& result)
+{
+	return 0==std::strncmp( result.c_str(), "ERROR", 5);
+}
+
+/// \brief Get the expected results by analyzing every non empty line as a JSON document on its own
+static std::vector<std::string> getExpectedResults( const strus::DocumentAnalyzerInstanceInterface* analyzer, const std::vector<std::string>& lines)
+{
+	std::vector<std::string> rt;
+	std::vector<std::string>::const_iterator li = lines.begin(), le = lines.end();
+	for (unsigned int lineno=1; li != le; ++li,++lineno)
+	{
+		if (li->find_first_not_of( " \t") == std::string::npos) continue;
+		strus::analyzer::Document doc = analyzer->analyze( *li, strus::analyzer::DocumentClass( "application/json", "UTF-8"));
+		if (g_errorhnd->hasError())
+		{
+			(void)g_errorhnd->fetchError();
+			rt.push_back( errorString( lineno));
+		}
+		else
+		{
+			rt.push_back( documentString( doc));
+		}
+	}
+	return rt;
+}
+
+/// \brief Fetch the documents analyzed, an error is expected to refer to the line number of the document failing
+static void fetchResults( std::vector<std::string>& results, strus::DocumentAnalyzerContextInterface* context)
+{
+	strus::analyzer::Document doc;
+	for (;;)
+	{
+		if (context->analyzeNext( doc))
+		{
+			results.push_back( documentString( doc));
+		}
+		else if (g_errorhnd->hasError())
+		{
+			std::string msg = g_errorhnd->fetchError();
+			unsigned int lineno = 0;
+			std::size_t pos = msg.find( "line ");
+			if (pos == std::string::npos || 1 != std::sscanf( msg.c_str() + pos + 5, "%u", &lineno))
+			{
+				throw std::runtime_error( std::string( "error without line number: ") + msg);
+			}
+			results.push_back( errorString( lineno));
+		}
+		else
+		{
+			break;
+		}
+	}
+}
+
+/// \brief Feed the NDJSON document in chunks of a size, fetching the documents after every chunk
+static std::vector<std::string> analyzeLines( const strus::DocumentAnalyzerInstanceInterface* analyzer, const std::string& content, std::size_t chunksize)
+{
+	std::vector<std::string> rt;
+	strus::local_ptr<strus::DocumentAnalyzerContextInterface> context( analyzer->createContext( strus::analyzer::DocumentClass( "application/x-ndjson", "UTF-8")));
+	if (!context.get()) throw std::runtime_error( g_errorhnd->fetchError());
+	std::size_t pos = 0;
+	while (pos < content.size())
+	{
+		std::size_t size = std::min( chunksize, content.size() - pos);
+		context->putInput( content.c_str() + pos, size, pos + size == content.size());
+		if (g_errorhnd->hasError()) throw std::runtime_error( g_errorhnd->fetchError());
+		pos += size;
+		fetchResults( rt, context.get());
+	}
+	return rt;
+}
+
+static unsigned int getUintValue( const char* arg)
+{
+	unsigned int rt = 0, prev = 0;
+	char const* cc = arg;
+	for (; *cc; ++cc)
+	{
+		if (*cc < '0' || *cc > '9') throw std::runtime_error( std::string( "parameter is not a non negative integer number: ") + arg);
+		rt = (rt * 10) + (*cc - '0');
+		if (rt < prev) throw std::runtime_error( std::string( "parameter out of range: ") + arg);
+		prev = rt;
+	}
+	return rt;
+}
+
+int main( int argc, const char* argv[])
+{
+	int rt = 0;
+	if (argc <= 1 || std::strcmp( argv[1], "-h") == 0 || std::strcmp( argv[1], "--help") == 0)
+	{
+		printUsage( argc, argv);
+		return 0;
+	}
+	else if (argc > 2)
+	{
+		std::cerr << "ERROR too many parameters" << std::endl;
+		printUsage( argc, argv);
+		return 1;
+	}
+	try
+	{
+		g_errorhnd = strus::createErrorBuffer_standard( 0, MAX_NOF_THREADS+1, NULL);
+		if (!g_errorhnd) throw std::runtime_error("failed to create error buffer object");
+		g_fileLocator = strus::createFileLocator_std( g_errorhnd);
+		if (!g_fileLocator) throw std::runtime_error("failed to create file locator");
+
+		unsigned int nofLines = getUintValue( argv[1]);
+		strus::local_ptr<strus::AnalyzerObjectBuilderInterface> objbuild(
+			strus::createAnalyzerObjectBuilder_default( g_fileLocator, g_errorhnd));
+		if (!objbuild.get()) throw std::runtime_error("failed to create analyzer object builder");
+		const strus::TextProcessorInterface* textproc = objbuild->getTextProcessor();
+		const strus::SegmenterInterface* segmenter = textproc->getSegmenterByName( "cjson");
+		if (!segmenter) throw std::runtime_error("unknown segmenter: 'cjson'");
+		strus::local_ptr<strus::DocumentAnalyzerInstanceInterface> analyzer( objbuild->createDocumentAnalyzer( segmenter));
+		if (!analyzer.get()) throw std::runtime_error("failed to create document analyzer");
+		defineFeature( analyzer.get(), textproc, true/*attribute*/, "id", "content", "/id()");
+		defineFeature( analyzer.get(), textproc, false/*search index*/, "word", "word", "/text()");
+		if (g_errorhnd->hasError()) throw std::runtime_error( g_errorhnd->fetchError());
+
+		std::vector<std::string> lines = createLines( nofLines);
+		std::string content;
+		std::vector<std::string>::const_iterator li = lines.begin(), le = lines.end();
+		for (; li != le; ++li)
+		{
+			if (li != lines.begin()) content.push_back( '\n');
+			content.append( *li);
+		}
+		std::vector<std::string> expected = getExpectedResults( analyzer.get(), lines);
+		unsigned int expectedNofErrors = 0;
+		for (unsigned int lidx=0; lidx < nofLines; ++lidx)
+		{
+			if (lidx % 37 == 20 && lidx % 11 != 4) ++expectedNofErrors;
+		}
+		if (expectedNofErrors != (unsigned int)std::count_if( expected.begin(), expected.end(), isErrorResult))
+		{
+			throw std::runtime_error( "number of errors of the analysis of every line on its own not as expected");
+		}
+
+		// ... chunks smaller than a line, chunks with lines split at their borders and the whole document as one chunk:
+		std::size_t chunksizeAr[] = {7,1000,4096,content.size(),0};
+		unsigned int nofThreadsAr[] = {1,3,MAX_NOF_THREADS,0};
+		for (unsigned int ti=0; nofThreadsAr[ ti]; ++ti)
+		{
+			// ... the minimum document size is chosen to run only the batches of lines in parallel, not the features of a line
+			analyzer->defineParallelProcessing( 1<<24, nofThreadsAr[ ti]);
+			for (unsigned int ci=0; chunksizeAr[ ci]; ++ci)
+			{
+				std::vector<std::string> results = analyzeLines( analyzer.get(), content, chunksizeAr[ ci]);
+				if (results != expected)
+				{
+					std::vector<std::string>::const_iterator ri = results.begin(), re = results.end();
+					std::vector<std::string>::const_iterator ei = expected.begin(), ee = expected.end();
+					for (; ri != re && ei != ee && *ri == *ei; ++ri,++ei){}
+					std::cerr << "first difference with " << nofThreadsAr[ ti] << " threads and chunk size " << chunksizeAr[ ci] << " at result " << (ri - results.begin()) << ":" << std::endl
+							<< "EXPECTED " << (ei == ee ? std::string("<end>") : *ei) << std::endl
+							<< "GOT " << (ri == re ? std::string("<end>") : *ri) << std::endl;
+					throw std::runtime_error( "results of the analysis of the lines differ from the analysis of every line on its own");
+				}
+			}
+		}
+		std::cerr << "OK" << std::endl;
+		rt = 0;
+	}
+	catch (const std::bad_alloc&)
+	{
+		std::cerr << "ERROR memory allocation error" << std::endl;
+		rt = 2;
+	}
+	catch (const std::runtime_error& e)
+	{
+		std::cerr << "ERROR " << e.what() << std::endl;
+		rt = 1;
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "EXCEPTION " << e.what() << std::endl;
+		rt = 1;
+	}
+	if (g_fileLocator)
+	{
+		delete g_fileLocator;
+	}
+	if (g_errorhnd)
+	{
+		delete g_errorhnd;
+	}
+	return rt;
+}
+
@@ -0,0 +1,346 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Test of the parallel analysis of the parts of a big TSV document with one sub document per row, comparing the results with sequential processing
+/// \file testAnalyzeParts.cpp
+#include "strus/lib/analyzer_objbuild.hpp"
+#include "strus/lib/error.hpp"
+#include "strus/lib/filelocator.hpp"
+#include "strus/errorBufferInterface.hpp"
+#include "strus/fileLocatorInterface.hpp"
+#include "strus/segmenterInterface.hpp"
+#include "strus/documentAnalyzerInstanceInterface.hpp"
+#include "strus/documentAnalyzerContextInterface.hpp"
+#include "strus/analyzer/documentClass.hpp"
+#include "strus/analyzer/document.hpp"
+#include "strus/textProcessorInterface.hpp"
+#include "strus/normalizerFunctionInterface.hpp"
+#include "strus/normalizerFunctionInstanceInterface.hpp"
+#include "strus/tokenizerFunctionInterface.hpp"
+#include "strus/tokenizerFunctionInstanceInterface.hpp"
+#include "strus/analyzerObjectBuilderInterface.hpp"
+#include "strus/base/local_ptr.hpp"
+#include "strus/analyzer/featureOptions.hpp"
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <stdexcept>
+#include <iostream>
+#include <sstream>
+
+static strus::ErrorBufferInterface* g_errorhnd = 0;
+static strus::FileLocatorInterface* g_fileLocator = 0;
+
+#define NOF_THREADS 2
+#define TSV_MIMETYPE "text/tab-separated-values"
+
+static void printUsage( int argc, const char* argv[])
+{
+	std::cerr << "usage: " << argv[0] << " <nofRows>" << std::endl;
+	std::cerr << "<nofRows> = number of rows of the TSV document, should be big enough to get more parts than threads" << std::endl;
+}
+
+/// \brief Normalizer reporting an error for the token "fail" and stopping the batch it is called with
+class FailingNormalizerFunctionInstance :public strus::NormalizerFunctionInstanceInterface
+{
+public:
+	FailingNormalizerFunctionInstance(){}
+	virtual ~FailingNormalizerFunctionInstance(){}
+
+	virtual std::string normalize( const char* src, std::size_t srcsize) const
+	{
+		std::string rt( src, srcsize);
+		if (rt == "fail")
+		{
+			g_errorhnd->report( strus::ErrorCodeRuntimeError, "error in 'fail' normalizer");
+			return std::string();
+		}
+		return rt;
+	}
+	virtual void normalizeBatch( const strus::analyzer::TokenSpan* in, std::size_t n, strus::analyzer::NormalizedOutput& out) const
+	{
+		for (std::size_t ii=0; ii < n; ++ii)
+		{
+			std::string res = normalize( in[ ii].ptr(), in[ ii].size());
+			if (g_errorhnd->hasError()) return;
+			out.addNormalizeResult( res);
+		}
+	}
+	virtual const char* name() const	{return "fail";}
+	virtual strus::StructView view() const
+	{
+		return strus::StructView()("name",name());
+	}
+};
+
+static void defineFeature( strus::DocumentAnalyzerInstanceInterface* analyzer, const strus::TextProcessorInterface* textproc, bool isAttribute, const char* name, const char* tokenizer, strus::NormalizerFunctionInstanceInterface* normalizer, const char* path)
+{
+	strus::local_ptr<strus::NormalizerFunctionInstanceInterface> nmi( normalizer);
+	const strus::TokenizerFunctionInterface* tk = textproc->getTokenizer( tokenizer);
+	if (!tk) throw std::runtime_error( std::string("unknown tokenizer: '") + tokenizer + "'");
+	strus::local_ptr<strus::TokenizerFunctionInstanceInterface> tki( tk->createInstance( std::vector<std::string>(), textproc));
+	if (!tki.get() || !nmi.get()) throw std::runtime_error( "failed to create feature functions");
+	std::vector<strus::NormalizerFunctionInstanceInterface*> normalizers( 1, nmi.release());
+	if (isAttribute)
+	{
+		analyzer->defineAttribute( name, path, tki.release(), normalizers);
+	}
+	else
+	{
+		analyzer->addSearchIndexFeature( name, path, tki.release(), normalizers, 0/*priority*/, strus::analyzer::FeatureOptions());
+	}
+}
+
+static strus::NormalizerFunctionInstanceInterface* createOrigNormalizer( const strus::TextProcessorInterface* textproc)
+{
+	const strus::NormalizerFunctionInterface* nm = textproc->getNormalizer( "orig");
+	if (!nm) throw std::runtime_error( "unknown normalizer: 'orig'");
+	return nm->createInstance( std::vector<std::string>(), textproc);
+}
+
+/// \brief Create an analyzer of the rows of a TSV document as sub documents
+/// \param[in] nofThreads number of threads for parallel processing, 0 for sequential processing
+/// \param[in] withFailingFeature true if the column 'flag' is analyzed with a normalizer failing for the value "fail"
+static strus::DocumentAnalyzerInstanceInterface* createAnalyzer( const strus::AnalyzerObjectBuilderInterface* objbuild, unsigned int nofThreads, bool withFailingFeature)
+{
+	const strus::TextProcessorInterface* textproc = objbuild->getTextProcessor();
+	const strus::SegmenterInterface* segmenter = textproc->getSegmenterByName( "tsv");
+	if (!segmenter) throw std::runtime_error( "unknown segmenter: 'tsv'");
+	strus::local_ptr<strus::DocumentAnalyzerInstanceInterface> analyzer( objbuild->createDocumentAnalyzer( segmenter));
+	if (!analyzer.get()) throw std::runtime_error("failed to create document analyzer");
+	// ... the TSV segmenter defines a sub section per row, the expression is ignored
+	analyzer->defineSubDocument( "row", "row");
+	defineFeature( analyzer.get(), textproc, true/*attribute*/, "id", "content", createOrigNormalizer( textproc), "id");
+	defineFeature( analyzer.get(), textproc, false/*search index*/, "word", "word", createOrigNormalizer( textproc), "text");
+	if (withFailingFeature)
+	{
+		defineFeature( analyzer.get(), textproc, false/*search index*/, "flag", "content", new FailingNormalizerFunctionInstance(), "flag");
+	}
+	if (nofThreads)
+	{
+		analyzer->defineParallelProcessing( 1024/*minDocumentSize*/, nofThreads);
+	}
+	if (g_errorhnd->hasError()) throw std::runtime_error( g_errorhnd->fetchError());
+	return analyzer.release();
+}
+
+static const char* g_words[] = {"Running","dogs","are","faster","than","the","Cats","walking","on","streets","of","Zürich","and","München",0};
+
+/// \brief Create the TSV document, the column 'flag' has the value "fail" in the row with the index failRow
+static std::string createTsvDocument( unsigned int nofRows, unsigned int failRow)
+{
+	std::ostringstream out;
+	out << "id\ttext\tflag\n";
+	unsigned int nofWords = sizeof(g_words)/sizeof(g_words[0])-1;
+	for (unsigned int ri=0; ri < nofRows; ++ri)
+	{
+		out << ri << "\t";
+		unsigned int wi = 0, we = ri % 17 + 1;
+		for (; wi < we; ++wi)
+		{
+			if (wi) out << " ";
+			out << g_words[ (ri * 3 + wi) % nofWords];
+		}
+		out << "\t" << (ri == failRow ? "fail" : "ok") << "\n";
+	}
+	return out.str();
+}
+
+static std::string documentToString( const strus::analyzer::Document& doc)
+{
+	std::ostringstream output;
+	output << "DOC " << doc.subDocumentTypeName();
+	std::vector<strus::analyzer::DocumentAttribute>::const_iterator
+		ai = doc.attributes().begin(), ae = doc.attributes().end();
+	for (; ai != ae; ++ai)
+	{
+		output << " " << ai->name() << "='" << ai->value() << "'";
+	}
+	std::vector<strus::analyzer::DocumentTerm> searchIndexTerms = doc.searchIndexTerms();
+	std::sort( searchIndexTerms.begin(), searchIndexTerms.end());
+	std::vector<strus::analyzer::DocumentTerm>::const_iterator
+		ti = searchIndexTerms.begin(), te = searchIndexTerms.end();
+	for (; ti != te; ++ti)
+	{
+		output << " " << ti->type() << ":" << ti->value() << "@" << ti->pos();
+	}
+	return output.str();
+}
+
+/// \brief Analyze the document with a context reset for it, the result of an error is "ERROR" followed by the error message, no documents are fetched after an error
+static std::vector<std::string> analyze( strus::DocumentAnalyzerContextInterface* ctx, const std::string& content, bool reference)
+{
+	std::vector<std::string> rt;
+	if (!ctx->reset( strus::analyzer::DocumentClass( TSV_MIMETYPE, "UTF-8"))) throw std::runtime_error( "failed to reset document analyzer context");
+	if (reference)
+	{
+		ctx->putInputReference( content.c_str(), content.size(), true);
+	}
+	else
+	{
+		ctx->putInput( content.c_str(), content.size(), true);
+	}
+	if (g_errorhnd->hasError()) throw std::runtime_error( g_errorhnd->fetchError());
+	strus::analyzer::Document doc;
+	while (ctx->analyzeNext( doc))
+	{
+		rt.push_back( documentToString( doc));
+	}
+	if (g_errorhnd->hasError())
+	{
+		rt.push_back( std::string("ERROR ") + g_errorhnd->fetchError());
+	}
+	return rt;
+}
+
+static void compareResults( const std::vector<std::string>& expected, const std::vector<std::string>& result, const char* description)
+{
+	std::vector<std::string>::const_iterator ri = result.begin(), re = result.end();
+	std::vector<std::string>::const_iterator ei = expected.begin(), ee = expected.end();
+	for (; ri != re && ei != ee && *ri == *ei; ++ri,++ei){}
+	if (ri != re || ei != ee)
+	{
+		std::cerr << "first difference " << description << " at result " << (ri - result.begin()) << ":" << std::endl
+				<< "EXPECTED " << (ei == ee ? std::string("<end>") : ei->substr( 0, 500)) << std::endl
+				<< "GOT " << (ri == re ? std::string("<end>") : ri->substr( 0, 500)) << std::endl;
+		throw std::runtime_error( std::string("result of analysis of the parts in parallel differs from sequential processing ") + description);
+	}
+}
+
+/// \brief Check that the documents are returned in the order of the rows
+static void checkRowOrder( const std::vector<std::string>& results, unsigned int nofRows)
+{
+	if (results.size() != nofRows) throw std::runtime_error( "number of documents analyzed not as expected");
+	for (unsigned int ri=0; ri < nofRows; ++ri)
+	{
+		char buf[ 64];
+		std::snprintf( buf, sizeof(buf), "DOC row id='%u' ", ri);
+		if (0!=std::strncmp( results[ ri].c_str(), buf, std::strlen( buf)))
+		{
+			throw std::runtime_error( std::string( "documents not returned in the order of the rows: ") + results[ ri].substr( 0, 100));
+		}
+	}
+}
+
+static unsigned int getUintValue( const char* arg)
+{
+	unsigned int rt = 0, prev = 0;
+	char const* cc = arg;
+	for (; *cc; ++cc)
+	{
+		if (*cc < '0' || *cc > '9') throw std::runtime_error( std::string( "parameter is not a non negative integer number: ") + arg);
+		rt = (rt * 10) + (*cc - '0');
+		if (rt < prev) throw std::runtime_error( std::string( "parameter out of range: ") + arg);
+		prev = rt;
+	}
+	return rt;
+}
+
+int main( int argc, const char* argv[])
+{
+	int rt = 0;
+	if (argc <= 1 || std::strcmp( argv[1], "-h") == 0 || std::strcmp( argv[1], "--help") == 0)
+	{
+		printUsage( argc, argv);
+		return 0;
+	}
+	else if (argc > 2)
+	{
+		std::cerr << "ERROR too many parameters" << std::endl;
+		printUsage( argc, argv);
+		return 1;
+	}
+	try
+	{
+		g_errorhnd = strus::createErrorBuffer_standard( 0, NOF_THREADS+1, NULL);
+		if (!g_errorhnd) throw std::runtime_error("failed to create error buffer object");
+		g_fileLocator = strus::createFileLocator_std( g_errorhnd);
+		if (!g_fileLocator) throw std::runtime_error("failed to create file locator");
+		strus::local_ptr<strus::AnalyzerObjectBuilderInterface> objbuild(
+			strus::createAnalyzerObjectBuilder_default( g_fileLocator, g_errorhnd));
+		if (!objbuild.get()) throw std::runtime_error("failed to create analyzer object builder");
+
+		unsigned int nofRows = getUintValue( argv[1]);
+		strus::analyzer::DocumentClass dclass( TSV_MIMETYPE, "UTF-8");
+
+		// [1] Sub documents of the rows returned in row order, the same as with sequential processing:
+		{
+			std::string content = createTsvDocument( nofRows, nofRows/*no row fails*/);
+			strus::local_ptr<strus::DocumentAnalyzerInstanceInterface> sequentialAnalyzer( createAnalyzer( objbuild.get(), 0, false));
+			strus::local_ptr<strus::DocumentAnalyzerInstanceInterface> parallelAnalyzer( createAnalyzer( objbuild.get(), NOF_THREADS, false));
+			strus::local_ptr<strus::DocumentAnalyzerContextInterface> sequentialContext( sequentialAnalyzer->createContext( dclass));
+			strus::local_ptr<strus::DocumentAnalyzerContextInterface> parallelContext( parallelAnalyzer->createContext( dclass));
+			if (!sequentialContext.get() || !parallelContext.get()) throw std::runtime_error( "failed to create document analyzer context");
+
+			std::vector<std::string> expected = analyze( sequentialContext.get(), content, false);
+			checkRowOrder( expected, nofRows);
+			// ... analyze twice with the same context, the second time after a reset
+			compareResults( expected, analyze( parallelContext.get(), content, false), "feeding a copy");
+			compareResults( expected, analyze( parallelContext.get(), content, false), "feeding a copy after reset");
+			compareResults( expected, analyze( parallelContext.get(), content, true), "feeding a reference");
+
+			// ... analyze returns the first sub document only
+			strus::analyzer::Document firstdoc = parallelAnalyzer->analyze( content, dclass);
+			if (g_errorhnd->hasError()) throw std::runtime_error( g_errorhnd->fetchError());
+			compareResults( std::vector<std::string>( 1, expected[0]), std::vector<std::string>( 1, documentToString( firstdoc)), "calling analyze");
+		}
+		// [2] Error in the analysis of a row of a part of a later round, the sub documents of the rows before are returned before the error:
+		{
+			unsigned int failRow = nofRows - nofRows / 4;
+			std::string content = createTsvDocument( nofRows, failRow);
+			strus::local_ptr<strus::DocumentAnalyzerInstanceInterface> sequentialAnalyzer( createAnalyzer( objbuild.get(), 0, true));
+			strus::local_ptr<strus::DocumentAnalyzerInstanceInterface> parallelAnalyzer( createAnalyzer( objbuild.get(), NOF_THREADS, true));
+			strus::local_ptr<strus::DocumentAnalyzerContextInterface> sequentialContext( sequentialAnalyzer->createContext( dclass));
+			strus::local_ptr<strus::DocumentAnalyzerContextInterface> parallelContext( parallelAnalyzer->createContext( dclass));
+			if (!sequentialContext.get() || !parallelContext.get()) throw std::runtime_error( "failed to create document analyzer context");
+
+			std::vector<std::string> expected = analyze( sequentialContext.get(), content, false);
+			std::vector<std::string> result = analyze( parallelContext.get(), content, false);
+			if (expected.size() != failRow + 1 || result.empty() || 0!=std::strncmp( result.back().c_str(), "ERROR", 5))
+			{
+				throw std::runtime_error( "expected error in the analysis of the row with the failing feature");
+			}
+			if (result.back().find( "parts") == std::string::npos)
+			{
+				throw std::runtime_error( std::string( "content not analyzed in parts: ") + result.back());
+			}
+			// ... the error messages differ, only the documents before the error are compared
+			expected.pop_back();
+			result.pop_back();
+			compareResults( expected, result, "with an error");
+		}
+		std::cerr << "OK" << std::endl;
+		rt = 0;
+	}
+	catch (const std::bad_alloc&)
+	{
+		std::cerr << "ERROR memory allocation error" << std::endl;
+		rt = 2;
+	}
+	catch (const std::runtime_error& e)
+	{
+		std::cerr << "ERROR " << e.what() << std::endl;
+		rt = 1;
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "EXCEPTION " << e.what() << std::endl;
+		rt = 1;
+	}
+	if (g_fileLocator)
+	{
+		delete g_fileLocator;
+	}
+	if (g_errorhnd)
+	{
+		delete g_errorhnd;
+	}
+	return rt;
+}
+
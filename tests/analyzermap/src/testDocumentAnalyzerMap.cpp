@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Test of the dispatch of document classes to analyzers in the document analyzer map and of the analysis with document class detection
+/// \file testDocumentAnalyzerMap.cpp
+#include "strus/lib/analyzer_objbuild.hpp"
+#include "strus/lib/error.hpp"
+#include "strus/lib/filelocator.hpp"
+#include "strus/errorBufferInterface.hpp"
+#include "strus/fileLocatorInterface.hpp"
+#include "strus/documentAnalyzerInstanceInterface.hpp"
+#include "strus/documentAnalyzerMapInterface.hpp"
+#include "strus/analyzer/document.hpp"
+#include "strus/textProcessorInterface.hpp"
+#include "strus/normalizerFunctionInterface.hpp"
+#include "strus/normalizerFunctionInstanceInterface.hpp"
+#include "strus/tokenizerFunctionInterface.hpp"
+#include "strus/tokenizerFunctionInstanceInterface.hpp"
+#include "strus/analyzerObjectBuilderInterface.hpp"
+#include "strus/base/local_ptr.hpp"
+#include <string>
+#include <vector>
+#include <map>
+#include <cstring>
+#include <cstdio>
+#include <stdexcept>
+#include <iostream>
+#include <sstream>
+
+static strus::ErrorBufferInterface* g_errorhnd = 0;
+static strus::FileLocatorInterface* g_fileLocator = 0;
+
+static void printUsage( int argc, const char* argv[])
+{
+	std::cerr << "usage: " << argv[0] << " <nofClasses>" << std::endl;
+	std::cerr << "<nofClasses> = number of additional document classes defined in the map" << std::endl;
+}
+
+static strus::DocumentAnalyzerInstanceInterface* createAnalyzer( const strus::DocumentAnalyzerMapInterface* amap, const strus::TextProcessorInterface* textproc, const char* mimeType, const char* attribute, const char* path)
+{
+	strus::local_ptr<strus::DocumentAnalyzerInstanceInterface> analyzer( amap->createAnalyzer( mimeType, ""));
+	if (!analyzer.get()) throw std::runtime_error( g_errorhnd->fetchError());
+
+	const strus::TokenizerFunctionInterface* tk = textproc->getTokenizer( "content");
+	if (!tk) throw std::runtime_error( "unknown tokenizer: 'content'");
+	strus::local_ptr<strus::TokenizerFunctionInstanceInterface> tki( tk->createInstance( std::vector<std::string>(), textproc));
+	const strus::NormalizerFunctionInterface* nm = textproc->getNormalizer( "orig");
+	if (!nm) throw std::runtime_error( "unknown normalizer: 'orig'");
+	strus::local_ptr<strus::NormalizerFunctionInstanceInterface> nmi( nm->createInstance( std::vector<std::string>(), textproc));
+	if (!tki.get() || !nmi.get()) throw std::runtime_error( "failed to create feature functions");
+	std::vector<strus::NormalizerFunctionInstanceInterface*> normalizers( 1, nmi.release());
+	analyzer->defineAttribute( attribute, path, tki.release(), normalizers);
+	if (g_errorhnd->hasError()) throw std::runtime_error( g_errorhnd->fetchError());
+	return analyzer.release();
+}
+
+static std::string getAttributes( const strus::analyzer::Document& doc)
+{
+	std::ostringstream out;
+	std::vector<strus::analyzer::DocumentAttribute>::const_iterator
+		ai = doc.attributes().begin(), ae = doc.attributes().end();
+	for (; ai != ae; ++ai)
+	{
+		out << " " << ai->name() << "='" << ai->value() << "'";
+	}
+	return out.str();
+}
+
+static void checkAnalyzer( const strus::DocumentAnalyzerMapInterface* amap, const std::string& mimeType, const std::string& schema, const strus::DocumentAnalyzerInstanceInterface* expected)
+{
+	const strus::DocumentAnalyzerInstanceInterface* analyzer = amap->getAnalyzer( mimeType, schema);
+	if (!expected)
+	{
+		if (analyzer || !g_errorhnd->hasError())
+		{
+			throw std::runtime_error( std::string("expected error getting the analyzer of an undefined document class: ") + mimeType + ";" + schema);
+		}
+		(void)g_errorhnd->fetchError();
+	}
+	else if (analyzer != expected)
+	{
+		if (g_errorhnd->hasError()) throw std::runtime_error( g_errorhnd->fetchError());
+		throw std::runtime_error( std::string("wrong analyzer for document class: ") + mimeType + ";" + schema);
+	}
+}
+
+static void checkAnalyzeAuto( const strus::DocumentAnalyzerMapInterface* amap, const std::string& content, const char* expected)
+{
+	strus::analyzer::Document doc = amap->analyzeAuto( content);
+	if (!expected)
+	{
+		if (!g_errorhnd->hasError())
+		{
+			throw std::runtime_error( "expected error analyzing a document of a class without analyzer");
+		}
+		(void)g_errorhnd->fetchError();
+		return;
+	}
+	if (g_errorhnd->hasError()) throw std::runtime_error( g_errorhnd->fetchError());
+	std::string result = getAttributes( doc);
+	if (result != expected)
+	{
+		std::cerr << "EXPECTED" << expected << std::endl << "GOT" << result << std::endl;
+		throw std::runtime_error( "result of analysis with document class detection not as expected");
+	}
+}
+
+static std::string testClassName( const char* prefix, unsigned int idx)
+{
+	char buf[ 64];
+	std::snprintf( buf, sizeof(buf), "%s%u", prefix, idx);
+	return std::string( buf);
+}
+
+static unsigned int getUintValue( const char* arg)
+{
+	unsigned int rt = 0, prev = 0;
+	char const* cc = arg;
+	for (; *cc; ++cc)
+	{
+		if (*cc < '0' || *cc > '9') throw std::runtime_error( std::string( "parameter is not a non negative integer number: ") + arg);
+		rt = (rt * 10) + (*cc - '0');
+		if (rt < prev) throw std::runtime_error( std::string( "parameter out of range: ") + arg);
+		prev = rt;
+	}
+	return rt;
+}
+
+int main( int argc, const char* argv[])
+{
+	int rt = 0;
+	if (argc <= 1 || std::strcmp( argv[1], "-h") == 0 || std::strcmp( argv[1], "--help") == 0)
+	{
+		printUsage( argc, argv);
+		return 0;
+	}
+	else if (argc > 2)
+	{
+		std::cerr << "ERROR too many parameters" << std::endl;
+		printUsage( argc, argv);
+		return 1;
+	}
+	try
+	{
+		g_errorhnd = strus::createErrorBuffer_standard( 0, 1, NULL);
+		if (!g_errorhnd) throw std::runtime_error("failed to create error buffer object");
+		g_fileLocator = strus::createFileLocator_std( g_errorhnd);
+		if (!g_fileLocator) throw std::runtime_error("failed to create file locator");
+
+		unsigned int nofClasses = getUintValue( argv[1]);
+		strus::local_ptr<strus::AnalyzerObjectBuilderInterface> objbuild(
+			strus::createAnalyzerObjectBuilder_default( g_fileLocator, g_errorhnd));
+		if (!objbuild.get()) throw std::runtime_error("failed to create analyzer object builder");
+		const strus::TextProcessorInterface* textproc = objbuild->getTextProcessor();
+		strus::local_ptr<strus::DocumentAnalyzerMapInterface> amap( objbuild->createDocumentAnalyzerMap());
+		if (!amap.get()) throw std::runtime_error("failed to create document analyzer map");
+
+		// [1] Analyzers for XML and JSON without schema and for XML with a schema:
+		strus::DocumentAnalyzerInstanceInterface* xmlAnalyzer = createAnalyzer( amap.get(), textproc, "application/xml", "xmltitle", "/doc/title()");
+		amap->addAnalyzer( "application/xml", "", xmlAnalyzer);
+		strus::DocumentAnalyzerInstanceInterface* jsonAnalyzer = createAnalyzer( amap.get(), textproc, "application/json", "jsontitle", "/doc/title()");
+		amap->addAnalyzer( "application/json", "", jsonAnalyzer);
+		strus::DocumentAnalyzerInstanceInterface* schemaAnalyzer = createAnalyzer( amap.get(), textproc, "application/xml", "schematitle", "/doc/title()");
+		amap->addAnalyzer( "application/xml", "special", schemaAnalyzer);
+		if (g_errorhnd->hasError()) throw std::runtime_error( g_errorhnd->fetchError());
+
+		// [2] Many more classes, to get the dispatch table resized several times and collisions in it:
+		std::map<std::string,const strus::DocumentAnalyzerInstanceInterface*> testClassAnalyzers;
+		unsigned int ci = 0;
+		for (; ci < nofClasses; ++ci)
+		{
+			std::string mimeType = testClassName( "application/x-test-", ci % 7);
+			std::string schema = (ci < 7) ? std::string() : testClassName( "schema", ci);
+			strus::DocumentAnalyzerInstanceInterface* analyzer = createAnalyzer( amap.get(), textproc, "application/xml", "title", "/doc/title()");
+			amap->addAnalyzer( mimeType, schema, analyzer);
+			if (g_errorhnd->hasError()) throw std::runtime_error( g_errorhnd->fetchError());
+			testClassAnalyzers[ mimeType + ";" + schema] = analyzer;
+		}
+
+		// [3] Dispatch of document classes, classes with an unknown schema get the analyzer without schema:
+		checkAnalyzer( amap.get(), "application/xml", "", xmlAnalyzer);
+		checkAnalyzer( amap.get(), "application/xml", "special", schemaAnalyzer);
+		checkAnalyzer( amap.get(), "application/xml", "unknown", xmlAnalyzer);
+		checkAnalyzer( amap.get(), "application/json", "", jsonAnalyzer);
+		checkAnalyzer( amap.get(), "application/json", "special", jsonAnalyzer);
+		checkAnalyzer( amap.get(), "text/plain", "", NULL);
+		checkAnalyzer( amap.get(), "text/plain", "special", NULL);
+		for (ci = 0; ci < nofClasses; ++ci)
+		{
+			std::string mimeType = testClassName( "application/x-test-", ci % 7);
+			std::string schema = (ci < 7) ? std::string() : testClassName( "schema", ci);
+			checkAnalyzer( amap.get(), mimeType, schema, testClassAnalyzers[ mimeType + ";" + schema]);
+			if (ci < 7)
+			{
+				checkAnalyzer( amap.get(), mimeType, "unknown", testClassAnalyzers[ mimeType + ";"]);
+			}
+		}
+		if (nofClasses > 0 && nofClasses < 7)
+		{
+			checkAnalyzer( amap.get(), testClassName( "application/x-test-", 6), "", NULL);
+		}
+
+		// [4] Analysis with document class detection:
+		checkAnalyzeAuto( amap.get(),
+			"<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n<doc><title>xml document</title></doc>",
+			" xmltitle='xml document'");
+		checkAnalyzeAuto( amap.get(),
+			"{\"doc\": {\"title\": \"json document\"}}",
+			" jsontitle='json document'");
+		{
+			// ... document bigger than the prefix used for the detection, with the selected element at the end
+			std::ostringstream content;
+			content << "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n<doc><text>";
+			unsigned int wi = 0, we = 10000;
+			for (; wi < we; ++wi)
+			{
+				content << " word" << (wi % 31);
+			}
+			content << "</text><title>big xml document</title></doc>";
+			checkAnalyzeAuto( amap.get(), content.str(), " xmltitle='big xml document'");
+		}
+		checkAnalyzeAuto( amap.get(), "just some plain text without markup", NULL);
+
+		std::cerr << "OK" << std::endl;
+		rt = 0;
+	}
+	catch (const std::bad_alloc&)
+	{
+		std::cerr << "ERROR memory allocation error" << std::endl;
+		rt = 2;
+	}
+	catch (const std::runtime_error& e)
+	{
+		std::cerr << "ERROR " << e.what() << std::endl;
+		rt = 1;
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "EXCEPTION " << e.what() << std::endl;
+		rt = 1;
+	}
+	if (g_fileLocator)
+	{
+		delete g_fileLocator;
+	}
+	if (g_errorhnd)
+	{
+		delete g_errorhnd;
+	}
+	return rt;
+}
+
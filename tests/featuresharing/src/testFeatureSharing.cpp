@@ -0,0 +1,343 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Test of the features sharing tokenization, normalization and normalizer caches, comparing the results with the features analyzed each on its own without cache
+/// \file testFeatureSharing.cpp
+#include "strus/lib/analyzer_objbuild.hpp"
+#include "strus/lib/error.hpp"
+#include "strus/lib/filelocator.hpp"
+#include "strus/errorBufferInterface.hpp"
+#include "strus/fileLocatorInterface.hpp"
+#include "strus/segmenterInterface.hpp"
+#include "strus/documentAnalyzerInstanceInterface.hpp"
+#include "strus/analyzer/documentClass.hpp"
+#include "strus/analyzer/document.hpp"
+#include "strus/textProcessorInterface.hpp"
+#include "strus/normalizerFunctionInterface.hpp"
+#include "strus/normalizerFunctionInstanceInterface.hpp"
+#include "strus/tokenizerFunctionInterface.hpp"
+#include "strus/tokenizerFunctionInstanceInterface.hpp"
+#include "strus/analyzerObjectBuilderInterface.hpp"
+#include "strus/base/local_ptr.hpp"
+#include "strus/analyzer/featureOptions.hpp"
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <iostream>
+#include <sstream>
+
+static strus::ErrorBufferInterface* g_errorhnd = 0;
+static strus::FileLocatorInterface* g_fileLocator = 0;
+
+#define TEXT_SELECTOR "/doc/text()"
+
+/// \brief Feature definition, functions are written as name followed by the arguments separated by spaces, normalizers are separated by ';'
+struct FeatureDef
+{
+	const char* type;
+	const char* tokenizer;
+	const char* normalizers;
+	unsigned int cache;	///< maximum number of entries of the normalizer cache, 0 if no cache is used
+};
+
+/// \brief Test case, a list of features analyzed together, terminated by a feature with type NULL
+struct TestCase
+{
+	const char* name;
+	bool samePositions;	///< true if all features have the same tokenizer, so that the ordinal positions are the same when analyzed on their own
+	const char* differentTypes[ 2];	///< two features with differently configured instances of the same normalizer that must not share results, NULL if not defined
+	FeatureDef features[ 12];
+};
+
+static const TestCase g_testCases[] = {
+	{"word", true, {0,0}, {
+		{"orig", "word", "orig"},
+		{"lc", "word", "lc"},
+		{"uc", "word", "uc"},
+		{"stem", "word", "lc;stem en"},
+		{"stemde", "word", "lc;stem de"},
+		{"stemuc", "word", "stem en;uc"},
+		{"lc2", "word", "lc"},
+		{0,0,0}}},
+	{"punctuation", false, {0,0}, {
+		{"word", "word", "orig"},
+		{"pde", "punctuation de", "orig"},
+		{"pen", "punctuation en", "orig"},
+		{"pde2", "punctuation de", "orig"},
+		{"pcolon", "punctuation de :", "orig"},
+		{"lc", "word", "lc"},
+		{0,0,0}}},
+	{"normalizer", true, {"dia","diade"}, {
+		{"dia", "word", "convdia"},
+		{"diade", "word", "convdia de"},
+		{"lcdia", "word", "lc;convdia"},
+		{"lcdiade", "word", "lc;convdia de"},
+		{"lcdiaen", "word", "lc;convdia en"},
+		{"lcdiadestem", "word", "lc;convdia de;stem de"},
+		{"lcdiastem", "word", "lc;convdia;stem de"},
+		{0,0,0}}},
+	{"cache", true, {"dia","diade"}, {
+		{"dia", "word", "lc;convdia", 100},
+		{"diade", "word", "lc;convdia de", 100},
+		{"dia2", "word", "lc;convdia", 100},
+		{"stemde", "word", "lc;convdia de;stem de", 3},
+		{"stem", "word", "lc;convdia;stem de", 0},
+		{"orig", "word", "orig", 1000},
+		{0,0,0}}},
+	{"multivalue", true, {0,0}, {
+		{"ngram", "word", "lc;ngram 3"},
+		{"ngramuc", "word", "lc;ngram 3;uc"},
+		{"ngramstem", "word", "lc;ngram 3;stem en", 10},
+		{"ngram4", "word", "lc;ngram 4;ngram 2"},
+		{0,0,0}}},
+	{0,false,{0,0},{{0,0,0}}}
+};
+
+static void parseFunction( const std::string& src, std::string& name, std::vector<std::string>& args)
+{
+	std::istringstream in( src);
+	std::string arg;
+	name.clear();
+	args.clear();
+	if (!(in >> name)) throw std::runtime_error( "empty function definition in test");
+	while (in >> arg)
+	{
+		args.push_back( arg);
+	}
+}
+
+static void freeNormalizers( std::vector<strus::NormalizerFunctionInstanceInterface*>& normalizers)
+{
+	std::vector<strus::NormalizerFunctionInstanceInterface*>::iterator ni = normalizers.begin(), ne = normalizers.end();
+	for (; ni != ne; ++ni) delete *ni;
+	normalizers.clear();
+}
+
+static void defineFeature( strus::DocumentAnalyzerInstanceInterface* analyzer, const strus::TextProcessorInterface* textproc, const FeatureDef& def, bool withCache)
+{
+	std::string name;
+	std::vector<std::string> args;
+	parseFunction( def.tokenizer, name, args);
+	const strus::TokenizerFunctionInterface* tk = textproc->getTokenizer( name);
+	if (!tk) throw std::runtime_error( std::string("unknown tokenizer: '") + name + "'");
+	strus::local_ptr<strus::TokenizerFunctionInstanceInterface> tki( tk->createInstance( args, textproc));
+	if (!tki.get()) throw std::runtime_error( std::string("failed to create tokenizer: '") + def.tokenizer + "'");
+
+	std::vector<strus::NormalizerFunctionInstanceInterface*> normalizers;
+	std::string normalizerDefs( def.normalizers);
+	std::size_t start = 0;
+	while (start <= normalizerDefs.size())
+	{
+		std::size_t end = normalizerDefs.find( ';', start);
+		if (end == std::string::npos) end = normalizerDefs.size();
+		parseFunction( normalizerDefs.substr( start, end-start), name, args);
+		start = end+1;
+
+		const strus::NormalizerFunctionInterface* nm = textproc->getNormalizer( name);
+		strus::NormalizerFunctionInstanceInterface* nmi = nm ? nm->createInstance( args, textproc) : 0;
+		if (!nmi)
+		{
+			freeNormalizers( normalizers);
+			throw std::runtime_error( std::string("failed to create normalizer: '") + def.normalizers + "'");
+		}
+		normalizers.push_back( nmi);
+	}
+	strus::analyzer::FeatureOptions options;
+	if (withCache) options.defineNormalizerCacheSize( def.cache);
+	analyzer->addSearchIndexFeature( def.type, TEXT_SELECTOR, tki.release(), normalizers, 0/*priority*/, options);
+}
+
+static strus::DocumentAnalyzerInstanceInterface* createAnalyzer( const strus::AnalyzerObjectBuilderInterface* objbuild, const FeatureDef* features, std::size_t nofFeatures, bool withCache)
+{
+	const strus::TextProcessorInterface* textproc = objbuild->getTextProcessor();
+	const strus::SegmenterInterface* segmenter = textproc->getSegmenterByName( "textwolf");
+	if (!segmenter) throw std::runtime_error( "unknown segmenter: textwolf");
+	strus::local_ptr<strus::DocumentAnalyzerInstanceInterface> analyzer( objbuild->createDocumentAnalyzer( segmenter));
+	if (!analyzer.get()) throw std::runtime_error("failed to create document analyzer");
+	for (std::size_t fi=0; fi < nofFeatures; ++fi)
+	{
+		defineFeature( analyzer.get(), textproc, features[ fi], withCache);
+	}
+	if (g_errorhnd->hasError())
+	{
+		throw std::runtime_error( g_errorhnd->fetchError());
+	}
+	return analyzer.release();
+}
+
+/// \brief Map of the feature type to the list of terms (position and value) as string
+typedef std::map<std::string,std::string> TermMap;
+
+static TermMap analyze( const strus::DocumentAnalyzerInstanceInterface* analyzer, const std::string& content, bool withPositions)
+{
+	strus::analyzer::Document doc = analyzer->analyze( content, strus::analyzer::DocumentClass( "application/xml", "UTF-8"));
+	if (g_errorhnd->hasError())
+	{
+		throw std::runtime_error( g_errorhnd->fetchError());
+	}
+	std::vector<strus::analyzer::DocumentTerm> terms = doc.searchIndexTerms();
+	std::sort( terms.begin(), terms.end());
+	TermMap rt;
+	std::vector<strus::analyzer::DocumentTerm>::const_iterator ti = terms.begin(), te = terms.end();
+	for (; ti != te; ++ti)
+	{
+		std::string& output = rt[ ti->type()];
+		if (withPositions)
+		{
+			std::ostringstream pos;
+			pos << ti->pos() << ":";
+			output.append( pos.str());
+		}
+		output.append( ti->value());
+		output.push_back( ' ');
+	}
+	return rt;
+}
+
+static const char* g_text[] = {
+	"Running dogs are faster than the Cats walking on the streets of Zürich and München.",
+	"Die Hunde der Müllers laufen schneller als die Katzen: Äpfel, Öl und Übermut!",
+	"The U.S. citizens, e.g. Mr. Smith, say: \"Stop!\" Don't they? Yes.",
+	0
+};
+
+static std::string createDocument()
+{
+	std::ostringstream out;
+	out << "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n<doc>";
+	for (int ii=0; ii < 3; ++ii)
+	{
+		for (char const** ti = g_text; *ti; ++ti)
+		{
+			out << "<text>" << *ti << "</text>\n";
+		}
+	}
+	out << "</doc>";
+	return out.str();
+}
+
+static void runTest( const strus::AnalyzerObjectBuilderInterface* objbuild, const TestCase& testCase, const std::string& content)
+{
+	std::size_t nofFeatures = 0;
+	for (; testCase.features[ nofFeatures].type; ++nofFeatures){}
+
+	strus::local_ptr<strus::DocumentAnalyzerInstanceInterface> analyzer( createAnalyzer( objbuild, testCase.features, nofFeatures, true/*withCache*/));
+	if (analyzer->view().tostring().find( "sharedtokenizer") == std::string::npos)
+	{
+		throw std::runtime_error( std::string("no tokenization shared in test ") + testCase.name);
+	}
+	TermMap result = analyze( analyzer.get(), content, testCase.samePositions);
+	// ... analyze a second time, with the normalizer caches of the pooled context filled
+	if (result != analyze( analyzer.get(), content, testCase.samePositions))
+	{
+		throw std::runtime_error( std::string("result of a document analyzed a second time differs in test ") + testCase.name);
+	}
+	for (std::size_t fi=0; fi < nofFeatures; ++fi)
+	{
+		const FeatureDef& feature = testCase.features[ fi];
+		strus::local_ptr<strus::DocumentAnalyzerInstanceInterface> featureAnalyzer( createAnalyzer( objbuild, &feature, 1, false/*withCache*/));
+		TermMap expected = analyze( featureAnalyzer.get(), content, testCase.samePositions);
+		if (expected[ feature.type].empty())
+		{
+			throw std::runtime_error( std::string("no terms in test ") + testCase.name + " for feature " + feature.type);
+		}
+		if (expected[ feature.type] != result[ feature.type])
+		{
+			std::cerr << "EXPECTED:" << std::endl << expected[ feature.type] << std::endl << "GOT:" << std::endl << result[ feature.type] << std::endl;
+			throw std::runtime_error( std::string("terms of feature analyzed with others differ from the feature analyzed on its own, test ") + testCase.name + ", feature " + feature.type);
+		}
+	}
+	if (testCase.differentTypes[0] && result[ testCase.differentTypes[0]] == result[ testCase.differentTypes[1]])
+	{
+		throw std::runtime_error( std::string("differently configured normalizers return the same terms in test ") + testCase.name);
+	}
+}
+
+/// \brief Test of the results of a normalizer with multiple values followed by other normalizers:
+///	The values of a normalizer not being the last in the list are normalized each with the rest of the list and the single value results are concatenated.
+static void testMultiValueChain( const strus::AnalyzerObjectBuilderInterface* objbuild)
+{
+	static const FeatureDef features[] = {
+		{"ngram", "word", "ngram 3"},
+		{"ngramuc", "word", "ngram 3;uc"},
+		{"ngramngram", "word", "ngram 4;ngram 2"}
+	};
+	static const char* expected[] = {
+		"1:abc 1:bcd 1:cde 2:xy ",
+		"1:ABCBCDCDE 2:XY ",
+		"1:ab 1:bc 1:bc 1:cd 1:cd 1:de 2:xy ",
+		0
+	};
+	std::string content( "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n<doc><text>abcde xy</text></doc>");
+	strus::local_ptr<strus::DocumentAnalyzerInstanceInterface> analyzer( createAnalyzer( objbuild, features, sizeof(features)/sizeof(features[0]), false/*withCache*/));
+	TermMap result = analyze( analyzer.get(), content, true/*withPositions*/);
+	for (int ei=0; expected[ ei]; ++ei)
+	{
+		if (result[ features[ ei].type] != expected[ ei])
+		{
+			std::cerr << "EXPECTED:" << std::endl << expected[ ei] << std::endl << "GOT:" << std::endl << result[ features[ ei].type] << std::endl;
+			throw std::runtime_error( std::string("unexpected result of normalizer with multiple values, feature ") + features[ ei].type);
+		}
+	}
+}
+
+int main( int argc, const char* argv[])
+{
+	int rt = 0;
+	if (argc > 1)
+	{
+		std::cerr << "usage: " << argv[0] << std::endl;
+		return (std::strcmp( argv[1], "-h") == 0 || std::strcmp( argv[1], "--help") == 0) ? 0 : 1;
+	}
+	try
+	{
+		g_errorhnd = strus::createErrorBuffer_standard( 0, 1, NULL);
+		if (!g_errorhnd) throw std::runtime_error("failed to create error buffer object");
+		g_fileLocator = strus::createFileLocator_std( g_errorhnd);
+		if (!g_fileLocator) throw std::runtime_error("failed to create file locator");
+		strus::local_ptr<strus::AnalyzerObjectBuilderInterface> objbuild(
+			strus::createAnalyzerObjectBuilder_default( g_fileLocator, g_errorhnd));
+		if (!objbuild.get()) throw std::runtime_error("failed to create analyzer object builder");
+
+		std::string content = createDocument();
+		for (int ti=0; g_testCases[ ti].name; ++ti)
+		{
+			runTest( objbuild.get(), g_testCases[ ti], content);
+		}
+		testMultiValueChain( objbuild.get());
+		std::cerr << "OK" << std::endl;
+		rt = 0;
+	}
+	catch (const std::bad_alloc&)
+	{
+		std::cerr << "ERROR memory allocation error" << std::endl;
+		rt = 2;
+	}
+	catch (const std::runtime_error& e)
+	{
+		std::cerr << "ERROR " << e.what() << std::endl;
+		rt = 1;
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "EXCEPTION " << e.what() << std::endl;
+		rt = 1;
+	}
+	if (g_fileLocator)
+	{
+		delete g_fileLocator;
+	}
+	if (g_errorhnd)
+	{
+		delete g_errorhnd;
+	}
+	return rt;
+}
+
@@ -50,6 +50,11 @@ static const Test g_test[] =
 	{"substrmap","ABCDEF5GHI", {"A=B,B=C,C=D,D=E,E=F,F=G", 0}, "BCDEFG5GHI"},
 	{"entityid","\"’`'?!/;:.,–-— )(+&%*#^[]{}<>_", {0}, "-"},
 	{"entityid","A\"BB’`'?!CC/;:.,–-D— )БВ(+&%*Ѝ#^[]E{}<>_F", {0}, "A-BB-CC-D-БВ-Ѝ-E-F"},
+	{"lc","Hello World", {0}, "hello world"},
+	{"uc","Hello World", {0}, "HELLO WORLD"},
+	{"trim","  Hello World ", {0}, "Hello World"},
+	{"wordjoin","  Hello   World ", {"_",0}, "Hello_World"},
+	{"stem","running", {"en",0}, "run"},
 	{0,0,{0},0}
 };
 
@@ -95,6 +100,16 @@ int main( int argc, const char* argv[])
 				std::cerr << " got '" << result << "' but expected '" << ti->output << "'" << std::endl;
 				throw std::runtime_error( "result not as expected");
 			}
+			// Normalization of a batch (the input twice) has to give the same result:
+			strus::analyzer::TokenSpan batch[ 2] = {
+				strus::analyzer::TokenSpan( ti->input, inputlen),
+				strus::analyzer::TokenSpan( ti->input, inputlen)};
+			strus::analyzer::NormalizedOutput batchOutput;
+			inst->normalizeBatch( batch, 2, batchOutput);
+			if (batchOutput.nofTokens() != 2 || batchOutput.normalizeResult( 0) != result || batchOutput.normalizeResult( 1) != result)
+			{
+				throw std::runtime_error( "result of batch normalization not as expected");
+			}
 			std::cerr << " result '" << ti->output << "'" << std::endl;
 		}
 		std::cerr << "OK" << std::endl;
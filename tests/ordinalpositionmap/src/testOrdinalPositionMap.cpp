@@ -0,0 +1,327 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Test of the map of term source positions to ordinal positions against the map implemented with std::set and std::map used before
+/// \file testOrdinalPositionMap.cpp
+#include "ordinalPositionMap.hpp"
+#include "bindTerm.hpp"
+#include "strus/analyzer/position.hpp"
+#include "strus/analyzer/positionBind.hpp"
+#include "strus/base/pseudoRandom.hpp"
+#include <iostream>
+#include <sstream>
+#include <cstring>
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+#include <set>
+#include <map>
+
+static strus::PseudoRandom g_random;
+
+typedef std::map<strus::analyzer::Position, unsigned int> PositionMap;
+
+/// \brief Position map as built by the segment processor before the introduction of the OrdinalPositionMap
+static void fillPositionSet( std::set<strus::analyzer::Position>& pset, std::set<strus::analyzer::Position>& pset_unique, const std::vector<strus::BindTerm>& terms)
+{
+	std::vector<strus::BindTerm>::const_iterator ri = terms.begin(), re = terms.end();
+	for (; ri != re; ++ri)
+	{
+		if (ri->posbind() == strus::analyzer::BindContent)
+		{
+			pset.insert( strus::analyzer::Position( ri->seg(), ri->ofs()+1));
+		}
+		else if (ri->posbind() == strus::analyzer::BindUnique)
+		{
+			pset_unique.insert( strus::analyzer::Position( ri->seg(), ri->ofs()+1));
+		}
+	}
+}
+
+static void mergeUniquePositionSet( std::set<strus::analyzer::Position>& pset, const std::set<strus::analyzer::Position>& pset_unique)
+{
+	std::set<strus::analyzer::Position>::const_iterator si = pset.begin(), se = pset.end();
+	std::set<strus::analyzer::Position>::const_iterator ui = pset_unique.begin(), ue = pset_unique.end();
+	while (si != se && ui != ue)
+	{
+		while (*si < *ui && si != se) ++si;
+		if (si != se)
+		{
+			for (++ui; ui != ue && *ui <= *si; ++ui){}
+			// ... take only the last of a unique sequence
+			std::set<strus::analyzer::Position>::const_iterator lastinseq = ui;
+			--lastinseq;
+			pset.insert( *lastinseq);
+		}
+	}
+	if (ui != ue)
+	{
+		std::set<strus::analyzer::Position>::const_iterator lastinseq = ue;
+		--lastinseq;
+		pset.insert( *lastinseq);
+	}
+}
+
+static PositionMap getPositionMap( const std::set<strus::analyzer::Position>& pset)
+{
+	PositionMap posmap;
+	std::set<strus::analyzer::Position>::const_iterator pi = pset.begin(), pe = pset.end();
+	unsigned int pcnt = 0;
+	for (; pi != pe; ++pi)
+	{
+		posmap[ *pi] = ++pcnt;
+	}
+	return posmap;
+}
+
+static unsigned int getOrdinalTermPosition( const PositionMap& posmap, const strus::BindTerm& term)
+{
+	switch (term.posbind())
+	{
+		case strus::analyzer::BindContent:
+		{
+			PositionMap::const_iterator
+				mi = posmap.find( strus::analyzer::Position( term.seg(), term.ofs()+1));
+			return (mi != posmap.end()) ? mi->second : 0;
+		}
+		case strus::analyzer::BindUnique:
+		case strus::analyzer::BindSuccessor:
+		{
+			PositionMap::const_iterator
+				mi = posmap.upper_bound( strus::analyzer::Position( term.seg(), term.ofs()));
+			return (mi != posmap.end()) ? mi->second : 0;
+		}
+		case strus::analyzer::BindPredecessor:
+		{
+			PositionMap::const_iterator
+				mi = posmap.upper_bound( strus::analyzer::Position( term.seg(), term.ofs()+1));
+			return (mi != posmap.end() && mi->second > 1) ? (mi->second - 1) : 0;
+		}
+	}
+	return 0;
+}
+
+static unsigned int getOrdinalPosition( const PositionMap& posmap, const strus::analyzer::Position& pos)
+{
+	PositionMap::const_iterator pi = posmap.lower_bound( pos);
+	if (pi == posmap.end())
+	{
+		return posmap.empty() ? 1 : posmap.rbegin()->second+1;
+	}
+	else
+	{
+		return pi->second;
+	}
+}
+
+static std::vector<strus::BindTerm> createRandomTerms( unsigned int maxNofTerms)
+{
+	static const strus::analyzer::PositionBind posbindar[] = {
+		strus::analyzer::BindContent, strus::analyzer::BindSuccessor, strus::analyzer::BindPredecessor, strus::analyzer::BindUnique};
+	std::vector<strus::BindTerm> rt;
+	// ... few segments and offsets to get many collisions, many terms to get the radix sort used
+	unsigned int nofTerms = g_random.get( 0, maxNofTerms+1);
+	int maxseg = g_random.get( 1, 10);
+	int maxofs = g_random.get( 1, 30);
+	unsigned int ti = 0;
+	for (; ti < nofTerms; ++ti)
+	{
+		int seg = g_random.get( 0, maxseg) * 1000;
+		int ofs = g_random.get( 0, maxofs);
+		strus::analyzer::PositionBind posbind = posbindar[ g_random.get( 0, 4)];
+		rt.push_back( strus::BindTerm( seg, ofs, ofs+1, 1/*ordlen*/, 0/*priority*/, posbind, 0/*typeidx*/, 0/*typeord*/, 0/*valueofs*/, 0/*valuesize*/));
+	}
+	return rt;
+}
+
+static std::string termString( const strus::BindTerm& term)
+{
+	static const char* posbindName[] = {"content","successor","predecessor","unique"};
+	std::ostringstream out;
+	out << "(" << term.seg() << "," << term.ofs() << ") " << posbindName[ term.posbind()];
+	return out.str();
+}
+
+static void runTest( strus::OrdinalPositionMap& map, unsigned int testidx, unsigned int maxNofTerms)
+{
+	std::vector<strus::BindTerm> searchTerms = createRandomTerms( maxNofTerms);
+	std::vector<strus::BindTerm> forwardTerms = createRandomTerms( maxNofTerms);
+
+	// Map built as done before:
+	std::set<strus::analyzer::Position> pset;
+	std::set<strus::analyzer::Position> pset_unique;
+	fillPositionSet( pset, pset_unique, searchTerms);
+	fillPositionSet( pset, pset_unique, forwardTerms);
+	mergeUniquePositionSet( pset, pset_unique);
+	PositionMap posmap = getPositionMap( pset);
+
+	// Map tested, reused for all tests:
+	map.clear();
+	map.collect( searchTerms);
+	map.collect( forwardTerms);
+	map.build();
+
+	if (map.size() != posmap.size())
+	{
+		std::ostringstream msg;
+		msg << "test " << testidx << ": number of positions " << map.size() << " differs from expected " << posmap.size();
+		throw std::runtime_error( msg.str());
+	}
+	std::vector<unsigned int> ordpos;
+	const std::vector<strus::BindTerm>* termsar[2] = {&searchTerms, &forwardTerms};
+	for (int ai=0; ai < 2; ++ai)
+	{
+		const std::vector<strus::BindTerm>& terms = *termsar[ ai];
+		map.assign( ordpos, terms);
+		if (ordpos.size() != terms.size())
+		{
+			std::ostringstream msg;
+			msg << "test " << testidx << ": number of ordinal positions assigned " << ordpos.size() << " differs from number of terms " << terms.size();
+			throw std::runtime_error( msg.str());
+		}
+		std::size_t ti = 0, te = terms.size();
+		for (; ti != te; ++ti)
+		{
+			unsigned int expected = getOrdinalTermPosition( posmap, terms[ ti]);
+			if (ordpos[ ti] != expected)
+			{
+				std::ostringstream msg;
+				msg << "test " << testidx << ": ordinal position " << ordpos[ ti] << " of term " << termString( terms[ ti]) << " differs from expected " << expected;
+				throw std::runtime_error( msg.str());
+			}
+		}
+	}
+	// Ordinal positions of structure boundaries:
+	int pi = 0, pe = 30;
+	for (; pi != pe; ++pi)
+	{
+		strus::analyzer::Position pos( g_random.get( 0, 11) * 1000, g_random.get( 0, 32));
+		unsigned int expected = getOrdinalPosition( posmap, pos);
+		unsigned int result = map.ordinalPosition( pos);
+		if (result != expected)
+		{
+			std::ostringstream msg;
+			msg << "test " << testidx << ": ordinal position " << result << " of (" << pos.seg() << "," << pos.ofs() << ") differs from expected " << expected;
+			throw std::runtime_error( msg.str());
+		}
+	}
+}
+
+/// \brief Test of the assignment of ordinal positions to the few terms bound to content of a query without building a map
+static void runSmallContentTest( unsigned int testidx)
+{
+	std::vector<strus::BindTerm> terms;
+	// ... sizes around the limit of the small list assignment, few offsets to get many collisions
+	unsigned int nofTerms = g_random.get( 0, strus::OrdinalPositionMap::MaxSmallContentSize + 3);
+	int maxseg = g_random.get( 1, 4);
+	int maxofs = g_random.get( 1, 20);
+	unsigned int ti = 0;
+	for (; ti < nofTerms; ++ti)
+	{
+		int seg = g_random.get( 0, maxseg);
+		int ofs = g_random.get( 0, maxofs);
+		terms.push_back( strus::BindTerm( seg, ofs, ofs+1, 1/*ordlen*/, 0/*priority*/, strus::analyzer::BindContent, 0/*typeidx*/, 0/*typeord*/, 0/*valueofs*/, 0/*valuesize*/));
+	}
+	std::vector<unsigned int> ordpos;
+	bool assigned = strus::OrdinalPositionMap::assignSmallContent( ordpos, terms);
+	if (assigned != (terms.size() <= strus::OrdinalPositionMap::MaxSmallContentSize))
+	{
+		std::ostringstream msg;
+		msg << "test " << testidx << ": small list assignment " << (assigned ? "done" : "refused") << " for " << terms.size() << " terms";
+		throw std::runtime_error( msg.str());
+	}
+	if (!assigned) return;
+
+	std::set<strus::analyzer::Position> pset;
+	std::set<strus::analyzer::Position> pset_unique;
+	fillPositionSet( pset, pset_unique, terms);
+	PositionMap posmap = getPositionMap( pset);
+
+	for (ti = 0; ti < nofTerms; ++ti)
+	{
+		unsigned int expected = getOrdinalTermPosition( posmap, terms[ ti]);
+		if (ordpos[ ti] != expected)
+		{
+			std::ostringstream msg;
+			msg << "test " << testidx << ": ordinal position " << ordpos[ ti] << " of term " << termString( terms[ ti]) << " in small list differs from expected " << expected;
+			throw std::runtime_error( msg.str());
+		}
+	}
+	// ... terms not bound to content are refused:
+	if (!terms.empty())
+	{
+		terms.back() = strus::BindTerm( 0, 0, 1, 1/*ordlen*/, 0/*priority*/, strus::analyzer::BindSuccessor, 0/*typeidx*/, 0/*typeord*/, 0/*valueofs*/, 0/*valuesize*/);
+		if (strus::OrdinalPositionMap::assignSmallContent( ordpos, terms))
+		{
+			std::ostringstream msg;
+			msg << "test " << testidx << ": small list assignment done for term not bound to content";
+			throw std::runtime_error( msg.str());
+		}
+	}
+}
+
+static unsigned int getUintValue( const char* arg)
+{
+	unsigned int rt = 0, prev = 0;
+	char const* cc = arg;
+	for (; *cc; ++cc)
+	{
+		if (*cc < '0' || *cc > '9') throw std::runtime_error( std::string( "parameter is not a non negative integer number: ") + arg);
+		rt = (rt * 10) + (*cc - '0');
+		if (rt < prev) throw std::runtime_error( std::string( "parameter out of range: ") + arg);
+		prev = rt;
+	}
+	return rt;
+}
+
+static void printUsage( int argc, const char* argv[])
+{
+	std::cerr << "usage: " << argv[0] << " <nofTests> <maxNofTerms>" << std::endl;
+	std::cerr << "<nofTests> = number of random tests to run" << std::endl;
+	std::cerr << "<maxNofTerms> = maximum number of search and of forward terms of a test" << std::endl;
+}
+
+int main( int argc, const char* argv[])
+{
+	if (argc <= 1 || std::strcmp( argv[1], "-h") == 0 || std::strcmp( argv[1], "--help") == 0)
+	{
+		printUsage( argc, argv);
+		return 0;
+	}
+	else if (argc != 3)
+	{
+		std::cerr << "ERROR wrong number of parameters" << std::endl;
+		printUsage( argc, argv);
+		return 1;
+	}
+	try
+	{
+		unsigned int nofTests = getUintValue( argv[1]);
+		unsigned int maxNofTerms = getUintValue( argv[2]);
+
+		strus::OrdinalPositionMap map;
+		unsigned int ti = 0;
+		for (; ti < nofTests; ++ti)
+		{
+			runTest( map, ti, maxNofTerms);
+			runSmallContentTest( ti);
+		}
+		std::cerr << "OK " << nofTests << " tests" << std::endl;
+		return 0;
+	}
+	catch (const std::bad_alloc&)
+	{
+		std::cerr << "ERROR memory allocation error" << std::endl;
+		return 2;
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "ERROR " << e.what() << std::endl;
+		return 1;
+	}
+}
+
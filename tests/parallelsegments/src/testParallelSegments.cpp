@@ -0,0 +1,299 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Test of the parallel processing of the segments of big documents, comparing the results with sequential processing
+/// \file testParallelSegments.cpp
+#include "strus/lib/analyzer_objbuild.hpp"
+#include "strus/lib/error.hpp"
+#include "strus/lib/filelocator.hpp"
+#include "strus/errorBufferInterface.hpp"
+#include "strus/fileLocatorInterface.hpp"
+#include "strus/segmenterInterface.hpp"
+#include "strus/documentAnalyzerInstanceInterface.hpp"
+#include "strus/documentAnalyzerContextInterface.hpp"
+#include "strus/analyzer/documentClass.hpp"
+#include "strus/analyzer/document.hpp"
+#include "strus/textProcessorInterface.hpp"
+#include "strus/normalizerFunctionInterface.hpp"
+#include "strus/normalizerFunctionInstanceInterface.hpp"
+#include "strus/tokenizerFunctionInterface.hpp"
+#include "strus/tokenizerFunctionInstanceInterface.hpp"
+#include "strus/analyzerObjectBuilderInterface.hpp"
+#include "strus/base/local_ptr.hpp"
+#include "strus/analyzer/featureOptions.hpp"
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <iostream>
+#include <sstream>
+
+static strus::ErrorBufferInterface* g_errorhnd = 0;
+static strus::FileLocatorInterface* g_fileLocator = 0;
+
+#define NOF_THREADS 4
+
+enum FeatureType {Attribute,SearchIndex,ForwardIndex};
+
+static void defineFeature( strus::DocumentAnalyzerInstanceInterface* analyzer, const strus::TextProcessorInterface* textproc, FeatureType type, const char* name, const char* tokenizer, const char* normalizer, const char* normalizerArg, const char* path)
+{
+	const strus::TokenizerFunctionInterface* tk = textproc->getTokenizer( tokenizer);
+	if (!tk) throw std::runtime_error( std::string("unknown tokenizer: '") + tokenizer + "'");
+	strus::local_ptr<strus::TokenizerFunctionInstanceInterface> tki( tk->createInstance( std::vector<std::string>(), textproc));
+	const strus::NormalizerFunctionInterface* nm = textproc->getNormalizer( normalizer);
+	if (!nm) throw std::runtime_error( std::string("unknown normalizer: '") + normalizer + "'");
+	std::vector<std::string> normalizerArgs;
+	if (normalizerArg) normalizerArgs.push_back( normalizerArg);
+	strus::local_ptr<strus::NormalizerFunctionInstanceInterface> nmi( nm->createInstance( normalizerArgs, textproc));
+	if (!tki.get() || !nmi.get()) throw std::runtime_error( "failed to create feature functions");
+	std::vector<strus::NormalizerFunctionInstanceInterface*> normalizers( 1, nmi.release());
+	switch (type)
+	{
+		case Attribute:
+			analyzer->defineAttribute( name, path, tki.release(), normalizers);
+			break;
+		case SearchIndex:
+			analyzer->addSearchIndexFeature( name, path, tki.release(), normalizers, 0/*priority*/, strus::analyzer::FeatureOptions());
+			break;
+		case ForwardIndex:
+			analyzer->addForwardIndexFeature( name, path, tki.release(), normalizers, 0/*priority*/, strus::analyzer::FeatureOptions());
+			break;
+	}
+}
+
+/// \brief Complete dump of a document with all elements in a unique order
+static std::string documentToString( const strus::analyzer::Document& doc)
+{
+	std::ostringstream output;
+	output << "DOC " << doc.subDocumentTypeName() << std::endl;
+	std::vector<strus::analyzer::DocumentAttribute>::const_iterator
+		ai = doc.attributes().begin(), ae = doc.attributes().end();
+	for (; ai != ae; ++ai)
+	{
+		output << "Attribute " << ai->name() << " = '" << ai->value() << "'" << std::endl;
+	}
+	std::vector<strus::analyzer::DocumentMetaData>::const_iterator
+		mi = doc.metadata().begin(), me = doc.metadata().end();
+	for (; mi != me; ++mi)
+	{
+		output << "MetaData " << mi->name() << " = '" << mi->value().tostring().c_str() << "'" << std::endl;
+	}
+	std::vector<strus::analyzer::DocumentTerm> searchIndexTerms = doc.searchIndexTerms();
+	std::sort( searchIndexTerms.begin(), searchIndexTerms.end());
+	std::vector<strus::analyzer::DocumentTerm>::const_iterator
+		ti = searchIndexTerms.begin(), te = searchIndexTerms.end();
+	for (; ti != te; ++ti)
+	{
+		output << "SearchTerm term " << ti->type() << " '" << ti->value() << "' at " << ti->pos() << std::endl;
+	}
+	std::vector<strus::analyzer::DocumentTerm> forwardIndexTerms = doc.forwardIndexTerms();
+	std::sort( forwardIndexTerms.begin(), forwardIndexTerms.end());
+	ti = forwardIndexTerms.begin(), te = forwardIndexTerms.end();
+	for (; ti != te; ++ti)
+	{
+		output << "ForwardIndex term " << ti->type() << " '" << ti->value() << "' at " << ti->pos() << std::endl;
+	}
+	return output.str();
+}
+
+static const char* g_words[] = {"Running","dogs","are","faster","than","the","Cats","walking","on","streets","of","Zürich","and","München",0};
+
+static std::string createXmlDocument( unsigned int nofParagraphs)
+{
+	std::ostringstream out;
+	out << "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n<doc><title>Parallel test</title>";
+	unsigned int nofWords = sizeof(g_words)/sizeof(g_words[0])-1;
+	for (unsigned int pi=0; pi < nofParagraphs; ++pi)
+	{
+		out << "<text>";
+		unsigned int wi = 0, we = pi % 23 + 1;
+		for (; wi < we; ++wi)
+		{
+			out << " " << g_words[ (pi * 7 + wi) % nofWords];
+		}
+		out << "</text>\n";
+	}
+	out << "</doc>";
+	return out.str();
+}
+
+static std::string createTsvDocument( unsigned int nofRows)
+{
+	std::ostringstream out;
+	out << "title\ttext\tcity\n";
+	unsigned int nofWords = sizeof(g_words)/sizeof(g_words[0])-1;
+	for (unsigned int ri=0; ri < nofRows; ++ri)
+	{
+		out << "row " << ri << "\t";
+		unsigned int wi = 0, we = ri % 11 + 1;
+		for (; wi < we; ++wi)
+		{
+			if (wi) out << " ";
+			out << g_words[ (ri * 3 + wi) % nofWords];
+		}
+		out << "\t" << g_words[ ri % nofWords] << "\n";
+	}
+	return out.str();
+}
+
+struct TestDocument
+{
+	const char* segmenter;
+	const char* mimeType;
+	const char* titleSelector;
+	const char* textSelector;
+	std::string content;
+
+	TestDocument( const char* segmenter_, const char* mimeType_, const char* titleSelector_, const char* textSelector_, const std::string& content_)
+		:segmenter(segmenter_),mimeType(mimeType_),titleSelector(titleSelector_),textSelector(textSelector_),content(content_){}
+};
+
+static strus::DocumentAnalyzerInstanceInterface* createAnalyzer( const strus::AnalyzerObjectBuilderInterface* objbuild, const TestDocument& testdoc, bool parallel)
+{
+	const strus::TextProcessorInterface* textproc = objbuild->getTextProcessor();
+	const strus::SegmenterInterface* segmenter = textproc->getSegmenterByName( testdoc.segmenter);
+	if (!segmenter) throw std::runtime_error( std::string("unknown segmenter: ") + testdoc.segmenter);
+	strus::local_ptr<strus::DocumentAnalyzerInstanceInterface> analyzer( objbuild->createDocumentAnalyzer( segmenter));
+	if (!analyzer.get()) throw std::runtime_error("failed to create document analyzer");
+	defineFeature( analyzer.get(), textproc, Attribute, "title", "content", "orig", 0, testdoc.titleSelector);
+	// ... features with the same selector and tokenizer share the tokenization
+	defineFeature( analyzer.get(), textproc, SearchIndex, "word", "word", "lc", 0, testdoc.textSelector);
+	defineFeature( analyzer.get(), textproc, SearchIndex, "stem", "word", "stem", "en", testdoc.textSelector);
+	defineFeature( analyzer.get(), textproc, SearchIndex, "sent", "punctuation", "orig", 0, testdoc.textSelector);
+	defineFeature( analyzer.get(), textproc, ForwardIndex, "orig", "word", "orig", 0, testdoc.textSelector);
+	if (parallel)
+	{
+		analyzer->defineParallelProcessing( 0/*minDocumentSize*/, NOF_THREADS);
+	}
+	return analyzer.release();
+}
+
+enum FeedMode {FeedCopy,FeedReference,FeedChunks};
+static const char* feedModeName( FeedMode mode)
+{
+	static const char* ar[] = {"copy","reference","chunks"};
+	return ar[ mode];
+}
+
+/// \brief Analyze a document with a context reset for the document, reusing the context and its worker threads
+static std::string analyze( strus::DocumentAnalyzerContextInterface* ctx, const TestDocument& testdoc, FeedMode mode)
+{
+	strus::analyzer::DocumentClass dclass( testdoc.mimeType, "UTF-8");
+	if (!ctx->reset( dclass)) throw std::runtime_error( "failed to reset document analyzer context");
+	switch (mode)
+	{
+		case FeedCopy:
+			ctx->putInput( testdoc.content.c_str(), testdoc.content.size(), true);
+			break;
+		case FeedReference:
+			ctx->putInputReference( testdoc.content.c_str(), testdoc.content.size(), true);
+			break;
+		case FeedChunks:
+		{
+			enum {ChunkSize=7777};
+			std::size_t pos = 0;
+			for (; pos + ChunkSize < testdoc.content.size(); pos += ChunkSize)
+			{
+				ctx->putInput( testdoc.content.c_str() + pos, ChunkSize, false);
+			}
+			ctx->putInput( testdoc.content.c_str() + pos, testdoc.content.size() - pos, true);
+			break;
+		}
+	}
+	std::string rt;
+	strus::analyzer::Document doc;
+	while (ctx->analyzeNext( doc))
+	{
+		rt.append( documentToString( doc));
+	}
+	if (g_errorhnd->hasError())
+	{
+		throw std::runtime_error( g_errorhnd->fetchError());
+	}
+	return rt;
+}
+
+int main( int argc, const char* argv[])
+{
+	int rt = 0;
+	if (argc > 1)
+	{
+		std::cerr << "usage: " << argv[0] << std::endl;
+		return (std::strcmp( argv[1], "-h") == 0 || std::strcmp( argv[1], "--help") == 0) ? 0 : 1;
+	}
+	try
+	{
+		g_errorhnd = strus::createErrorBuffer_standard( 0, NOF_THREADS+1, NULL);
+		if (!g_errorhnd) throw std::runtime_error("failed to create error buffer object");
+		g_fileLocator = strus::createFileLocator_std( g_errorhnd);
+		if (!g_fileLocator) throw std::runtime_error("failed to create file locator");
+		strus::local_ptr<strus::AnalyzerObjectBuilderInterface> objbuild(
+			strus::createAnalyzerObjectBuilder_default( g_fileLocator, g_errorhnd));
+		if (!objbuild.get()) throw std::runtime_error("failed to create analyzer object builder");
+
+		std::vector<TestDocument> testdocs;
+		testdocs.push_back( TestDocument( "textwolf", "application/xml", "/doc/title()", "/doc/text()", createXmlDocument( 3000)));
+		testdocs.push_back( TestDocument( "tsv", "text/tab-separated-values", "title", "text", createTsvDocument( 3000)));
+
+		std::vector<TestDocument>::const_iterator di = testdocs.begin(), de = testdocs.end();
+		for (; di != de; ++di)
+		{
+			strus::local_ptr<strus::DocumentAnalyzerInstanceInterface> sequentialAnalyzer( createAnalyzer( objbuild.get(), *di, false));
+			strus::local_ptr<strus::DocumentAnalyzerInstanceInterface> parallelAnalyzer( createAnalyzer( objbuild.get(), *di, true));
+			strus::analyzer::DocumentClass dclass( di->mimeType, "UTF-8");
+			strus::local_ptr<strus::DocumentAnalyzerContextInterface> sequentialContext( sequentialAnalyzer->createContext( dclass));
+			strus::local_ptr<strus::DocumentAnalyzerContextInterface> parallelContext( parallelAnalyzer->createContext( dclass));
+			if (!sequentialContext.get() || !parallelContext.get()) throw std::runtime_error( "failed to create document analyzer context");
+
+			std::string expected = analyze( sequentialContext.get(), *di, FeedCopy);
+			if (expected.empty()) throw std::runtime_error( std::string("empty result analyzing document with segmenter ") + di->segmenter);
+
+			FeedMode modes[] = {FeedCopy,FeedReference,FeedChunks};
+			for (unsigned int mi=0; mi < sizeof(modes)/sizeof(modes[0]); ++mi)
+			{
+				// ... analyze twice, the second time with the worker threads started already
+				for (int ri=0; ri < 2; ++ri)
+				{
+					std::string result = analyze( parallelContext.get(), *di, modes[ mi]);
+					if (result != expected)
+					{
+						std::cerr << "EXPECTED:" << std::endl << expected.substr( 0, 2000) << std::endl << "GOT:" << std::endl << result.substr( 0, 2000) << std::endl;
+						throw std::runtime_error( std::string("result of parallel processing differs from sequential processing, segmenter ") + di->segmenter + ", feed " + feedModeName( modes[ mi]));
+					}
+				}
+			}
+		}
+		std::cerr << "OK" << std::endl;
+		rt = 0;
+	}
+	catch (const std::bad_alloc&)
+	{
+		std::cerr << "ERROR memory allocation error" << std::endl;
+		rt = 2;
+	}
+	catch (const std::runtime_error& e)
+	{
+		std::cerr << "ERROR " << e.what() << std::endl;
+		rt = 1;
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "EXCEPTION " << e.what() << std::endl;
+		rt = 1;
+	}
+	if (g_fileLocator)
+	{
+		delete g_fileLocator;
+	}
+	if (g_errorhnd)
+	{
+		delete g_errorhnd;
+	}
+	return rt;
+}
+
@@ -16,6 +16,7 @@
 #include "strus/segmenterContextInterface.hpp"
 #include "strus/documentAnalyzerInstanceInterface.hpp"
 #include "strus/documentAnalyzerContextInterface.hpp"
+#include "strus/documentSinkInterface.hpp"
 #include "strus/analyzer/documentClass.hpp"
 #include "strus/textProcessorInterface.hpp"
 #include "strus/aggregatorFunctionInterface.hpp"
@@ -84,7 +85,7 @@ struct FuncDef
 	}
 };
 
-static void loadAnalyzerConfig( strus::DocumentAnalyzerInstanceInterface* analyzer, const strus::TextProcessorInterface* textproc)
+static void loadAnalyzerConfig( strus::DocumentAnalyzerInstanceInterface* analyzer, const strus::TextProcessorInterface* textproc, bool withAggregator)
 {
 	static const ConfigItem config[32] =
 	{
@@ -100,10 +101,13 @@ static void loadAnalyzerConfig( strus::DocumentAnalyzerInstanceInterface* analyz
 		{ConfigItem::Attribute,0,{0},0,0}
 	};
 	analyzer->defineSubDocument( "doc", "/doc");
-	const strus::AggregatorFunctionInterface* aggf = textproc->getAggregator( "count");
-	strus::local_ptr<strus::AggregatorFunctionInstanceInterface> aggfi( aggf->createInstance( std::vector<std::string>( 1,"stem")));
-	analyzer->defineAggregatedMetaData( "doclen", aggfi.get());
-	(void)aggfi.release();
+	if (withAggregator)
+	{
+		const strus::AggregatorFunctionInterface* aggf = textproc->getAggregator( "count");
+		strus::local_ptr<strus::AggregatorFunctionInstanceInterface> aggfi( aggf->createInstance( std::vector<std::string>( 1,"stem")));
+		analyzer->defineAggregatedMetaData( "doclen", aggfi.get());
+		(void)aggfi.release();
+	}
 
 	ConfigItem const* ci = config;
 	for (; ci->name; ++ci)
@@ -155,6 +159,161 @@ static void loadAnalyzerConfig( strus::DocumentAnalyzerInstanceInterface* analyz
 	}
 }
 
+/// \brief Document sink building documents from the events, checking that the events are passed in a document frame
+class TestDocumentSink
+	:public strus::DocumentSinkInterface
+{
+public:
+	TestDocumentSink()
+		:m_docs(),m_open(false){}
+	virtual ~TestDocumentSink(){}
+
+	virtual void startDocument( const char* subDocumentTypeName, std::size_t subDocumentTypeNameSize)
+	{
+		if (m_open) throw std::runtime_error( "document sink: start of document before end of previous document");
+		m_open = true;
+		m_docs.push_back( strus::analyzer::Document());
+		m_docs.back().setSubDocumentTypeName( std::string( subDocumentTypeName, subDocumentTypeNameSize));
+	}
+	virtual void addSearchIndexTerm( const char* type, std::size_t typesize, const char* value, std::size_t valuesize, unsigned int pos)
+	{
+		current().addSearchIndexTerm( std::string( type, typesize), std::string( value, valuesize), pos);
+	}
+	virtual void addForwardIndexTerm( const char* type, std::size_t typesize, const char* value, std::size_t valuesize, unsigned int pos)
+	{
+		current().addForwardIndexTerm( std::string( type, typesize), std::string( value, valuesize), pos);
+	}
+	virtual void setMetaData( const char* name, std::size_t namesize, const strus::NumericVariant& value)
+	{
+		current().setMetaData( std::string( name, namesize), value);
+	}
+	virtual void setAttribute( const char* name, std::size_t namesize, const char* value, std::size_t valuesize)
+	{
+		current().setAttribute( std::string( name, namesize), std::string( value, valuesize));
+	}
+	virtual void addAccess( const char* userRoleName, std::size_t userRoleNameSize)
+	{
+		current().addAccess( std::string( userRoleName, userRoleNameSize));
+	}
+	virtual void addSearchIndexStructure( const char* name, std::size_t namesize, const strus::analyzer::DocumentStructure::PositionRange& header, const strus::analyzer::DocumentStructure::PositionRange& content)
+	{
+		current().addSearchIndexStructure( std::string( name, namesize), header, content);
+	}
+	virtual void endDocument()
+	{
+		if (!m_open) throw std::runtime_error( "document sink: end of document without start");
+		m_open = false;
+	}
+
+	const std::vector<strus::analyzer::Document>& documents() const
+	{
+		if (m_open) throw std::runtime_error( "document sink: last document not terminated");
+		return m_docs;
+	}
+
+private:
+	strus::analyzer::Document& current()
+	{
+		if (!m_open) throw std::runtime_error( "document sink: element passed outside of a document");
+		return m_docs.back();
+	}
+
+private:
+	std::vector<strus::analyzer::Document> m_docs;
+	bool m_open;
+};
+
+/// \brief Complete dump of a document with all elements in a unique order
+static std::string documentToString( const strus::analyzer::Document& doc)
+{
+	std::ostringstream output;
+	output << "DOC " << doc.subDocumentTypeName() << std::endl;
+	std::vector<strus::analyzer::DocumentAttribute>::const_iterator
+		ai = doc.attributes().begin(), ae = doc.attributes().end();
+	for (; ai != ae; ++ai)
+	{
+		output << "Attribute " << ai->name() << " = '" << ai->value() << "'" << std::endl;
+	}
+	std::vector<strus::analyzer::DocumentMetaData>::const_iterator
+		mi = doc.metadata().begin(), me = doc.metadata().end();
+	for (; mi != me; ++mi)
+	{
+		output << "MetaData " << mi->name() << " = '" << mi->value().tostring().c_str() << "'" << std::endl;
+	}
+	std::vector<std::string>::const_iterator
+		xi = doc.accessList().begin(), xe = doc.accessList().end();
+	for (; xi != xe; ++xi)
+	{
+		output << "Access " << *xi << std::endl;
+	}
+	std::vector<strus::analyzer::DocumentTerm> searchIndexTerms = doc.searchIndexTerms();
+	std::sort( searchIndexTerms.begin(), searchIndexTerms.end());
+	std::vector<strus::analyzer::DocumentTerm>::const_iterator
+		ti = searchIndexTerms.begin(), te = searchIndexTerms.end();
+	for (; ti != te; ++ti)
+	{
+		output << "SearchTerm term " << ti->type() << " '" << ti->value() << "' at " << ti->pos() << std::endl;
+	}
+	std::vector<strus::analyzer::DocumentTerm> forwardIndexTerms = doc.forwardIndexTerms();
+	std::sort( forwardIndexTerms.begin(), forwardIndexTerms.end());
+	ti = forwardIndexTerms.begin(), te = forwardIndexTerms.end();
+	for (; ti != te; ++ti)
+	{
+		output << "ForwardIndex term " << ti->type() << " '" << ti->value() << "' at " << ti->pos() << std::endl;
+	}
+	std::vector<strus::analyzer::DocumentStructure>::const_iterator
+		si = doc.searchIndexStructures().begin(), se = doc.searchIndexStructures().end();
+	for (; si != se; ++si)
+	{
+		output << "Structure " << si->name()
+			<< " [" << si->source().start() << "," << si->source().end() << "]"
+			<< " [" << si->sink().start() << "," << si->sink().end() << "]" << std::endl;
+	}
+	return output.str();
+}
+
+/// \brief Test that the events passed to a document sink are equal to the documents built by the analyzer
+static void testDocumentSink( const strus::DocumentAnalyzerInstanceInterface* analyzer, const strus::analyzer::DocumentClass& documentClass, const std::string& inputsrc)
+{
+	std::vector<std::string> expected;
+	strus::local_ptr<strus::DocumentAnalyzerContextInterface> docctx( analyzer->createContext( documentClass));
+	if (!docctx.get()) throw std::runtime_error( "failed to create document analyzer context");
+	docctx->putInput( inputsrc.c_str(), inputsrc.size(), true);
+	strus::analyzer::Document doc;
+	while (docctx->analyzeNext( doc))
+	{
+		expected.push_back( documentToString( doc));
+	}
+	TestDocumentSink sink;
+	strus::local_ptr<strus::DocumentAnalyzerContextInterface> sinkctx( analyzer->createContext( documentClass));
+	if (!sinkctx.get()) throw std::runtime_error( "failed to create document analyzer context");
+	sinkctx->putInput( inputsrc.c_str(), inputsrc.size(), true);
+	std::size_t nofEvents = 0;
+	while (sinkctx->analyzeNext( sink))
+	{
+		if (sink.documents().size() != ++nofEvents) throw std::runtime_error( "document sink: not exactly one document passed with one call of analyzeNext");
+	}
+	if (g_errorhnd->hasError())
+	{
+		throw std::runtime_error( g_errorhnd->fetchError());
+	}
+	const std::vector<strus::analyzer::Document>& result = sink.documents();
+	if (result.size() != expected.size() || expected.empty())
+	{
+		throw std::runtime_error( "number of documents passed to document sink not as expected");
+	}
+	std::vector<strus::analyzer::Document>::const_iterator ri = result.begin(), re = result.end();
+	std::vector<std::string>::const_iterator ei = expected.begin();
+	for (; ri != re; ++ri,++ei)
+	{
+		if (documentToString( *ri) != *ei)
+		{
+			std::cerr << "EXPECTED:" << std::endl << *ei << "GOT:" << std::endl << documentToString( *ri);
+			throw std::runtime_error( "document passed to document sink differs from document analyzed");
+		}
+	}
+}
+
 int main( int argc, const char* argv[])
 {
 	int rt = 0;
@@ -231,7 +390,7 @@ int main( int argc, const char* argv[])
 		const strus::TextProcessorInterface* textproc = objbuild->getTextProcessor();
 		const strus::SegmenterInterface* segmenter = textproc->getSegmenterByName( "textwolf");
 		strus::local_ptr<strus::DocumentAnalyzerInstanceInterface> analyzer( objbuild->createDocumentAnalyzer( segmenter));
-		loadAnalyzerConfig( analyzer.get(), textproc);
+		loadAnalyzerConfig( analyzer.get(), textproc, true/*withAggregator*/);
 
 		std::string inputsrc;
 		unsigned int ec;
@@ -293,6 +452,13 @@ int main( int argc, const char* argv[])
 		{
 			throw std::runtime_error("output not as expected");
 		}
+
+		// Documents passed to a sink, with aggregated meta data (materialized document) and without (direct output):
+		testDocumentSink( analyzer.get(), documentClass, inputsrc);
+		strus::local_ptr<strus::DocumentAnalyzerInstanceInterface> analyzerNoAggr( objbuild->createDocumentAnalyzer( segmenter));
+		if (!analyzerNoAggr.get()) throw std::runtime_error( "failed to create document analyzer");
+		loadAnalyzerConfig( analyzerNoAggr.get(), textproc, false/*withAggregator*/);
+		testDocumentSink( analyzerNoAggr.get(), documentClass, inputsrc);
 		std::cerr << "OK" << std::endl;
 		rt = 0;
 	}
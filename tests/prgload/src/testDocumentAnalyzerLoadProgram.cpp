@@ -51,6 +51,7 @@ static void printUsage( int argc, const char* argv[])
 	std::cerr << "options:"<< std::endl;
 	std::cerr << "-h|--help         = print this usage" << std::endl;
 	std::cerr << "-G|--debug <SEL>  = print debug info of name <SEL>" << std::endl;
+	std::cerr << "-M|--mapped       = feed the document mapped into memory with putInputMapped" << std::endl;
 }
 
 static std::string getFilePath( const std::string& resourcedir, const std::string& filename)
@@ -80,6 +81,7 @@ int main( int argc, const char* argv[])
 		// Parse arguments:
 		int argi = 1;
 		std::vector<std::string> debugselectors;
+		bool mapped = false;
 		for (; argi < argc && argv[ argi][ 0] == '-'; ++argi)
 		{
 			if (std::strcmp( argv[ argi], "-h") == 0 || std::strcmp( argv[ argi], "--help") == 0)
@@ -96,6 +98,10 @@ int main( int argc, const char* argv[])
 				}
 				debugselectors.push_back( argv[argi]);
 			}
+			else if (std::strcmp( argv[ argi], "-M") == 0 || std::strcmp( argv[ argi], "--mapped") == 0)
+			{
+				mapped = true;
+			}
 			else if (argv[ argi][ 1] == '-')
 			{
 				++argi;
@@ -175,8 +181,11 @@ int main( int argc, const char* argv[])
 		std::string expectContent;
 
 		int ec;
-		ec = strus::readFile( docFilePath, docContent);
-		if (ec) throw std::runtime_error( strus::string_format("error reading file '%s' with document to process: %s", docFilePath.c_str(), std::strerror(ec)));
+		if (!mapped)
+		{
+			ec = strus::readFile( docFilePath, docContent);
+			if (ec) throw std::runtime_error( strus::string_format("error reading file '%s' with document to process: %s", docFilePath.c_str(), std::strerror(ec)));
+		}
 		ec = strus::readFile( expectFilePath, expectContent);
 		if (ec) throw std::runtime_error( strus::string_format("error reading file '%s' with expected test output: %s", expectFilePath.c_str(), std::strerror(ec)));
 		if (!strus::load_DocumentAnalyzer_programfile_std( analyzer.get(), textproc.get(), programFile, g_errorhnd))
@@ -189,7 +198,14 @@ int main( int argc, const char* argv[])
 		strus::local_ptr<strus::DocumentAnalyzerContextInterface> context( analyzer->createContext( documentClass));
 		if (!context.get()) throw std::runtime_error( "failed to create document analyzer context");
 
-		context->putInput( docContent.c_str(), docContent.size(), true/*EOF*/);
+		if (mapped)
+		{
+			context->putInputMapped( docFilePath);
+		}
+		else
+		{
+			context->putInput( docContent.c_str(), docContent.size(), true/*EOF*/);
+		}
 		if (g_errorhnd->hasError()) throw std::runtime_error( "put input failed");
 		strus::analyzer::Document doc;
 		std::ostringstream out;
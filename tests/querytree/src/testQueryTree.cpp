@@ -253,6 +253,34 @@ private:
 	int m_factor;
 };
 
+/// \brief Normalizer counting its calls and reporting an error for the value "fail", used to test that failed analysis results are not cached
+class FailingNormalizerFunctionInstance :public strus::NormalizerFunctionInstanceInterface
+{
+public:
+	explicit FailingNormalizerFunctionInstance( int* callcnt_)
+		:m_callcnt(callcnt_){}
+	virtual ~FailingNormalizerFunctionInstance(){}
+
+	virtual std::string normalize( const char* src, std::size_t srcsize) const
+	{
+		++*m_callcnt;
+		std::string rt( src, srcsize);
+		if (rt == "fail")
+		{
+			g_errorhnd->report( strus::ErrorCodeRuntimeError, "error in 'fail' normalizer");
+			return std::string();
+		}
+		return rt;
+	}
+	virtual const char* name() const	{return "fail";}
+	virtual strus::StructView view() const
+	{
+		return strus::StructView()("name",name());
+	}
+private:
+	int* m_callcnt;
+};
+
 static int charArrayLength( const char** ar)
 {
 	char const** ai = ar;
@@ -554,6 +582,55 @@ static QueryTree mapExpectedAnalyzedQueryTree( const QueryTree& qt, const char**
 	}
 }
 
+/// \brief Analyze a query with a single field twice with a cached analyzer, checking the error and the number of normalizer calls
+static void testResultCacheQuery( strus::QueryAnalyzerInstanceInterface* qana, const std::string& value, bool expectError, int* callcnt)
+{
+	int callcntStart = *callcnt;
+	for (int ci=0; ci<2; ++ci)
+	{
+		strus::local_ptr<strus::QueryAnalyzerContextInterface> ctx( qana->createContext());
+		if (!ctx.get()) throw std::runtime_error( g_errorhnd->fetchError());
+		ctx->putField( 1, "FAIL", value);
+		strus::analyzer::QueryTermExpression expr = ctx->analyze();
+		if (expectError)
+		{
+			if (!g_errorhnd->hasError()) throw std::runtime_error( "error of normalizer in query analysis not reported");
+			(void)g_errorhnd->fetchError();
+		}
+		else if (g_errorhnd->hasError())
+		{
+			throw std::runtime_error( g_errorhnd->fetchError());
+		}
+	}
+	// ... a failed analysis has to be repeated, a successful one is served from the cache the second time:
+	int expectedNofCalls = expectError ? 2 : 1;
+	if (*callcnt - callcntStart != expectedNofCalls)
+	{
+		throw std::runtime_error( strus::string_format( "query analysis with result cache called normalizer %d times instead of %d for '%s'", *callcnt - callcntStart, expectedNofCalls, value.c_str()));
+	}
+}
+
+static void testResultCacheError( strus::TextProcessorInterface* textproc)
+{
+	int callcnt = 0;
+	strus::local_ptr<strus::QueryAnalyzerInstanceInterface> qana( strus::createQueryAnalyzer( g_errorhnd));
+	if (!qana.get()) throw std::runtime_error( g_errorhnd->fetchError());
+	const strus::TokenizerFunctionInterface* tokenizertype = textproc->getTokenizer( "content");
+	if (!tokenizertype) throw std::runtime_error( g_errorhnd->fetchError());
+	strus::Reference<strus::TokenizerFunctionInstanceInterface> tokenizer( tokenizertype->createInstance( std::vector<std::string>(), textproc));
+	if (!tokenizer.get()) throw std::runtime_error( g_errorhnd->fetchError());
+	std::vector<strus::NormalizerFunctionInstanceInterface*> normalizers;
+	normalizers.push_back( new FailingNormalizerFunctionInstance( &callcnt));
+	qana->addElement( "word", "FAIL", tokenizer.get(), normalizers, 0/*priority*/);
+	tokenizer.release();
+	qana->defineResultCache( 1<<10);
+	if (g_errorhnd->hasError()) throw std::runtime_error( g_errorhnd->fetchError());
+
+	testResultCacheQuery( qana.get(), "fail", true/*expectError*/, &callcnt);
+	testResultCacheQuery( qana.get(), "pass", false/*expectError*/, &callcnt);
+	testResultCacheQuery( qana.get(), "fail", true/*expectError*/, &callcnt);
+}
+
 int main( int argc, const char* argv[])
 {
 	int rt = 0;
@@ -601,6 +678,15 @@ int main( int argc, const char* argv[])
 		if (!analyzer.get()) throw std::runtime_error( g_errorhnd->fetchError());
 		defineQueryAnalysis( analyzer.get(), textproc.get(), typemax, desttypes);
 
+		// ... same analysis with a result cache, every query is analyzed twice to get the result from the cache the second time
+		strus::local_ptr<strus::QueryAnalyzerInstanceInterface> cachedAnalyzer( strus::createQueryAnalyzer( g_errorhnd));
+		if (!cachedAnalyzer.get()) throw std::runtime_error( g_errorhnd->fetchError());
+		defineQueryAnalysis( cachedAnalyzer.get(), textproc.get(), typemax, desttypes);
+		cachedAnalyzer->defineResultCache( 1<<20);
+
+		// ... results of a query analysis failing with an error must not be cached
+		testResultCacheError( textproc.get());
+
 		int ti=1,te=nofTests+1;
 		for (; ti<te; ++ti)
 		{
@@ -633,6 +719,16 @@ int main( int argc, const char* argv[])
 #ifdef STRUS_LOWLEVEL_DEBUG
 			std::cerr << "expected tree after analysis:" << std::endl << expectedstr;
 #endif
+			for (int ci=0; ci<2; ++ci)
+			{
+				QueryTree cachedtree = analyzeQueryTree( cachedAnalyzer.get(), querytree);
+				std::ostringstream cachedstream;
+				cachedtree.print( cachedstream);
+				if (cachedstream.str() != outputstr)
+				{
+					throw std::runtime_error("output of query analysis with result cache not equal to output without cache");
+				}
+			}
 			if (g_errorhnd->hasError())
 			{
 				throw std::runtime_error( g_errorhnd->fetchError());
@@ -0,0 +1,309 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Test of the incremental JSON event parser against the events created from the cJSON tree of the document
+/// \file testJsonEventParser.cpp
+#include "jsonEventParser.hpp"
+#include "cjson2textwolf.hpp"
+#include "strus/base/fileio.hpp"
+#include <string>
+#include <vector>
+#include <deque>
+#include <utility>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <stdexcept>
+#include <iostream>
+#include <sstream>
+
+#undef STRUS_LOWLEVEL_DEBUG
+
+typedef std::vector<std::pair<int,std::string> > EventList;
+
+static void printUsage( int argc, const char* argv[])
+{
+	std::cerr << "usage: " << argv[0] << " <testdir>" << std::endl;
+	std::cerr << "<testdir> = directory with the test document input.json" << std::endl;
+}
+
+static std::string eventListString( const EventList& events)
+{
+	std::ostringstream out;
+	EventList::const_iterator ei = events.begin(), ee = events.end();
+	for (; ei != ee; ++ei)
+	{
+		out << textwolf::XMLScannerBase::getElementTypeName( (textwolf::XMLScannerBase::ElementType)ei->first) << " '" << ei->second << "'" << std::endl;
+	}
+	return out.str();
+}
+
+/// \brief Get the events created from the cJSON tree of a document, as done by the segmenter before the JsonEventParser
+static bool getTreeEvents( EventList& result, const std::string& content, std::string& error)
+{
+	try
+	{
+		// ... the values of the items refer to the tree, they are copied before the tree is freed
+		cJSON* tree = strus::parseJsonTree( content);
+		try
+		{
+			std::vector<strus::TextwolfItem> items;
+			std::deque<std::string> idxstrings;
+			strus::getTextwolfItems( items, idxstrings, tree);
+			std::vector<strus::TextwolfItem>::const_iterator ii = items.begin(), ie = items.end();
+			for (; ii != ie; ++ii)
+			{
+				result.push_back( std::pair<int,std::string>( ii->type, ii->value ? std::string( ii->value) : std::string()));
+			}
+		}
+		catch (const std::runtime_error&)
+		{
+			cJSON_Delete( tree);
+			throw;
+		}
+		cJSON_Delete( tree);
+		return true;
+	}
+	catch (const std::runtime_error& err)
+	{
+		error = err.what();
+		return false;
+	}
+}
+
+static void fetchEvents( EventList& result, strus::JsonEventParser& parser)
+{
+	strus::JsonEventParser::ElementType type;
+	const char* value;
+	std::size_t valuesize;
+	while (parser.getNext( type, value, valuesize))
+	{
+		result.push_back( std::pair<int,std::string>( type, value ? std::string( value, valuesize) : std::string()));
+	}
+}
+
+/// \brief Get the events of the JsonEventParser for a document fed in chunks
+/// \param[in] splits positions where the content is split into chunks in ascending order
+/// \param[in] interleaved true if the events are fetched after each chunk, false if all chunks are fed before fetching the first event
+static bool getParserEvents( EventList& result, const std::string& content, const std::vector<std::size_t>& splits, bool interleaved, std::string& error)
+{
+	try
+	{
+		strus::JsonEventParser parser;
+		std::size_t chunkpos = 0;
+		std::vector<std::size_t>::const_iterator si = splits.begin(), se = splits.end();
+		for (;;)
+		{
+			std::size_t chunkend = (si == se) ? content.size() : *si++;
+			parser.putInput( content.c_str() + chunkpos, chunkend - chunkpos, chunkend == content.size());
+			chunkpos = chunkend;
+			if (interleaved || chunkend == content.size())
+			{
+				fetchEvents( result, parser);
+			}
+			if (chunkend == content.size()) break;
+		}
+		if (!parser.finished())
+		{
+			error = "document not finished after end of input";
+			return false;
+		}
+		return true;
+	}
+	catch (const std::runtime_error& err)
+	{
+		error = err.what();
+		return false;
+	}
+}
+
+static std::vector<std::size_t> chunkSplits( std::size_t contentsize, std::size_t chunksize)
+{
+	std::vector<std::size_t> rt;
+	std::size_t pos = chunksize;
+	for (; pos < contentsize; pos += chunksize)
+	{
+		rt.push_back( pos);
+	}
+	return rt;
+}
+
+static void compareEvents( const std::string& content, const std::vector<std::size_t>& splits, bool interleaved, const char* description)
+{
+	EventList expected;
+	std::string expectedError;
+	bool expectedOk = getTreeEvents( expected, content, expectedError);
+
+	EventList result;
+	std::string resultError;
+	bool resultOk = getParserEvents( result, content, splits, interleaved, resultError);
+
+	if (expectedOk != resultOk || (expectedOk && expected != result))
+	{
+		std::cerr << "DOCUMENT " << content.substr( 0, 200) << std::endl;
+		if (expectedOk) std::cerr << "EXPECTED" << std::endl << eventListString( expected); else std::cerr << "EXPECTED ERROR " << expectedError << std::endl;
+		if (resultOk) std::cerr << "GOT" << std::endl << eventListString( result); else std::cerr << "GOT ERROR " << resultError << std::endl;
+		throw std::runtime_error( std::string("events of JSON event parser differ from events of cJSON tree, ") + description);
+	}
+}
+
+/// \brief Compare the events for a document fed in chunks of different sizes down to single bytes, fetched interleaved and not
+static void testChunkSizes( const std::string& content)
+{
+	static const std::size_t chunksizes[] = {1, 2, 3, 7, 64, 0};
+	for (int ci = 0; chunksizes[ ci]; ++ci)
+	{
+		char description[ 128];
+		std::snprintf( description, sizeof(description), "chunk size %u", (unsigned int)chunksizes[ ci]);
+		std::vector<std::size_t> splits = chunkSplits( content.size(), chunksizes[ ci]);
+		compareEvents( content, splits, true/*interleaved*/, description);
+		compareEvents( content, splits, false/*interleaved*/, description);
+	}
+	compareEvents( content, std::vector<std::size_t>(), true/*interleaved*/, "document as one chunk");
+}
+
+/// \brief Compare the events for a document fed in two chunks, split at every position
+static void testSplitPositions( const std::string& content)
+{
+	std::size_t pos = 1;
+	for (; pos < content.size(); ++pos)
+	{
+		char description[ 128];
+		std::snprintf( description, sizeof(description), "split at position %u", (unsigned int)pos);
+		compareEvents( content, std::vector<std::size_t>( 1, pos), true/*interleaved*/, description);
+	}
+}
+
+static void checkExpectedEvents( const std::string& content, const EventList& expected)
+{
+	EventList result;
+	std::string error;
+	if (!getParserEvents( result, content, chunkSplits( content.size(), 1), true/*interleaved*/, error))
+	{
+		throw std::runtime_error( std::string("error parsing document: ") + error);
+	}
+	if (result != expected)
+	{
+		std::cerr << "DOCUMENT " << content << std::endl;
+		std::cerr << "EXPECTED" << std::endl << eventListString( expected);
+		std::cerr << "GOT" << std::endl << eventListString( result);
+		throw std::runtime_error( "events of JSON event parser not as expected");
+	}
+}
+
+static EventList& addEvent( EventList& events, textwolf::XMLScannerBase::ElementType type, const char* value)
+{
+	events.push_back( std::pair<int,std::string>( type, value));
+	return events;
+}
+
+static void testExpectedEvents()
+{
+	typedef textwolf::XMLScannerBase TX;
+	{
+		// ... elements of arrays without name are tagged with their index, as getTextwolfItems did for the segmenter before
+		EventList expected;
+		addEvent( expected, TX::OpenTag, "0");
+		addEvent( expected, TX::OpenTag, "a");
+		addEvent( expected, TX::Content, "1");
+		addEvent( expected, TX::CloseTag, "a");
+		addEvent( expected, TX::CloseTag, "0");
+		addEvent( expected, TX::OpenTag, "1");
+		addEvent( expected, TX::Content, "x");
+		addEvent( expected, TX::CloseTag, "1");
+		addEvent( expected, TX::OpenTag, "2");
+		addEvent( expected, TX::OpenTag, "0");
+		addEvent( expected, TX::Content, "y");
+		addEvent( expected, TX::CloseTag, "0");
+		addEvent( expected, TX::CloseTag, "2");
+		checkExpectedEvents( "[{\"a\":1},\"x\",[\"y\"]]", expected);
+	}
+	{
+		// ... elements of arrays with a name are repeated tags with the name of the array
+		EventList expected;
+		addEvent( expected, TX::OpenTag, "doc");
+		addEvent( expected, TX::TagAttribName, "id");
+		addEvent( expected, TX::TagAttribValue, "7");
+		addEvent( expected, TX::OpenTag, "item");
+		addEvent( expected, TX::Content, "a");
+		addEvent( expected, TX::CloseTag, "item");
+		addEvent( expected, TX::OpenTag, "item");
+		addEvent( expected, TX::Content, "b");
+		addEvent( expected, TX::CloseTag, "item");
+		addEvent( expected, TX::Content, "text");
+		addEvent( expected, TX::CloseTag, "doc");
+		checkExpectedEvents( "{\"doc\":{\"-id\":7,\"item\":[\"a\",\"b\"],\"#text\":\"text\"}}", expected);
+	}
+	{
+		// ... escapes and surrogate pairs decoded to UTF-8, BOM skipped, all split across 1 byte chunks
+		EventList expected;
+		addEvent( expected, TX::OpenTag, "s");
+		addEvent( expected, TX::Content, "a\n\t\"\\/\xC3\xA4\xF0\x9F\x98\x80z");
+		addEvent( expected, TX::CloseTag, "s");
+		checkExpectedEvents( "\xEF\xBB\xBF{\"s\":\"a\\n\\t\\\"\\\\\\/\\u00e4\\ud83d\\ude00z\"}", expected);
+	}
+}
+
+int main( int argc, const char* argv[])
+{
+	if (argc <= 1 || std::strcmp( argv[1], "-h") == 0 || std::strcmp( argv[1], "--help") == 0)
+	{
+		printUsage( argc, argv);
+		return 0;
+	}
+	else if (argc > 2)
+	{
+		std::cerr << "ERROR too many parameters" << std::endl;
+		printUsage( argc, argv);
+		return 1;
+	}
+	try
+	{
+		std::string inputfile = std::string( argv[1]) + strus::dirSeparator() + "input.json";
+		std::string inputsrc;
+		int ec = strus::readFile( inputfile, inputsrc);
+		if (ec) throw std::runtime_error( std::string("error reading input file ") + inputfile + ": " + ::strerror(ec));
+
+		testExpectedEvents();
+		testChunkSizes( inputsrc);
+
+		// Documents with escapes, surrogates, BOM, literals, empty structures and errors, split at every position:
+		static const char* documents[] = {
+			"null", "{}", "[]", "[1,2,3]", "[[1,2],[3]]",
+			"{\"a\":[1,{\"b\":null},[]],\"-x\":true,\"#text\":false}",
+			"{\"a\":null,\"-b\":null,\"#c\":null,\"\":1}",
+			"{\"a\":{\"b\":{\"c\":\"d\"}}}",
+			"\xEF\xBB\xBF{\"a\":1}",
+			"\xEF\xBB\xBF[\"\\u00e4\"]",
+			"{\"s\":\"a\\n\\t\\\"\\\\\\/\\u00e4\\ud83d\\ude00x\"}",
+			"[\"\\uD834\\uDD1E\", \"\\u20AC\", \"\\u0041\\u0042\"]",
+			"[-5, 1.5e10, 0.25, true, false, null]",
+			"\n\n  [1,\n 2 ]",
+			"{\"s\":\"\\q\"}", "[1,]", "{\"a\":1,}", "{\"a\" 1}", "[1 2]", "[nul]", "[true,false,truex]",
+			"[\"unterminated", "{\"a\":", "{\"a\":\"\\ud800\"}", "{\"a\":\"\\uZZZZ\"}", "[\"\\u12\"]",
+			0};
+		for (int di = 0; documents[ di]; ++di)
+		{
+			std::string document( documents[ di]);
+			testChunkSizes( document);
+			testSplitPositions( document);
+		}
+		std::cerr << "OK" << std::endl;
+		return 0;
+	}
+	catch (const std::bad_alloc&)
+	{
+		std::cerr << "ERROR memory allocation error" << std::endl;
+		return 2;
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "ERROR " << e.what() << std::endl;
+		return 1;
+	}
+}
+
@@ -17,6 +17,7 @@
 #include "strus/base/fileio.hpp"
 #include "strus/base/local_ptr.hpp"
 #include <memory>
+#include <algorithm>
 #include <string>
 #include <cstring>
 #include <stdexcept>
@@ -211,11 +212,19 @@ int main( int argc, const char* argv[])
 		strus::local_ptr<strus::SegmenterContextInterface> segmenterContext( segmenterInstance->createContext( dclass));
 		if (!segmenterContext.get()) throw std::runtime_error("failed to create segmenter context");
 
+		// ... every second chunk is fed by reference, the input source outlives the segmenter context
 		std::size_t chunksize = 100;
 		std::size_t chunkpos = 0;
-		for (; chunkpos + chunksize < inputsrc.size(); chunkpos += chunksize)
+		for (int chunkidx=0; chunkpos + chunksize < inputsrc.size(); chunkpos += chunksize,++chunkidx)
 		{
-			segmenterContext->putInput( inputsrc.c_str() + chunkpos, chunksize, false);
+			if (chunkidx % 2 == 0)
+			{
+				segmenterContext->putInput( inputsrc.c_str() + chunkpos, chunksize, false);
+			}
+			else
+			{
+				segmenterContext->putInputReference( inputsrc.c_str() + chunkpos, chunksize, false);
+			}
 #ifdef STRUS_LOWLEVEL_DEBUG
 			std::cout << "PUT INPUT" << std::endl << std::string( inputsrc.c_str() + chunkpos, chunksize) << std::endl;
 #endif
@@ -239,6 +248,140 @@ int main( int argc, const char* argv[])
 			throw std::runtime_error( g_errorhnd->fetchError());
 		}
 
+		// ... the context reset for the same input has to produce the same segments
+		if (!segmenterContext->reset( dclass))
+		{
+			throw std::runtime_error( g_errorhnd->hasError() ? g_errorhnd->fetchError() : "failed to reset segmenter context");
+		}
+		segmenterContext->putInput( inputsrc.c_str(), inputsrc.size(), true);
+		std::ostringstream resetout;
+		while (segmenterContext->getNext( id, pos, segment, segmentsize))
+		{
+			resetout << "[" << id << "] " << std::string(segment,segmentsize) << std::endl;
+		}
+		if (g_errorhnd->hasError())
+		{
+			throw std::runtime_error( g_errorhnd->fetchError());
+		}
+		if (resetout.str() != out.str())
+		{
+			throw std::runtime_error("output of segmenter context reset not equal to output of new context");
+		}
+
+		// [3] Test segmenter with a limit of input buffered, chunks rejected are fed again after consuming the input buffered:
+		strus::local_ptr<strus::SegmenterInstanceInterface> limitedInstance(
+			segmenter->createInstance( strus::analyzer::SegmenterOptions()( "maxbuffer", "250")));
+		if (!limitedInstance.get()) throw std::runtime_error("failed to create segmenter instance with a buffer limit");
+		for (ri = rulear.begin(); ri != re; ++ri)
+		{
+			if (ri->endIdx)
+			{
+				limitedInstance->defineSubSection( ri->startIdx, ri->endIdx, ri->expression);
+			}
+			else
+			{
+				limitedInstance->defineSelectorExpression( ri->startIdx, ri->expression);
+			}
+		}
+		strus::local_ptr<strus::SegmenterContextInterface> limitedContext( limitedInstance->createContext( dclass));
+		if (!limitedContext.get()) throw std::runtime_error("failed to create segmenter context with a buffer limit");
+		std::ostringstream limitedout;
+		int nofOverflows = 0;
+		chunksize = 100;
+		for (chunkpos = 0; chunkpos < inputsrc.size(); chunkpos += chunksize)
+		{
+			std::size_t size = std::min( chunksize, inputsrc.size() - chunkpos);
+			bool eof = chunkpos + size == inputsrc.size();
+			for (;;)
+			{
+				limitedContext->putInput( inputsrc.c_str() + chunkpos, size, eof);
+				if (!g_errorhnd->hasError()) break;
+				if (limitedContext->bufferedInputSize() + size <= 250)
+				{
+					throw std::runtime_error( g_errorhnd->fetchError());
+				}
+				// ... buffer overflow, the chunk rejected has to be fed again after consuming input
+				g_errorhnd->fetchError();
+				++nofOverflows;
+				std::size_t buffered = limitedContext->bufferedInputSize();
+				while (limitedContext->getNext( id, pos, segment, segmentsize))
+				{
+					limitedout << "[" << id << "] " << std::string(segment,segmentsize) << std::endl;
+				}
+				if (g_errorhnd->hasError())
+				{
+					throw std::runtime_error( g_errorhnd->fetchError());
+				}
+				if (limitedContext->bufferedInputSize() >= buffered)
+				{
+					throw std::runtime_error("input consumed not released by the segmenter");
+				}
+			}
+			if (limitedContext->bufferedInputSize() > 250)
+			{
+				throw std::runtime_error("input buffered by the segmenter exceeds the limit");
+			}
+		}
+		while (limitedContext->getNext( id, pos, segment, segmentsize))
+		{
+			limitedout << "[" << id << "] " << std::string(segment,segmentsize) << std::endl;
+		}
+		if (g_errorhnd->hasError())
+		{
+			throw std::runtime_error( g_errorhnd->fetchError());
+		}
+		if (nofOverflows == 0)
+		{
+			throw std::runtime_error("no buffer overflow reported by segmenter with a buffer limit");
+		}
+		if (limitedout.str() != resetout.str())
+		{
+			throw std::runtime_error("output of segmenter context with a buffer limit not equal to output without limit");
+		}
+
+		// [4] Test segmenter with the last chunk fed after consuming all input before, the last chunk is scanned without a longjmp at its end:
+		std::size_t lastChunkSizes[] = {1, 7, 64, inputsrc.size() / 2, inputsrc.size() - 1, 0};
+		for (int li = 0; lastChunkSizes[ li]; ++li)
+		{
+			if (!segmenterContext->reset( dclass))
+			{
+				throw std::runtime_error( g_errorhnd->hasError() ? g_errorhnd->fetchError() : "failed to reset segmenter context");
+			}
+			std::ostringstream lastchunkout;
+			std::size_t lastChunkPos = inputsrc.size() - lastChunkSizes[ li];
+			chunksize = 100;
+			for (chunkpos = 0; chunkpos < lastChunkPos; chunkpos += chunksize)
+			{
+				std::size_t size = std::min( chunksize, lastChunkPos - chunkpos);
+				segmenterContext->putInput( inputsrc.c_str() + chunkpos, size, false);
+				if (g_errorhnd->hasError())
+				{
+					throw std::runtime_error( g_errorhnd->fetchError());
+				}
+				while (segmenterContext->getNext( id, pos, segment, segmentsize))
+				{
+					lastchunkout << "[" << id << "] " << std::string(segment,segmentsize) << std::endl;
+				}
+				if (g_errorhnd->hasError())
+				{
+					throw std::runtime_error( g_errorhnd->fetchError());
+				}
+			}
+			segmenterContext->putInput( inputsrc.c_str() + lastChunkPos, inputsrc.size() - lastChunkPos, true);
+			while (segmenterContext->getNext( id, pos, segment, segmentsize))
+			{
+				lastchunkout << "[" << id << "] " << std::string(segment,segmentsize) << std::endl;
+			}
+			if (g_errorhnd->hasError())
+			{
+				throw std::runtime_error( g_errorhnd->fetchError());
+			}
+			if (lastchunkout.str() != resetout.str())
+			{
+				throw std::runtime_error( "output of segmenter context with the last chunk fed separately not equal to output with all input fed at once");
+			}
+		}
+
 		ec = strus::writeFile( outputfile, out.str());
 		if (ec) throw std::runtime_error( std::string("error writing output file ") + outputfile + ": " + ::strerror(ec));
 
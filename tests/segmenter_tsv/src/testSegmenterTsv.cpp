@@ -18,6 +18,7 @@
 #include "strus/base/local_ptr.hpp"
 #include <memory>
 #include <string>
+#include <vector>
 #include <cstring>
 #include <stdexcept>
 #include <iostream>
@@ -225,15 +226,46 @@ int main( int argc, const char* argv[])
 		strus::SegmenterPosition pos;
 		const char* segment;
 		std::size_t segmentsize;
+		std::ostringstream segout;
 		while (segmenterContext->getNext( id, pos, segment, segmentsize))
 		{
 			out << "[" << id << "] " << std::string(segment,segmentsize) << std::endl;
+			segout << "[" << id << "] " << pos << " " << std::string(segment,segmentsize) << std::endl;
 		}
 		std::cout << out.str();
 		if (g_errorhnd->hasError())
 		{
 			throw std::runtime_error( g_errorhnd->fetchError());
 		}
+		// [3] Test segmenting the content split into parts:
+		std::vector<strus::SegmenterInstanceInterface::ContentPart> parts;
+		if (!segmenterInstance->splitContent( parts, dclass, inputsrc.c_str(), inputsrc.size(), 2))
+		{
+			throw std::runtime_error( "failed to split content");
+		}
+		if (parts.size() != 2)
+		{
+			throw std::runtime_error( "unexpected number of parts of split content");
+		}
+		std::ostringstream partout;
+		std::vector<strus::SegmenterInstanceInterface::ContentPart>::const_iterator pi = parts.begin(), pe = parts.end();
+		for (; pi != pe; ++pi)
+		{
+			strus::local_ptr<strus::SegmenterContextInterface> partContext( segmenterInstance->createPartContext( dclass, inputsrc.c_str(), inputsrc.size(), *pi));
+			if (!partContext.get()) throw std::runtime_error("failed to create segmenter context for part of content");
+			while (partContext->getNext( id, pos, segment, segmentsize))
+			{
+				partout << "[" << id << "] " << pos << " " << std::string(segment,segmentsize) << std::endl;
+			}
+		}
+		if (g_errorhnd->hasError())
+		{
+			throw std::runtime_error( g_errorhnd->fetchError());
+		}
+		if (partout.str() != segout.str())
+		{
+			throw std::runtime_error("output of segmenting the parts of the content differs from the output of segmenting the content");
+		}
 
 		ec = strus::writeFile( outputfile, out.str());
 		if (ec) throw std::runtime_error( std::string("error writing output file ") + outputfile + ": " + ::strerror(ec));
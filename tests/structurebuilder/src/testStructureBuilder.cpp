@@ -0,0 +1,734 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Test of the builder of the structures of a document against the implementation with std::set used before
+/// \file testStructureBuilder.cpp
+#include "searchIndexStructureBuilder.hpp"
+#include "searchIndexStructure.hpp"
+#include "strus/documentAnalyzerInstanceInterface.hpp"
+#include "strus/analyzer/position.hpp"
+#include "strus/base/pseudoRandom.hpp"
+#include <iostream>
+#include <sstream>
+#include <cstring>
+#include <cstdlib>
+#include <stdexcept>
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <set>
+
+using namespace strus;
+
+static strus::PseudoRandom g_random;
+
+typedef DocumentAnalyzerInstanceInterface DI;
+
+// Structure building as done before the introduction of the SearchIndexStructureBuilder:
+struct FieldArea
+{
+	enum Type {HeaderType,ContentType};
+	Type type;
+	const char* id;
+	SearchIndexStructure::PositionRange positionRange;
+
+	FieldArea()
+		:type(ContentType),id(0),positionRange(){}
+	FieldArea( Type type_, const char* id_, const SearchIndexStructure::PositionRange& positionRange_)
+		:type(type_),id(id_),positionRange(positionRange_){}
+	FieldArea( const FieldArea& o)
+		:type(o.type),id(o.id),positionRange(o.positionRange){}
+
+	bool operator<( const FieldArea& o) const
+	{
+		if (positionRange.second == o.positionRange.second)
+		{
+			return (positionRange.first == o.positionRange.first)
+				? (type == o.type
+					? id < o.id
+					: (int)type < (int)o.type)
+				: positionRange.first < o.positionRange.first;
+		}
+		else
+		{
+			return positionRange.second < o.positionRange.second;
+		}
+	}
+	bool covers( const FieldArea& oth) const
+	{
+		return positionRange.second >= oth.positionRange.second
+			&& positionRange.first <= oth.positionRange.first;
+	}
+	bool isequal( const FieldArea& oth) const
+	{
+		return positionRange.second == oth.positionRange.second
+			&& positionRange.first == oth.positionRange.first;
+	}
+	static bool isMatchSeparator( char aa)
+	{
+		return aa == '\0' || aa == FIELD_ID_SEPARATOR;
+	}
+	static bool isSubMatch( const char* haystack, const char* needle)
+	{
+		char const* ai = std::strstr( haystack, needle);
+		return ai
+			&& (ai == haystack || *(ai-1) == FIELD_ID_SEPARATOR)
+			&& isMatchSeparator( ai[std::strlen(needle)]);
+	}
+	struct IdSubString {
+		const char* str;
+		std::size_t len;
+		int hash;
+	};
+	static int hashIdSubString( const char* str, std::size_t len)
+	{
+		std::size_t li = 0, le = len;
+		int hs = 1031;
+		for (; li != le; ++li)
+		{
+			hs += (str[ li] * li * 10) + 137;
+		}
+		return hs;
+	}
+
+	static void parseIdSubStrings( IdSubString* buf, std::size_t bufsize, std::size_t& len, const char* haystack)
+	{
+		char const* hi = haystack;
+		char const* hn = std::strchr( hi, FIELD_ID_SEPARATOR);
+		len = 0;
+
+		for (; hn && len < bufsize;
+			hi=hn+1,hn = std::strchr( hi, FIELD_ID_SEPARATOR),++len)
+		{
+			buf[ len].hash
+				= hashIdSubString(
+					buf[ len].str = hi,
+					buf[ len].len = hn-hi);
+		}
+		if (len == bufsize)
+		{
+			throw std::runtime_error( std::string("too many ids assigned to structure in ") + haystack);
+		}
+		buf[ len].hash
+			= hashIdSubString(
+				buf[ len].str = hi,
+				buf[ len].len = std::strchr( hi, '\0')-hi);
+		++len;
+	}
+
+	static bool findCommonMatch( const char* haystack1, const char* haystack2)
+	{
+		enum {MaxNofFields = 1024};
+
+		IdSubString har1[ MaxNofFields]; std::size_t harlen1 = 0;
+		IdSubString har2[ MaxNofFields]; std::size_t harlen2 = 0;
+
+		parseIdSubStrings( har1, MaxNofFields, harlen1, haystack1);
+		parseIdSubStrings( har2, MaxNofFields, harlen2, haystack2);
+
+		std::size_t h1 = 0;
+		for (; h1 < harlen1; ++h1)
+		{
+			std::size_t h2 = 0;
+			for (; h2 < harlen2; ++h2)
+			{
+				if (har1[ h1].hash == har2[ h2].hash
+				&&  har1[ h1].len == har2[ h2].len
+				&&  0==std::memcmp( har1[ h1].str, har2[ h2].str, har2[ h2].len))
+				{
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+	bool matches( const FieldArea& oth) const
+	{
+		if (id == oth.id) return true;
+		if (!id || !oth.id) return false;
+		if (0!=std::strchr( id, FIELD_ID_SEPARATOR))
+		{
+			if (0!=std::strchr( oth.id, FIELD_ID_SEPARATOR))
+			{
+				return findCommonMatch( id, oth.id);
+			}
+			else
+			{
+				return isSubMatch( id, oth.id);
+			}
+		}
+		else if (0!=std::strchr( oth.id, FIELD_ID_SEPARATOR))
+		{
+			return isSubMatch( oth.id, id);
+		}
+		else
+		{
+			return 0==std::strcmp( id, oth.id);
+		}
+		return false;
+	}
+};
+
+static void collectHeaderFields(
+	std::set<FieldArea>& res,
+	const std::vector<SeachIndexFieldConfig>& fieldConfigs,
+	const std::vector<SearchIndexField>& fields, int configIdx)
+{
+	std::vector<SearchIndexField>::const_iterator fi = fields.begin(), fe = fields.end();
+	for (; fi != fe; ++fi)
+	{
+		const SeachIndexFieldConfig& config = fieldConfigs[ fi->configIdx()];
+		std::vector<int>::const_iterator
+			hi = config.headerStructureList().begin(),
+			he = config.headerStructureList().end();
+		for (; hi != he; ++hi)
+		{
+			if (*hi == configIdx)
+			{
+				const char* idstr = fi->id().empty() ? 0 : fi->id().c_str();
+				SearchIndexStructure::PositionRange posrange( fi->start(), fi->end());
+				FieldArea area( FieldArea::HeaderType, idstr, posrange);
+				res.insert( area);
+			}
+		}
+	}
+}
+
+static void collectContentFields(
+	std::set<FieldArea>& res,
+	const std::vector<SeachIndexFieldConfig>& fieldConfigs,
+	const std::vector<SearchIndexField>& fields, int configIdx)
+{
+	std::vector<SearchIndexField>::const_iterator fi = fields.begin(), fe = fields.end();
+	for (; fi != fe; ++fi)
+	{
+		const SeachIndexFieldConfig& config = fieldConfigs[ fi->configIdx()];
+		std::vector<int>::const_iterator
+			ci = config.contentStructureList().begin(),
+			ce = config.contentStructureList().end();
+		for (; ci != ce; ++ci)
+		{
+			if (*ci == configIdx)
+			{
+				const char* idstr = fi->id().empty() ? 0 : fi->id().c_str();
+				SearchIndexStructure::PositionRange posrange( fi->start(), fi->end());
+				FieldArea area( FieldArea::ContentType, idstr, posrange);
+				res.insert( area);
+			}
+		}
+	}
+}
+
+static void addStructureFieldCandidate( std::vector<FieldArea>& candidates, const FieldArea& area)
+{
+	std::vector<FieldArea>::iterator ci = candidates.begin(), ce = candidates.end();
+	while (ci != ce)
+	{
+		if (ci->covers( area))
+		{
+			return;
+		}
+		else if (area.covers( *ci))
+		{
+			ci = candidates.erase( ci);
+			ce = candidates.end();
+		}
+		else
+		{
+			++ci;
+		}
+	}
+	candidates.push_back( area);
+}
+
+static void addInnerStructureFieldCandidate( std::vector<FieldArea>& candidates, const FieldArea& area)
+{
+	std::vector<FieldArea>::iterator ci = candidates.begin(), ce = candidates.end();
+	while (ci != ce)
+	{
+		if (ci->covers( area))
+		{
+			ci = candidates.erase( ci);
+			ce = candidates.end();
+		}
+		else if (area.covers( *ci))
+		{
+			return;
+		}
+		else
+		{
+			++ci;
+		}
+	}
+	candidates.push_back( area);
+}
+
+static void flushStructureFieldCandidates( std::vector<SearchIndexStructure>& dest, int configIdx, const FieldArea& header, const std::vector<FieldArea>& candidates)
+{
+	std::vector<FieldArea>::const_iterator ci = candidates.begin(), ce = candidates.end();
+	for (; ci != ce; ++ci)
+	{
+		dest.push_back( SearchIndexStructure( configIdx, header.positionRange, ci->positionRange));
+	}
+}
+
+static void oldBuild( std::vector<SearchIndexStructure>& m_structures, const std::vector<SeachIndexFieldConfig>& fieldConfigs, DocumentAnalyzerInstanceInterface::StructureType stype, const std::vector<SearchIndexField>& fields, int configIdx)
+{
+	std::set<FieldArea> areaset;
+
+	collectHeaderFields( areaset, fieldConfigs, fields, configIdx);
+	collectContentFields( areaset, fieldConfigs, fields, configIdx);
+
+	switch (stype)
+	{
+		case DocumentAnalyzerInstanceInterface::StructureCover:
+		{
+			// Find header covering content completely (not equal)
+			std::set<FieldArea>::reverse_iterator ai = areaset.rbegin(), ae = areaset.rend();
+			for (; ai != ae; ++ai)
+			{
+				if (ai->type == FieldArea::HeaderType)
+				{
+					std::vector<FieldArea> candidates;
+					std::set<FieldArea>::reverse_iterator next_ai = ai;
+					++next_ai;
+					for (; next_ai != ae; ++next_ai)
+					{
+						if (next_ai->type == FieldArea::ContentType
+						&&  ai->matches( *next_ai)
+						&&  ai->covers( *next_ai)
+						&& !ai->isequal( *next_ai))
+						{
+							addStructureFieldCandidate( candidates, *next_ai);
+						}
+					}
+					flushStructureFieldCandidates( m_structures, configIdx, *ai, candidates);
+				}
+			}
+			break;
+		}
+		case DocumentAnalyzerInstanceInterface::StructureLabel:
+		{
+			// Find header inside content (covered by content, not equal)
+			std::set<FieldArea>::const_iterator ai = areaset.begin(), ae = areaset.end();
+			for (; ai != ae; ++ai)
+			{
+				if (ai->type == FieldArea::HeaderType)
+				{
+					std::vector<FieldArea> candidates;
+					std::set<FieldArea>::const_iterator next_ai = ai;
+					++next_ai;
+					for (; next_ai != ae; ++next_ai)
+					{
+						if (next_ai->type == FieldArea::ContentType
+						&&  next_ai->matches( *ai)
+						&&  next_ai->covers( *ai)
+						&& !next_ai->isequal( *ai))
+						{
+							addInnerStructureFieldCandidate( candidates, *next_ai);
+						}
+					}
+					flushStructureFieldCandidates( m_structures, configIdx, *ai, candidates);
+				}
+			}
+		}
+		case DocumentAnalyzerInstanceInterface::StructureHeader:
+		{
+			std::set<FieldArea>::const_iterator ai = areaset.begin(), ae = areaset.end();
+			for (; ai != ae; ++ai)
+			{
+				if (ai->type == FieldArea::HeaderType)
+				{
+					std::vector<FieldArea> candidates;
+					std::set<FieldArea>::const_iterator next_ai = ai;
+					++next_ai;
+					for (; next_ai != ae && next_ai->type == FieldArea::ContentType; ++next_ai)
+					{
+						if (next_ai->positionRange.first >= ai->positionRange.second
+						&&  next_ai->matches( *ai))
+						{
+							addStructureFieldCandidate( candidates, *next_ai);
+						}
+					}
+					flushStructureFieldCandidates( m_structures, configIdx, *ai, candidates);
+				}
+			}
+			break;
+		}
+		case DocumentAnalyzerInstanceInterface::StructureFooter:
+		{
+			std::set<FieldArea>::reverse_iterator ai = areaset.rbegin(), ae = areaset.rend();
+			for (; ai != ae; ++ai)
+			{
+				if (ai->type == FieldArea::HeaderType)
+				{
+					std::vector<FieldArea> candidates;
+					std::set<FieldArea>::reverse_iterator next_ai = ai;
+					++next_ai;
+					for (; next_ai != ae && next_ai->type == FieldArea::ContentType; ++next_ai)
+					{
+						if (next_ai->positionRange.second <= ai->positionRange.first
+						&&  next_ai->matches( *ai))
+
+						{
+							addStructureFieldCandidate( candidates, *next_ai);
+						}
+					}
+					flushStructureFieldCandidates( m_structures, configIdx, *ai, candidates);
+				}
+			}
+			break;
+		}
+		case DocumentAnalyzerInstanceInterface::StructureSpan:
+		{
+			std::set<FieldArea>::const_iterator ai = areaset.begin(), ae = areaset.end();
+			for (; ai != ae; ++ai)
+			{
+				if (ai->type == FieldArea::HeaderType)
+				{
+					std::vector<FieldArea> candidates;
+					std::set<FieldArea>::const_iterator next_ai = ai;
+					++next_ai;
+					for (; next_ai != ae; ++next_ai)
+					{
+						if (next_ai->type == FieldArea::ContentType
+						&&  next_ai->positionRange.first >= ai->positionRange.second
+						&&  next_ai->matches( *ai))
+						{
+							SearchIndexStructure::PositionRange
+								posrange( ai->positionRange.first, next_ai->positionRange.first);
+							FieldArea area( FieldArea::ContentType, ai->id, posrange);
+							addStructureFieldCandidate( candidates, area);
+							break;//... only the next candidate matches
+						}
+					}
+					if (candidates.empty())
+					{
+						//... no end marker found, set end position to end of document
+						SearchIndexStructure::PositionRange
+							posrange( ai->positionRange.first, analyzer::Position::endOfDocument());
+						FieldArea area( FieldArea::ContentType, ai->id, posrange);
+						addStructureFieldCandidate( candidates, area);
+					}
+					flushStructureFieldCandidates( m_structures, configIdx, *ai, candidates);
+				}
+			}
+			break;
+		}
+		case DocumentAnalyzerInstanceInterface::StructureAssociative:
+		{
+			std::set<FieldArea>::const_iterator ai = areaset.begin(), ae = areaset.end();
+			for (; ai != ae; ++ai)
+			{
+				if (ai->type == FieldArea::HeaderType)
+				{
+					std::vector<FieldArea> candidates;
+					std::set<FieldArea>::const_iterator next_ai = areaset.begin();
+					for (; next_ai != ae; ++next_ai)
+					{
+						if (next_ai->type == FieldArea::ContentType
+						&&  !ai->isequal( *next_ai)
+						&&  next_ai->matches( *ai))
+						{
+							addStructureFieldCandidate( candidates, *next_ai);
+						}
+					}
+					flushStructureFieldCandidates( m_structures, configIdx, *ai, candidates);
+				}
+			}
+			break;
+		}
+	}
+}
+
+
+static std::string positionString( const analyzer::Position& pos)
+{
+	std::ostringstream out;
+	if (pos == analyzer::Position::endOfDocument())
+	{
+		out << "eod";
+	}
+	else
+	{
+		out << pos.seg();
+		if (pos.ofs()) out << "." << pos.ofs();
+	}
+	return out.str();
+}
+
+/// \brief Get the structures as string sorted, because the order of structures with the same header and equal contents is not defined
+static std::string structuresString( const std::vector<SearchIndexStructure>& structures)
+{
+	std::vector<std::string> items;
+	std::vector<SearchIndexStructure>::const_iterator si = structures.begin(), se = structures.end();
+	for (; si != se; ++si)
+	{
+		std::ostringstream out;
+		out << "[" << positionString( si->source().first) << "-" << positionString( si->source().second) << "]->["
+			<< positionString( si->sink().first) << "-" << positionString( si->sink().second) << "]";
+		items.push_back( out.str());
+	}
+	std::sort( items.begin(), items.end());
+	std::string rt;
+	std::vector<std::string>::const_iterator ii = items.begin(), ie = items.end();
+	for (; ii != ie; ++ii)
+	{
+		if (!rt.empty()) rt.push_back( ' ');
+		rt.append( *ii);
+	}
+	return rt;
+}
+
+/// \brief Field configurations: header only (0), content only (1), header and content (2) of the structure 0
+static std::vector<SeachIndexFieldConfig> createFieldConfigs()
+{
+	std::vector<SeachIndexFieldConfig> rt;
+	rt.push_back( SeachIndexFieldConfig( "h", "", "", "", 0));
+	rt.back().defineHeaderStructureRef( 0);
+	rt.push_back( SeachIndexFieldConfig( "c", "", "", "", 0));
+	rt.back().defineContentStructureRef( 0);
+	rt.push_back( SeachIndexFieldConfig( "b", "", "", "", 0));
+	rt.back().defineHeaderStructureRef( 0);
+	rt.back().defineContentStructureRef( 0);
+	return rt;
+}
+
+static const DI::StructureType g_structureTypes[] = {
+	DI::StructureCover, DI::StructureLabel, DI::StructureHeader,
+	DI::StructureFooter, DI::StructureSpan, DI::StructureAssociative
+};
+
+static std::vector<SearchIndexField> createRandomFields( SearchIndexFieldIdMap& idmap, unsigned int maxNofFields)
+{
+	static const char* ids[] = {"a","b","c","d",""};
+	std::vector<SearchIndexField> rt;
+	// ... few positions to get many fields with equal or overlapping ranges
+	unsigned int nofFields = g_random.get( 1, maxNofFields+1);
+	int maxpos = g_random.get( 2, maxNofFields+2);
+	unsigned int fi = 0;
+	for (; fi < nofFields; ++fi)
+	{
+		rt.push_back( SearchIndexField( g_random.get( 0, 3), 0/*scopeIdx*/));
+		int start = g_random.get( 1, maxpos+1);
+		int end = start + g_random.get( 0, maxpos/2+1);
+		rt.back().setStart( analyzer::Position( start, 0));
+		rt.back().setEnd( analyzer::Position( end, 0));
+		int ii = 0, ie = g_random.get( 0, 3);
+		for (; ii < ie; ++ii)
+		{
+			// ... an empty id only as additional id
+			rt.back().setId( ids[ g_random.get( 0, ii ? 5 : 4)], idmap);
+		}
+	}
+	return rt;
+}
+
+static std::string fieldsString( const std::vector<SearchIndexField>& fields)
+{
+	static const char* configName[] = {"header","content","both"};
+	std::ostringstream out;
+	std::vector<SearchIndexField>::const_iterator fi = fields.begin(), fe = fields.end();
+	for (; fi != fe; ++fi)
+	{
+		out << "\t" << configName[ fi->configIdx()] << " [" << positionString( fi->start()) << "-" << positionString( fi->end()) << "] id '" << fi->id() << "'" << std::endl;
+	}
+	return out.str();
+}
+
+static void runRandomTest( SearchIndexStructureBuilder& builder, const std::vector<SeachIndexFieldConfig>& fieldConfigs, unsigned int testidx, unsigned int maxNofFields)
+{
+	SearchIndexFieldIdMap idmap;
+	std::vector<SearchIndexField> fields = createRandomFields( idmap, maxNofFields);
+	DI::StructureType stype = g_structureTypes[ testidx % (sizeof(g_structureTypes)/sizeof(g_structureTypes[0]))];
+
+	std::vector<SearchIndexStructure> expected;
+	oldBuild( expected, fieldConfigs, stype, fields, 0);
+	std::vector<SearchIndexStructure> result;
+	builder.build( result, 0, stype, fieldConfigs, fields);
+
+	std::string expectedstr = structuresString( expected);
+	std::string resultstr = structuresString( result);
+	if (expectedstr != resultstr)
+	{
+		std::ostringstream msg;
+		msg << "test " << testidx << ": structures of type " << DI::structureTypeName( stype) << " built differ from expected" << std::endl
+			<< "fields:" << std::endl << fieldsString( fields)
+			<< "expected: " << expectedstr << std::endl
+			<< "result: " << resultstr;
+		throw std::runtime_error( msg.str());
+	}
+}
+
+struct FieldDef
+{
+	int configIdx;
+	int start;
+	int end;
+	const char* ids[3];	///< ids assigned in separate calls, each can be a list of ids separated by FIELD_ID_SEPARATOR
+};
+
+struct FixedTest
+{
+	DI::StructureType structureType;
+	FieldDef fields[12];
+	const char* expected;
+};
+
+/// \brief Cases with fields with multiple ids and expected result written out
+static const FixedTest g_fixedTests[] =
+{
+	{DI::StructureCover, {
+		{0, 1,10, {"a,b",0}},
+		{1, 2,4, {"b",0}},
+		{1, 3,4, {"a",0}},
+		{1, 5,8, {"c","a",0}},
+		{1, 1,10, {"a",0}},
+		{1, 6,7, {"d",0}},
+		{0, 11,20, {"d",0}},
+		{1, 12,13, {"x,d",0}},
+		{-1, 0,0, {0}}},
+		"[1-10]->[2-4] [1-10]->[5-8] [11-20]->[12-13]"
+	},
+	{DI::StructureLabel, {
+		{0, 3,4, {"a",0}},
+		{1, 1,10, {"a,b",0}},
+		{1, 2,6, {"b","a",0}},
+		{1, 2,8, {"c",0}},
+		{1, 3,4, {"a",0}},
+		{0, 12,13, {"x,y",0}},
+		{1, 11,15, {"y",0}},
+		{1, 11,14, {"x",0}},
+		{-1, 0,0, {0}}},
+		"[12-13]->[11-14] [3-4]->[2-6]"
+	},
+	{DI::StructureSpan, {
+		{0, 1,2, {"a,b",0}},
+		{1, 3,4, {"x",0}},
+		{1, 5,6, {"c","b",0}},
+		{1, 7,8, {"a",0}},
+		{0, 9,10, {"c",0}},
+		{0, 11,12, {"d","e",0}},
+		{1, 13,14, {"e,f",0}},
+		{-1, 0,0, {0}}},
+		"[1-2]->[1-5] [11-12]->[11-13] [9-10]->[9-eod]"
+	},
+	{DI::StructureAssociative, {
+		{0, 1,2, {"a,b",0}},
+		{1, 3,6, {"a",0}},
+		{1, 4,5, {"b",0}},
+		{1, 8,9, {"b,c",0}},
+		{1, 1,2, {"a",0}},
+		{0, 10,11, {"c","d",0}},
+		{1, 12,13, {"d",""}},
+		{-1, 0,0, {0}}},
+		"[1-2]->[3-6] [1-2]->[8-9] [10-11]->[12-13] [10-11]->[8-9]"
+	},
+	{DI::StructureCover, {{-1, 0,0, {0}}}, 0}
+};
+
+static void runFixedTest( SearchIndexStructureBuilder& builder, const std::vector<SeachIndexFieldConfig>& fieldConfigs, unsigned int testidx, const FixedTest& test)
+{
+	SearchIndexFieldIdMap idmap;
+	std::vector<SearchIndexField> fields;
+	FieldDef const* fi = test.fields;
+	for (; fi->configIdx >= 0; ++fi)
+	{
+		fields.push_back( SearchIndexField( fi->configIdx, 0/*scopeIdx*/));
+		fields.back().setStart( analyzer::Position( fi->start, 0));
+		fields.back().setEnd( analyzer::Position( fi->end, 0));
+		for (int ii=0; ii < 3 && fi->ids[ ii]; ++ii)
+		{
+			fields.back().setId( fi->ids[ ii], idmap);
+		}
+	}
+	std::vector<SearchIndexStructure> previous;
+	oldBuild( previous, fieldConfigs, test.structureType, fields, 0);
+	std::vector<SearchIndexStructure> result;
+	builder.build( result, 0, test.structureType, fieldConfigs, fields);
+
+	std::string previousstr = structuresString( previous);
+	std::string resultstr = structuresString( result);
+	if (resultstr != test.expected || previousstr != test.expected)
+	{
+		std::ostringstream msg;
+		msg << "fixed test " << testidx << ": structures of type " << DI::structureTypeName( test.structureType) << " built differ from expected" << std::endl
+			<< "fields:" << std::endl << fieldsString( fields)
+			<< "expected: " << test.expected << std::endl
+			<< "result: " << resultstr << std::endl
+			<< "previous implementation: " << previousstr;
+		throw std::runtime_error( msg.str());
+	}
+}
+
+static unsigned int getUintValue( const char* arg)
+{
+	unsigned int rt = 0, prev = 0;
+	char const* cc = arg;
+	for (; *cc; ++cc)
+	{
+		if (*cc < '0' || *cc > '9') throw std::runtime_error( std::string( "parameter is not a non negative integer number: ") + arg);
+		rt = (rt * 10) + (*cc - '0');
+		if (rt < prev) throw std::runtime_error( std::string( "parameter out of range: ") + arg);
+		prev = rt;
+	}
+	return rt;
+}
+
+static void printUsage( int argc, const char* argv[])
+{
+	std::cerr << "usage: " << argv[0] << " <nofTests> <maxNofFields>" << std::endl;
+	std::cerr << "<nofTests> = number of random tests to run" << std::endl;
+	std::cerr << "<maxNofFields> = maximum number of fields of a random test" << std::endl;
+}
+
+int main( int argc, const char* argv[])
+{
+	if (argc <= 1 || std::strcmp( argv[1], "-h") == 0 || std::strcmp( argv[1], "--help") == 0)
+	{
+		printUsage( argc, argv);
+		return 0;
+	}
+	else if (argc != 3)
+	{
+		std::cerr << "ERROR wrong number of parameters" << std::endl;
+		printUsage( argc, argv);
+		return 1;
+	}
+	try
+	{
+		unsigned int nofTests = getUintValue( argv[1]);
+		unsigned int maxNofFields = getUintValue( argv[2]);
+		if (maxNofFields == 0) throw std::runtime_error( "maximum number of fields must be positive");
+
+		std::vector<SeachIndexFieldConfig> fieldConfigs = createFieldConfigs();
+		// ... builder reused for all tests, as done for a document analyzed
+		SearchIndexStructureBuilder builder;
+		unsigned int ti = 0;
+		for (; g_fixedTests[ ti].fields[0].configIdx >= 0; ++ti)
+		{
+			runFixedTest( builder, fieldConfigs, ti, g_fixedTests[ ti]);
+		}
+		for (ti = 0; ti < nofTests; ++ti)
+		{
+			runRandomTest( builder, fieldConfigs, ti, maxNofFields);
+		}
+		std::cerr << "OK " << nofTests << " tests" << std::endl;
+		return 0;
+	}
+	catch (const std::bad_alloc&)
+	{
+		std::cerr << "ERROR memory allocation error" << std::endl;
+		return 2;
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "ERROR " << e.what() << std::endl;
+		return 1;
+	}
+}
+
@@ -103,11 +103,12 @@ static std::vector<Rule> parseRules( const std::string& src)
 typedef textwolf::XMLPathSelectAutomatonParser<> Automaton;
 typedef textwolf::XMLPathSelect<textwolf::charset::UTF8> XMLPathSelect;
 
-static void feedAutomaton( Automaton& automaton, const std::vector<Rule>& rules)
+static void feedAutomaton( Automaton& automaton, strus::XPathTagFilter& tagFilter, const std::vector<Rule>& rules)
 {
 	std::vector<Rule>::const_iterator ri = rules.begin(), re = rules.end();
 	for (int ridx=0; ri != re; ++ri,++ridx)
 	{
+		tagFilter.addExpression( ri->expression);
 		int errorpos = automaton.addExpression( ridx+1, ri->expression.c_str(), ri->expression.size());
 		if (errorpos) throw std::runtime_error( strus::string_format("error in selection expression '%s' on line %d, pos %d, at %s", ri->expression.c_str(), ri->linecnt, errorpos, ri->expression.c_str()+errorpos-1));
 	}
@@ -163,9 +164,10 @@ int main( int argc, const char* argv[])
 				std::string
 			> XMLScanner;
 		Automaton automaton;
+		strus::XPathTagFilter tagFilter;
 		std::vector<Rule> rules = parseRules( rulesrc);
-		feedAutomaton( automaton, rules);
-		strus::XPathAutomatonContext xpathselect( &automaton);
+		feedAutomaton( automaton, tagFilter, rules);
+		strus::XPathAutomatonContext xpathselect( &automaton, &tagFilter);
 		textwolf::SrcIterator srciter( inputsrc.c_str(), inputsrc.size(), 0/*no jmpbuf, throws*/);
 		XMLScanner scanner( srciter);
 		typename XMLScanner::iterator itr = scanner.begin(false);
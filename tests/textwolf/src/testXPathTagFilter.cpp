@@ -0,0 +1,331 @@
+/*
+ * Copyright (c) 2020 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Test of the filter of tags not referenced by selector expressions, skipping subtrees in the selection of XML elements
+/// \file testXPathTagFilter.cpp
+#include "textwolf.hpp"
+#include "private/xpathAutomaton.hpp"
+#include "strus/base/string_format.hpp"
+#include "strus/base/pseudoRandom.hpp"
+#include <string>
+#include <vector>
+#include <cstring>
+#include <stdexcept>
+#include <iostream>
+#include <sstream>
+
+static strus::PseudoRandom g_random;
+
+typedef textwolf::XMLPathSelectAutomatonParser<> Automaton;
+typedef textwolf::XMLScanner<
+		textwolf::SrcIterator,
+		textwolf::charset::UTF8,
+		textwolf::charset::UTF8,
+		std::string
+	> XMLScanner;
+
+static void printUsage( int argc, const char* argv[])
+{
+	std::cerr << "usage: " << argv[0] << " <nofTests>" << std::endl;
+	std::cerr << "<nofTests> = number of random documents to select elements from" << std::endl;
+}
+
+static strus::XPathTagFilter createTagFilter( const char** expressions)
+{
+	strus::XPathTagFilter rt;
+	char const** ei = expressions;
+	for (; *ei; ++ei)
+	{
+		rt.addExpression( *ei);
+	}
+	return rt;
+}
+
+static void checkFilter( const char** expressions, bool expectEnabled, const char** contained, const char** notContained)
+{
+	strus::XPathTagFilter filter = createTagFilter( expressions);
+	if (filter.enabled() != expectEnabled)
+	{
+		throw std::runtime_error( strus::string_format( "tag filter of expressions starting with '%s' is %s", expressions[0], filter.enabled() ? "enabled" : "disabled"));
+	}
+	char const** ti = contained;
+	for (; ti && *ti; ++ti)
+	{
+		if (!filter.contains( *ti, std::strlen( *ti)))
+		{
+			throw std::runtime_error( strus::string_format( "tag '%s' missing in tag filter of expressions starting with '%s'", *ti, expressions[0]));
+		}
+	}
+	for (ti = notContained; ti && *ti; ++ti)
+	{
+		if (filter.contains( *ti, std::strlen( *ti)))
+		{
+			throw std::runtime_error( strus::string_format( "tag '%s' unexpected in tag filter of expressions starting with '%s'", *ti, expressions[0]));
+		}
+	}
+}
+
+static void testFilterExpressions()
+{
+	// Absolute paths of named tags, names compared case insensitive, attribute names and values in conditions are no tags:
+	static const char* expr1[] = {"/doc/title()", "/doc/Item@id", "/doc/item[@lang='a/b*']/text()", "/doc/meta~", " / doc / head ", 0};
+	static const char* in1[] = {"doc", "DOC", "title", "item", "ITEM", "text", "meta", "head", 0};
+	static const char* notin1[] = {"id", "lang", "a", "b", "skip", "", "titles", 0};
+	checkFilter( expr1, true, in1, notin1);
+
+	// Descendant steps, wildcards and relative paths can select elements in any subtree and disable the filter:
+	static const char* expr2[] = {"/doc/title()", "//title()", 0};
+	checkFilter( expr2, false, 0, 0);
+	static const char* expr3[] = {"/doc//title()", 0};
+	checkFilter( expr3, false, 0, 0);
+	static const char* expr4[] = {"/doc/*/title()", 0};
+	checkFilter( expr4, false, 0, 0);
+	static const char* expr5[] = {"/*", 0};
+	checkFilter( expr5, false, 0, 0);
+	static const char* expr6[] = {"doc/title()", 0};
+	checkFilter( expr6, false, 0, 0);
+	static const char* expr7[] = {"//title()", "/doc/title()", 0};
+	checkFilter( expr7, false, 0, 0);
+
+	// Many tags, to get the hash table grown several times:
+	strus::XPathTagFilter filter;
+	int ti = 0, te = 300;
+	for (; ti < te; ++ti)
+	{
+		filter.addExpression( strus::string_format( "/doc/tag%d()", ti));
+	}
+	if (!filter.enabled()) throw std::runtime_error( "tag filter with many tags disabled");
+	for (ti = 0; ti < te; ++ti)
+	{
+		std::string tagname = strus::string_format( "tag%d", ti);
+		if (!filter.contains( tagname.c_str(), tagname.size())) throw std::runtime_error( strus::string_format( "tag '%s' missing in tag filter with many tags", tagname.c_str()));
+		tagname = strus::string_format( "tag%d", ti + te);
+		if (filter.contains( tagname.c_str(), tagname.size())) throw std::runtime_error( strus::string_format( "tag '%s' unexpected in tag filter with many tags", tagname.c_str()));
+	}
+}
+
+/// \brief Get the list of elements selected in a document as string "<id>:<content>" separated by ';'
+static std::string selectElements( const Automaton& automaton, const strus::XPathTagFilter& tagFilter, const std::string& content)
+{
+	strus::XPathAutomatonContext xpathselect( &automaton, &tagFilter);
+	textwolf::SrcIterator srciter( content.c_str(), content.size(), 0/*no jmpbuf, throws*/);
+	XMLScanner scanner( srciter);
+	XMLScanner::iterator itr = scanner.begin(false);
+
+	std::ostringstream out;
+	for (;;)
+	{
+		++itr;
+		XMLScanner::ElementType et = itr->type();
+		if (et == XMLScanner::ErrorOccurred)
+		{
+			const char* errstr = "";
+			scanner.getError( &errstr);
+			throw std::runtime_error( strus::string_format( "error in document at position %u: %s", (unsigned int)scanner.getTokenPosition(), errstr));
+		}
+		else if (et == XMLScanner::Exit)
+		{
+			break;
+		}
+		xpathselect.putElement( et, itr->content(), itr->size());
+		int id;
+		while (xpathselect.getNext( id))
+		{
+			out << id << ":" << std::string( itr->content(), itr->size()) << ";";
+		}
+	}
+	return out.str();
+}
+
+static void defineExpressions( Automaton& automaton, strus::XPathTagFilter& tagFilter, const char** expressions)
+{
+	char const** ei = expressions;
+	for (int eidx=1; *ei; ++ei,++eidx)
+	{
+		int errorpos = automaton.addExpression( eidx, *ei, std::strlen( *ei));
+		if (errorpos) throw std::runtime_error( strus::string_format( "error in selection expression '%s' at position %d", *ei, errorpos));
+		tagFilter.addExpression( *ei);
+	}
+}
+
+/// \brief Check the elements selected, all of 'expected' must be part of the result, the result must be equal to 'expected' if the filter is enabled
+static void checkSelection( const char** expressions, const std::string& content, bool expectEnabled, const char** expected)
+{
+	Automaton automaton;
+	strus::XPathTagFilter tagFilter;
+	defineExpressions( automaton, tagFilter, expressions);
+	if (tagFilter.enabled() != expectEnabled)
+	{
+		throw std::runtime_error( strus::string_format( "tag filter of expressions starting with '%s' is %s", expressions[0], tagFilter.enabled() ? "enabled" : "disabled"));
+	}
+	std::string result = selectElements( automaton, tagFilter, content);
+	std::string expectedstr;
+	char const** ei = expected;
+	for (; *ei; ++ei)
+	{
+		expectedstr.append( *ei);
+		if (std::strstr( result.c_str(), *ei) == 0)
+		{
+			std::cerr << "EXPECTED " << *ei << std::endl << "GOT " << result << std::endl;
+			throw std::runtime_error( strus::string_format( "element missing in selection with expressions starting with '%s'", expressions[0]));
+		}
+	}
+	if (expectEnabled && result != expectedstr)
+	{
+		std::cerr << "EXPECTED " << expectedstr << std::endl << "GOT " << result << std::endl;
+		throw std::runtime_error( strus::string_format( "selection with expressions starting with '%s' not as expected", expressions[0]));
+	}
+}
+
+static void testSelectionFixed()
+{
+	std::string content( "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+		"<doc><skip><title>hidden</title><skip><title>deep</title></skip></skip><title>visible</title><item id=\"1\">x<skip id=\"2\"/></item></doc>");
+
+	// ... the subtrees of 'skip' are skipped, elements selected must be the same as without filter:
+	static const char* expr1[] = {"/doc/title()", "/doc/item@id", 0};
+	static const char* sel1[] = {"1:visible;", "2:1;", 0};
+	checkSelection( expr1, content, true, sel1);
+
+	// ... paths with '//' or '*' must still select elements in the subtrees of tags not named in any expression:
+	static const char* expr2[] = {"/doc/title()", "//title()", 0};
+	static const char* sel2[] = {"2:hidden;", "2:deep;", "1:visible;", 0};
+	checkSelection( expr2, content, false, sel2);
+	static const char* expr3[] = {"/doc/*/title()", 0};
+	static const char* sel3[] = {"1:hidden;", 0};
+	checkSelection( expr3, content, false, sel3);
+}
+
+static std::string randomDocument()
+{
+	static const char* tagnames[] = {"doc","title","item","text","skip","meta","Title","ITEM"};
+	std::ostringstream out;
+	out << "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n<doc>";
+	std::vector<const char*> stk;
+	int ei = 0, ee = g_random.get( 1, 200);
+	for (; ei < ee; ++ei)
+	{
+		switch (g_random.get( 0, 4))
+		{
+			case 0:
+			case 1:
+				if (stk.size() < 6)
+				{
+					const char* tagname = tagnames[ g_random.get( 0, sizeof(tagnames)/sizeof(tagnames[0]))];
+					out << "<" << tagname;
+					if (g_random.get( 0, 3) == 0)
+					{
+						out << " id=\"" << g_random.get( 0, 5) << "\"";
+					}
+					if (g_random.get( 0, 5) == 0)
+					{
+						out << "/>";
+					}
+					else
+					{
+						out << ">";
+						stk.push_back( tagname);
+					}
+					break;
+				}
+				/*no break here!*/
+			case 2:
+				if (!stk.empty())
+				{
+					out << "</" << stk.back() << ">";
+					stk.pop_back();
+					break;
+				}
+				/*no break here!*/
+			case 3:
+				out << "w" << g_random.get( 0, 100);
+				break;
+		}
+	}
+	for (; !stk.empty(); stk.pop_back())
+	{
+		out << "</" << stk.back() << ">";
+	}
+	out << "</doc>";
+	return out.str();
+}
+
+static void testSelectionRandom( int nofTests)
+{
+	// Absolute paths only, so that the filter is enabled, compared with the selection without filter:
+	static const char* expressions[] = {
+		"/doc/title()", "/doc/item@id", "/doc/item/text()", "/doc/item/title~", "/doc/text/item",
+		"/doc/item[@id='2']/title()", "/doc/meta/meta/title()", 0};
+	Automaton automaton;
+	strus::XPathTagFilter tagFilter;
+	defineExpressions( automaton, tagFilter, expressions);
+	if (!tagFilter.enabled()) throw std::runtime_error( "tag filter of random selection test disabled");
+	strus::XPathTagFilter disabledFilter;
+	disabledFilter.addExpression( "//title()");
+
+	int ti = 0;
+	for (; ti < nofTests; ++ti)
+	{
+		std::string content = randomDocument();
+		std::string result = selectElements( automaton, tagFilter, content);
+		std::string expected = selectElements( automaton, disabledFilter, content);
+		if (result != expected)
+		{
+			std::cerr << "DOCUMENT " << content << std::endl << "EXPECTED " << expected << std::endl << "GOT " << result << std::endl;
+			throw std::runtime_error( strus::string_format( "selection with tag filter differs from selection without in test %d", ti));
+		}
+	}
+}
+
+static int getUintValue( const char* arg)
+{
+	int rt = 0, prev = 0;
+	char const* cc = arg;
+	for (; *cc; ++cc)
+	{
+		if (*cc < '0' || *cc > '9') throw std::runtime_error( std::string( "parameter is not a non negative integer number: ") + arg);
+		rt = (rt * 10) + (*cc - '0');
+		if (rt < prev) throw std::runtime_error( std::string( "parameter out of range: ") + arg);
+		prev = rt;
+	}
+	return rt;
+}
+
+int main( int argc, const char* argv[])
+{
+	if (argc <= 1 || std::strcmp( argv[1], "-h") == 0 || std::strcmp( argv[1], "--help") == 0)
+	{
+		printUsage( argc, argv);
+		return 0;
+	}
+	else if (argc > 2)
+	{
+		std::cerr << "ERROR too many parameters" << std::endl;
+		printUsage( argc, argv);
+		return 1;
+	}
+	try
+	{
+		int nofTests = getUintValue( argv[1]);
+		testFilterExpressions();
+		testSelectionFixed();
+		testSelectionRandom( nofTests);
+		std::cerr << "OK" << std::endl;
+		return 0;
+	}
+	catch (const std::bad_alloc&)
+	{
+		std::cerr << "ERROR memory allocation error" << std::endl;
+		return 2;
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "ERROR " << e.what() << std::endl;
+		return 1;
+	}
+}
+